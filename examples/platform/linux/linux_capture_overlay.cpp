@@ -380,16 +380,22 @@ void CaptureOverlay::HandleToolbarClick(int mx, int my,
   gtk_widget_queue_draw(window_);
 }
 
-void CaptureOverlay::CopyToClipboard() {
-  if (sel_w_ <= 0 || sel_h_ <= 0) return;
+// Crop the selection out of the frozen screenshot.  The view shares the
+// screenshot's pixels (no copy, no recapture of the overlay itself) and
+// stays valid after Dismiss() destroys screenshot_.
+PixelGrabImage* CaptureOverlay::SelectionImage() const {
+  if (!screenshot_ || sel_w_ <= 0 || sel_h_ <= 0) return nullptr;
+  int sw = pixelgrab_image_get_width(screenshot_);
+  int sh = pixelgrab_image_get_height(screenshot_);
+  int x0 = std::max(sel_x_, 0), y0 = std::max(sel_y_, 0);
+  int x1 = std::min(sel_x_ + sel_w_, sw), y1 = std::min(sel_y_ + sel_h_, sh);
+  if (x1 <= x0 || y1 <= y0) return nullptr;
+  return pixelgrab_image_create_view(screenshot_, x0, y0, x1 - x0, y1 - y0);
+}
 
-  auto& app = LinuxApplication::instance();
-  PixelGrabImage* region = pixelgrab_capture_region(
-      app.Ctx(), sel_x_, sel_y_, sel_w_, sel_h_);
-  if (!region) {
-    // Fallback: crop from the already-captured screenshot.
-    region = screenshot_;
-  }
+void CaptureOverlay::CopyToClipboard() {
+  PixelGrabImage* region = SelectionImage();
+  if (!region) return;
 
   // Use GTK clipboard to copy the image.
   int w = pixelgrab_image_get_width(region);
@@ -418,21 +424,17 @@ void CaptureOverlay::CopyToClipboard() {
   gtk_clipboard_store(clipboard);
   g_object_unref(pb);
 
-  if (region != screenshot_)
-    pixelgrab_image_destroy(region);
+  pixelgrab_image_destroy(region);
 
   std::printf("[Capture] Copied to clipboard (%dx%d).\n", w, h);
   Dismiss();
 }
 
 void CaptureOverlay::PinSelection() {
-  if (sel_w_ <= 0 || sel_h_ <= 0) return;
-
-  auto& app = LinuxApplication::instance();
-  PixelGrabImage* region = pixelgrab_capture_region(
-      app.Ctx(), sel_x_, sel_y_, sel_w_, sel_h_);
+  PixelGrabImage* region = SelectionImage();
   if (!region) return;
 
+  auto& app = LinuxApplication::instance();
   pixelgrab_pin_image(app.Ctx(), region, sel_x_, sel_y_);
   pixelgrab_image_destroy(region);
 
@@ -441,11 +443,7 @@ void CaptureOverlay::PinSelection() {
 }
 
 void CaptureOverlay::SaveToFile() {
-  if (sel_w_ <= 0 || sel_h_ <= 0) return;
-
-  auto& app = LinuxApplication::instance();
-  PixelGrabImage* region = pixelgrab_capture_region(
-      app.Ctx(), sel_x_, sel_y_, sel_w_, sel_h_);
+  PixelGrabImage* region = SelectionImage();
   if (!region) return;
 
   // Use GTK file chooser.
@@ -31,6 +31,7 @@ class CaptureOverlay {
   void DrawToolbar(cairo_t* cr, int win_w, int win_h);
 
   void HandleToolbarClick(int mx, int my, int win_w, int win_h);
+  PixelGrabImage* SelectionImage() const;
   void CopyToClipboard();
   void PinSelection();
   void SaveToFile();
@@ -40,19 +40,34 @@ extern "C" {
 // General rules:
 //   - Each PixelGrabContext is independent; different contexts may be used
 //     concurrently from different threads without external synchronization.
-//   - Operations on the SAME context, annotation, pin window, or recorder
-//     handle are NOT thread-safe.  The caller must serialize access to a
-//     single handle (e.g. with a mutex) if it is shared across threads.
+//   - Screen queries, captures (pixelgrab_capture_*), color picking, the
+//     magnifier, window enumeration, DPI queries and the capture history
+//     may be called on the SAME context from several threads.  Captures
+//     then run in parallel on additional display connections (see
+//     PixelGrabContextOptions::max_capture_connections); window capture,
+//     incremental capture and enumeration share the context's first
+//     connection and take turns.  The last error reflects whichever call
+//     finished last.
+//   - Other operations on the SAME context, and any on an annotation, pin
+//     window, recorder or tile tracker handle, are NOT thread-safe.  The
+//     caller must serialize access to a single handle (e.g. with a mutex)
+//     if it is shared across threads.
 //   - PixelGrabImage objects are immutable after creation; reading image
 //     properties and data is safe from multiple threads simultaneously.
 //   - pixelgrab_set_log_level() and pixelgrab_set_log_callback() are
 //     process-global and internally synchronized.
+//   - pixelgrab_buffer_pool_*() functions are process-global and internally
+//     synchronized; images may be destroyed from any thread.
+//   - A PixelGrabStream captures on its own thread with its own display
+//     connection.  pixelgrab_stream_poll(), _set_callback() and
+//     _get_stats() may be called from any thread; _destroy() must not race
+//     with the other stream calls.
 //   - pixelgrab_version_*() and pixelgrab_color_*() utility functions are
 //     stateless and safe to call from any thread at any time.
 //
 // Recommended pattern:
-//   Create one PixelGrabContext per thread, or protect a shared context
-//   with a mutex.
+//   Share one PixelGrabContext between capture threads, or create one per
+//   thread; protect other shared handles with a mutex.
 //
 
 // ---------------------------------------------------------------------------
@@ -63,6 +78,8 @@ typedef struct PixelGrabImage PixelGrabImage;
 typedef struct PixelGrabAnnotation PixelGrabAnnotation;
 typedef struct PixelGrabPinWindow PixelGrabPinWindow;
 typedef struct PixelGrabRecorder PixelGrabRecorder;
+typedef struct PixelGrabStream PixelGrabStream;
+typedef struct PixelGrabTileTracker PixelGrabTileTracker;
 
 // ---------------------------------------------------------------------------
 // Types
@@ -130,8 +147,29 @@ typedef enum PixelGrabPixelFormat {
   kPixelGrabFormatBgra8 = 0,   ///< B8G8R8A8 (default, most common)
   kPixelGrabFormatRgba8 = 1,   ///< R8G8B8A8
   kPixelGrabFormatNative = 2,  ///< Platform native format, zero conversion
+                               ///< (B8G8R8A8 with opaque alpha on all
+                               ///< current platforms)
 } PixelGrabPixelFormat;
 
+/// How pixelgrab_capture_window() obtains a window's pixels.
+typedef enum PixelGrabWindowCaptureMode {
+  kPixelGrabWindowCaptureScreen = 0,   ///< Read the window's area of the
+                                       ///< screen (default); windows on top
+                                       ///< of it are captured too
+  kPixelGrabWindowCaptureContent = 1,  ///< Read the window's own contents,
+                                       ///< even when covered or partly
+                                       ///< off-screen
+} PixelGrabWindowCaptureMode;
+
+/// Resampling filter for pixelgrab_image_resize() and
+/// pixelgrab_capture_region_scaled().
+typedef enum PixelGrabResizeFilter {
+  kPixelGrabFilterBox = 0,       ///< Area average; fastest, sharp downscale
+  kPixelGrabFilterBilinear = 1,  ///< Triangle filter; smooth, no ringing
+  kPixelGrabFilterLanczos3 = 2,  ///< 3-lobe Lanczos; sharpest, may ring at
+                                 ///< hard edges
+} PixelGrabResizeFilter;
+
 /// RGBA color value (8-bit per channel).
 typedef struct PixelGrabColor {
   uint8_t r;
@@ -156,6 +194,42 @@ typedef struct PixelGrabDpiInfo {
   int dpi_y;         ///< Vertical DPI value
 } PixelGrabDpiInfo;
 
+/// Axis-aligned rectangle in virtual screen (or image) coordinates.
+typedef struct PixelGrabRect {
+  int x;       ///< Left edge
+  int y;       ///< Top edge
+  int width;   ///< Width in pixels
+  int height;  ///< Height in pixels
+} PixelGrabRect;
+
+/// Counters of the process-wide image buffer pool.
+typedef struct PixelGrabBufferPoolStats {
+  uint64_t acquire_count;      ///< Buffers requested by new images
+  uint64_t hit_count;          ///< Requests served from an idle pooled buffer
+  uint64_t miss_count;         ///< Requests that needed a fresh allocation
+  uint64_t evict_count;        ///< Idle buffers freed to honor the limit
+  uint64_t bytes_in_use;       ///< Bytes held by live images
+  uint64_t peak_bytes_in_use;  ///< Highest bytes_in_use observed
+  uint64_t bytes_pooled;       ///< Idle bytes kept for reuse
+  uint64_t max_pooled_bytes;   ///< Current high-water mark for bytes_pooled
+} PixelGrabBufferPoolStats;
+
+/// Counters of a capture stream (see pixelgrab_stream_create()).
+typedef struct PixelGrabStreamStats {
+  uint64_t frames_captured;   ///< Frames written into the ring
+  uint64_t frames_delivered;  ///< Frames returned by poll or passed to the
+                              ///< callback
+  uint64_t frames_dropped;    ///< Frames replaced by a newer one before
+                              ///< they were delivered
+  uint64_t frames_late;       ///< Ticks skipped because capture overran
+                              ///< the frame interval
+  uint64_t capture_errors;    ///< Failed capture attempts
+  uint64_t slots_replaced;    ///< Ring slots re-allocated because every
+                              ///< slot was still held by a consumer
+  double avg_capture_ms;      ///< Mean time spent capturing one frame
+  double max_capture_ms;      ///< Slowest single capture
+} PixelGrabStreamStats;
+
 /// Shape drawing style for annotation tools.
 typedef struct PixelGrabShapeStyle {
   uint32_t stroke_color;  ///< Stroke color in ARGB format (0xAARRGGBB)
@@ -196,6 +270,36 @@ typedef struct PixelGrabHistoryEntry {
   int64_t timestamp;   ///< Unix timestamp (seconds)
 } PixelGrabHistoryEntry;
 
+/// Lossless compression of the images kept in the capture history.
+typedef enum PixelGrabHistoryCodec {
+  kPixelGrabHistoryCodecPixel = 0,  ///< Pixel runs, row copies and QOI-style
+                                    ///< colour deltas (default)
+  kPixelGrabHistoryCodecRle = 1,    ///< Byte-level RLE (the former format)
+} PixelGrabHistoryCodec;
+
+/// Storage used by the capture history.
+typedef struct PixelGrabHistoryUsage {
+  int entry_count;        ///< Entries (with or without a stored image)
+  int image_count;        ///< Entries whose image is stored
+  uint64_t raw_bytes;     ///< Uncompressed size of the stored images
+  uint64_t stored_bytes;  ///< Compressed size of the stored images (and
+                          ///< of keyframes their deltas still use)
+  uint64_t dropped_images;  ///< Images not stored because the compression
+                            ///< queue was full (drop policy)
+  int disk_entry_count;   ///< Entries kept in the history directory only
+  uint64_t disk_bytes;    ///< Size of the history directory's segments
+  uint64_t thumbnail_bytes;  ///< Size of the stored thumbnails
+} PixelGrabHistoryUsage;
+
+/// What a capture does when the history's compression queue is full.
+typedef enum PixelGrabHistoryBackpressure {
+  kPixelGrabHistoryBackpressureInline = 0,  ///< Compress on the capturing
+                                            ///< thread (default)
+  kPixelGrabHistoryBackpressureBlock = 1,   ///< Wait for a free queue slot
+  kPixelGrabHistoryBackpressureDrop = 2,    ///< Record the region only; the
+                                            ///< image is not stored
+} PixelGrabHistoryBackpressure;
+
 /// Information about a display screen / monitor.
 typedef struct PixelGrabScreenInfo {
   int index;       ///< Screen index (0-based)
@@ -293,6 +397,43 @@ typedef struct PixelGrabRecordConfig {
                                       ///<  -1 = force CPU (never use GPU)
 } PixelGrabRecordConfig;
 
+/// Capture backend implementation, chosen at context creation.
+typedef enum PixelGrabBackendType {
+  kPixelGrabBackendDefault = 0,  ///< Platform default (Xlib on Linux)
+  kPixelGrabBackendXcb = 1,      ///< Linux: XCB with pipelined requests;
+                                 ///< suited to remote (SSH/VNC) displays
+  kPixelGrabBackendSynthetic = 2,  ///< Generated test scene, no display
+                                   ///< server (all platforms)
+} PixelGrabBackendType;
+
+/// Scene of the synthetic backend.  Zero sizes and counts select the
+/// defaults; the damage rate is used as given.
+typedef struct PixelGrabSyntheticConfig {
+  int screen_count;     ///< Virtual monitors, side by side (0 = 1)
+  int screen_width;     ///< Width of each monitor (0 = 1920)
+  int screen_height;    ///< Height of each monitor (0 = 1080)
+  int damage_percent;   ///< Share of 64x64 tiles that animate, 0..100
+  int fps;              ///< Scene frame rate against the wall clock
+                        ///< (0 = advance one frame per capture call)
+  uint32_t seed;        ///< Scene layout seed
+} PixelGrabSyntheticConfig;
+
+/// Options for pixelgrab_context_create_with_options().  Zero-initialize
+/// for the defaults.
+typedef struct PixelGrabContextOptions {
+  PixelGrabBackendType backend;  ///< Capture backend (0 = default)
+  int max_capture_connections;   ///< Display connections captures may use
+                                 ///< concurrently (0 = up to 4, bounded by
+                                 ///< the CPU count; 1 = a single one)
+  const PixelGrabSyntheticConfig* synthetic;  ///< Synthetic scene (NULL =
+                                              ///< PIXELGRAB_SYNTHETIC or
+                                              ///< the defaults)
+  const char* history_directory;  ///< Keep history evicted from memory in
+                                  ///< this directory, across sessions
+                                  ///< (UTF-8; NULL = memory only)
+  uint64_t history_disk_bytes;    ///< Size cap of that directory (0 = 4 GB)
+} PixelGrabContextOptions;
+
 // ---------------------------------------------------------------------------
 // Context management
 // ---------------------------------------------------------------------------
@@ -303,6 +444,46 @@ typedef struct PixelGrabRecordConfig {
 /// @return A new context, or NULL on failure.
 PIXELGRAB_API PixelGrabContext* pixelgrab_context_create(void);
 
+/// Create a context with explicit options.
+///
+/// kPixelGrabBackendXcb replaces the capture backend and the element
+/// detector with XCB implementations that send independent requests in
+/// one batch before collecting the replies, so window enumeration, element
+/// detection and pixelgrab_capture_regions() cost about one round-trip
+/// latency instead of one per request.  It uses the core protocol only
+/// (no MIT-SHM, XRandR or XDamage) and reports the root window as a single
+/// screen.  If the requested backend is not available in this build the
+/// default one is used; check pixelgrab_get_backend_type().
+///
+/// kPixelGrabBackendSynthetic needs no display server: it renders a
+/// reproducible scene of gradients, scrolling text and static panels on
+/// options->synthetic's virtual monitors, for benchmarks and CI.  The
+/// same configuration yields the same frames on every host.  Setting the
+/// environment variable PIXELGRAB_BACKEND=synthetic selects it for
+/// contexts that ask for the default backend; PIXELGRAB_SYNTHETIC then
+/// configures the scene, e.g. "screens=2,width=1280,height=720,damage=25,
+/// fps=0,seed=7".  No element detector is available on it.
+///
+/// options->history_directory adds an on-disk tier to the capture history.
+/// Entries and images that leave memory (past pixelgrab_history_set_max_count()
+/// or the memory budget) are appended to it instead of being discarded, and
+/// the history of the previous context that used the directory is picked up
+/// again without decoding anything.  Stored images are read back through a
+/// memory mapping when recaptured.  Once the directory exceeds
+/// history_disk_bytes the oldest entries are deleted.  Only one context
+/// may use a directory at a time.
+///
+/// @param options  Options, or NULL for the defaults.
+/// @return A new context, or NULL on failure.
+PIXELGRAB_API PixelGrabContext* pixelgrab_context_create_with_options(
+    const PixelGrabContextOptions* options);
+
+/// Get the capture backend the context actually uses: after a fallback
+/// to the default, or kPixelGrabBackendSynthetic if PIXELGRAB_BACKEND
+/// replaced the default.  Returns kPixelGrabBackendDefault if ctx is NULL.
+PIXELGRAB_API PixelGrabBackendType pixelgrab_get_backend_type(
+    const PixelGrabContext* ctx);
+
 /// Destroy a pixelgrab context and release all associated resources.
 ///
 /// @param ctx  Context to destroy. NULL is safely ignored.
@@ -369,6 +550,122 @@ PIXELGRAB_API PixelGrabImage* pixelgrab_capture_region(PixelGrabContext* ctx,
                                                        int x, int y, int width,
                                                        int height);
 
+/// Capture several regions at once.
+///
+/// Nearby regions are coalesced and each group is read from the screen in
+/// a single request (through MIT-SHM when available); every output image
+/// is a zero-copy view into its group's read (see
+/// pixelgrab_image_create_view()), so an output keeps the whole group's
+/// pixels alive until it is destroyed.  Regions are clipped to the screen
+/// like pixelgrab_capture_region().  Not recorded in capture history.
+///
+/// @param ctx         Initialized context.
+/// @param rects       Array of count regions in virtual screen coordinates.
+/// @param count       Number of regions.
+/// @param out_images  Caller-allocated array of count pointers.  Entry i
+///                    receives the image for rects[i], or NULL if that
+///                    region could not be captured (e.g. entirely
+///                    off-screen).  Free each non-NULL entry with
+///                    pixelgrab_image_destroy().
+/// @return kPixelGrabOk if every region was captured,
+///         kPixelGrabErrorCaptureFailed if some entries are NULL.
+PIXELGRAB_API PixelGrabError pixelgrab_capture_regions(
+    PixelGrabContext* ctx, const PixelGrabRect* rects, int count,
+    PixelGrabImage** out_images);
+
+/// Capture a region directly into a caller-provided BGRA8 buffer.
+///
+/// No image is allocated, so a capture loop can recycle one buffer for every
+/// frame.  Pixel (0, 0) of dst corresponds to (x, y); parts of the region
+/// that lie outside the screen are left unchanged.  Not recorded in capture
+/// history.
+///
+/// @param ctx         Initialized context.
+/// @param x           Left edge of the region.
+/// @param y           Top edge of the region.
+/// @param width       Width of the region in pixels.
+/// @param height      Height of the region in pixels.
+/// @param dst         Destination buffer of at least height * dst_stride
+///                    bytes.
+/// @param dst_stride  Bytes per destination row (>= width * 4).
+/// @return kPixelGrabOk on success.
+PIXELGRAB_API PixelGrabError pixelgrab_capture_region_into(
+    PixelGrabContext* ctx, int x, int y, int width, int height, uint8_t* dst,
+    int dst_stride);
+
+/// Capture a whole screen directly into a caller-provided BGRA8 buffer.
+///
+/// The buffer must be sized for the screen as reported by
+/// pixelgrab_get_screen_info() (height rows of dst_stride >= width * 4).
+///
+/// @param ctx           Initialized context.
+/// @param screen_index  Zero-based screen index.
+/// @param dst           Destination buffer.
+/// @param dst_stride    Bytes per destination row.
+/// @return kPixelGrabOk on success.
+PIXELGRAB_API PixelGrabError pixelgrab_capture_screen_into(
+    PixelGrabContext* ctx, int screen_index, uint8_t* dst, int dst_stride);
+
+/// Capture a region and resample it to out_width x out_height.
+///
+/// The region is read in horizontal strips that are filtered as they
+/// arrive, so the full-resolution region is never held in memory -- useful
+/// for thumbnails and previews of large (e.g. multi-monitor 8K) areas.
+/// Strips are separate reads, so content that changes during the call may
+/// be caught at slightly different moments from top to bottom.  Parts of
+/// the region outside the screen are black.  The image has the capture
+/// format (see pixelgrab_set_capture_format()).  Not recorded in capture
+/// history.
+///
+/// @param ctx         Initialized context.
+/// @param x           Left edge of the region.
+/// @param y           Top edge of the region.
+/// @param width       Width of the region in pixels.
+/// @param height      Height of the region in pixels.
+/// @param out_width   Width of the returned image (> 0).
+/// @param out_height  Height of the returned image (> 0).
+/// @param filter      Resampling filter.
+/// @return Scaled image, or NULL on failure.
+PIXELGRAB_API PixelGrabImage* pixelgrab_capture_region_scaled(
+    PixelGrabContext* ctx, int x, int y, int width, int height, int out_width,
+    int out_height, PixelGrabResizeFilter filter);
+
+/// Capture a region with damage tracking (incremental capture).
+///
+/// The first call starts tracking and reads the screen once.  Subsequent
+/// calls re-read only the areas that changed since the previous incremental
+/// capture on this context, so polling a mostly static screen is cheap.
+/// The returned image always contains the full (clipped) region.
+///
+/// Supported natively on Linux/X11 with the XDamage extension and by the
+/// synthetic backend, which reports exactly its animated tiles.  Elsewhere
+/// this behaves like pixelgrab_capture_region() and reports the whole region
+/// as changed.  Incremental captures are not recorded in capture history.
+///
+/// @param ctx                Initialized context.
+/// @param x                  Left edge of the region.
+/// @param y                  Top edge of the region.
+/// @param width              Width of the region in pixels.
+/// @param height             Height of the region in pixels.
+/// @param out_changed        Caller-allocated array receiving the changed
+///                           rectangles inside the region, in virtual screen
+///                           coordinates (may be NULL).
+/// @param max_changed        Capacity of out_changed.  If more rectangles
+///                           changed, a single bounding rectangle is written.
+/// @param out_changed_count  Receives the number of rectangles written to
+///                           out_changed (or the number of changed
+///                           rectangles if out_changed is NULL); 0 means
+///                           nothing changed.  May be NULL.
+/// @return Captured image, or NULL on failure.
+PIXELGRAB_API PixelGrabImage* pixelgrab_capture_region_incremental(
+    PixelGrabContext* ctx, int x, int y, int width, int height,
+    PixelGrabRect* out_changed, int max_changed, int* out_changed_count);
+
+/// Stop damage tracking and release the persistent framebuffer kept for
+/// pixelgrab_capture_region_incremental().  The next incremental capture
+/// starts over with a full read.
+PIXELGRAB_API void pixelgrab_capture_incremental_reset(PixelGrabContext* ctx);
+
 /// Capture the contents of a specific window.
 ///
 /// @param ctx        Initialized context.
@@ -377,6 +674,49 @@ PIXELGRAB_API PixelGrabImage* pixelgrab_capture_region(PixelGrabContext* ctx,
 PIXELGRAB_API PixelGrabImage* pixelgrab_capture_window(
     PixelGrabContext* ctx, PixelGrabWindowId window_id);
 
+/// Select the pixel format of images returned by pixelgrab_capture_screen(),
+/// pixelgrab_capture_region(), pixelgrab_capture_window(),
+/// pixelgrab_capture_region_incremental() and history recaptures.
+///
+/// Where the platform supports it (Linux/X11) the capture converts straight
+/// into the requested layout, so choosing kPixelGrabFormatRgba8 costs no
+/// extra pass over the pixels.  The *_into() functions always write BGRA8.
+/// The default is kPixelGrabFormatBgra8.
+///
+/// @param ctx     Context.
+/// @param format  Desired pixel format.
+/// @return kPixelGrabOk, or kPixelGrabErrorInvalidParam for an unknown format.
+PIXELGRAB_API PixelGrabError pixelgrab_set_capture_format(
+    PixelGrabContext* ctx, PixelGrabPixelFormat format);
+
+/// Get the pixel format selected with pixelgrab_set_capture_format().
+/// Returns kPixelGrabFormatBgra8 if ctx is NULL.
+PIXELGRAB_API PixelGrabPixelFormat pixelgrab_get_capture_format(
+    const PixelGrabContext* ctx);
+
+/// Select how pixelgrab_capture_window() reads window pixels.
+///
+/// kPixelGrabWindowCaptureContent is implemented on Linux/X11 with the
+/// XComposite extension: each captured window is redirected and its backing
+/// pixmap is kept for later captures, so repeated captures of a covered
+/// window read its own pixels directly.  Up to 8 windows are kept
+/// redirected; switching back to kPixelGrabWindowCaptureScreen (or
+/// destroying the context) releases them.  Windows that are not mapped
+/// (e.g. minimized) fall back to a screen read.
+///
+/// @param ctx   Initialized context.
+/// @param mode  Desired window capture mode.
+/// @return kPixelGrabOk, kPixelGrabErrorInvalidParam for an unknown mode, or
+///         kPixelGrabErrorNotSupported if the platform (or X server) cannot
+///         provide the mode.
+PIXELGRAB_API PixelGrabError pixelgrab_set_window_capture_mode(
+    PixelGrabContext* ctx, PixelGrabWindowCaptureMode mode);
+
+/// Get the mode selected with pixelgrab_set_window_capture_mode().
+/// Returns kPixelGrabWindowCaptureScreen if ctx is NULL.
+PIXELGRAB_API PixelGrabWindowCaptureMode pixelgrab_get_window_capture_mode(
+    const PixelGrabContext* ctx);
+
 // ---------------------------------------------------------------------------
 // Window enumeration
 // ---------------------------------------------------------------------------
@@ -415,6 +755,8 @@ PIXELGRAB_API const uint8_t* pixelgrab_image_get_data(
     const PixelGrabImage* image);
 
 /// Get the total size of the pixel data in bytes.
+/// For views (see pixelgrab_image_create_view()) the last row ends at the
+/// view's right edge: stride * (height - 1) + width * 4.
 PIXELGRAB_API size_t pixelgrab_image_get_data_size(
     const PixelGrabImage* image);
 
@@ -423,6 +765,66 @@ PIXELGRAB_API size_t pixelgrab_image_get_data_size(
 /// @param image  Image to destroy. NULL is safely ignored.
 PIXELGRAB_API void pixelgrab_image_destroy(PixelGrabImage* image);
 
+/// Create a zero-copy view of a rectangle inside an image.
+///
+/// The view shares the parent's pixel buffer: its data pointer is offset to
+/// (x, y) and its stride is the parent's stride.  No pixels are copied.  The
+/// view is an ordinary image in every other respect -- it may be exported,
+/// annotated, pinned, passed to OCR or watermarked, and must be freed with
+/// pixelgrab_image_destroy().  It stays valid after the parent is destroyed;
+/// the buffer lives until the last image referencing it is gone.
+///
+/// Modifying either image in place (e.g. pixelgrab_watermark_apply_text())
+/// first gives it a private copy, so the other is never affected.
+///
+/// @param image   Parent image (may itself be a view).
+/// @param x       Left edge of the view inside the parent.
+/// @param y       Top edge of the view inside the parent.
+/// @param width   View width (> 0).
+/// @param height  View height (> 0).
+/// @return New image, or NULL if image is NULL or the rectangle is empty or
+///         not entirely inside the parent.
+PIXELGRAB_API PixelGrabImage* pixelgrab_image_create_view(
+    const PixelGrabImage* image, int x, int y, int width, int height);
+
+/// Resample an image to width x height.
+///
+/// Uses the same SIMD resampler as pixelgrab_capture_region_scaled().
+/// Channels are filtered independently (alpha is not premultiplied).
+///
+/// @param image   Source image.
+/// @param width   Width of the new image (> 0).
+/// @param height  Height of the new image (> 0).
+/// @param filter  Resampling filter.
+/// @return New image in the source's pixel format, or NULL on invalid
+///         arguments.  Free with pixelgrab_image_destroy().
+PIXELGRAB_API PixelGrabImage* pixelgrab_image_resize(
+    const PixelGrabImage* image, int width, int height,
+    PixelGrabResizeFilter filter);
+
+// --- Image buffer pool ---
+//
+// Pixel storage is recycled through a process-wide pool bucketed by size
+// class, so repeated same-size captures reuse memory instead of allocating
+// and page-faulting a fresh buffer each time.  Destroying an image returns
+// its buffer to the pool.  These functions are process-global and
+// internally synchronized.
+
+/// Set the maximum number of idle bytes the pool keeps for reuse
+/// (default 256 MB).  Idle buffers beyond the limit are freed, oldest first.
+/// 0 disables pooling: buffers are freed as soon as their image is destroyed.
+PIXELGRAB_API void pixelgrab_buffer_pool_set_limit(uint64_t max_pooled_bytes);
+
+/// Free all idle pooled buffers.  Buffers held by live images are unaffected.
+PIXELGRAB_API void pixelgrab_buffer_pool_trim(void);
+
+/// Get pool counters.
+///
+/// @param out_stats  Receives the counters.
+/// @return kPixelGrabOk, or kPixelGrabErrorInvalidParam if out_stats is NULL.
+PIXELGRAB_API PixelGrabError pixelgrab_buffer_pool_get_stats(
+    PixelGrabBufferPoolStats* out_stats);
+
 // ---------------------------------------------------------------------------
 // DPI awareness
 // ---------------------------------------------------------------------------
@@ -670,13 +1072,81 @@ PIXELGRAB_API PixelGrabImage* pixelgrab_history_recapture(
 PIXELGRAB_API PixelGrabImage* pixelgrab_recapture_last(
     PixelGrabContext* ctx);
 
-/// Clear all capture history entries.
+/// Clear all capture history entries, including those in the context's
+/// history directory.
 PIXELGRAB_API void pixelgrab_history_clear(PixelGrabContext* ctx);
 
 /// Set the maximum number of history entries (default 50).
 PIXELGRAB_API void pixelgrab_history_set_max_count(
     PixelGrabContext* ctx, int max_count);
 
+/// Select how images recorded from now on are compressed; images already
+/// in the history keep their codec.  Stored images and thumbnails share a
+/// 128 MB budget (oldest evicted first), so a tighter codec keeps more of
+/// them.
+///
+/// @return kPixelGrabOk, or kPixelGrabErrorInvalidParam for an unknown
+///         codec.
+PIXELGRAB_API PixelGrabError pixelgrab_history_set_codec(
+    PixelGrabContext* ctx, PixelGrabHistoryCodec codec);
+
+/// Get the number of entries and stored images and their raw and
+/// compressed sizes.  Waits for queued images to finish compressing and
+/// for evicted ones to reach the history directory.
+PIXELGRAB_API PixelGrabError pixelgrab_history_get_usage(
+    PixelGrabContext* ctx, PixelGrabHistoryUsage* out_usage);
+
+/// Get a small preview of a history entry's image, e.g. for a gallery.
+///
+/// Every stored capture also gets a thumbnail, box-filtered to fit
+/// max_size x max_size pixels (see pixelgrab_history_set_thumbnail_size();
+/// smaller captures are copied at full size).  Thumbnails are made by the
+/// background worker, so browsing the history needs no full decode; they
+/// count against the memory budget and are evicted with their image.
+/// Entries without a thumbnail (still queued, evicted, or kept in the
+/// history directory) are scaled from their stored image.  Unlike
+/// pixelgrab_history_recapture() this never captures the screen.
+///
+/// Caller must free with pixelgrab_image_destroy().
+///
+/// @return The thumbnail, or NULL if the entry or its image is not stored.
+PIXELGRAB_API PixelGrabImage* pixelgrab_history_get_thumbnail(
+    PixelGrabContext* ctx, int history_id);
+
+/// Set the size thumbnails of later captures fit in (default 200).
+///
+/// @return kPixelGrabOk, or kPixelGrabErrorInvalidParam if max_size < 1.
+PIXELGRAB_API PixelGrabError pixelgrab_history_set_thumbnail_size(
+    PixelGrabContext* ctx, int max_size);
+
+/// Set how often a full keyframe is stored.
+///
+/// A capture with the same size as the previous stored image is kept as
+/// the tiles that differ from it, which is close to free for a region that
+/// has not changed; restoring it patches the last keyframe.  At most
+/// interval - 1 such deltas follow each keyframe (default 16).  A capture
+/// identical to an image still stored shares that image's data instead.
+/// 1 stores every image on its own.
+///
+/// @return kPixelGrabOk, or kPixelGrabErrorInvalidParam if interval < 1.
+PIXELGRAB_API PixelGrabError pixelgrab_history_set_keyframe_interval(
+    PixelGrabContext* ctx, int interval);
+
+/// Configure background compression of history images.
+///
+/// A region capture adds its history entry immediately and queues the
+/// image; a worker thread compresses it and attaches it to the entry.
+/// Until then pixelgrab_history_recapture() returns the queued image.
+/// At most max_pending images wait (default 4); when the queue is full
+/// the capture follows |policy|.  max_pending 0 compresses every image on
+/// the capturing thread, before the capture returns.
+///
+/// @return kPixelGrabOk, or kPixelGrabErrorInvalidParam for a negative
+///         max_pending or an unknown policy.
+PIXELGRAB_API PixelGrabError pixelgrab_history_set_queue(
+    PixelGrabContext* ctx, int max_pending,
+    PixelGrabHistoryBackpressure policy);
+
 // ---------------------------------------------------------------------------
 // Pin Windows (Floating Overlay)
 // ---------------------------------------------------------------------------
@@ -898,6 +1368,148 @@ PIXELGRAB_API int64_t pixelgrab_recorder_get_duration_ms(
 PIXELGRAB_API PixelGrabError pixelgrab_recorder_write_frame(
     PixelGrabRecorder* recorder, const PixelGrabImage* frame);
 
+// ---------------------------------------------------------------------------
+// Capture streams
+// ---------------------------------------------------------------------------
+
+/// Frame callback for capture streams.  Invoked on the stream's capture
+/// thread; the frame is only valid for the duration of the call (use
+/// pixelgrab_image_create_view() on the whole frame to keep it).  The
+/// callback should return quickly: capture is paused while it runs.
+///
+/// @param stream    The stream that captured the frame.
+/// @param frame     Newest frame (borrowed, do not destroy).
+/// @param sequence  Frame sequence number, starting at 1.
+/// @param userdata  The pointer passed to pixelgrab_stream_set_callback().
+typedef void (*pixelgrab_stream_callback_t)(PixelGrabStream* stream,
+                                            const PixelGrabImage* frame,
+                                            uint64_t sequence,
+                                            void* userdata);
+
+/// Start capturing a region continuously on a background thread.
+///
+/// Frames are captured at a fixed rate into a ring of ring_depth
+/// pre-allocated images, so steady-state capture does not allocate and
+/// does not hold the context lock.  Images use the context's capture
+/// format (pixelgrab_set_capture_format()) at creation time.  Parts of the
+/// region outside the screen stay black.
+///
+/// @param ctx         Initialized context (used for validation and error
+///                    reporting; the stream may outlive other calls on it
+///                    but must be destroyed before the context).
+/// @param region      Region in virtual screen coordinates.
+/// @param fps         Target frame rate, 1..240.
+/// @param ring_depth  Number of frame buffers, 2..64.  More slots let
+///                    consumers hold polled frames longer without forcing
+///                    a re-allocation.
+/// @return Stream handle, or NULL on failure.  Free with
+///         pixelgrab_stream_destroy().
+PIXELGRAB_API PixelGrabStream* pixelgrab_stream_create(
+    PixelGrabContext* ctx, const PixelGrabRect* region, int fps,
+    int ring_depth);
+
+/// Stop the capture thread and release the stream.  Wakes threads blocked
+/// in pixelgrab_stream_poll().  NULL is safely ignored.
+PIXELGRAB_API void pixelgrab_stream_destroy(PixelGrabStream* stream);
+
+/// Register (or, with NULL, remove) the frame callback.  If the previous
+/// callback is running, this waits for it to return, so its userdata may be
+/// freed afterwards (called from inside the callback, it does not wait).
+/// Use either the callback or polling: frames passed to the callback count
+/// as delivered and are not returned by pixelgrab_stream_poll().
+PIXELGRAB_API PixelGrabError pixelgrab_stream_set_callback(
+    PixelGrabStream* stream, pixelgrab_stream_callback_t callback,
+    void* userdata);
+
+/// Get the newest frame that has not been delivered yet.
+///
+/// The returned image shares pixels with the ring (no copy); its ring slot
+/// is not reused until the image is destroyed.
+///
+/// @param stream        Stream handle.
+/// @param timeout_ms    0 returns immediately, a positive value waits up to
+///                      that long for a new frame, a negative value waits
+///                      until one arrives or the stream is destroyed.
+/// @param out_sequence  Receives the frame sequence number (may be NULL).
+/// @return New frame (free with pixelgrab_image_destroy()), or NULL if no
+///         new frame is available.
+PIXELGRAB_API PixelGrabImage* pixelgrab_stream_poll(PixelGrabStream* stream,
+                                                    int timeout_ms,
+                                                    uint64_t* out_sequence);
+
+/// Get the stream's frame counters.
+/// @return kPixelGrabOk, or kPixelGrabErrorInvalidParam on NULL arguments.
+PIXELGRAB_API PixelGrabError pixelgrab_stream_get_stats(
+    const PixelGrabStream* stream, PixelGrabStreamStats* out_stats);
+
+// ---------------------------------------------------------------------------
+// Change detection
+// ---------------------------------------------------------------------------
+//
+// Both functions split frames into tile_size x tile_size tiles (edge tiles
+// are clipped) and report the tiles that changed, in image coordinates and
+// row-major order.  If more tiles changed than out_tiles can hold, a single
+// rectangle bounding all of them is written instead.  Neither needs a
+// context or a platform extension.
+
+/// Compare two frames tile by tile.
+///
+/// Each reported rectangle is the bounding box of the differing pixels
+/// inside one tile.  Bgra8 and Native frames compare as equal layouts; an
+/// Rgba8 frame only compares with another Rgba8 frame.
+///
+/// @param a, b       Frames of the same size.
+/// @param tile_size  Tile edge in pixels (> 0), e.g. 64.
+/// @param out_tiles  Caller-allocated array receiving the changed tiles
+///                   (may be NULL to only count them).
+/// @param max_tiles  Capacity of out_tiles.
+/// @param out_count  Receives the number of rectangles written to
+///                   out_tiles (or the number of changed tiles if out_tiles
+///                   is NULL); 0 means the frames are identical.
+/// @return kPixelGrabOk, or kPixelGrabErrorInvalidParam on NULL images,
+///         mismatched sizes or layouts, or a bad tile_size / max_tiles.
+PIXELGRAB_API PixelGrabError pixelgrab_image_diff(const PixelGrabImage* a,
+                                                  const PixelGrabImage* b,
+                                                  int tile_size,
+                                                  PixelGrabRect* out_tiles,
+                                                  int max_tiles,
+                                                  int* out_count);
+
+/// Create a tracker that reports which tiles of successive frames (e.g.
+/// from pixelgrab_stream_poll()) changed.
+///
+/// The tracker keeps a 64-bit hash per tile rather than the previous
+/// frame, so each update reads only the new frame.  Reported rectangles
+/// are whole tiles.
+///
+/// @param tile_size  Tile edge in pixels (> 0).
+/// @return Tracker handle, or NULL on invalid tile_size.  Free with
+///         pixelgrab_tile_tracker_destroy().
+PIXELGRAB_API PixelGrabTileTracker* pixelgrab_tile_tracker_create(
+    int tile_size);
+
+/// Destroy a tile tracker.  NULL is safely ignored.
+PIXELGRAB_API void pixelgrab_tile_tracker_destroy(
+    PixelGrabTileTracker* tracker);
+
+/// Hash the tiles of frame and report those that changed since the
+/// previous update.  The first update, the first after
+/// pixelgrab_tile_tracker_reset(), and any update whose frame size or
+/// layout differs from the previous one report every tile.
+///
+/// @param tracker    Tracker handle.
+/// @param frame      New frame.
+/// @param out_tiles  As for pixelgrab_image_diff().
+/// @param max_tiles  Capacity of out_tiles.
+/// @param out_count  As for pixelgrab_image_diff().
+/// @return kPixelGrabOk, or kPixelGrabErrorInvalidParam.
+PIXELGRAB_API PixelGrabError pixelgrab_tile_tracker_update(
+    PixelGrabTileTracker* tracker, const PixelGrabImage* frame,
+    PixelGrabRect* out_tiles, int max_tiles, int* out_count);
+
+/// Forget the stored tile hashes; the next update reports every tile.
+PIXELGRAB_API void pixelgrab_tile_tracker_reset(PixelGrabTileTracker* tracker);
+
 // ---------------------------------------------------------------------------
 // Watermark
 // ---------------------------------------------------------------------------
@@ -1038,6 +1650,73 @@ PIXELGRAB_API PixelGrabError pixelgrab_image_export(
     const PixelGrabImage* image, const char* path,
     PixelGrabImageFormat format, int quality);
 
+// ---------------------------------------------------------------------------
+// Performance statistics
+// ---------------------------------------------------------------------------
+
+/// Instrumented operation stages.
+typedef enum PixelGrabStage {
+  kPixelGrabStageCapture = 0,          ///< One backend screen read (every
+                                       ///< capture call; includes format
+                                       ///< conversion done during the read)
+  kPixelGrabStageConvert = 1,          ///< Separate pixel format conversion
+  kPixelGrabStageHistoryCompress = 2,  ///< Compressing a capture for history
+  kPixelGrabStageExport = 3,           ///< pixelgrab_image_export()
+  kPixelGrabStageOcr = 4,              ///< pixelgrab_ocr_recognize()
+  kPixelGrabStageRecorder = 5,         ///< pixelgrab_recorder_write_frame()
+  kPixelGrabStageCount = 6,            ///< Number of stages
+} PixelGrabStage;
+
+/// Counters and latency percentiles of one stage.  Percentiles come from a
+/// log-linear histogram and are within 12.5% of the exact value.
+typedef struct PixelGrabStageStats {
+  uint64_t count;     ///< Operations recorded (including failed ones)
+  uint64_t failures;  ///< Operations that failed
+  uint64_t bytes;     ///< Pixel bytes produced or consumed
+  double total_ms;    ///< Sum of latencies
+  double mean_ms;
+  double p50_ms;
+  double p90_ms;
+  double p99_ms;
+  double max_ms;
+} PixelGrabStageStats;
+
+/// Output format of pixelgrab_stats_dump().
+typedef enum PixelGrabStatsFormat {
+  kPixelGrabStatsText = 0,  ///< Aligned table, one line per stage
+  kPixelGrabStatsJson = 1,  ///< {"capture":{"count":...,"p99_ms":...},...}
+} PixelGrabStatsFormat;
+
+/// Get the counters and latency percentiles of one stage.
+///
+/// Every context keeps its own statistics from creation (recording costs a
+/// few atomic adds per operation).  Pass NULL for the process-wide totals,
+/// which also cover calls without a context such as
+/// pixelgrab_image_export().  Streams and the recorder's automatic capture
+/// loop are not included.  Thread-safe.
+///
+/// @param ctx        Context, or NULL for the process-wide totals.
+/// @param stage      Stage to query.
+/// @param out_stats  Receives the statistics.
+/// @return kPixelGrabOk, or kPixelGrabErrorInvalidParam for an unknown stage
+///         or a NULL out_stats.
+PIXELGRAB_API PixelGrabError pixelgrab_get_stats(
+    const PixelGrabContext* ctx, PixelGrabStage stage,
+    PixelGrabStageStats* out_stats);
+
+/// Format the statistics of every stage as text or JSON.
+///
+/// @param ctx     Context, or NULL for the process-wide totals.
+/// @param format  Output format.
+/// @return Newly allocated string (free with pixelgrab_free_string()), or
+///         NULL on allocation failure.
+PIXELGRAB_API char* pixelgrab_stats_dump(const PixelGrabContext* ctx,
+                                         PixelGrabStatsFormat format);
+
+/// Zero the statistics of ctx (NULL: the process-wide totals).  Resetting
+/// a context leaves the process-wide totals unchanged.
+PIXELGRAB_API void pixelgrab_stats_reset(PixelGrabContext* ctx);
+
 // ---------------------------------------------------------------------------
 // Version information
 // ---------------------------------------------------------------------------
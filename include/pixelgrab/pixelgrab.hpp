@@ -79,6 +79,18 @@ class Image {
     return pixelgrab_image_get_data_size(raw_);
   }
 
+  /// Zero-copy view of a sub-rectangle; empty on invalid bounds.
+  Image view(int x, int y, int w, int h) const noexcept {
+    return Image(pixelgrab_image_create_view(raw_, x, y, w, h));
+  }
+
+  /// Resampled copy; empty on invalid arguments.
+  Image resized(int w, int h,
+                PixelGrabResizeFilter filter = kPixelGrabFilterBilinear) const
+      noexcept {
+    return Image(pixelgrab_image_resize(raw_, w, h, filter));
+  }
+
  private:
   PixelGrabImage* raw_ = nullptr;
 };
@@ -118,6 +130,10 @@ class Context {
   Context() : raw_(pixelgrab_context_create()) {
     if (!raw_) throw Error(kPixelGrabErrorNotInitialized, "Context creation failed");
   }
+  explicit Context(const PixelGrabContextOptions& options)
+      : raw_(pixelgrab_context_create_with_options(&options)) {
+    if (!raw_) throw Error(kPixelGrabErrorNotInitialized, "Context creation failed");
+  }
   ~Context() { pixelgrab_context_destroy(raw_); }
 
   Context(Context&& o) noexcept : raw_(o.raw_) { o.raw_ = nullptr; }
@@ -134,6 +150,10 @@ class Context {
 
   PixelGrabContext* get() const noexcept { return raw_; }
 
+  PixelGrabBackendType backend_type() const noexcept {
+    return pixelgrab_get_backend_type(raw_);
+  }
+
   PixelGrabError last_error() const {
     return pixelgrab_get_last_error(raw_);
   }
@@ -165,12 +185,81 @@ class Context {
     return Image(img);
   }
 
+  /// Capture a region downscaled to out_w x out_h, read in strips.
+  Image CaptureRegionScaled(
+      int x, int y, int w, int h, int out_w, int out_h,
+      PixelGrabResizeFilter filter = kPixelGrabFilterBilinear) {
+    auto* img = pixelgrab_capture_region_scaled(raw_, x, y, w, h, out_w,
+                                                out_h, filter);
+    if (!img) throw_last("CaptureRegionScaled failed");
+    return Image(img);
+  }
+
   Image CaptureWindow(PixelGrabWindowId wid) {
     auto* img = pixelgrab_capture_window(raw_, wid);
     if (!img) throw_last("CaptureWindow failed");
     return Image(img);
   }
 
+  /// Pixel format of subsequently captured images (default Bgra8).
+  void SetCaptureFormat(PixelGrabPixelFormat format) {
+    check(pixelgrab_set_capture_format(raw_, format));
+  }
+  PixelGrabPixelFormat GetCaptureFormat() const noexcept {
+    return pixelgrab_get_capture_format(raw_);
+  }
+
+  /// How CaptureWindow() reads window pixels (default: screen contents).
+  void SetWindowCaptureMode(PixelGrabWindowCaptureMode mode) {
+    check(pixelgrab_set_window_capture_mode(raw_, mode));
+  }
+  PixelGrabWindowCaptureMode GetWindowCaptureMode() const noexcept {
+    return pixelgrab_get_window_capture_mode(raw_);
+  }
+
+  /// Capture several regions with coalesced reads.  Entries for regions
+  /// that could not be captured are empty.
+  std::vector<Image> CaptureRegions(const std::vector<PixelGrabRect>& rects) {
+    std::vector<PixelGrabImage*> raw(rects.size(), nullptr);
+    auto err = pixelgrab_capture_regions(
+        raw_, rects.data(), static_cast<int>(rects.size()), raw.data());
+    if (err != kPixelGrabOk && err != kPixelGrabErrorCaptureFailed) {
+      throw_last("CaptureRegions failed");
+    }
+    std::vector<Image> images;
+    images.reserve(raw.size());
+    for (auto* img : raw) images.emplace_back(img);
+    return images;
+  }
+
+  /// Capture into a caller-owned BGRA8 buffer (no allocation).
+  void CaptureRegionInto(int x, int y, int w, int h, uint8_t* dst,
+                         int dst_stride) {
+    check(pixelgrab_capture_region_into(raw_, x, y, w, h, dst, dst_stride));
+  }
+
+  void CaptureScreenInto(int screen_index, uint8_t* dst, int dst_stride) {
+    check(pixelgrab_capture_screen_into(raw_, screen_index, dst, dst_stride));
+  }
+
+  /// Damage-tracked capture; |changed| receives the changed rectangles.
+  Image CaptureRegionIncremental(int x, int y, int w, int h,
+                                 std::vector<PixelGrabRect>* changed = nullptr,
+                                 int max_changed = 64) {
+    std::vector<PixelGrabRect> buf(max_changed > 0 ? max_changed : 1);
+    int n = 0;
+    auto* img = pixelgrab_capture_region_incremental(
+        raw_, x, y, w, h, buf.data(), static_cast<int>(buf.size()), &n);
+    if (!img) throw_last("CaptureRegionIncremental failed");
+    if (changed) {
+      buf.resize(n);
+      *changed = std::move(buf);
+    }
+    return Image(img);
+  }
+
+  void ResetIncrementalCapture() { pixelgrab_capture_incremental_reset(raw_); }
+
   Image CaptureScreenExcludePins(int screen_index) {
     auto* img = pixelgrab_capture_screen_exclude_pins(raw_, screen_index);
     if (!img) throw_last("CaptureScreenExcludePins failed");
@@ -249,6 +338,12 @@ class Context {
     return Image(img);
   }
 
+  Image HistoryThumbnail(int history_id) {
+    auto* img = pixelgrab_history_get_thumbnail(raw_, history_id);
+    if (!img) throw_last("HistoryThumbnail failed");
+    return Image(img);
+  }
+
   Image RecaptureLast() {
     auto* img = pixelgrab_recapture_last(raw_);
     if (!img) throw_last("RecaptureLast failed");
@@ -257,6 +352,29 @@ class Context {
 
   void HistoryClear() { pixelgrab_history_clear(raw_); }
   void HistorySetMaxCount(int n) { pixelgrab_history_set_max_count(raw_, n); }
+  void HistorySetCodec(PixelGrabHistoryCodec codec) {
+    check(pixelgrab_history_set_codec(raw_, codec));
+  }
+
+  void HistorySetKeyframeInterval(int interval) {
+    check(pixelgrab_history_set_keyframe_interval(raw_, interval));
+  }
+
+  void HistorySetThumbnailSize(int max_size) {
+    check(pixelgrab_history_set_thumbnail_size(raw_, max_size));
+  }
+
+  void HistorySetQueue(int max_pending,
+                       PixelGrabHistoryBackpressure policy =
+                           kPixelGrabHistoryBackpressureInline) {
+    check(pixelgrab_history_set_queue(raw_, max_pending, policy));
+  }
+
+  PixelGrabHistoryUsage history_usage() {
+    PixelGrabHistoryUsage u = {};
+    check(pixelgrab_history_get_usage(raw_, &u));
+    return u;
+  }
 
   // -- Clipboard --
 
@@ -309,6 +427,26 @@ class Context {
     return s;
   }
 
+  // -- Statistics --
+
+  PixelGrabStageStats stats(PixelGrabStage stage) const {
+    PixelGrabStageStats st = {};
+    PixelGrabError err = pixelgrab_get_stats(raw_, stage, &st);
+    if (err != kPixelGrabOk) throw Error(err, "Unknown stage");
+    return st;
+  }
+
+  std::string StatsDump(
+      PixelGrabStatsFormat format = kPixelGrabStatsText) const {
+    char* s = pixelgrab_stats_dump(raw_, format);
+    if (!s) return {};
+    std::string result(s);
+    pixelgrab_free_string(s);
+    return result;
+  }
+
+  void StatsReset() { pixelgrab_stats_reset(raw_); }
+
   // -- Pin windows --
 
   int pin_count() { return pixelgrab_pin_count(raw_); }
@@ -510,6 +648,121 @@ class PinWindow {
   PixelGrabPinWindow* raw_ = nullptr;
 };
 
+// ---------------------------------------------------------------------------
+// Stream  (move-only RAII wrapper)
+// ---------------------------------------------------------------------------
+
+class Stream {
+ public:
+  Stream(Context& ctx, const PixelGrabRect& region, int fps,
+         int ring_depth = 4)
+      : raw_(pixelgrab_stream_create(ctx.get(), &region, fps, ring_depth)) {
+    if (!raw_) throw Error(ctx.last_error(), ctx.last_error_message());
+  }
+  ~Stream() { pixelgrab_stream_destroy(raw_); }
+
+  Stream(Stream&& o) noexcept : raw_(o.raw_) { o.raw_ = nullptr; }
+  Stream& operator=(Stream&& o) noexcept {
+    if (this != &o) {
+      pixelgrab_stream_destroy(raw_);
+      raw_ = o.raw_;
+      o.raw_ = nullptr;
+    }
+    return *this;
+  }
+  Stream(const Stream&) = delete;
+  Stream& operator=(const Stream&) = delete;
+
+  PixelGrabStream* get() const noexcept { return raw_; }
+
+  /// Newest undelivered frame; empty if none arrived within |timeout_ms|.
+  Image Poll(int timeout_ms = 0, uint64_t* sequence = nullptr) {
+    return Image(pixelgrab_stream_poll(raw_, timeout_ms, sequence));
+  }
+
+  void set_callback(pixelgrab_stream_callback_t cb, void* userdata) {
+    pixelgrab_stream_set_callback(raw_, cb, userdata);
+  }
+
+  PixelGrabStreamStats stats() const {
+    PixelGrabStreamStats s = {};
+    pixelgrab_stream_get_stats(raw_, &s);
+    return s;
+  }
+
+ private:
+  PixelGrabStream* raw_ = nullptr;
+};
+
+// ---------------------------------------------------------------------------
+// Change detection
+// ---------------------------------------------------------------------------
+
+/// Changed tiles between two frames of the same size (bounding boxes of
+/// the differing pixels per tile).
+inline std::vector<PixelGrabRect> image_diff(const Image& a, const Image& b,
+                                             int tile_size = 64) {
+  std::vector<PixelGrabRect> tiles;
+  if (tile_size > 0) {
+    tiles.resize(static_cast<size_t>(a.width() / tile_size + 1) *
+                 (a.height() / tile_size + 1));
+  }
+  int n = 0;
+  auto err = pixelgrab_image_diff(a.get(), b.get(), tile_size, tiles.data(),
+                                  static_cast<int>(tiles.size()), &n);
+  if (err != kPixelGrabOk) throw Error(err, "image_diff failed");
+  tiles.resize(static_cast<size_t>(n));
+  return tiles;
+}
+
+/// Reports the tiles of successive frames that changed (see
+/// pixelgrab_tile_tracker_create()).
+class TileTracker {
+ public:
+  explicit TileTracker(int tile_size = 64)
+      : raw_(pixelgrab_tile_tracker_create(tile_size)),
+        tile_size_(tile_size) {
+    if (!raw_) throw Error(kPixelGrabErrorInvalidParam, "Bad tile size");
+  }
+  ~TileTracker() { pixelgrab_tile_tracker_destroy(raw_); }
+
+  TileTracker(TileTracker&& o) noexcept
+      : raw_(o.raw_), tile_size_(o.tile_size_) {
+    o.raw_ = nullptr;
+  }
+  TileTracker& operator=(TileTracker&& o) noexcept {
+    if (this != &o) {
+      pixelgrab_tile_tracker_destroy(raw_);
+      raw_ = o.raw_;
+      tile_size_ = o.tile_size_;
+      o.raw_ = nullptr;
+    }
+    return *this;
+  }
+  TileTracker(const TileTracker&) = delete;
+  TileTracker& operator=(const TileTracker&) = delete;
+
+  PixelGrabTileTracker* get() const noexcept { return raw_; }
+
+  std::vector<PixelGrabRect> Update(const Image& frame) {
+    std::vector<PixelGrabRect> tiles(
+        static_cast<size_t>(frame.width() / tile_size_ + 1) *
+        (frame.height() / tile_size_ + 1));
+    int n = 0;
+    auto err = pixelgrab_tile_tracker_update(
+        raw_, frame.get(), tiles.data(), static_cast<int>(tiles.size()), &n);
+    if (err != kPixelGrabOk) throw Error(err, "TileTracker update failed");
+    tiles.resize(static_cast<size_t>(n));
+    return tiles;
+  }
+
+  void Reset() noexcept { pixelgrab_tile_tracker_reset(raw_); }
+
+ private:
+  PixelGrabTileTracker* raw_ = nullptr;
+  int tile_size_ = 0;
+};
+
 // ---------------------------------------------------------------------------
 // Free functions (color utilities)
 // ---------------------------------------------------------------------------
@@ -541,6 +794,22 @@ inline PixelGrabColor from_hex(const char* hex) {
 
 inline const char* version_string() { return pixelgrab_version_string(); }
 
+// ---------------------------------------------------------------------------
+// Free functions (image buffer pool)
+// ---------------------------------------------------------------------------
+
+inline void set_buffer_pool_limit(uint64_t max_pooled_bytes) {
+  pixelgrab_buffer_pool_set_limit(max_pooled_bytes);
+}
+
+inline void trim_buffer_pool() { pixelgrab_buffer_pool_trim(); }
+
+inline PixelGrabBufferPoolStats buffer_pool_stats() {
+  PixelGrabBufferPoolStats s = {};
+  pixelgrab_buffer_pool_get_stats(&s);
+  return s;
+}
+
 }  // namespace pixelgrab
 
 #endif  // PIXELGRAB_PIXELGRAB_HPP_
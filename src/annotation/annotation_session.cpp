@@ -57,15 +57,9 @@ AnnotationSession::AnnotationSession(
     std::unique_ptr<AnnotationRenderer> renderer)
     : base_image_(std::move(base_image)),
       renderer_(std::move(renderer)) {
-  // Create output image as a copy of base.
+  // Output starts out sharing the base pixels; the first draw copies them.
   if (base_image_) {
-    std::vector<uint8_t> copy(base_image_->data(),
-                              base_image_->data() + base_image_->data_size());
-    output_image_ = Image::CreateFromData(base_image_->width(),
-                                          base_image_->height(),
-                                          base_image_->stride(),
-                                          base_image_->format(),
-                                          std::move(copy));
+    output_image_ = base_image_->Clone();
   }
 }
 
@@ -208,11 +202,7 @@ std::unique_ptr<Image> AnnotationSession::Export() {
     Redraw();
   }
   if (!output_image_) return nullptr;
-  std::vector<uint8_t> copy(output_image_->data(),
-                            output_image_->data() + output_image_->data_size());
-  return Image::CreateFromData(output_image_->width(), output_image_->height(),
-                               output_image_->stride(), output_image_->format(),
-                               std::move(copy));
+  return output_image_->Clone();
 }
 
 // ---------------------------------------------------------------------------
@@ -230,15 +220,14 @@ void AnnotationSession::Redraw() {
   // restore the snapshot and render only the new shapes.
   bool can_incremental =
       !full_redraw_ && snapshot_image_ && snapshot_count_ <= total;
+  // The output object itself is kept (GetResult() hands out its address);
+  // only its storage is re-pointed, and the first shape drawn detaches it.
   if (can_incremental) {
-    // Verify none of the existing shapes were modified.
-    std::memcpy(output_image_->mutable_data(), snapshot_image_->data(),
-                snapshot_image_->data_size());
+    *output_image_ = std::move(*snapshot_image_->Clone());
     start_from = snapshot_count_;
   } else {
     // Full redraw from base.
-    std::memcpy(output_image_->mutable_data(), base_image_->data(),
-                base_image_->data_size());
+    *output_image_ = std::move(*base_image_->Clone());
     start_from = 0;
   }
 
@@ -276,7 +265,7 @@ void AnnotationSession::Redraw() {
     renderer_->EndRender();
   }
 
-  // Save snapshot for future incremental renders.
+  // Save snapshot for future incremental renders (shares the pixels).
   snapshot_image_ = output_image_->Clone();
   snapshot_count_ = total;
 
@@ -3,12 +3,15 @@
 #ifndef PIXELGRAB_CORE_CAPTURE_BACKEND_H_
 #define PIXELGRAB_CORE_CAPTURE_BACKEND_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "core/image.h"
+#include "core/pixel_convert.h"
 #include "pixelgrab/pixelgrab.h"
 
 namespace pixelgrab {
@@ -39,8 +42,29 @@ class CaptureBackend {
   /// Refresh and return the list of connected screens.
   virtual std::vector<PixelGrabScreenInfo> GetScreens() = 0;
 
+  /// True if the backend is notified of monitor layout changes, so callers
+  /// may cache GetScreens() until ScreensChanged() reports a change instead
+  /// of re-querying on a timer.
+  virtual bool SupportsScreenChangeEvents() const { return false; }
+
+  /// Drain pending layout-change notifications.  Returns true if the screen
+  /// configuration changed since the previous call.  Only meaningful when
+  /// SupportsScreenChangeEvents() is true.
+  virtual bool ScreensChanged() { return false; }
+
   // -- Capture operations --
 
+  /// Select the pixel format of images returned by CaptureScreen(),
+  /// CaptureRegion() and CaptureWindow().  Backends that can write the
+  /// format directly while converting from the platform layout override
+  /// this; the default only accepts the native B,G,R,A layout and callers
+  /// convert afterwards.  CaptureRegionInto(), CaptureRegionIncremental()
+  /// and GetPixelColor() always produce BGRA.
+  /// @return true if subsequent captures use |format|.
+  virtual bool SetOutputFormat(PixelGrabPixelFormat format) {
+    return format != kPixelGrabFormatRgba8;
+  }
+
   /// Capture the full contents of a screen.
   virtual std::unique_ptr<Image> CaptureScreen(int screen_index) = 0;
 
@@ -51,6 +75,75 @@ class CaptureBackend {
   /// Capture the contents of a specific window.
   virtual std::unique_ptr<Image> CaptureWindow(uint64_t window_handle) = 0;
 
+  /// Select how CaptureWindow() obtains pixels.  The default only supports
+  /// kPixelGrabWindowCaptureScreen.
+  /// @return true if subsequent window captures use |mode|.
+  virtual bool SetWindowCaptureMode(PixelGrabWindowCaptureMode mode) {
+    return mode == kPixelGrabWindowCaptureScreen;
+  }
+
+  /// Capture a region straight into caller-owned BGRA8 memory.
+  /// |dst| must hold |height| rows of |dst_stride| bytes (>= width * 4).
+  /// Pixel (0, 0) of |dst| corresponds to (x, y); parts of the region that
+  /// are off-screen are left untouched.  The default implementation goes
+  /// through CaptureRegion() and copies; platforms should override it to
+  /// convert directly into |dst| without an intermediate Image.
+  ///
+  /// The default requires CaptureRegion() to return the full, unclipped
+  /// |width| x |height| region with pixel (0, 0) at (x, y), and fails
+  /// otherwise; off-screen parts are then copied as CaptureRegion() filled
+  /// them.  An RGBA image (see SetOutputFormat()) is swizzled back to BGRA.
+  virtual bool CaptureRegionInto(int x, int y, int width, int height,
+                                 uint8_t* dst, int dst_stride) {
+    auto img = CaptureRegion(x, y, width, height);
+    if (!img || !dst) return false;
+    if (img->width() != width || img->height() != height) return false;
+    const bool bgra = IsBgraLayout(img->format());
+    for (int row = 0; row < height; ++row) {
+      const uint8_t* src =
+          img->data() + static_cast<size_t>(row) * img->stride();
+      uint8_t* out = dst + static_cast<size_t>(row) * dst_stride;
+      if (bgra) {
+        std::memcpy(out, src, static_cast<size_t>(width) * 4);
+      } else {
+        SwapRedBlue(src, out, static_cast<size_t>(width), false);
+      }
+    }
+    return true;
+  }
+
+  /// Capture several regions; entry i of the result holds |rects[i]| (or
+  /// nullptr on failure).  Backends on an asynchronous protocol override
+  /// this to send every read before waiting for the first reply; the
+  /// default captures the regions one after another.
+  virtual std::vector<std::unique_ptr<Image>> CaptureRegions(
+      const std::vector<PixelGrabRect>& rects) {
+    std::vector<std::unique_ptr<Image>> images;
+    images.reserve(rects.size());
+    for (const auto& r : rects) {
+      images.push_back(CaptureRegion(r.x, r.y, r.width, r.height));
+    }
+    return images;
+  }
+
+  /// Damage-tracked capture of a region.  |out_changed| receives the parts of
+  /// the region that changed since the previous incremental capture, in
+  /// virtual screen coordinates.  The default implementation has no damage
+  /// information: it performs a full capture and reports the whole region.
+  virtual std::unique_ptr<Image> CaptureRegionIncremental(
+      int x, int y, int width, int height,
+      std::vector<PixelGrabRect>* out_changed) {
+    auto img = CaptureRegion(x, y, width, height);
+    if (out_changed) {
+      out_changed->clear();
+      if (img) out_changed->push_back({x, y, img->width(), img->height()});
+    }
+    return img;
+  }
+
+  /// Release damage-tracking state held for CaptureRegionIncremental().
+  virtual void ResetIncrementalCapture() {}
+
   // -- Window enumeration --
 
   /// Enumerate visible top-level windows.
@@ -87,6 +180,11 @@ class CaptureBackend {
 /// Defined in platform/<os>/xxx_capture_backend.cpp.
 std::unique_ptr<CaptureBackend> CreatePlatformBackend();
 
+/// Create the backend selected by |type|: kPixelGrabBackendDefault is
+/// CreatePlatformBackend(); other types return nullptr on platforms or
+/// builds without them.  Defined next to CreatePlatformBackend().
+std::unique_ptr<CaptureBackend> CreateCaptureBackend(PixelGrabBackendType type);
+
 }  // namespace internal
 }  // namespace pixelgrab
 
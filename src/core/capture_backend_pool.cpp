@@ -0,0 +1,131 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Leases capture backend instances to concurrent callers of one context.
+
+#include "core/capture_backend_pool.h"
+
+#include <utility>
+
+#include "core/logger.h"
+
+namespace pixelgrab {
+namespace internal {
+
+CaptureBackendPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), backend_(other.backend_) {
+  other.pool_ = nullptr;
+  other.backend_ = nullptr;
+}
+
+CaptureBackendPool::Lease& CaptureBackendPool::Lease::operator=(
+    Lease&& other) noexcept {
+  if (this != &other) {
+    if (pool_ && backend_) pool_->Release(backend_);
+    pool_ = other.pool_;
+    backend_ = other.backend_;
+    other.pool_ = nullptr;
+    other.backend_ = nullptr;
+  }
+  return *this;
+}
+
+CaptureBackendPool::Lease::~Lease() {
+  if (pool_ && backend_) pool_->Release(backend_);
+}
+
+CaptureBackendPool::~CaptureBackendPool() { Shutdown(); }
+
+void CaptureBackendPool::Reset(std::unique_ptr<CaptureBackend> primary,
+                               Factory factory, int max_instances) {
+  Shutdown();
+  std::lock_guard<std::mutex> lock(mu_);
+  if (primary) slots_.push_back({std::move(primary), false});
+  factory_ = std::move(factory);
+  max_instances_ = max_instances < 1 ? 1 : max_instances;
+  factory_failed_ = false;
+}
+
+void CaptureBackendPool::Shutdown() {
+  std::lock_guard<std::mutex> lock(mu_);
+  for (Slot& slot : slots_) slot.backend->Shutdown();
+  slots_.clear();
+}
+
+CaptureBackend* CaptureBackendPool::primary() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return slots_.empty() ? nullptr : slots_[0].backend.get();
+}
+
+CaptureBackendPool::Lease CaptureBackendPool::LockPrimary() {
+  std::unique_lock<std::mutex> lock(mu_);
+  released_.wait(lock, [this] { return slots_.empty() || !slots_[0].busy; });
+  if (slots_.empty()) return Lease();
+  slots_[0].busy = true;
+  return Lease(this, slots_[0].backend.get());
+}
+
+CaptureBackendPool::Lease CaptureBackendPool::TryLockPrimary() {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (slots_.empty() || slots_[0].busy) return Lease();
+  slots_[0].busy = true;
+  return Lease(this, slots_[0].backend.get());
+}
+
+CaptureBackendPool::Lease CaptureBackendPool::Acquire() {
+  std::unique_lock<std::mutex> lock(mu_);
+  for (;;) {
+    if (slots_.empty()) return Lease();
+    for (Slot& slot : slots_) {  // Primary first.
+      if (!slot.busy) {
+        slot.busy = true;
+        return Lease(this, slot.backend.get());
+      }
+    }
+
+    if (factory_ && !factory_failed_ &&
+        static_cast<int>(slots_.size()) + opening_ < max_instances_) {
+      // Connecting takes a while; other leases proceed meanwhile.
+      ++opening_;
+      lock.unlock();
+      std::unique_ptr<CaptureBackend> backend = factory_();
+      bool ok = backend && backend->Initialize();
+      lock.lock();
+      --opening_;
+      if (ok) {
+        slots_.push_back({std::move(backend), true});
+        PIXELGRAB_LOG_DEBUG("Capture backend pool grew to {} instances",
+                            slots_.size());
+        return Lease(this, slots_.back().backend.get());
+      }
+      // Don't retry on every call; the busy instances will free up.
+      factory_failed_ = true;
+      PIXELGRAB_LOG_WARN("Failed to open an additional capture backend, "
+                         "staying at {} instances",
+                         slots_.size());
+      continue;
+    }
+
+    released_.wait(lock);
+  }
+}
+
+int CaptureBackendPool::instance_count() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return static_cast<int>(slots_.size());
+}
+
+void CaptureBackendPool::Release(CaptureBackend* backend) {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    for (Slot& slot : slots_) {
+      if (slot.backend.get() == backend) {
+        slot.busy = false;
+        break;
+      }
+    }
+  }
+  // All waiters: a LockPrimary() caller can only use one particular slot.
+  released_.notify_all();
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
@@ -0,0 +1,105 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Leases capture backend instances to concurrent callers of one context.
+
+#ifndef PIXELGRAB_CORE_CAPTURE_BACKEND_POOL_H_
+#define PIXELGRAB_CORE_CAPTURE_BACKEND_POOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "core/capture_backend.h"
+
+namespace pixelgrab {
+namespace internal {
+
+/// Hands out exclusive use of capture backends so that independent captures
+/// on one context run in parallel instead of queueing on one connection.
+///
+/// The primary instance is the one the context initialized.  It carries the
+/// per-connection state (damage tracking, the window list cache, composite
+/// redirections), so operations that depend on that state lease it with
+/// LockPrimary().  Plain reads use Acquire(), which takes the primary when
+/// it is idle, then any idle secondary, and otherwise opens a secondary --
+/// a backend with its own display connection -- while fewer than
+/// |max_instances| exist.  Only when every instance is busy does it wait.
+/// Thread-safe.
+class CaptureBackendPool {
+ public:
+  using Factory = std::function<std::unique_ptr<CaptureBackend>()>;
+
+  /// Exclusive use of one backend until destroyed.  Move-only.
+  class Lease {
+   public:
+    Lease() = default;
+    Lease(Lease&& other) noexcept;
+    Lease& operator=(Lease&& other) noexcept;
+    ~Lease();
+
+    CaptureBackend* get() const { return backend_; }
+    CaptureBackend* operator->() const { return backend_; }
+    explicit operator bool() const { return backend_ != nullptr; }
+
+   private:
+    friend class CaptureBackendPool;
+    Lease(CaptureBackendPool* pool, CaptureBackend* backend)
+        : pool_(pool), backend_(backend) {}
+
+    CaptureBackendPool* pool_ = nullptr;
+    CaptureBackend* backend_ = nullptr;
+  };
+
+  CaptureBackendPool() = default;
+  ~CaptureBackendPool();
+
+  // Non-copyable.
+  CaptureBackendPool(const CaptureBackendPool&) = delete;
+  CaptureBackendPool& operator=(const CaptureBackendPool&) = delete;
+
+  /// Install an initialized primary backend (may be null: every lease is
+  /// then empty).  |factory| returns uninitialized secondaries; at most
+  /// |max_instances| backends exist in total.  Call before any lease.
+  void Reset(std::unique_ptr<CaptureBackend> primary, Factory factory,
+             int max_instances);
+
+  /// Shut down and destroy every backend.  No lease may be outstanding.
+  void Shutdown();
+
+  /// The primary backend, without leasing it.
+  CaptureBackend* primary() const;
+
+  /// Exclusive use of the primary backend; waits while it is leased.
+  Lease LockPrimary();
+
+  /// Like LockPrimary(), but returns an empty lease instead of waiting.
+  Lease TryLockPrimary();
+
+  /// Exclusive use of any backend.  Empty only if there is no primary.
+  Lease Acquire();
+
+  /// Number of backends currently open (primary included).
+  int instance_count() const;
+
+ private:
+  struct Slot {
+    std::unique_ptr<CaptureBackend> backend;
+    bool busy = false;
+  };
+
+  void Release(CaptureBackend* backend);
+
+  mutable std::mutex mu_;
+  std::condition_variable released_;
+  std::vector<Slot> slots_;  // slots_[0] is the primary.
+  Factory factory_;
+  int max_instances_ = 1;
+  int opening_ = 0;            // Secondaries being initialized unlocked.
+  bool factory_failed_ = false;
+};
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_CORE_CAPTURE_BACKEND_POOL_H_
@@ -3,111 +3,326 @@
 
 #include "core/capture_history.h"
 
+#include <algorithm>
 #include <chrono>
-#include <cstring>
+#include <iterator>
 
+#include "core/frame_diff.h"
+#include "core/history_codec.h"
 #include "core/image.h"
+#include "core/image_resample.h"
 
 namespace pixelgrab {
 namespace internal {
 
-CaptureHistory::CaptureHistory() = default;
-
-// Simple byte-level RLE: pairs of (count, byte) for runs of identical bytes,
-// with a literal escape for non-repeating data.  Tuned for BGRA image data
-// where large uniform regions (alpha=255, solid backgrounds) are common.
-//
-// Format:  [tag, payload...]
-//   tag 0x00..0x7F  => literal run of (tag+1) bytes follows
-//   tag 0x80..0xFF  => repeat next byte (tag - 0x80 + 3) times  (3..130)
-//
-// Worst case expansion: ~1.006x for incompressible data.
-std::unique_ptr<CaptureHistory::CompressedImage> CaptureHistory::Compress(
-    const Image& img) {
-  auto ci = std::make_unique<CompressedImage>();
-  ci->width = img.width();
-  ci->height = img.height();
-  ci->stride = img.stride();
-  ci->format = img.format();
-  ci->raw_size = img.data_size();
-
-  const uint8_t* src = img.data();
-  size_t src_len = img.data_size();
-
-  // Worst case: header bytes per 128-byte literal run.
-  ci->data.reserve(src_len + src_len / 128 + 2);
-
-  size_t i = 0;
-  while (i < src_len) {
-    // Check for a run of identical bytes (min 3 to break even).
-    size_t run = 1;
-    while (i + run < src_len && src[i + run] == src[i] && run < 130) {
-      ++run;
-    }
-
-    if (run >= 3) {
-      ci->data.push_back(static_cast<uint8_t>(0x80 + run - 3));
-      ci->data.push_back(src[i]);
-      i += run;
-    } else {
-      // Literal run: collect up to 128 non-repeating bytes.
-      size_t lit_start = i;
-      size_t lit_len = 0;
-      while (lit_len < 128 && i < src_len) {
-        size_t ahead = 1;
-        while (i + ahead < src_len && src[i + ahead] == src[i] && ahead < 130)
-          ++ahead;
-        if (ahead >= 3) break;
-        ++lit_len;
-        ++i;
-      }
-      if (lit_len > 0) {
-        ci->data.push_back(static_cast<uint8_t>(lit_len - 1));
-        ci->data.insert(ci->data.end(), src + lit_start,
-                         src + lit_start + lit_len);
+namespace {
+
+// |img| box-filtered to fit |max_size| x |max_size| with its aspect ratio,
+// or a copy of it if it already fits (never its buffer, which may be the
+// caller's).
+std::shared_ptr<const Image> FitThumbnail(
+    const std::shared_ptr<const Image>& img, int max_size) {
+  const int longest = std::max(img->width(), img->height());
+  if (longest <= max_size) {
+    std::shared_ptr<Image> copy = img->Clone();
+    return copy->mutable_data() ? copy : nullptr;  // Detaches from |img|.
+  }
+  const auto scale = [&](int side) {
+    const int64_t scaled =
+        (static_cast<int64_t>(side) * max_size + longest / 2) / longest;
+    return std::max(1, static_cast<int>(scaled));
+  };
+  return ResizeImage(*img, scale(img->width()), scale(img->height()),
+                     kPixelGrabFilterBox);
+}
+
+// True if |a| and |b| have the same geometry, layout and pixels.
+bool SamePixels(const Image& a, const Image& b) {
+  if (a.width() != b.width() || a.height() != b.height() ||
+      a.format() != b.format()) {
+    return false;
+  }
+  for (int y = 0; y < a.height(); ++y) {
+    if (MatchingPixels(a.data() + static_cast<ptrdiff_t>(y) * a.stride(),
+                       b.data() + static_cast<ptrdiff_t>(y) * b.stride(),
+                       a.width()) != a.width()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Key of CaptureHistory::images_by_geometry_: images with equal keys can be
+// deltas of one another.
+uint64_t GeometryKey(int width, int height, PixelGrabPixelFormat format) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(width)) << 32) |
+         (static_cast<uint64_t>(static_cast<uint32_t>(height)) << 8) |
+         static_cast<uint8_t>(format);
+}
+
+}  // namespace
+
+// static
+size_t CaptureHistory::StoredSize(const CompressedImage& ci) {
+  return ci.data.size() + ci.patches.size() * sizeof(HistoryPatch);
+}
+
+CaptureHistory::CaptureHistory(MetricsRegistry* metrics)
+    : metrics_(metrics) {}
+
+CaptureHistory::~CaptureHistory() {
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    if (store_) {
+      // Everything goes to disk, the queued images included.
+      idle_cv_.wait(lock, [this] { return pending_.empty(); });
+      for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {
+        auto image = images_.find(it->id);
+        spills_.push_back(
+            {it->id, image != images_.end() ? image->second : nullptr, true,
+             *it});
       }
     }
+    stopping_ = true;
+    pending_.clear();
   }
+  work_cv_.notify_all();
+  idle_cv_.notify_all();
+  if (worker_.joinable()) worker_.join();
+  // The worker is gone; write what it left.
+  for (const Spill& spill : spills_) WriteSpill(spill);
+}
 
-  ci->data.shrink_to_fit();
-  return ci;
+bool CaptureHistory::OpenStore(const std::string& directory,
+                               uint64_t max_bytes) {
+  auto store = HistoryStore::Open(directory, max_bytes);
+  if (!store) return false;
+  std::lock_guard<std::mutex> lock(mu_);
+  next_id_ = std::max(next_id_, store->MaxId() + 1);
+  store_ = std::move(store);
+  return true;
 }
 
-std::unique_ptr<Image> CaptureHistory::Decompress(const CompressedImage& ci) {
-  auto img = Image::Create(ci.width, ci.height, ci.format);
-  if (!img) return nullptr;
+void CaptureHistory::WriteSpill(const Spill& spill) {
+  if (spill.image) SpillImage(spill.id, *spill.image);
+  if (spill.has_entry) store_->Append(&spill.entry, nullptr);
+}
 
-  uint8_t* dst = img->mutable_data();
-  size_t dst_len = img->data_size();
-  size_t di = 0;
+void CaptureHistory::SpillImage(int id, const CompressedImage& ci) {
+  // Oldest first, so that a delta's base is always on disk before it.
+  std::vector<const CompressedImage*> chain;
+  for (const CompressedImage* p = &ci; p && !store_->HasImage(p->id);
+       p = p->base.get()) {
+    chain.push_back(p);
+  }
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    const CompressedImage& c = **it;
+    HistoryStore::ImageRecord record;
+    record.id = c.id;
+    record.base_id = c.base ? c.base->id : 0;
+    record.width = c.width;
+    record.height = c.height;
+    record.format = c.format;
+    record.codec = c.codec;
+    record.raw_size = c.raw_size;
+    record.patches = &c.patches;
+    record.data = &c.data;
+    if (!store_->Append(nullptr, &record)) return;
+  }
+  if (id != ci.id && !store_->HasImage(id)) {
+    // A shared blob: stored once, then referenced as an empty delta.
+    static const std::vector<uint8_t> kNoData;
+    HistoryStore::ImageRecord alias;
+    alias.id = id;
+    alias.base_id = ci.id;
+    alias.width = ci.width;
+    alias.height = ci.height;
+    alias.format = ci.format;
+    alias.codec = ci.codec;
+    alias.raw_size = ci.raw_size;
+    alias.patches = nullptr;
+    alias.data = &kNoData;
+    store_->Append(nullptr, &alias);
+  }
+}
 
-  const uint8_t* src = ci.data.data();
-  size_t si = 0;
-  size_t src_len = ci.data.size();
+std::shared_ptr<const CaptureHistory::CompressedImage>
+CaptureHistory::Compress(int id, const std::shared_ptr<const Image>& img,
+                         PixelGrabHistoryCodec codec,
+                         std::shared_ptr<const Image>* thumbnail) {
+  StageTimer timer(metrics_, kPixelGrabStageHistoryCompress);
+  timer.set_bytes(img->data_size());
 
-  while (si < src_len && di < dst_len) {
-    uint8_t tag = src[si++];
-    if (tag <= 0x7F) {
-      size_t count = static_cast<size_t>(tag) + 1;
-      size_t copy = (std::min)(count, (std::min)(src_len - si, dst_len - di));
-      std::memcpy(dst + di, src + si, copy);
-      si += copy;
-      di += copy;
-    } else {
-      size_t count = static_cast<size_t>(tag - 0x80) + 3;
-      if (si >= src_len) break;
-      uint8_t val = src[si++];
-      size_t fill = (std::min)(count, dst_len - di);
-      std::memset(dst + di, val, fill);
-      di += fill;
+  const uint64_t hash = HashImagePixels(*img);
+  std::shared_ptr<const CompressedImage> duplicate;
+  std::shared_ptr<const CompressedImage> base;
+  int thumbnail_size;
+  uint64_t generation;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    generation = generation_;
+    auto it = blobs_.find(hash);
+    if (it != blobs_.end() && keyframe_interval_ > 1) {
+      duplicate = it->second.lock();
+    }
+    base = FindDeltaBase(id, *img);
+    thumbnail_size = thumbnail_size_;
+  }
+  *thumbnail = FitThumbnail(img, thumbnail_size);
+  if (duplicate && duplicate->width == img->width() &&
+      duplicate->height == img->height() &&
+      duplicate->format == img->format()) {
+    // Confirm against the pixels (usually a cached frame) before sharing.
+    auto frame = Decompress(duplicate);
+    if (frame && SamePixels(*frame, *img)) return duplicate;
+  }
+  std::shared_ptr<const Image> reference;
+  if (base) reference = Decompress(base);
+
+  // Tiles that differ from the base; mostly changed images start a new
+  // chain instead.
+  std::vector<PixelGrabRect> changed;
+  if (reference) {
+    DiffImageTiles(*img, *reference, kDeltaTileSize, &changed);
+    uint64_t changed_pixels = 0;
+    for (const auto& r : changed) {
+      changed_pixels += static_cast<uint64_t>(r.width) * r.height;
+    }
+    if (changed_pixels * 2 > static_cast<uint64_t>(img->width()) *
+                                 img->height()) {
+      reference.reset();
     }
   }
 
-  return img;
+  std::atomic<uint64_t>* stored_bytes = &stored_bytes_;
+  std::shared_ptr<CompressedImage> ci(
+      new CompressedImage(), [stored_bytes](CompressedImage* p) {
+        stored_bytes->fetch_sub(StoredSize(*p), std::memory_order_relaxed);
+        delete p;
+      });
+  ci->id = id;
+  ci->width = img->width();
+  ci->height = img->height();
+  ci->format = img->format();
+  ci->codec = codec;
+  ci->raw_size = img->data_size();
+  ci->hash = hash;
+  if (reference) {
+    std::vector<uint8_t> encoded;
+    ci->patches.reserve(changed.size());
+    for (const auto& r : changed) {
+      EncodeHistoryImage(codec,
+                         img->data() + static_cast<ptrdiff_t>(r.y) *
+                                           img->stride() + r.x * 4,
+                         r.width, r.height, img->stride(), &encoded);
+      ci->patches.push_back({r, ci->data.size(), encoded.size()});
+      ci->data.insert(ci->data.end(), encoded.begin(), encoded.end());
+    }
+    ci->data.shrink_to_fit();
+    ci->base = std::move(base);
+    ci->chain = ci->base->chain + 1;
+  } else {
+    EncodeHistoryImage(codec, img->data(), img->width(), img->height(),
+                       img->stride(), &ci->data);
+  }
+  stored_bytes_.fetch_add(StoredSize(*ci), std::memory_order_relaxed);
+
+  // The next capture of this geometry is likely to use it as its base.
+  // Cache a private copy: |img| shares the caller's buffer, which must go
+  // back to the buffer pool once the caller is done with it.
+  std::shared_ptr<Image> copy = img->Clone();
+  if (!copy->mutable_data()) copy.reset();  // Detaches from |img|.
+  std::lock_guard<std::mutex> lock(mu_);
+  // Cleared meanwhile: Attach() drops the result; keep it out of the
+  // caches too.
+  if (generation != generation_) return ci;
+  // The worker and an inline Record() may have compressed the same pixels
+  // at once; share whichever got here first.  Its frame is still cached.
+  auto it = blobs_.find(hash);
+  if (it != blobs_.end() && keyframe_interval_ > 1) {
+    if (auto other = it->second.lock()) {
+      auto frame = FindDecoded(other->id);
+      if (frame && SamePixels(*frame, *img)) return other;
+    }
+  }
+  if (copy) CacheDecoded(id, std::move(copy));
+  blobs_[hash] = ci;
+  if (blobs_.size() > 2 * images_.size() + kDecodedCacheSize) {
+    for (auto it = blobs_.begin(); it != blobs_.end();) {
+      if (it->second.expired()) {
+        it = blobs_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  return ci;
+}
+
+std::shared_ptr<const Image> CaptureHistory::Decompress(
+    const std::shared_ptr<const CompressedImage>& ci) const {
+  // Walk back to a cached frame or the keyframe; |ci| keeps the chain alive.
+  std::vector<const CompressedImage*> chain;
+  std::shared_ptr<const Image> frame;
+  uint64_t generation;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    generation = generation_;
+    for (const CompressedImage* p = ci.get(); p; p = p->base.get()) {
+      frame = FindDecoded(p->id);
+      if (frame) break;
+      chain.push_back(p);
+    }
+  }
+  if (chain.empty()) return frame;
+
+  // Oldest first: a keyframe (unless a cached frame was found), then the
+  // deltas, each patched into |acc| in place.
+  std::unique_ptr<Image> acc;
+  if (frame) {
+    acc = frame->Clone();  // Detaches on the first write below.
+  }
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    const CompressedImage& c = **it;
+    if (!c.base) {
+      acc = Image::CreateUninitialized(c.width, c.height, c.format);
+      if (!acc || !acc->mutable_data() ||
+          !DecodeHistoryImage(c.codec, c.data.data(), c.data.size(),
+                              c.width, c.height, acc->mutable_data(),
+                              acc->stride())) {
+        return nullptr;
+      }
+      continue;
+    }
+    if (!acc || acc->width() != c.width || acc->height() != c.height) {
+      return nullptr;
+    }
+    uint8_t* dst = acc->mutable_data();
+    if (!dst) return nullptr;
+    for (const auto& patch : c.patches) {
+      const PixelGrabRect& r = patch.rect;
+      if (r.x < 0 || r.y < 0 || r.width > c.width - r.x ||
+          r.height > c.height - r.y ||
+          patch.offset + patch.size > c.data.size() ||
+          !DecodeHistoryImage(
+              c.codec, c.data.data() + patch.offset, patch.size, r.width,
+              r.height,
+              dst + static_cast<ptrdiff_t>(r.y) * acc->stride() + r.x * 4,
+              acc->stride())) {
+        return nullptr;
+      }
+    }
+  }
+  frame = std::move(acc);
+
+  std::lock_guard<std::mutex> lock(mu_);
+  if (generation == generation_) CacheDecoded(ci->id, frame);
+  return frame;
 }
 
 int CaptureHistory::Record(int x, int y, int width, int height,
                            std::unique_ptr<Image> image) {
+  std::unique_lock<std::mutex> lock(mu_);
   HistoryEntry entry;
   entry.id = next_id_++;
   entry.region_x = x;
@@ -121,53 +336,341 @@ int CaptureHistory::Record(int x, int y, int width, int height,
           now.time_since_epoch())
           .count();
 
-  int id = entry.id;
+  const int id = entry.id;
   entries_.push_front(entry);
+  PurgeExcess();
+  if (!image) return id;
 
-  if (image) {
-    auto compressed = Compress(*image);
-    if (compressed) {
-      total_compressed_bytes_ += compressed->data.size();
-      images_[id] = std::move(compressed);
+  const PixelGrabHistoryCodec codec = codec_;
+  const auto queue_full = [this] {
+    return static_cast<int>(pending_.size()) >= max_pending_;
+  };
+  if (queue_full() && max_pending_ > 0 &&
+      backpressure_ == kPixelGrabHistoryBackpressureBlock) {
+    // SetQueue() may switch the policy or depth while this waits.
+    idle_cv_.wait(lock, [&] {
+      return stopping_ || max_pending_ == 0 ||
+             backpressure_ != kPixelGrabHistoryBackpressureBlock ||
+             !queue_full();
+    });
+  }
+  if (!queue_full()) {
+    pending_.push_back({id, codec, std::move(image)});
+    if (!worker_.joinable()) {
+      worker_ = std::thread(&CaptureHistory::WorkerLoop, this);
     }
+    work_cv_.notify_one();
+    return id;
+  }
+  if (max_pending_ > 0 &&
+      backpressure_ == kPixelGrabHistoryBackpressureDrop) {
+    ++dropped_images_;
+    return id;
   }
 
-  PurgeExcess();
-  EnforceMemoryBudget();
+  // Synchronous queue, or inline backpressure.
+  lock.unlock();
+  std::shared_ptr<const Image> thumbnail;
+  auto compressed = Compress(id, std::move(image), codec, &thumbnail);
+  lock.lock();
+  Attach(id, std::move(compressed), std::move(thumbnail));
   return id;
 }
 
+void CaptureHistory::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mu_);
+  for (;;) {
+    work_cv_.wait(lock, [this] {
+      return stopping_ || !pending_.empty() || !spills_.empty();
+    });
+    if (stopping_) return;
+    if (!spills_.empty()) {
+      // Write everything queued so far without the lock; the spills stay
+      // queued (and found by lookups) until they are on disk.
+      std::vector<Spill> batch(spills_.begin(), spills_.end());
+      spill_writing_ = true;
+      lock.unlock();
+      for (const Spill& spill : batch) WriteSpill(spill);
+      lock.lock();
+      spill_writing_ = false;
+      for (size_t i = 0; i < batch.size(); ++i) {
+        if (spills_.front().image) {
+          spill_bytes_ -= StoredSize(*spills_.front().image);
+        }
+        spills_.pop_front();
+      }
+      idle_cv_.notify_all();
+      // The batch holds the last references to most images; free them
+      // without the lock too.
+      lock.unlock();
+      batch.clear();
+      lock.lock();
+      continue;
+    }
+    PendingImage item = pending_.front();
+    lock.unlock();
+    std::shared_ptr<const Image> thumbnail;
+    auto compressed = Compress(item.id, item.image, item.codec, &thumbnail);
+    lock.lock();
+    // Clear() may have dropped the item (and queued others) meanwhile.
+    if (!pending_.empty() && pending_.front().id == item.id) {
+      pending_.pop_front();
+    }
+    Attach(item.id, std::move(compressed), std::move(thumbnail));
+    idle_cv_.notify_all();
+  }
+}
+
+void CaptureHistory::Attach(int id,
+                            std::shared_ptr<const CompressedImage> compressed,
+                            std::shared_ptr<const Image> thumbnail) {
+  // The entry may have been purged or cleared while compressing.
+  if (!FindEntryLocked(id)) {
+    // Purged to disk (or on its way) ahead of its image.
+    if (store_ &&
+        (FindSpill(id, true) || store_->FindEntry(id, nullptr))) {
+      QueueSpill(id, std::move(compressed), nullptr);
+    }
+    return;
+  }
+  total_raw_bytes_ += compressed->raw_size;
+  images_by_geometry_[GeometryKey(compressed->width, compressed->height,
+                                  compressed->format)]
+      .insert(id);
+  images_[id] = std::move(compressed);
+  if (thumbnail) {
+    EraseThumbnail(id);
+    thumbnail_bytes_ += thumbnail->data_size();
+    thumbnails_[id] = std::move(thumbnail);
+  }
+  EnforceMemoryBudget();
+}
+
+const HistoryEntry* CaptureHistory::FindEntryLocked(int id) const {
+  if (entries_.empty()) return nullptr;
+  const int64_t index = static_cast<int64_t>(entries_.front().id) - id;
+  if (index < 0 || index >= static_cast<int64_t>(entries_.size())) {
+    return nullptr;
+  }
+  const HistoryEntry& e = entries_[static_cast<size_t>(index)];
+  return e.id == id ? &e : nullptr;
+}
+
+std::shared_ptr<const CaptureHistory::CompressedImage>
+CaptureHistory::FindDeltaBase(int id, const Image& img) const {
+  if (keyframe_interval_ <= 1) return nullptr;
+  // The newest stored image of the same geometry, if its chain has room.
+  // Captures may be stored out of order (inline compression overtakes the
+  // queue), so look for the newest one older than |id|.
+  auto ids = images_by_geometry_.find(
+      GeometryKey(img.width(), img.height(), img.format()));
+  if (ids == images_by_geometry_.end()) return nullptr;
+  auto older = ids->second.lower_bound(id);
+  if (older == ids->second.begin()) return nullptr;
+  auto it = images_.find(*std::prev(older));
+  if (it == images_.end()) return nullptr;
+  if (it->second->chain + 1 >= keyframe_interval_) return nullptr;
+  return it->second;
+}
+
+void CaptureHistory::EraseImage(ImageMap::iterator it) {
+  const CompressedImage& c = *it->second;
+  auto ids =
+      images_by_geometry_.find(GeometryKey(c.width, c.height, c.format));
+  if (ids != images_by_geometry_.end()) {
+    ids->second.erase(it->first);
+    if (ids->second.empty()) images_by_geometry_.erase(ids);
+  }
+  total_raw_bytes_ -= c.raw_size;
+  images_.erase(it);
+}
+
+std::shared_ptr<const Image> CaptureHistory::FindDecoded(int id) const {
+  for (auto it = decoded_.begin(); it != decoded_.end(); ++it) {
+    if (it->first != id) continue;
+    auto hit = *it;
+    decoded_.erase(it);
+    decoded_.push_front(hit);
+    return hit.second;
+  }
+  return nullptr;
+}
+
+void CaptureHistory::CacheDecoded(int id,
+                                  std::shared_ptr<const Image> frame) const {
+  for (auto it = decoded_.begin(); it != decoded_.end(); ++it) {
+    if (it->first == id) {
+      decoded_bytes_ -= it->second->data_size();
+      decoded_.erase(it);
+      break;
+    }
+  }
+  decoded_bytes_ += frame->data_size();
+  decoded_.emplace_front(id, std::move(frame));
+  TrimDecodedCache();
+}
+
+void CaptureHistory::TrimDecodedCache() const {
+  while (!decoded_.empty() &&
+         (decoded_.size() > kDecodedCacheSize ||
+          MemoryInUse() > max_memory_bytes_)) {
+    decoded_bytes_ -= decoded_.back().second->data_size();
+    decoded_.pop_back();
+  }
+}
+
+uint64_t CaptureHistory::MemoryInUse() const {
+  // Images queued for the store are as good as gone.
+  const uint64_t stored = stored_bytes_.load(std::memory_order_relaxed);
+  const uint64_t kept = stored > spill_bytes_ ? stored - spill_bytes_ : 0;
+  return kept + decoded_bytes_ + thumbnail_bytes_;
+}
+
+void CaptureHistory::QueueSpill(int id,
+                                std::shared_ptr<const CompressedImage> image,
+                                const HistoryEntry* entry) {
+  if (image) spill_bytes_ += StoredSize(*image);
+  spills_.push_back({id, std::move(image), entry != nullptr,
+                     entry ? *entry : HistoryEntry()});
+  if (!worker_.joinable()) {
+    worker_ = std::thread(&CaptureHistory::WorkerLoop, this);
+  }
+  work_cv_.notify_one();
+}
+
+const CaptureHistory::Spill* CaptureHistory::FindSpill(int id,
+                                                       bool entry) const {
+  for (const Spill& spill : spills_) {
+    if (spill.id == id && (entry ? spill.has_entry : !!spill.image)) {
+      return &spill;
+    }
+  }
+  return nullptr;
+}
+
+void CaptureHistory::EraseThumbnail(int id) {
+  auto it = thumbnails_.find(id);
+  if (it == thumbnails_.end()) return;
+  thumbnail_bytes_ -= it->second->data_size();
+  thumbnails_.erase(it);
+}
+
 int CaptureHistory::Count() const {
-  return static_cast<int>(entries_.size());
+  std::lock_guard<std::mutex> lock(mu_);
+  int count = static_cast<int>(entries_.size());
+  if (!store_) return count;
+  for (const Spill& spill : spills_) count += spill.has_entry;
+  return count + store_->EntryCount();
 }
 
 bool CaptureHistory::GetEntry(int index, HistoryEntry* out) const {
-  if (index < 0 || index >= static_cast<int>(entries_.size())) return false;
-  if (!out) return false;
+  std::lock_guard<std::mutex> lock(mu_);
+  if (index < 0 || !out) return false;
+  const int count = static_cast<int>(entries_.size());
+  if (index >= count) {
+    // Older entries are queued for the disk (newest last), then on it.
+    if (!store_) return false;
+    index -= count;
+    for (auto it = spills_.rbegin(); it != spills_.rend(); ++it) {
+      if (it->has_entry && index-- == 0) {
+        *out = it->entry;
+        return true;
+      }
+    }
+    return store_->GetEntry(index, out);
+  }
   *out = entries_[index];
   return true;
 }
 
-const HistoryEntry* CaptureHistory::FindById(int id) const {
-  for (const auto& e : entries_) {
-    if (e.id == id) return &e;
+bool CaptureHistory::FindById(int id, HistoryEntry* out) const {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (const HistoryEntry* e = FindEntryLocked(id)) {
+    if (out) *out = *e;
+    return true;
   }
-  return nullptr;
+  if (!store_) return false;
+  if (const Spill* spill = FindSpill(id, true)) {
+    if (out) *out = spill->entry;
+    return true;
+  }
+  return store_->FindEntry(id, out);
 }
 
 std::unique_ptr<Image> CaptureHistory::GetImageById(int id) const {
-  auto it = images_.find(id);
-  if (it == images_.end()) return nullptr;
-  return Decompress(*it->second);
+  std::shared_ptr<const CompressedImage> compressed;
+  uint64_t generation;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    generation = generation_;
+    auto it = images_.find(id);
+    if (it == images_.end()) {
+      // Not compressed yet: share the queued pixels.
+      for (const auto& p : pending_) {
+        if (p.id == id) return p.image->Clone();
+      }
+      if (!store_) return nullptr;
+      if (auto frame = FindDecoded(id)) return frame->Clone();
+      if (const Spill* spill = FindSpill(id, false)) {
+        compressed = spill->image;
+      }
+    } else {
+      compressed = it->second;
+    }
+  }
+  if (!compressed) {
+    // Evicted to disk: decode from the mapped segment.
+    std::shared_ptr<const Image> frame = store_->ReadImage(id);
+    if (!frame) return nullptr;
+    std::lock_guard<std::mutex> lock(mu_);
+    if (generation == generation_) CacheDecoded(id, frame);
+    return frame->Clone();
+  }
+  auto frame = Decompress(compressed);
+  // A copy-on-write clone: the cached pixels stay intact.
+  return frame ? frame->Clone() : nullptr;
+}
+
+std::unique_ptr<Image> CaptureHistory::GetThumbnail(int id) const {
+  int thumbnail_size;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = thumbnails_.find(id);
+    if (it != thumbnails_.end()) return it->second->Clone();
+    thumbnail_size = thumbnail_size_;
+  }
+  std::shared_ptr<const Image> image = GetImageById(id);
+  if (!image) return nullptr;
+  auto thumbnail = FitThumbnail(image, thumbnail_size);
+  return thumbnail ? thumbnail->Clone() : nullptr;
 }
 
 void CaptureHistory::Clear() {
-  entries_.clear();
-  images_.clear();
-  total_compressed_bytes_ = 0;
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    // A batch being written would land in the store after it is emptied.
+    idle_cv_.wait(lock, [this] { return !spill_writing_; });
+    ++generation_;
+    entries_.clear();
+    images_.clear();
+    images_by_geometry_.clear();
+    pending_.clear();
+    spills_.clear();
+    spill_bytes_ = 0;
+    decoded_.clear();
+    decoded_bytes_ = 0;
+    thumbnails_.clear();
+    thumbnail_bytes_ = 0;
+    blobs_.clear();
+    dropped_images_ = 0;
+    total_raw_bytes_ = 0;
+    if (store_) store_->Clear();
+  }
+  idle_cv_.notify_all();
 }
 
 void CaptureHistory::SetMaxCount(int max_count) {
+  std::lock_guard<std::mutex> lock(mu_);
   if (max_count > 0) {
     max_count_ = max_count;
     PurgeExcess();
@@ -175,33 +678,85 @@ void CaptureHistory::SetMaxCount(int max_count) {
 }
 
 void CaptureHistory::SetMaxMemoryBytes(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mu_);
   max_memory_bytes_ = bytes;
   EnforceMemoryBudget();
 }
 
+void CaptureHistory::SetCodec(PixelGrabHistoryCodec codec) {
+  std::lock_guard<std::mutex> lock(mu_);
+  codec_ = codec;
+}
+
+void CaptureHistory::SetQueue(int max_pending,
+                              PixelGrabHistoryBackpressure policy) {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    max_pending_ = max_pending;
+    backpressure_ = policy;
+  }
+  // A deeper queue may release blocked Record() calls.
+  idle_cv_.notify_all();
+}
+
+void CaptureHistory::SetThumbnailSize(int max_size) {
+  std::lock_guard<std::mutex> lock(mu_);
+  thumbnail_size_ = max_size;
+}
+
+void CaptureHistory::SetKeyframeInterval(int interval) {
+  std::lock_guard<std::mutex> lock(mu_);
+  keyframe_interval_ = interval;
+}
+
+PixelGrabHistoryUsage CaptureHistory::GetUsage() const {
+  std::unique_lock<std::mutex> lock(mu_);
+  idle_cv_.wait(lock, [this] {
+    return stopping_ || (pending_.empty() && spills_.empty());
+  });
+  PixelGrabHistoryUsage usage = {};
+  usage.entry_count = static_cast<int>(entries_.size());
+  usage.image_count = static_cast<int>(images_.size());
+  usage.raw_bytes = total_raw_bytes_;
+  usage.stored_bytes = stored_bytes_.load(std::memory_order_relaxed);
+  usage.dropped_images = dropped_images_;
+  usage.thumbnail_bytes = thumbnail_bytes_;
+  if (store_) {
+    usage.disk_entry_count = store_->EntryCount();
+    usage.disk_bytes = store_->SizeBytes();
+  }
+  return usage;
+}
+
 void CaptureHistory::PurgeExcess() {
   while (static_cast<int>(entries_.size()) > max_count_) {
     int removed_id = entries_.back().id;
-    entries_.pop_back();
     auto it = images_.find(removed_id);
-    if (it != images_.end()) {
-      total_compressed_bytes_ -= it->second->data.size();
-      images_.erase(it);
+    if (store_) {
+      QueueSpill(removed_id, it != images_.end() ? it->second : nullptr,
+                 &entries_.back());
     }
+    entries_.pop_back();
+    EraseThumbnail(removed_id);
+    if (it != images_.end()) EraseImage(it);
   }
 }
 
 void CaptureHistory::EnforceMemoryBudget() {
-  // Evict images (oldest first) until within budget.
-  // Metadata entries are kept so re-capture from screen still works.
+  // Cached frames go first; they are only a shortcut.
+  TrimDecodedCache();
+  // Then evict images and thumbnails (oldest first) until within budget.
+  // Metadata entries are kept so re-capture from screen still works.  An
+  // evicted keyframe frees nothing until its newer deltas go too.
   for (auto rit = entries_.rbegin();
-       rit != entries_.rend() && total_compressed_bytes_ > max_memory_bytes_;
+       rit != entries_.rend() && MemoryInUse() > max_memory_bytes_;
        ++rit) {
     auto it = images_.find(rit->id);
     if (it != images_.end()) {
-      total_compressed_bytes_ -= it->second->data.size();
-      images_.erase(it);
+      if (store_) QueueSpill(it->first, it->second, nullptr);
+      EraseImage(it);
     }
+    EraseThumbnail(rit->id);
   }
 }
 
@@ -4,12 +4,22 @@
 #ifndef PIXELGRAB_CORE_CAPTURE_HISTORY_H_
 #define PIXELGRAB_CORE_CAPTURE_HISTORY_H_
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <deque>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "core/history_codec.h"
+#include "core/history_store.h"
+#include "core/metrics.h"
 #include "pixelgrab/pixelgrab.h"
 
 namespace pixelgrab {
@@ -29,16 +39,66 @@ struct HistoryEntry {
 
 /// Manages a bounded list of past capture regions for recall / re-capture.
 ///
-/// Images are stored in a compressed format (simple RLE on BGRA rows) to
-/// reduce memory footprint.  A configurable memory budget caps total storage;
+/// Images are stored compressed (see history_codec.h; the pixel codec by
+/// default) to reduce memory footprint.  A configurable memory budget caps
+/// total storage;
 /// when the budget is exceeded the oldest images are evicted while their
 /// metadata entries are kept (enabling re-capture from screen).
+///
+/// Repeated captures of one geometry are stored as deltas: only the tiles
+/// that differ from the previous stored image of that size, so restoring
+/// a delta costs the changed area rather than the whole frame.  A full
+/// keyframe starts a new chain every |keyframe_interval| images of a
+/// geometry, or when most of the image changed.  A delta holds a
+/// reference to its base, so evicting an entry never breaks a newer one;
+/// the base's bytes stay counted until its last dependent goes.  The few
+/// most recently decoded (or recorded) frames are cached, so walking a
+/// chain is rarely needed.  The cache holds the history's own pixels,
+/// never a caller's buffer, and counts against the memory budget; it is
+/// trimmed before any image is evicted.
+///
+/// Images are also hashed: one identical to an image still held (by an
+/// entry or as a base) shares its compressed blob instead of extending a
+/// chain, so a static screen captured repeatedly costs one keyframe.
+///
+/// Record() adds the entry at once and hands the image to a worker thread
+/// (started on first use) through a bounded queue; the compressed image is
+/// attached when it is ready, and queued images are served uncompressed
+/// meanwhile.  When the queue is full, Record() compresses inline, waits,
+/// or drops the image, as configured by SetQueue().
+///
+/// Each image also gets a thumbnail (box-filtered to fit
+/// SetThumbnailSize(), default 200 pixels), made next to its compression
+/// and kept raw.  Thumbnails count against the memory budget and are
+/// evicted with their entry's image; GetThumbnail() scales a new one from
+/// the image wherever it is still stored.
+///
+/// With a HistoryStore opened (OpenStore()), entries past the count limit
+/// and images past the memory budget move to disk instead of being
+/// dropped, and lookups fall through to it for anything not in memory.
+/// They are queued under the lock and written by the worker thread, so
+/// Record() never waits for the disk; lookups find them in the queue
+/// meanwhile.  The store's entries are all older than the in-memory ones.
+///
+/// Thread-safe.  Compression, decompression and disk writes run outside
+/// the lock, so recording a large capture does not stall concurrent
+/// lookups.
 class CaptureHistory {
  public:
-  CaptureHistory();
+  /// Compression times are recorded in |metrics| if given.
+  explicit CaptureHistory(MetricsRegistry* metrics = nullptr);
+
+  /// Stops the worker; queued images are discarded, unless a store is open:
+  /// then they are finished and every entry is moved to the store.
+  ~CaptureHistory();
+
+  // Non-copyable.
+  CaptureHistory(const CaptureHistory&) = delete;
+  CaptureHistory& operator=(const CaptureHistory&) = delete;
 
   /// Record a new capture region with an optional image snapshot.
-  /// Returns the assigned entry ID.
+  /// Returns the assigned entry ID.  The image is not modified; pass a
+  /// copy-on-write clone if the caller keeps writing to its own.
   int Record(int x, int y, int width, int height,
              std::unique_ptr<Image> image = nullptr);
 
@@ -48,45 +108,192 @@ class CaptureHistory {
   /// Get entry by reverse-chronological index (0 = most recent).
   bool GetEntry(int index, HistoryEntry* out) const;
 
-  /// Find entry by its unique ID. Returns nullptr if not found.
-  const HistoryEntry* FindById(int id) const;
+  /// Copy the entry with the given unique ID into |out|.
+  /// Returns false if not found.
+  bool FindById(int id, HistoryEntry* out) const;
 
   /// Get the stored image for a given entry ID.
   /// Decompresses on demand; returns nullptr if not found or evicted.
   std::unique_ptr<Image> GetImageById(int id) const;
 
+  /// Get the thumbnail of the entry with the given ID.  Entries without
+  /// one (queued, on disk, or evicted before it was made) scale their
+  /// full image; returns nullptr if there is none.
+  std::unique_ptr<Image> GetThumbnail(int id) const;
+
   /// Clear all history entries.
   void Clear();
 
   /// Set the maximum number of stored entries (default 50).
   void SetMaxCount(int max_count);
 
-  /// Set the maximum total memory budget for stored images (bytes).
-  /// Default: 128 MB.  When exceeded, oldest images are evicted.
+  /// Set the maximum total memory budget for stored images, thumbnails
+  /// and cached frames (bytes).  Default: 128 MB.  When exceeded, the
+  /// frame cache shrinks first, then the oldest images and thumbnails are
+  /// evicted.
   void SetMaxMemoryBytes(size_t bytes);
 
+  /// Codec for images recorded from now on.  Default: the pixel codec.
+  void SetCodec(PixelGrabHistoryCodec codec);
+
+  /// Allow up to |max_pending| queued images (default 4; 0 compresses in
+  /// Record()) and choose what Record() does when they are all taken.
+  void SetQueue(int max_pending, PixelGrabHistoryBackpressure policy);
+
+  /// Store a keyframe at least every |interval| images of a geometry
+  /// (default 16); 1 stores every image on its own, without deltas or
+  /// shared blobs.
+  void SetKeyframeInterval(int interval);
+
+  /// Fit thumbnails of images recorded from now on in |max_size| x
+  /// |max_size| pixels (default 200).
+  void SetThumbnailSize(int max_size);
+
+  /// Entry and stored-image counts and sizes, once the queue has drained.
+  PixelGrabHistoryUsage GetUsage() const;
+
+  /// Keep evicted entries and images in |directory| (see HistoryStore),
+  /// picking up the entries already there.  Call before recording.
+  bool OpenStore(const std::string& directory, uint64_t max_bytes);
+
  private:
   struct CompressedImage {
+    int id;  // First entry stored with it; identical images share it.
     int width;
     int height;
-    int stride;
     PixelGrabPixelFormat format;
+    PixelGrabHistoryCodec codec;
     std::vector<uint8_t> data;  // Compressed payload.
     size_t raw_size;            // Original uncompressed size.
+    // A delta replaces |patches| of |base|, each encoded at |offset| in
+    // |data|; a keyframe (no base) encodes the whole image.  |chain|
+    // counts the deltas back to the keyframe.
+    std::vector<HistoryPatch> patches;
+    std::shared_ptr<const CompressedImage> base;
+    int chain = 0;
+    uint64_t hash = 0;  // HashImagePixels() of the image.
+  };
+
+  // An image waiting for the worker.  It stays at the front of |pending_|
+  // while it is being compressed so lookups can still find it.
+  struct PendingImage {
+    int id;
+    PixelGrabHistoryCodec codec;
+    std::shared_ptr<const Image> image;
   };
 
-  static std::unique_ptr<CompressedImage> Compress(const Image& img);
-  static std::unique_ptr<Image> Decompress(const CompressedImage& ci);
+  // An entry and/or image on its way to the store.  It stays in |spills_|
+  // until written so lookups can still find it.
+  struct Spill {
+    int id;
+    std::shared_ptr<const CompressedImage> image;  // Null if entry only.
+    bool has_entry;
+    HistoryEntry entry;
+  };
+
+  static constexpr int kDecodedCacheSize = 3;
+  static constexpr int kDeltaTileSize = 64;
+  static constexpr int kDefaultThumbnailSize = 200;
+
+  // Bytes counted against the memory budget.
+  static size_t StoredSize(const CompressedImage& ci);
 
+  // Also scales |img| down into |thumbnail|.
+  std::shared_ptr<const CompressedImage> Compress(
+      int id, const std::shared_ptr<const Image>& img,
+      PixelGrabHistoryCodec codec, std::shared_ptr<const Image>* thumbnail);
+  // Rebuild the pixels of |ci|, starting from the nearest cached frame of
+  // its chain.  Caches the result.
+  std::shared_ptr<const Image> Decompress(
+      const std::shared_ptr<const CompressedImage>& ci) const;
+
+  void WorkerLoop();
+  // Append |spill| to the store (image first).  Called without |mu_|.
+  void WriteSpill(const Spill& spill);
+  // Append the image of entry |id|, |ci|, to the store, preceded by any of
+  // its chain not there yet.
+  void SpillImage(int id, const CompressedImage& ci);
+
+  // Called with |mu_| held.
+  void Attach(int id, std::shared_ptr<const CompressedImage> compressed,
+              std::shared_ptr<const Image> thumbnail);
+  const HistoryEntry* FindEntryLocked(int id) const;
+  std::shared_ptr<const CompressedImage> FindDeltaBase(int id,
+                                                       const Image& img) const;
+  std::shared_ptr<const Image> FindDecoded(int id) const;
+  using ImageMap =
+      std::unordered_map<int, std::shared_ptr<const CompressedImage>>;
+  // Remove a stored image and its accounting.
+  void EraseImage(ImageMap::iterator it);
+  void CacheDecoded(int id, std::shared_ptr<const Image> frame) const;
+  // Drop cached frames past kDecodedCacheSize or the memory budget.
+  void TrimDecodedCache() const;
+  uint64_t MemoryInUse() const;
+  void EraseThumbnail(int id);
+  // Queue entry |id|'s image (may be null) and, if given, the entry for
+  // the store, starting the worker if needed.
+  void QueueSpill(int id, std::shared_ptr<const CompressedImage> image,
+                  const HistoryEntry* entry);
+  // Queued spill of entry |id| (one carrying the entry if |entry|, else
+  // one carrying its image), or null.
+  const Spill* FindSpill(int id, bool entry) const;
   void PurgeExcess();
   void EnforceMemoryBudget();
 
+  MetricsRegistry* const metrics_;
+  // Bytes of every live compressed image, including keyframes that only
+  // newer deltas still reference.  Declared before anything holding
+  // images: their deleter updates it.
+  std::atomic<uint64_t> stored_bytes_{0};
+
+  mutable std::mutex mu_;
+  std::condition_variable work_cv_;          // Image queued or stopping.
+  mutable std::condition_variable idle_cv_;  // Queued image finished.
+  std::deque<PendingImage> pending_;
+  int max_pending_ = 4;
+  PixelGrabHistoryBackpressure backpressure_ =
+      kPixelGrabHistoryBackpressureInline;
+  uint64_t dropped_images_ = 0;
+  // Oldest first; entries among them in ascending ID order.
+  std::deque<Spill> spills_;
+  uint64_t spill_bytes_ = 0;    // StoredSize() of the images in |spills_|.
+  bool spill_writing_ = false;  // The worker is writing from |spills_|.
+  bool stopping_ = false;
+  // Bumped by Clear().  Work done outside the lock publishes its results
+  // (blob index, decoded frames) only if the generation is unchanged, so
+  // a cleared ID is never repopulated.
+  uint64_t generation_ = 0;
+  std::thread worker_;
+
+  // Most recently used first.
+  mutable std::deque<std::pair<int, std::shared_ptr<const Image>>> decoded_;
+  mutable size_t decoded_bytes_ = 0;
+  int keyframe_interval_ = 16;
+
+  // Newest first.  IDs are consecutive (Record() is the only insertion and
+  // entries leave from the old end or all at once), so an entry is found
+  // by its distance from the front.
   std::deque<HistoryEntry> entries_;
-  std::unordered_map<int, std::unique_ptr<CompressedImage>> images_;
-  size_t total_compressed_bytes_ = 0;
+  // Shared so a reader can decompress after dropping the lock while the
+  // entry is evicted.
+  ImageMap images_;
+  // (width, height, format) -> IDs of the images in |images_| with that
+  // geometry, so FindDeltaBase() need not scan the entries.
+  std::unordered_map<uint64_t, std::set<int>> images_by_geometry_;
+  std::unordered_map<int, std::shared_ptr<const Image>> thumbnails_;
+  size_t thumbnail_bytes_ = 0;  // Sum over thumbnails_.
+  int thumbnail_size_ = kDefaultThumbnailSize;
+  // Content hash -> compressed blob, while anything still holds the blob.
+  std::unordered_map<uint64_t, std::weak_ptr<const CompressedImage>> blobs_;
+  size_t total_raw_bytes_ = 0;
+  PixelGrabHistoryCodec codec_ = kPixelGrabHistoryCodecPixel;
   size_t max_memory_bytes_ = 128ULL * 1024 * 1024;  // 128 MB
   int max_count_ = 50;
   int next_id_ = 1;
+
+  // Disk tier (optional).  Its own lock nests inside |mu_|; the worker
+  // writes to it without |mu_|.  Set once, before any recording.
+  std::unique_ptr<HistoryStore> store_;
 };
 
 }  // namespace internal
@@ -0,0 +1,214 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Continuous region capture on a background thread into a frame ring.
+
+#include "core/capture_stream.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "core/logger.h"
+#include "core/pixel_convert.h"
+
+namespace pixelgrab {
+namespace internal {
+
+CaptureStream::CaptureStream(std::unique_ptr<CaptureBackend> backend,
+                             const PixelGrabRect& region, int fps,
+                             int ring_depth, PixelGrabPixelFormat format)
+    : backend_(std::move(backend)),
+      region_(region),
+      interval_(std::chrono::nanoseconds(1'000'000'000LL / fps)),
+      ring_depth_(ring_depth),
+      format_(format) {}
+
+CaptureStream::~CaptureStream() {
+  Stop();
+  if (backend_) backend_->Shutdown();
+}
+
+bool CaptureStream::Start() {
+  if (running_.load(std::memory_order_acquire)) return true;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    ring_.clear();
+    for (int i = 0; i < ring_depth_; ++i) {
+      // Zeroed: off-screen parts of the region are never written.
+      auto frame = Image::Create(region_.width, region_.height, format_);
+      if (!frame) {
+        PIXELGRAB_LOG_ERROR("Failed to allocate {}x{} stream frame",
+                            region_.width, region_.height);
+        ring_.clear();
+        return false;
+      }
+      ring_.push_back(std::move(frame));
+    }
+  }
+  running_.store(true, std::memory_order_release);
+  thread_ = std::thread(&CaptureStream::Run, this);
+  PIXELGRAB_LOG_INFO("Capture stream started: ({},{}) {}x{}, {} slots",
+                     region_.x, region_.y, region_.width, region_.height,
+                     ring_depth_);
+  return true;
+}
+
+void CaptureStream::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (!running_.load(std::memory_order_acquire)) return;
+    running_.store(false, std::memory_order_release);
+  }
+  stop_cv_.notify_all();
+  frame_cv_.notify_all();
+  if (thread_.joinable()) thread_.join();
+  PIXELGRAB_LOG_INFO("Capture stream stopped");
+}
+
+void CaptureStream::SetFrameCallback(FrameCallback callback) {
+  FrameCallback previous;
+  std::unique_lock<std::mutex> lock(mu_);
+  previous = std::move(callback_);
+  callback_ = std::move(callback);
+  // The capture thread calls a copy outside |mu_|; once this returns, the
+  // old callback (and its user data) is no longer in use.  From inside the
+  // callback, waiting would deadlock.
+  if (std::this_thread::get_id() != thread_.get_id()) {
+    callback_cv_.wait(lock, [this] { return !callback_running_; });
+  }
+}
+
+std::unique_ptr<Image> CaptureStream::Poll(int timeout_ms,
+                                           uint64_t* out_sequence) {
+  std::unique_lock<std::mutex> lock(mu_);
+  auto ready = [this] {
+    return latest_seq_ > delivered_seq_ ||
+           !running_.load(std::memory_order_acquire);
+  };
+  if (timeout_ms < 0) {
+    frame_cv_.wait(lock, ready);
+  } else if (timeout_ms > 0) {
+    frame_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+  }
+  if (latest_seq_ <= delivered_seq_ || latest_slot_ < 0) return nullptr;
+
+  // Shares the slot's pixels; the writer skips slots that are still shared.
+  auto frame = ring_[latest_slot_]->Clone();
+  delivered_seq_ = latest_seq_;
+  ++frames_delivered_;
+  if (out_sequence) *out_sequence = latest_seq_;
+  return frame;
+}
+
+PixelGrabStreamStats CaptureStream::GetStats() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  PixelGrabStreamStats s{};
+  s.frames_captured = frames_captured_;
+  s.frames_delivered = frames_delivered_;
+  s.frames_dropped = frames_dropped_;
+  s.frames_late = frames_late_;
+  s.capture_errors = capture_errors_;
+  s.slots_replaced = slots_replaced_;
+  s.avg_capture_ms =
+      frames_captured_ ? total_capture_ms_ / frames_captured_ : 0.0;
+  s.max_capture_ms = max_capture_ms_;
+  return s;
+}
+
+Image* CaptureStream::AcquireSlotLocked() {
+  // Oldest slot first: start just after the published one.
+  for (int i = 1; i <= ring_depth_; ++i) {
+    int slot = (std::max(latest_slot_, 0) + i) % ring_depth_;
+    if (slot == latest_slot_) continue;
+    if (!ring_[slot]->is_shared()) return ring_[slot].get();
+  }
+  // Every other slot is still held by a consumer.  The consumer keeps its
+  // pixels alive through the shared storage; give this slot a new buffer.
+  int slot = (std::max(latest_slot_, 0) + 1) % ring_depth_;
+  auto fresh = Image::Create(region_.width, region_.height, format_);
+  if (!fresh) return nullptr;
+  ring_[slot] = std::move(fresh);
+  ++slots_replaced_;
+  return ring_[slot].get();
+}
+
+void CaptureStream::Run() {
+  auto next_tick = std::chrono::steady_clock::now();
+
+  while (running_.load(std::memory_order_acquire)) {
+    Image* slot = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      slot = AcquireSlotLocked();
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    // CaptureRegionInto writes BGRA; RGBA streams swizzle in place.  The
+    // slot is relabelled first so the conversion sees what is there.
+    if (slot) slot->set_format(kPixelGrabFormatBgra8);
+    bool ok = slot &&
+              backend_->CaptureRegionInto(region_.x, region_.y,
+                                          region_.width, region_.height,
+                                          slot->mutable_data(),
+                                          slot->stride()) &&
+              ConvertImageFormat(slot, format_);
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - t0)
+                    .count();
+
+    FrameCallback callback;
+    uint64_t seq = 0;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      if (ok) {
+        if (latest_seq_ > delivered_seq_) ++frames_dropped_;
+        for (int i = 0; i < ring_depth_; ++i) {
+          if (ring_[i].get() == slot) latest_slot_ = i;
+        }
+        seq = ++latest_seq_;
+        ++frames_captured_;
+        total_capture_ms_ += ms;
+        max_capture_ms_ = std::max(max_capture_ms_, ms);
+        callback = callback_;
+        callback_running_ = static_cast<bool>(callback);
+      } else {
+        ++capture_errors_;
+      }
+    }
+
+    if (ok) {
+      frame_cv_.notify_all();
+      if (callback) {
+        // The writer is this thread, so |slot| is stable during the call.
+        callback(*slot, seq);
+        callback = nullptr;
+        {
+          std::lock_guard<std::mutex> lock(mu_);
+          callback_running_ = false;
+          if (delivered_seq_ < seq) {
+            delivered_seq_ = seq;
+            ++frames_delivered_;
+          }
+        }
+        callback_cv_.notify_all();
+      }
+    }
+
+    // Fixed-rate pacing.  Ticks that already passed are skipped (and
+    // counted) rather than captured back-to-back.
+    next_tick += interval_;
+    auto now = std::chrono::steady_clock::now();
+    if (now > next_tick) {
+      auto behind = (now - next_tick) / interval_;
+      std::lock_guard<std::mutex> lock(mu_);
+      frames_late_ += static_cast<uint64_t>(behind) + 1;
+      next_tick = now;
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mu_);
+    stop_cv_.wait_until(lock, next_tick, [this] {
+      return !running_.load(std::memory_order_acquire);
+    });
+  }
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
@@ -0,0 +1,112 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Continuous region capture on a background thread into a frame ring.
+
+#ifndef PIXELGRAB_CORE_CAPTURE_STREAM_H_
+#define PIXELGRAB_CORE_CAPTURE_STREAM_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/capture_backend.h"
+#include "core/image.h"
+#include "pixelgrab/pixelgrab.h"
+
+namespace pixelgrab {
+namespace internal {
+
+/// Captures a fixed region at a fixed rate on a dedicated thread.
+///
+/// The stream owns its own CaptureBackend (and therefore its own display
+/// connection), so capturing never contends with the context mutex.
+/// Frames are written straight into a ring of pre-allocated images; after
+/// start-up the capture loop does not allocate.
+///
+/// Consumers get the newest frame either by polling (Poll() hands out a
+/// copy-on-write clone, so no pixels are copied) or through a callback
+/// invoked on the capture thread.  A frame that is replaced by a newer one
+/// before it was delivered counts as dropped.  Ring slots still referenced
+/// by a polled frame are skipped by the writer; if every slot is held, the
+/// oldest one is replaced with a fresh buffer instead of being overwritten.
+class CaptureStream {
+ public:
+  /// Called on the capture thread with each new frame.  |frame| is only
+  /// valid for the duration of the call.
+  using FrameCallback = std::function<void(const Image& frame,
+                                           uint64_t sequence)>;
+
+  /// |backend| must be initialized.  |ring_depth| >= 2.
+  CaptureStream(std::unique_ptr<CaptureBackend> backend,
+                const PixelGrabRect& region, int fps, int ring_depth,
+                PixelGrabPixelFormat format);
+  ~CaptureStream();
+
+  // Non-copyable.
+  CaptureStream(const CaptureStream&) = delete;
+  CaptureStream& operator=(const CaptureStream&) = delete;
+
+  /// Allocate the ring and start the capture thread.
+  bool Start();
+
+  /// Stop and join the capture thread; wakes blocked Poll() callers.
+  void Stop();
+
+  /// Install (or clear, with an empty function) the frame callback.  Waits
+  /// for a call of the previous callback still running on the capture
+  /// thread, unless called from that callback.
+  void SetFrameCallback(FrameCallback callback);
+
+  /// Return the newest frame not yet delivered, waiting up to |timeout_ms|
+  /// (0 = don't wait, < 0 = until a frame arrives or the stream stops).
+  std::unique_ptr<Image> Poll(int timeout_ms, uint64_t* out_sequence);
+
+  PixelGrabStreamStats GetStats() const;
+
+ private:
+  void Run();
+
+  /// Pick a ring slot the writer may overwrite (never the published frame,
+  /// never one shared with a consumer).  Called with |mu_| held.
+  Image* AcquireSlotLocked();
+
+  std::unique_ptr<CaptureBackend> backend_;
+  const PixelGrabRect region_;
+  const std::chrono::nanoseconds interval_;
+  const int ring_depth_;
+  const PixelGrabPixelFormat format_;
+
+  std::thread thread_;
+  std::atomic<bool> running_{false};
+
+  mutable std::mutex mu_;
+  std::condition_variable frame_cv_;  // New frame published or stopping.
+  std::condition_variable stop_cv_;   // Wakes the pacing sleep on Stop().
+  std::condition_variable callback_cv_;  // A callback call returned.
+  std::vector<std::unique_ptr<Image>> ring_;
+  int latest_slot_ = -1;          // Slot holding the newest frame.
+  uint64_t latest_seq_ = 0;       // Sequence number of that frame (1-based).
+  uint64_t delivered_seq_ = 0;    // Newest sequence handed to a consumer.
+  FrameCallback callback_;
+  bool callback_running_ = false;  // The capture thread is in a callback.
+
+  // Statistics (guarded by |mu_|).
+  uint64_t frames_captured_ = 0;
+  uint64_t frames_delivered_ = 0;
+  uint64_t frames_dropped_ = 0;
+  uint64_t frames_late_ = 0;
+  uint64_t capture_errors_ = 0;
+  uint64_t slots_replaced_ = 0;
+  double total_capture_ms_ = 0.0;
+  double max_capture_ms_ = 0.0;
+};
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_CORE_CAPTURE_STREAM_H_
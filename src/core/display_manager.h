@@ -0,0 +1,38 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Display-server connections shared by the subsystems of one context.
+
+#ifndef PIXELGRAB_CORE_DISPLAY_MANAGER_H_
+#define PIXELGRAB_CORE_DISPLAY_MANAGER_H_
+
+#include <memory>
+
+namespace pixelgrab {
+namespace internal {
+
+/// Owns the display-server connections that a context's helper subsystems
+/// (element detection, clipboard, pin windows) share, so they don't connect
+/// anew on every call.  Opaque outside the platform layer: each platform
+/// factory that accepts a DisplayManager downcasts it to its own type.
+///
+/// Platforms whose system APIs need no client connection (Windows, macOS)
+/// have no implementation; their factories accept and ignore nullptr.
+class DisplayManager {
+ public:
+  virtual ~DisplayManager() = default;
+
+  // Non-copyable.
+  DisplayManager(const DisplayManager&) = delete;
+  DisplayManager& operator=(const DisplayManager&) = delete;
+
+ protected:
+  DisplayManager() = default;
+};
+
+/// Factory implemented per-platform.  Returns nullptr where subsystems
+/// reach the display directly.
+std::unique_ptr<DisplayManager> CreatePlatformDisplayManager();
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_CORE_DISPLAY_MANAGER_H_
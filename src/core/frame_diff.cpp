@@ -0,0 +1,346 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Tile-based change detection between frames.
+
+#include "core/frame_diff.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "core/image.h"
+#include "core/pixel_convert.h"
+#include "core/simd_support.h"
+
+namespace pixelgrab {
+namespace internal {
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Row comparison kernels.  Both take rows of |n| 32-bit pixels.
+// FirstDiff returns the index of the first differing pixel (n if none),
+// LastDiff the index of the last one (-1 if none).
+// ---------------------------------------------------------------------------
+
+using DiffFn = int (*)(const uint8_t* a, const uint8_t* b, int n);
+
+inline bool PixelsEqual(const uint8_t* a, const uint8_t* b) {
+  uint32_t x, y;
+  std::memcpy(&x, a, 4);
+  std::memcpy(&y, b, 4);
+  return x == y;
+}
+
+inline bool PixelPairsEqual(const uint8_t* a, const uint8_t* b) {
+  uint64_t x, y;
+  std::memcpy(&x, a, 8);
+  std::memcpy(&y, b, 8);
+  return x == y;
+}
+
+int FirstDiffScalar(const uint8_t* a, const uint8_t* b, int n) {
+  int i = 0;
+  while (i + 2 <= n && PixelPairsEqual(a + i * 4, b + i * 4)) i += 2;
+  for (; i < n; ++i) {
+    if (!PixelsEqual(a + i * 4, b + i * 4)) return i;
+  }
+  return n;
+}
+
+int LastDiffScalar(const uint8_t* a, const uint8_t* b, int n) {
+  int i = n;
+  while (i >= 2 && PixelPairsEqual(a + (i - 2) * 4, b + (i - 2) * 4)) i -= 2;
+  while (i > 0) {
+    --i;
+    if (!PixelsEqual(a + i * 4, b + i * 4)) return i;
+  }
+  return -1;
+}
+
+// The vector kernels skip equal blocks and let the scalar kernels pinpoint
+// the pixel inside the first (or last) unequal block.
+
+#if defined(PIXELGRAB_HAVE_SSE2)
+
+inline bool BlocksEqualSse2(const uint8_t* a, const uint8_t* b) {
+  __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+  __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) == 0xFFFF;
+}
+
+int FirstDiffSse2(const uint8_t* a, const uint8_t* b, int n) {
+  int i = 0;
+  while (i + 4 <= n && BlocksEqualSse2(a + i * 4, b + i * 4)) i += 4;
+  return i + FirstDiffScalar(a + i * 4, b + i * 4, n - i);
+}
+
+int LastDiffSse2(const uint8_t* a, const uint8_t* b, int n) {
+  int i = n;
+  while (i >= 4 && BlocksEqualSse2(a + (i - 4) * 4, b + (i - 4) * 4)) i -= 4;
+  return LastDiffScalar(a, b, i);
+}
+
+#endif  // PIXELGRAB_HAVE_SSE2
+
+#if defined(PIXELGRAB_HAVE_AVX2)
+
+PIXELGRAB_TARGET_AVX2
+int FirstDiffAvx2(const uint8_t* a, const uint8_t* b, int n) {
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i va =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i * 4));
+    __m256i vb =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i * 4));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)) != -1) break;
+  }
+  return i + FirstDiffScalar(a + i * 4, b + i * 4, n - i);
+}
+
+PIXELGRAB_TARGET_AVX2
+int LastDiffAvx2(const uint8_t* a, const uint8_t* b, int n) {
+  int i = n;
+  for (; i >= 8; i -= 8) {
+    __m256i va =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + (i - 8) * 4));
+    __m256i vb =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + (i - 8) * 4));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)) != -1) break;
+  }
+  return LastDiffScalar(a, b, i);
+}
+
+#endif  // PIXELGRAB_HAVE_AVX2
+
+#if defined(PIXELGRAB_HAVE_NEON)
+
+inline bool BlocksEqualNeon(const uint8_t* a, const uint8_t* b) {
+  uint64x2_t eq =
+      vreinterpretq_u64_u8(vceqq_u8(vld1q_u8(a), vld1q_u8(b)));
+  return (vgetq_lane_u64(eq, 0) & vgetq_lane_u64(eq, 1)) == ~0ull;
+}
+
+int FirstDiffNeon(const uint8_t* a, const uint8_t* b, int n) {
+  int i = 0;
+  while (i + 4 <= n && BlocksEqualNeon(a + i * 4, b + i * 4)) i += 4;
+  return i + FirstDiffScalar(a + i * 4, b + i * 4, n - i);
+}
+
+int LastDiffNeon(const uint8_t* a, const uint8_t* b, int n) {
+  int i = n;
+  while (i >= 4 && BlocksEqualNeon(a + (i - 4) * 4, b + (i - 4) * 4)) i -= 4;
+  return LastDiffScalar(a, b, i);
+}
+
+#endif  // PIXELGRAB_HAVE_NEON
+
+struct DiffKernels {
+  DiffFn first;
+  DiffFn last;
+};
+
+const DiffKernels& GetDiffKernels() {
+  static const DiffKernels kernels = [] {
+    DiffKernels k = {FirstDiffScalar, LastDiffScalar};
+    switch (ActiveSimdLevel()) {
+#if defined(PIXELGRAB_HAVE_AVX2)
+      case SimdLevel::kAvx2:
+        k = {FirstDiffAvx2, LastDiffAvx2};
+        break;
+#endif
+#if defined(PIXELGRAB_HAVE_SSE2)
+      case SimdLevel::kSse2:
+        k = {FirstDiffSse2, LastDiffSse2};
+        break;
+#endif
+#if defined(PIXELGRAB_HAVE_NEON)
+      case SimdLevel::kNeon:
+        k = {FirstDiffNeon, LastDiffNeon};
+        break;
+#endif
+      default:
+        break;
+    }
+    return k;
+  }();
+  return kernels;
+}
+
+// ---------------------------------------------------------------------------
+// Tile hashing (xxHash64-style rounds; four lanes keep the multipliers
+// busy instead of serializing on one accumulator).
+// ---------------------------------------------------------------------------
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+
+inline uint64_t Rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t Load64(const uint8_t* p) {
+  uint64_t v;
+  std::memcpy(&v, p, 8);
+  return v;
+}
+
+inline uint64_t HashRound(uint64_t acc, uint64_t input) {
+  return Rotl(acc + input * kPrime2, 31) * kPrime1;
+}
+
+// Hash |len| bytes (a multiple of 4) continuing from |seed|.
+uint64_t HashPixelBytes(const uint8_t* p, size_t len, uint64_t seed) {
+  size_t i = 0;
+  uint64_t h;
+  if (len >= 32) {
+    uint64_t v0 = seed + kPrime1 + kPrime2;
+    uint64_t v1 = seed + kPrime2;
+    uint64_t v2 = seed;
+    uint64_t v3 = seed - kPrime1;
+    for (; i + 32 <= len; i += 32) {
+      v0 = HashRound(v0, Load64(p + i));
+      v1 = HashRound(v1, Load64(p + i + 8));
+      v2 = HashRound(v2, Load64(p + i + 16));
+      v3 = HashRound(v3, Load64(p + i + 24));
+    }
+    h = Rotl(v0, 1) + Rotl(v1, 7) + Rotl(v2, 12) + Rotl(v3, 18);
+  } else {
+    h = seed + kPrime3;
+  }
+  h += len;
+  for (; i + 8 <= len; i += 8) {
+    h = Rotl(h ^ HashRound(0, Load64(p + i)), 27) * kPrime1 + kPrime3;
+  }
+  if (i < len) {  // One remaining pixel.
+    uint32_t v;
+    std::memcpy(&v, p + i, 4);
+    h = Rotl(h ^ (v * kPrime1), 23) * kPrime2 + kPrime3;
+  }
+  h ^= h >> 33;
+  h *= kPrime2;
+  h ^= h >> 29;
+  h *= kPrime3;
+  h ^= h >> 32;
+  return h;
+}
+
+}  // namespace
+
+int MatchingPixels(const uint8_t* a, const uint8_t* b, int n) {
+  return n > 0 ? GetDiffKernels().first(a, b, n) : 0;
+}
+
+uint64_t HashImagePixels(const Image& image) {
+  // Rows are chained through the seed; padding past the width is skipped.
+  uint64_t h = static_cast<uint64_t>(image.width()) * kPrime1 ^
+               static_cast<uint64_t>(image.height()) * kPrime2;
+  const size_t row_bytes = static_cast<size_t>(image.width()) * 4;
+  for (int y = 0; y < image.height(); ++y) {
+    const uint8_t* row =
+        image.data() + static_cast<ptrdiff_t>(y) * image.stride();
+    h = HashPixelBytes(row, row_bytes, h);
+  }
+  return h;
+}
+
+void DiffImageTiles(const Image& a, const Image& b, int tile_size,
+                    std::vector<PixelGrabRect>* changed) {
+  const DiffKernels& k = GetDiffKernels();
+  const int width = a.width();
+  const int height = a.height();
+  const int cols = (width + tile_size - 1) / tile_size;
+
+  // Bounding box of the differences in each tile of the current tile row;
+  // x1/y1 are exclusive, x1 == 0 means clean.
+  struct Box {
+    int x0, y0, x1, y1;
+  };
+  std::vector<Box> boxes(cols);
+
+  for (int ty = 0; ty < height; ty += tile_size) {
+    const int rows = std::min(tile_size, height - ty);
+    std::fill(boxes.begin(), boxes.end(), Box{0, 0, 0, 0});
+    for (int y = ty; y < ty + rows; ++y) {
+      const uint8_t* ra = a.data() + static_cast<ptrdiff_t>(y) * a.stride();
+      const uint8_t* rb = b.data() + static_cast<ptrdiff_t>(y) * b.stride();
+      // One pass over the whole row settles the common unchanged case.
+      int x = k.first(ra, rb, width);
+      if (x == width) continue;
+      for (int c = x / tile_size; c < cols; ++c) {
+        const int sx = c * tile_size;
+        const int ex = std::min(sx + tile_size, width);
+        int first = x;
+        if (sx > x) {
+          first = sx + k.first(ra + sx * 4, rb + sx * 4, ex - sx);
+          if (first == ex) continue;
+        }
+        Box& box = boxes[c];
+        if (box.x1 == 0) {
+          box = {first, y, first + 1, y + 1};
+        } else {
+          box.x0 = std::min(box.x0, first);
+          box.x1 = std::max(box.x1, first + 1);
+          box.y1 = y + 1;
+        }
+        // Only pixels right of the current box can widen it.
+        const int from = box.x1;
+        if (from < ex) {
+          int last = k.last(ra + from * 4, rb + from * 4, ex - from);
+          if (last >= 0) box.x1 = from + last + 1;
+        }
+      }
+    }
+    for (const Box& box : boxes) {
+      if (box.x1 == 0) continue;
+      changed->push_back(
+          {box.x0, box.y0, box.x1 - box.x0, box.y1 - box.y0});
+    }
+  }
+}
+
+TileTracker::TileTracker(int tile_size) : tile_size_(tile_size) {}
+
+void TileTracker::Update(const Image& frame,
+                         std::vector<PixelGrabRect>* changed) {
+  const int width = frame.width();
+  const int height = frame.height();
+  const int cols = (width + tile_size_ - 1) / tile_size_;
+  const int rows = (height + tile_size_ - 1) / tile_size_;
+  const bool bgra = IsBgraLayout(frame.format());
+
+  const bool fresh = hashes_.empty() || width != width_ ||
+                     height != height_ || bgra != bgra_layout_;
+  if (fresh) {
+    width_ = width;
+    height_ = height;
+    bgra_layout_ = bgra;
+    hashes_.assign(static_cast<size_t>(cols) * rows, 0);
+  }
+
+  std::vector<uint64_t> band(cols);
+  for (int tr = 0; tr < rows; ++tr) {
+    const int ty = tr * tile_size_;
+    const int th = std::min(tile_size_, height - ty);
+    std::fill(band.begin(), band.end(), 0);
+    for (int y = ty; y < ty + th; ++y) {
+      const uint8_t* row =
+          frame.data() + static_cast<ptrdiff_t>(y) * frame.stride();
+      for (int c = 0; c < cols; ++c) {
+        const int x = c * tile_size_;
+        const int tw = std::min(tile_size_, width - x);
+        band[c] = HashPixelBytes(row + x * 4, static_cast<size_t>(tw) * 4,
+                                 band[c]);
+      }
+    }
+    for (int c = 0; c < cols; ++c) {
+      uint64_t& stored = hashes_[static_cast<size_t>(tr) * cols + c];
+      if (!fresh && stored == band[c]) continue;
+      stored = band[c];
+      const int x = c * tile_size_;
+      changed->push_back({x, ty, std::min(tile_size_, width - x), th});
+    }
+  }
+}
+
+void TileTracker::Reset() { hashes_.clear(); }
+
+}  // namespace internal
+}  // namespace pixelgrab
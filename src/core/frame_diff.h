@@ -0,0 +1,74 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Tile-based change detection between frames.
+
+#ifndef PIXELGRAB_CORE_FRAME_DIFF_H_
+#define PIXELGRAB_CORE_FRAME_DIFF_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "pixelgrab/pixelgrab.h"
+
+namespace pixelgrab {
+namespace internal {
+
+class Image;
+
+/// Number of leading pixels that are equal in the rows of |n| 32-bit pixels
+/// at |a| and |b|, compared with the same SIMD kernels as DiffImageTiles().
+/// The rows may overlap (e.g. b == a - 4 measures a run of one pixel).
+int MatchingPixels(const uint8_t* a, const uint8_t* b, int n);
+
+/// 64-bit hash of the pixels and size of |image| (not of its row padding),
+/// with the same four-lane rounds as TileTracker.  Equal images hash
+/// equally; unequal ones collide with negligible probability.
+uint64_t HashImagePixels(const Image& image);
+
+/// Compare two frames of the same size and byte layout tile by tile.
+///
+/// For every |tile_size| x |tile_size| tile (edge tiles are clipped to the
+/// image) containing at least one differing pixel, appends to |changed| the
+/// bounding box of the differing pixels inside that tile, in image
+/// coordinates and row-major tile order.  Rows are scanned with SSE2, AVX2
+/// or NEON compares (see ActiveSimdLevel()); an unchanged row costs one
+/// vectorized pass over both images.
+void DiffImageTiles(const Image& a, const Image& b, int tile_size,
+                    std::vector<PixelGrabRect>* changed);
+
+/// Reports which tiles of a frame sequence changed, keeping only a 64-bit
+/// hash per tile instead of the previous frame.
+///
+/// Each Update() reads the new frame once.  Reported rectangles are whole
+/// (edge-clipped) tiles, since the previous pixels are not available to
+/// narrow them down.  Not thread-safe.
+class TileTracker {
+ public:
+  /// |tile_size| > 0.
+  explicit TileTracker(int tile_size);
+
+  // Non-copyable.
+  TileTracker(const TileTracker&) = delete;
+  TileTracker& operator=(const TileTracker&) = delete;
+
+  /// Hash the tiles of |frame| and append to |changed| those whose hash
+  /// differs from the previous Update().  Every tile is reported on the
+  /// first call, after Reset(), and when the frame size or layout changes.
+  void Update(const Image& frame, std::vector<PixelGrabRect>* changed);
+
+  /// Forget the stored hashes.
+  void Reset();
+
+  int tile_size() const { return tile_size_; }
+
+ private:
+  const int tile_size_;
+  int width_ = 0;
+  int height_ = 0;
+  bool bgra_layout_ = true;
+  std::vector<uint64_t> hashes_;  // Row-major, one per tile.
+};
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_CORE_FRAME_DIFF_H_
@@ -0,0 +1,382 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Lossless codecs for images kept in the capture history.
+
+#include "core/history_codec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "core/frame_diff.h"
+
+namespace pixelgrab {
+namespace internal {
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Byte-level RLE (the original history format), applied row by row.
+//
+//   tag 0x00..0x7F  => literal run of (tag+1) bytes follows
+//   tag 0x80..0xFF  => repeat next byte (tag - 0x80 + 3) times  (3..130)
+//
+// Worst case expansion: ~1.006x for incompressible data.
+// ---------------------------------------------------------------------------
+
+void EncodeRleRow(const uint8_t* src, size_t src_len,
+                  std::vector<uint8_t>* out) {
+  size_t i = 0;
+  while (i < src_len) {
+    // Check for a run of identical bytes (min 3 to break even).
+    size_t run = 1;
+    while (i + run < src_len && src[i + run] == src[i] && run < 130) {
+      ++run;
+    }
+
+    if (run >= 3) {
+      out->push_back(static_cast<uint8_t>(0x80 + run - 3));
+      out->push_back(src[i]);
+      i += run;
+    } else {
+      // Literal run: collect up to 128 non-repeating bytes.
+      size_t lit_start = i;
+      size_t lit_len = 0;
+      while (lit_len < 128 && i < src_len) {
+        size_t ahead = 1;
+        while (i + ahead < src_len && src[i + ahead] == src[i] && ahead < 130)
+          ++ahead;
+        if (ahead >= 3) break;
+        ++lit_len;
+        ++i;
+      }
+      if (lit_len > 0) {
+        out->push_back(static_cast<uint8_t>(lit_len - 1));
+        out->insert(out->end(), src + lit_start, src + lit_start + lit_len);
+      }
+    }
+  }
+}
+
+// Decodes one row of |dst_len| bytes; runs never span rows.
+bool DecodeRleRow(const uint8_t* src, size_t src_len, size_t* si,
+                  uint8_t* dst, size_t dst_len) {
+  size_t di = 0;
+  while (di < dst_len) {
+    if (*si >= src_len) return false;
+    uint8_t tag = src[(*si)++];
+    if (tag <= 0x7F) {
+      size_t count = static_cast<size_t>(tag) + 1;
+      if (count > src_len - *si || count > dst_len - di) return false;
+      std::memcpy(dst + di, src + *si, count);
+      *si += count;
+      di += count;
+    } else {
+      size_t count = static_cast<size_t>(tag - 0x80) + 3;
+      if (*si >= src_len || count > dst_len - di) return false;
+      std::memset(dst + di, src[(*si)++], count);
+      di += count;
+    }
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Pixel codec.
+//
+// Pixels are 32-bit words coded in scan order.  Long stretches of screen
+// content either repeat the pixel to the left (flat backgrounds) or the
+// pixel above (vertical edges, repeated lines), so those are coded as runs
+// whose lengths are found with the SIMD row-compare kernels; the remaining
+// (e.g. antialiased) pixels are coded QOI-style against the previous pixel
+// and a 64-entry cache of recently seen colours.  Channel 1 is green in
+// both BGRA and RGBA layouts, which the luma op relies on.
+//
+//   0x00..0x3F  INDEX  cache[op]
+//   0x40..0x7F  DIFF   channels 0-2 differ by -2..1 (2 bits each)
+//   0x80..0xBF  LUMA   d1 = -32..31, next byte (d0-d1, d2-d1) in -8..7
+//   0xC0..0xDE  RUN    repeat the previous pixel (op & 0x1F) + 1 times
+//   0xDF        RUN    32 + varint times
+//   0xE0..0xEE  UP     copy (op & 0x0F) + 1 pixels from the row above
+//   0xEF        UP     16 + varint pixels
+//   0xFE        RGB    3 bytes, alpha of the previous pixel
+//   0xFF        RGBA   4 bytes
+//
+// Runs stop at the end of a row.  The previous pixel carries over from one
+// row to the next and starts as opaque black.  At most 5 bytes per pixel.
+// ---------------------------------------------------------------------------
+
+constexpr uint8_t kOpIndex = 0x00;
+constexpr uint8_t kOpDiff = 0x40;
+constexpr uint8_t kOpLuma = 0x80;
+constexpr uint8_t kOpRun = 0xC0;
+constexpr uint8_t kOpRunLong = 0xDF;
+constexpr uint8_t kOpUp = 0xE0;
+constexpr uint8_t kOpUpLong = 0xEF;
+constexpr uint8_t kOpRgb = 0xFE;
+constexpr uint8_t kOpRgba = 0xFF;
+constexpr int kShortRun = 31;
+constexpr int kShortUp = 15;
+constexpr uint32_t kInitialPixel = 0xFF000000u;
+
+inline uint32_t LoadPixel(const uint8_t* p) {
+  uint32_t v;
+  std::memcpy(&v, p, 4);
+  return v;
+}
+
+inline void StorePixel(uint8_t* p, uint32_t v) { std::memcpy(p, &v, 4); }
+
+inline int CacheSlot(uint32_t px) {
+  return static_cast<int>(((px & 0xFF) * 3 + ((px >> 8) & 0xFF) * 5 +
+                           ((px >> 16) & 0xFF) * 7 + (px >> 24) * 11) &
+                          63);
+}
+
+inline uint8_t* PutVarint(uint8_t* out, uint32_t v) {
+  while (v >= 0x80) {
+    *out++ = static_cast<uint8_t>(v | 0x80);
+    v >>= 7;
+  }
+  *out++ = static_cast<uint8_t>(v);
+  return out;
+}
+
+inline bool GetVarint(const uint8_t** in, const uint8_t* end, uint32_t* v) {
+  uint32_t result = 0;
+  for (int shift = 0; shift < 35 && *in < end; shift += 7) {
+    const uint8_t b = *(*in)++;
+    result |= static_cast<uint32_t>(b & 0x7F) << shift;
+    if (!(b & 0x80)) {
+      *v = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+inline uint8_t* PutRun(uint8_t* out, uint8_t op, uint8_t long_op,
+                       int short_max, int length) {
+  if (length <= short_max) {
+    *out++ = static_cast<uint8_t>(op | (length - 1));
+    return out;
+  }
+  *out++ = long_op;
+  return PutVarint(out, static_cast<uint32_t>(length - short_max - 1));
+}
+
+// Codes one pixel that is not part of a run.
+inline uint8_t* PutLiteral(uint8_t* out, uint32_t px, uint32_t prev,
+                           uint32_t* cache) {
+  const int slot = CacheSlot(px);
+  if (cache[slot] == px) {
+    *out++ = static_cast<uint8_t>(kOpIndex | slot);
+    return out;
+  }
+  cache[slot] = px;
+  if ((px >> 24) == (prev >> 24)) {
+    const int d0 = static_cast<int8_t>((px & 0xFF) - (prev & 0xFF));
+    const int d1 =
+        static_cast<int8_t>(((px >> 8) & 0xFF) - ((prev >> 8) & 0xFF));
+    const int d2 =
+        static_cast<int8_t>(((px >> 16) & 0xFF) - ((prev >> 16) & 0xFF));
+    if (d0 >= -2 && d0 <= 1 && d1 >= -2 && d1 <= 1 && d2 >= -2 && d2 <= 1) {
+      *out++ = static_cast<uint8_t>(kOpDiff | (d0 + 2) << 4 | (d1 + 2) << 2 |
+                                    (d2 + 2));
+      return out;
+    }
+    const int d01 = d0 - d1;
+    const int d21 = d2 - d1;
+    if (d1 >= -32 && d1 <= 31 && d01 >= -8 && d01 <= 7 && d21 >= -8 &&
+        d21 <= 7) {
+      *out++ = static_cast<uint8_t>(kOpLuma | (d1 + 32));
+      *out++ = static_cast<uint8_t>((d01 + 8) << 4 | (d21 + 8));
+      return out;
+    }
+    *out++ = kOpRgb;
+    *out++ = static_cast<uint8_t>(px);
+    *out++ = static_cast<uint8_t>(px >> 8);
+    *out++ = static_cast<uint8_t>(px >> 16);
+    return out;
+  }
+  *out++ = kOpRgba;
+  StorePixel(out, px);
+  return out + 4;
+}
+
+void EncodePixelCodec(const uint8_t* src, int width, int height, int stride,
+                      std::vector<uint8_t>* out) {
+  // Code into an uninitialized worst-case buffer, then copy out the used
+  // part: cheaper than growing a vector byte by byte.
+  const size_t bound = static_cast<size_t>(width) * height * 5;
+  std::unique_ptr<uint8_t[]> buffer(new uint8_t[bound]);
+  uint8_t* o = buffer.get();
+
+  uint32_t cache[64] = {};
+  uint32_t prev = kInitialPixel;
+  for (int y = 0; y < height; ++y) {
+    const uint8_t* row = src + static_cast<ptrdiff_t>(y) * stride;
+    const uint8_t* up = y ? row - stride : nullptr;
+    int x = 0;
+    while (x < width) {
+      const uint32_t px = LoadPixel(row + x * 4);
+      const int rest = width - x - 1;
+      // Runs are tested with one scalar compare before the vector kernel,
+      // so literal-heavy stretches stay cheap.
+      int up_run = 0;
+      if (up && px == LoadPixel(up + x * 4)) {
+        up_run = 1 + MatchingPixels(row + (x + 1) * 4, up + (x + 1) * 4,
+                                    rest);
+      }
+      int left_run = 0;
+      if (px == prev) {
+        left_run = 1 + MatchingPixels(row + (x + 1) * 4, row + x * 4, rest);
+      }
+      if (up_run > left_run) {
+        o = PutRun(o, kOpUp, kOpUpLong, kShortUp, up_run);
+        x += up_run;
+        prev = LoadPixel(row + (x - 1) * 4);
+      } else if (left_run > 0) {
+        o = PutRun(o, kOpRun, kOpRunLong, kShortRun, left_run);
+        x += left_run;
+      } else {
+        o = PutLiteral(o, px, prev, cache);
+        prev = px;
+        ++x;
+      }
+    }
+  }
+  out->assign(buffer.get(), o);
+}
+
+bool DecodePixelCodec(const uint8_t* data, size_t size, int width,
+                      int height, uint8_t* dst, int dst_stride) {
+  const uint8_t* in = data;
+  const uint8_t* const end = data + size;
+  uint32_t cache[64] = {};
+  uint32_t prev = kInitialPixel;
+  for (int y = 0; y < height; ++y) {
+    uint8_t* row = dst + static_cast<ptrdiff_t>(y) * dst_stride;
+    const uint8_t* up = y ? row - dst_stride : nullptr;
+    int x = 0;
+    while (x < width) {
+      if (in >= end) return false;
+      const uint8_t op = *in++;
+      if (op < kOpRun) {
+        uint32_t px;
+        if (op < kOpDiff) {
+          px = cache[op];
+        } else if (op < kOpLuma) {
+          const uint32_t d0 = ((op >> 4) & 3) - 2u;
+          const uint32_t d1 = ((op >> 2) & 3) - 2u;
+          const uint32_t d2 = (op & 3) - 2u;
+          px = (prev & 0xFF000000u) | ((prev + d0) & 0xFF) |
+               (((prev >> 8) + d1) & 0xFF) << 8 |
+               (((prev >> 16) + d2) & 0xFF) << 16;
+          cache[CacheSlot(px)] = px;
+        } else {
+          if (in >= end) return false;
+          const int d1 = (op & 0x3F) - 32;
+          const int d0 = d1 + (*in >> 4) - 8;
+          const int d2 = d1 + (*in & 0x0F) - 8;
+          ++in;
+          px = (prev & 0xFF000000u) |
+               ((prev + static_cast<uint32_t>(d0)) & 0xFF) |
+               (((prev >> 8) + static_cast<uint32_t>(d1)) & 0xFF) << 8 |
+               (((prev >> 16) + static_cast<uint32_t>(d2)) & 0xFF) << 16;
+          cache[CacheSlot(px)] = px;
+        }
+        StorePixel(row + x * 4, px);
+        prev = px;
+        ++x;
+      } else if (op == kOpRgb || op == kOpRgba) {
+        uint32_t px;
+        if (op == kOpRgb) {
+          if (end - in < 3) return false;
+          px = (prev & 0xFF000000u) | in[0] | in[1] << 8 |
+               static_cast<uint32_t>(in[2]) << 16;
+          in += 3;
+        } else {
+          if (end - in < 4) return false;
+          px = LoadPixel(in);
+          in += 4;
+        }
+        cache[CacheSlot(px)] = px;
+        StorePixel(row + x * 4, px);
+        prev = px;
+        ++x;
+      } else if (op <= kOpRunLong) {
+        uint32_t length = (op & 0x1F) + 1u;
+        if (op == kOpRunLong) {
+          uint32_t extra;
+          if (!GetVarint(&in, end, &extra)) return false;
+          length = kShortRun + 1u + extra;
+        }
+        if (length > static_cast<uint32_t>(width - x)) return false;
+        for (uint32_t i = 0; i < length; ++i) {
+          StorePixel(row + (x + i) * 4, prev);
+        }
+        x += static_cast<int>(length);
+      } else if (op <= kOpUpLong) {
+        uint32_t length = (op & 0x0F) + 1u;
+        if (op == kOpUpLong) {
+          uint32_t extra;
+          if (!GetVarint(&in, end, &extra)) return false;
+          length = kShortUp + 1u + extra;
+        }
+        if (!up || length > static_cast<uint32_t>(width - x)) return false;
+        std::memcpy(row + x * 4, up + x * 4, length * 4);
+        x += static_cast<int>(length);
+        prev = LoadPixel(row + (x - 1) * 4);
+      } else {
+        return false;  // Reserved op.
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+bool IsValidHistoryCodec(PixelGrabHistoryCodec codec) {
+  return codec == kPixelGrabHistoryCodecPixel ||
+         codec == kPixelGrabHistoryCodecRle;
+}
+
+void EncodeHistoryImage(PixelGrabHistoryCodec codec, const uint8_t* src,
+                        int width, int height, int stride,
+                        std::vector<uint8_t>* out) {
+  out->clear();
+  if (width <= 0 || height <= 0) return;
+  if (codec == kPixelGrabHistoryCodecRle) {
+    const size_t row_bytes = static_cast<size_t>(width) * 4;
+    // Worst case: header bytes per 128-byte literal run.
+    out->reserve(row_bytes * height + row_bytes * height / 128 + 2);
+    for (int y = 0; y < height; ++y) {
+      EncodeRleRow(src + static_cast<ptrdiff_t>(y) * stride, row_bytes, out);
+    }
+    out->shrink_to_fit();
+    return;
+  }
+  EncodePixelCodec(src, width, height, stride, out);
+}
+
+bool DecodeHistoryImage(PixelGrabHistoryCodec codec, const uint8_t* data,
+                        size_t size, int width, int height, uint8_t* dst,
+                        int dst_stride) {
+  if (codec == kPixelGrabHistoryCodecRle) {
+    const size_t row_bytes = static_cast<size_t>(width) * 4;
+    size_t si = 0;
+    for (int y = 0; y < height; ++y) {
+      if (!DecodeRleRow(data, size, &si,
+                        dst + static_cast<ptrdiff_t>(y) * dst_stride,
+                        row_bytes)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return DecodePixelCodec(data, size, width, height, dst, dst_stride);
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
@@ -0,0 +1,44 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Lossless codecs for images kept in the capture history.
+
+#ifndef PIXELGRAB_CORE_HISTORY_CODEC_H_
+#define PIXELGRAB_CORE_HISTORY_CODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pixelgrab/pixelgrab.h"
+
+namespace pixelgrab {
+namespace internal {
+
+/// A rectangle of an image encoded on its own (rows of the rectangle only)
+/// at |offset| in a larger buffer, e.g. the changed tiles of a delta.
+struct HistoryPatch {
+  PixelGrabRect rect;
+  size_t offset;
+  size_t size;
+};
+
+/// True for the PixelGrabHistoryCodec values this build implements.
+bool IsValidHistoryCodec(PixelGrabHistoryCodec codec);
+
+/// Encode |height| rows of |width| 32-bit pixels (|stride| bytes apart)
+/// with |codec|, replacing the contents of |out|.  Row padding is not
+/// stored.
+void EncodeHistoryImage(PixelGrabHistoryCodec codec, const uint8_t* src,
+                        int width, int height, int stride,
+                        std::vector<uint8_t>* out);
+
+/// Decode data produced by EncodeHistoryImage() with the same codec and
+/// dimensions into |dst| rows of |dst_stride| bytes.  Returns false on
+/// malformed input (|dst| is then partially written).
+bool DecodeHistoryImage(PixelGrabHistoryCodec codec, const uint8_t* data,
+                        size_t size, int width, int height, uint8_t* dst,
+                        int dst_stride);
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_CORE_HISTORY_CODEC_H_
@@ -0,0 +1,634 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// On-disk tier of the capture history: append-only segments and an index.
+
+#include "core/history_store.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "core/capture_history.h"
+#include "core/image.h"
+#include "core/logger.h"
+
+namespace pixelgrab {
+namespace internal {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// All multi-byte fields are little-endian, as on every supported target.
+constexpr uint32_t kIndexMagic = 0x49484750;    // "PGHI"
+constexpr uint32_t kSegmentMagic = 0x53484750;  // "PGHS"
+constexpr uint32_t kRecordMagic = 0x52484750;   // "PGHR"
+constexpr uint32_t kFormatVersion = 1;
+
+constexpr size_t kFileHeaderSize = 8;     // magic, version
+constexpr size_t kIndexRecordSize = 56;   // see WriteIndexRecord()
+constexpr size_t kRecordHeaderSize = 48;  // see Append()
+constexpr size_t kPatchSize = 32;         // x, y, w, h, offset, size
+
+// A new segment is started once the current one reaches this size.
+constexpr uint64_t kSegmentBytes = 64ull * 1024 * 1024;
+
+// Index record flags.
+constexpr uint32_t kHasEntry = 1;
+constexpr uint32_t kHasImage = 2;
+
+// Guards ReadImage() against a corrupt, cyclic base chain.
+constexpr int kMaxChain = 4096;
+
+void Put32(uint8_t* p, uint32_t v) { std::memcpy(p, &v, 4); }
+void Put64(uint8_t* p, uint64_t v) { std::memcpy(p, &v, 8); }
+
+uint32_t Get32(const uint8_t* p) {
+  uint32_t v;
+  std::memcpy(&v, p, 4);
+  return v;
+}
+
+uint64_t Get64(const uint8_t* p) {
+  uint64_t v;
+  std::memcpy(&v, p, 8);
+  return v;
+}
+
+bool WriteAll(std::FILE* f, const void* data, size_t size) {
+  return size == 0 || std::fwrite(data, 1, size, f) == size;
+}
+
+bool WriteFileHeader(std::FILE* f, uint32_t magic) {
+  uint8_t header[kFileHeaderSize];
+  Put32(header, magic);
+  Put32(header + 4, kFormatVersion);
+  return WriteAll(f, header, sizeof(header)) && std::fflush(f) == 0;
+}
+
+// "history-000042.seg" -> 42; 0 for anything else.
+uint32_t ParseSegmentName(const std::string& name) {
+  constexpr char kPrefix[] = "history-";
+  constexpr char kSuffix[] = ".seg";
+  const size_t prefix = sizeof(kPrefix) - 1;
+  const size_t suffix = sizeof(kSuffix) - 1;
+  if (name.size() != prefix + 6 + suffix ||
+      name.compare(0, prefix, kPrefix) != 0 ||
+      name.compare(prefix + 6, suffix, kSuffix) != 0) {
+    return 0;
+  }
+  uint32_t number = 0;
+  for (size_t i = prefix; i < prefix + 6; ++i) {
+    if (name[i] < '0' || name[i] > '9') return 0;
+    number = number * 10 + static_cast<uint32_t>(name[i] - '0');
+  }
+  return number;
+}
+
+int EntryId(int id) { return id; }
+int EntryId(const HistoryEntry& entry) { return entry.id; }
+
+// Fields of an image record header.
+struct RecordView {
+  int id;
+  int base_id;
+  int width;
+  int height;
+  PixelGrabPixelFormat format;
+  PixelGrabHistoryCodec codec;
+  uint32_t patch_count;
+  const uint8_t* patches;
+  const uint8_t* payload;
+  uint64_t payload_size;
+};
+
+bool ParseRecord(const uint8_t* rec, uint64_t size, RecordView* out) {
+  if (size < kRecordHeaderSize || Get32(rec) != kRecordMagic) return false;
+  out->id = static_cast<int>(Get32(rec + 4));
+  out->base_id = static_cast<int>(Get32(rec + 8));
+  out->width = static_cast<int>(Get32(rec + 12));
+  out->height = static_cast<int>(Get32(rec + 16));
+  out->format = static_cast<PixelGrabPixelFormat>(Get32(rec + 20));
+  out->codec = static_cast<PixelGrabHistoryCodec>(Get32(rec + 24));
+  out->patch_count = Get32(rec + 28);
+  // rec + 32: raw size (informational).
+  out->payload_size = Get64(rec + 40);
+  const uint64_t patch_bytes =
+      static_cast<uint64_t>(out->patch_count) * kPatchSize;
+  if (out->width <= 0 || out->height <= 0 ||
+      !IsValidHistoryCodec(out->codec) ||
+      patch_bytes > size - kRecordHeaderSize ||
+      out->payload_size > size - kRecordHeaderSize - patch_bytes) {
+    return false;
+  }
+  out->patches = rec + kRecordHeaderSize;
+  out->payload = out->patches + patch_bytes;
+  return true;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Read-only file mapping
+// ---------------------------------------------------------------------------
+
+class HistoryStore::Mapping {
+ public:
+  static std::shared_ptr<Mapping> Open(const std::string& path) {
+    auto mapping = std::make_shared<Mapping>();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(
+        path.c_str(), GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    LARGE_INTEGER size;
+    HANDLE section = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+      section = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0,
+                                   nullptr);
+    }
+    CloseHandle(file);
+    if (!section) return nullptr;
+    // The view keeps the section alive.
+    void* view = MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(section);
+    if (!view) return nullptr;
+    mapping->data_ = static_cast<const uint8_t*>(view);
+    mapping->size_ = static_cast<uint64_t>(size.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    void* view = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+      view = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                    MAP_SHARED, fd, 0);
+    }
+    ::close(fd);  // The mapping keeps the file open.
+    if (view == MAP_FAILED) return nullptr;
+    mapping->data_ = static_cast<const uint8_t*>(view);
+    mapping->size_ = static_cast<uint64_t>(st.st_size);
+#endif
+    return mapping;
+  }
+
+  Mapping() = default;
+  ~Mapping() {
+    if (!data_) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+#else
+    ::munmap(const_cast<uint8_t*>(data_), static_cast<size_t>(size_));
+#endif
+  }
+
+  Mapping(const Mapping&) = delete;
+  Mapping& operator=(const Mapping&) = delete;
+
+  const uint8_t* data() const { return data_; }
+  uint64_t size() const { return size_; }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  uint64_t size_ = 0;
+};
+
+// ---------------------------------------------------------------------------
+// HistoryStore
+// ---------------------------------------------------------------------------
+
+HistoryStore::HistoryStore(std::string directory, uint64_t max_bytes)
+    : directory_(std::move(directory)), max_bytes_(max_bytes) {}
+
+HistoryStore::~HistoryStore() {
+  if (active_file_) std::fclose(active_file_);
+  if (index_file_) std::fclose(index_file_);
+}
+
+std::unique_ptr<HistoryStore> HistoryStore::Open(const std::string& directory,
+                                                 uint64_t max_bytes) {
+  std::error_code ec;
+  fs::create_directories(directory, ec);
+  if (!fs::is_directory(directory, ec)) {
+    PIXELGRAB_LOG_WARN("History store: cannot create directory {}",
+                       directory);
+    return nullptr;
+  }
+
+  std::unique_ptr<HistoryStore> store(new HistoryStore(directory, max_bytes));
+  std::lock_guard<std::mutex> lock(store->mu_);
+  for (const auto& file : fs::directory_iterator(directory, ec)) {
+    const uint32_t number =
+        ParseSegmentName(file.path().filename().string());
+    if (number == 0) continue;
+    std::error_code size_ec;
+    const uint64_t size = file.file_size(size_ec);
+    if (size_ec) continue;
+    store->segments_[number].size = size;
+    store->total_bytes_ += size;
+  }
+  if (!store->LoadIndex()) return nullptr;
+
+  store->index_file_ = std::fopen(store->IndexPath().c_str(), "ab");
+  if (!store->index_file_) return nullptr;
+  PIXELGRAB_LOG_INFO("History store {}: {} entries, {} images, {} bytes",
+                     directory, store->entries_.size(), store->images_.size(),
+                     store->total_bytes_);
+  return store;
+}
+
+std::string HistoryStore::SegmentPath(uint32_t number) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "history-%06u.seg", number);
+  return (fs::path(directory_) / name).string();
+}
+
+std::string HistoryStore::IndexPath() const {
+  return (fs::path(directory_) / "history.idx").string();
+}
+
+bool HistoryStore::LoadIndex() {
+  std::FILE* f = std::fopen(IndexPath().c_str(), "rb");
+  if (!f) {
+    // New store.
+    f = std::fopen(IndexPath().c_str(), "wb");
+    if (!f) return false;
+    const bool ok = WriteFileHeader(f, kIndexMagic);
+    std::fclose(f);
+    return ok;
+  }
+
+  uint8_t header[kFileHeaderSize];
+  if (std::fread(header, 1, sizeof(header), f) != sizeof(header) ||
+      Get32(header) != kIndexMagic || Get32(header + 4) != kFormatVersion) {
+    std::fclose(f);
+    PIXELGRAB_LOG_WARN("History store: unrecognized index {}", IndexPath());
+    return false;
+  }
+
+  // Later records override earlier ones; a torn last record is ignored.
+  uint8_t rec[kIndexRecordSize];
+  while (std::fread(rec, 1, sizeof(rec), f) == sizeof(rec)) {
+    const int id = static_cast<int>(Get32(rec));
+    const uint32_t flags = Get32(rec + 4);
+    if (id <= 0) continue;
+    if (flags & kHasImage) {
+      Location loc;
+      loc.segment = Get32(rec + 32);
+      loc.offset = Get64(rec + 40);
+      loc.size = Get64(rec + 48);
+      auto seg = segments_.find(loc.segment);
+      if (seg != segments_.end() && loc.offset <= seg->second.size &&
+          loc.size <= seg->second.size - loc.offset) {
+        images_[id] = loc;
+        seg->second.max_id = std::max(seg->second.max_id, id);
+      }
+    }
+    if (flags & kHasEntry) {
+      HistoryEntry entry;
+      entry.id = id;
+      entry.region_x = static_cast<int>(Get32(rec + 8));
+      entry.region_y = static_cast<int>(Get32(rec + 12));
+      entry.region_width = static_cast<int>(Get32(rec + 16));
+      entry.region_height = static_cast<int>(Get32(rec + 20));
+      entry.timestamp = static_cast<int64_t>(Get64(rec + 24));
+      UpsertEntry(entry);
+    }
+    max_id_ = std::max(max_id_, id);
+  }
+  std::fclose(f);
+  return true;
+}
+
+bool HistoryStore::WriteIndexRecord(std::FILE* file, int id,
+                                    const HistoryEntry* entry,
+                                    const Location* image) {
+  uint8_t rec[kIndexRecordSize] = {};
+  Put32(rec, static_cast<uint32_t>(id));
+  Put32(rec + 4, (entry ? kHasEntry : 0) | (image ? kHasImage : 0));
+  if (entry) {
+    Put32(rec + 8, static_cast<uint32_t>(entry->region_x));
+    Put32(rec + 12, static_cast<uint32_t>(entry->region_y));
+    Put32(rec + 16, static_cast<uint32_t>(entry->region_width));
+    Put32(rec + 20, static_cast<uint32_t>(entry->region_height));
+    Put64(rec + 24, static_cast<uint64_t>(entry->timestamp));
+  }
+  if (image) {
+    Put32(rec + 32, image->segment);
+    // rec + 36: reserved.
+    Put64(rec + 40, image->offset);
+    Put64(rec + 48, image->size);
+  }
+  return WriteAll(file, rec, sizeof(rec));
+}
+
+bool HistoryStore::RewriteIndex() {
+  const std::string tmp = IndexPath() + ".tmp";
+  std::FILE* f = std::fopen(tmp.c_str(), "wb");
+  if (!f) return false;
+  bool ok = WriteFileHeader(f, kIndexMagic);
+  for (const auto& entry : entries_) {
+    auto it = images_.find(entry.id);
+    ok = ok && WriteIndexRecord(f, entry.id, &entry,
+                                it != images_.end() ? &it->second : nullptr);
+  }
+  const auto has_entry = [this](int id) {
+    return std::binary_search(
+        entries_.begin(), entries_.end(), id,
+        [](const auto& a, const auto& b) { return EntryId(a) < EntryId(b); });
+  };
+  for (const auto& image : images_) {
+    if (!has_entry(image.first)) {
+      ok = ok && WriteIndexRecord(f, image.first, nullptr, &image.second);
+    }
+  }
+  ok = std::fclose(f) == 0 && ok;
+
+  if (index_file_) std::fclose(index_file_);
+  std::error_code ec;
+  if (ok) fs::rename(tmp, IndexPath(), ec);
+  index_file_ = std::fopen(IndexPath().c_str(), "ab");
+  return ok && !ec && index_file_;
+}
+
+void HistoryStore::UpsertEntry(const HistoryEntry& entry) {
+  auto it = std::lower_bound(
+      entries_.begin(), entries_.end(), entry.id,
+      [](const HistoryEntry& e, int id) { return e.id < id; });
+  if (it != entries_.end() && it->id == entry.id) {
+    *it = entry;
+  } else {
+    entries_.insert(it, entry);
+  }
+}
+
+bool HistoryStore::Append(const HistoryEntry* entry,
+                          const ImageRecord* image) {
+  if (!entry && !image) return false;
+  std::lock_guard<std::mutex> lock(mu_);
+  if (!index_file_) return false;
+
+  Location loc = {};
+  if (image) {
+    const size_t patch_count = image->patches ? image->patches->size() : 0;
+    const uint64_t record_size = kRecordHeaderSize +
+                                 patch_count * kPatchSize +
+                                 image->data->size();
+    if (active_file_ &&
+        segments_[active_segment_].size + record_size > kSegmentBytes) {
+      std::fclose(active_file_);
+      active_file_ = nullptr;
+    }
+    if (!active_file_) {
+      // Each session appends to segments of its own.
+      active_segment_ = segments_.empty() ? 1 : segments_.rbegin()->first + 1;
+      active_file_ = std::fopen(SegmentPath(active_segment_).c_str(), "wb");
+      if (!active_file_ || !WriteFileHeader(active_file_, kSegmentMagic)) {
+        PIXELGRAB_LOG_WARN("History store: cannot create {}",
+                           SegmentPath(active_segment_));
+        if (active_file_) std::fclose(active_file_);
+        active_file_ = nullptr;
+        return false;
+      }
+      segments_[active_segment_].size = kFileHeaderSize;
+      total_bytes_ += kFileHeaderSize;
+    }
+
+    uint8_t header[kRecordHeaderSize] = {};
+    Put32(header, kRecordMagic);
+    Put32(header + 4, static_cast<uint32_t>(image->id));
+    Put32(header + 8, static_cast<uint32_t>(image->base_id));
+    Put32(header + 12, static_cast<uint32_t>(image->width));
+    Put32(header + 16, static_cast<uint32_t>(image->height));
+    Put32(header + 20, static_cast<uint32_t>(image->format));
+    Put32(header + 24, static_cast<uint32_t>(image->codec));
+    Put32(header + 28, static_cast<uint32_t>(patch_count));
+    Put64(header + 32, image->raw_size);
+    Put64(header + 40, image->data->size());
+    std::vector<uint8_t> patches(patch_count * kPatchSize);
+    for (size_t i = 0; i < patch_count; ++i) {
+      const HistoryPatch& p = (*image->patches)[i];
+      uint8_t* out = patches.data() + i * kPatchSize;
+      Put32(out, static_cast<uint32_t>(p.rect.x));
+      Put32(out + 4, static_cast<uint32_t>(p.rect.y));
+      Put32(out + 8, static_cast<uint32_t>(p.rect.width));
+      Put32(out + 12, static_cast<uint32_t>(p.rect.height));
+      Put64(out + 16, p.offset);
+      Put64(out + 24, p.size);
+    }
+    Segment& seg = segments_[active_segment_];
+    if (!WriteAll(active_file_, header, sizeof(header)) ||
+        !WriteAll(active_file_, patches.data(), patches.size()) ||
+        !WriteAll(active_file_, image->data->data(), image->data->size()) ||
+        std::fflush(active_file_) != 0) {
+      // The segment's tail is unusable now; continue in a new one.
+      PIXELGRAB_LOG_WARN("History store: write to {} failed",
+                         SegmentPath(active_segment_));
+      std::fclose(active_file_);
+      active_file_ = nullptr;
+      return false;
+    }
+    loc = {active_segment_, seg.size, record_size};
+    seg.size += record_size;
+    seg.max_id = std::max(seg.max_id, image->id);
+    total_bytes_ += record_size;
+    images_[image->id] = loc;
+  }
+
+  const int id = entry ? entry->id : image->id;
+  // The record is on disk before the index refers to it.
+  if (!WriteIndexRecord(index_file_, id, entry, image ? &loc : nullptr) ||
+      std::fflush(index_file_) != 0) {
+    return false;
+  }
+  if (entry) UpsertEntry(*entry);
+  max_id_ = std::max(max_id_, id);
+
+  bool dropped = false;
+  while (total_bytes_ > max_bytes_ && segments_.size() > 1 &&
+         segments_.begin()->first != active_segment_) {
+    DropOldestSegment();
+    dropped = true;
+  }
+  if (dropped) RewriteIndex();
+  return true;
+}
+
+void HistoryStore::DropOldestSegment() {
+  auto seg = segments_.begin();
+  const uint32_t number = seg->first;
+  // Entries are spilled roughly in ID order, so everything up to the
+  // segment's newest image goes with it.
+  const int max_id = seg->second.max_id;
+  for (auto it = images_.begin(); it != images_.end();) {
+    if (it->second.segment == number) {
+      it = images_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  entries_.erase(entries_.begin(),
+                 std::upper_bound(entries_.begin(), entries_.end(), max_id,
+                                  [](int id, const HistoryEntry& e) {
+                                    return id < e.id;
+                                  }));
+  total_bytes_ -= seg->second.size;
+  segments_.erase(seg);  // Unmaps once no reader holds the mapping.
+  std::error_code ec;
+  fs::remove(SegmentPath(number), ec);
+  if (ec) {
+    PIXELGRAB_LOG_DEBUG("History store: cannot remove segment {}: {}",
+                        number, ec.message());
+  }
+}
+
+std::shared_ptr<HistoryStore::Mapping> HistoryStore::MapSegment(
+    uint32_t number, uint64_t end) const {
+  auto it = segments_.find(number);
+  if (it == segments_.end()) return nullptr;
+  Segment& seg = it->second;
+  // The segment being appended to grows; map it again to see new records.
+  if (!seg.mapping || seg.mapping->size() < end) {
+    seg.mapping = Mapping::Open(SegmentPath(number));
+  }
+  if (!seg.mapping || seg.mapping->size() < end) return nullptr;
+  return seg.mapping;
+}
+
+bool HistoryStore::HasImage(int id) const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return images_.count(id) != 0;
+}
+
+int HistoryStore::EntryCount() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return static_cast<int>(entries_.size());
+}
+
+bool HistoryStore::GetEntry(int index, HistoryEntry* out) const {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (!out || index < 0 || index >= static_cast<int>(entries_.size())) {
+    return false;
+  }
+  *out = entries_[entries_.size() - 1 - index];
+  return true;
+}
+
+bool HistoryStore::FindEntry(int id, HistoryEntry* out) const {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto it = std::lower_bound(
+      entries_.begin(), entries_.end(), id,
+      [](const HistoryEntry& e, int key) { return e.id < key; });
+  if (it == entries_.end() || it->id != id) return false;
+  if (out) *out = *it;
+  return true;
+}
+
+std::unique_ptr<Image> HistoryStore::ReadImage(int id) const {
+  // Collect the chain back to its keyframe; the mappings keep the records
+  // readable after the lock is dropped.
+  struct Step {
+    std::shared_ptr<Mapping> mapping;
+    RecordView record;
+  };
+  std::vector<Step> chain;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    for (int current = id; current != 0;) {
+      if (chain.size() >= static_cast<size_t>(kMaxChain)) return nullptr;
+      auto it = images_.find(current);
+      if (it == images_.end()) return nullptr;
+      const Location& loc = it->second;
+      auto mapping = MapSegment(loc.segment, loc.offset + loc.size);
+      if (!mapping) return nullptr;
+      RecordView record;
+      if (!ParseRecord(mapping->data() + loc.offset, loc.size, &record) ||
+          record.id != current) {
+        return nullptr;
+      }
+      chain.push_back({std::move(mapping), record});
+      current = record.base_id;
+    }
+  }
+  if (chain.empty()) return nullptr;
+
+  const RecordView& key = chain.back().record;
+  auto image = Image::CreateUninitialized(key.width, key.height, key.format);
+  if (!image || !image->mutable_data()) return nullptr;
+  uint8_t* dst = image->mutable_data();
+  const int stride = image->stride();
+  if (key.base_id != 0 ||
+      !DecodeHistoryImage(key.codec, key.payload, key.payload_size,
+                          key.width, key.height, dst, stride)) {
+    return nullptr;
+  }
+  for (auto it = chain.rbegin() + 1; it != chain.rend(); ++it) {
+    const RecordView& r = it->record;
+    if (r.width != key.width || r.height != key.height) return nullptr;
+    for (uint32_t i = 0; i < r.patch_count; ++i) {
+      const uint8_t* p = r.patches + static_cast<size_t>(i) * kPatchSize;
+      const int x = static_cast<int>(Get32(p));
+      const int y = static_cast<int>(Get32(p + 4));
+      const int w = static_cast<int>(Get32(p + 8));
+      const int h = static_cast<int>(Get32(p + 12));
+      const uint64_t offset = Get64(p + 16);
+      const uint64_t size = Get64(p + 24);
+      if (x < 0 || y < 0 || w <= 0 || h <= 0 || w > r.width - x ||
+          h > r.height - y || offset > r.payload_size ||
+          size > r.payload_size - offset ||
+          !DecodeHistoryImage(r.codec, r.payload + offset, size, w, h,
+                              dst + static_cast<ptrdiff_t>(y) * stride + x * 4,
+                              stride)) {
+        return nullptr;
+      }
+    }
+  }
+  return image;
+}
+
+int HistoryStore::MaxId() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return max_id_;
+}
+
+uint64_t HistoryStore::SizeBytes() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return total_bytes_;
+}
+
+void HistoryStore::Clear() {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (active_file_) std::fclose(active_file_);
+  active_file_ = nullptr;
+  for (const auto& seg : segments_) {
+    std::error_code ec;
+    fs::remove(SegmentPath(seg.first), ec);
+  }
+  segments_.clear();
+  images_.clear();
+  entries_.clear();
+  total_bytes_ = 0;
+  // IDs keep counting up so a reopened store never reuses one.
+  RewriteIndex();
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
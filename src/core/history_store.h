@@ -0,0 +1,137 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// On-disk tier of the capture history: append-only segments and an index.
+
+#ifndef PIXELGRAB_CORE_HISTORY_STORE_H_
+#define PIXELGRAB_CORE_HISTORY_STORE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/history_codec.h"
+#include "pixelgrab/pixelgrab.h"
+
+namespace pixelgrab {
+namespace internal {
+
+class Image;
+struct HistoryEntry;
+
+/// Persistent store for history entries and their compressed images.
+///
+/// A directory holds numbered segment files, to which image records are
+/// only ever appended, and an index file that maps entry and image IDs to
+/// their records.  Opening reads the index alone; segments are memory
+/// mapped on first read and images are decoded straight from the mapped
+/// pages, so resident memory stays small however large the store grows.
+/// Once the store exceeds its size cap the oldest segment is deleted
+/// together with the entries recorded in it.
+///
+/// Images are stored as CaptureHistory holds them: keyframes or deltas
+/// whose base must be appended first.  A delta whose base was in a deleted
+/// segment can no longer be restored; ReadImage() then returns nullptr.
+///
+/// Thread-safe.  Appends and index updates take an internal lock; decoding
+/// runs outside it.
+class HistoryStore {
+ public:
+  /// A compressed image to append (see CaptureHistory).
+  struct ImageRecord {
+    int id;
+    int base_id;  // 0 for a keyframe.
+    int width;
+    int height;
+    PixelGrabPixelFormat format;
+    PixelGrabHistoryCodec codec;
+    uint64_t raw_size;
+    const std::vector<HistoryPatch>* patches;  // Deltas only.
+    const std::vector<uint8_t>* data;
+  };
+
+  /// Open (creating if needed) the store in |directory|, reading only its
+  /// index.  |max_bytes| caps the segments' total size.  Returns nullptr if
+  /// the directory cannot be created or the index is unreadable.
+  static std::unique_ptr<HistoryStore> Open(const std::string& directory,
+                                            uint64_t max_bytes);
+  ~HistoryStore();
+
+  // Non-copyable.
+  HistoryStore(const HistoryStore&) = delete;
+  HistoryStore& operator=(const HistoryStore&) = delete;
+
+  /// Append |image| (optional) and the entry |entry| (optional) describing
+  /// it; an entry without an image refers to an image appended earlier
+  /// under the same ID, if any.  Returns false on a write error.
+  bool Append(const HistoryEntry* entry, const ImageRecord* image);
+
+  bool HasImage(int id) const;
+
+  /// Number of entries; GetEntry() indexes them newest first.
+  int EntryCount() const;
+  bool GetEntry(int index, HistoryEntry* out) const;
+  bool FindEntry(int id, HistoryEntry* out) const;
+
+  /// Decode the image stored under |id| (replaying its deltas).
+  std::unique_ptr<Image> ReadImage(int id) const;
+
+  /// Highest entry or image ID in the store (0 if empty).
+  int MaxId() const;
+
+  /// Total size of the segment files.
+  uint64_t SizeBytes() const;
+
+  /// Delete every segment and entry.
+  void Clear();
+
+ private:
+  class Mapping;
+
+  struct Location {
+    uint32_t segment;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  struct Segment {
+    uint64_t size = 0;
+    int max_id = 0;                    // Highest image ID recorded in it.
+    std::shared_ptr<Mapping> mapping;  // Mapped on first read.
+  };
+
+  HistoryStore(std::string directory, uint64_t max_bytes);
+
+  std::string SegmentPath(uint32_t number) const;
+  std::string IndexPath() const;
+
+  // Called with |mu_| held.
+  bool LoadIndex();
+  bool WriteIndexRecord(std::FILE* file, int id, const HistoryEntry* entry,
+                        const Location* image);
+  bool RewriteIndex();
+  void UpsertEntry(const HistoryEntry& entry);
+  std::shared_ptr<Mapping> MapSegment(uint32_t number, uint64_t end) const;
+  void DropOldestSegment();
+
+  const std::string directory_;
+  const uint64_t max_bytes_;
+
+  mutable std::mutex mu_;
+  std::vector<HistoryEntry> entries_;  // Ascending ID.
+  std::unordered_map<int, Location> images_;
+  mutable std::map<uint32_t, Segment> segments_;
+  uint64_t total_bytes_ = 0;
+  int max_id_ = 0;
+  std::FILE* index_file_ = nullptr;
+  std::FILE* active_file_ = nullptr;  // Segment appended this session.
+  uint32_t active_segment_ = 0;
+};
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_CORE_HISTORY_STORE_H_
@@ -3,6 +3,7 @@
 #include "core/image.h"
 
 #include <cassert>
+#include <cstring>
 #include <utility>
 
 namespace pixelgrab {
@@ -29,19 +30,74 @@ Image::Image(int width, int height, int stride, PixelGrabPixelFormat format,
       height_(height),
       stride_(stride),
       format_(format),
-      data_(std::move(data)) {}
+      storage_(std::make_shared<Storage>(PixelBuffer::Adopt(std::move(data)))),
+      size_(storage_->pixels.size()) {}
+
+Image::Image(int width, int height, int stride, PixelGrabPixelFormat format,
+             PixelBuffer data)
+    : width_(width),
+      height_(height),
+      stride_(stride),
+      format_(format),
+      storage_(std::make_shared<Storage>(std::move(data))),
+      size_(storage_->pixels.size()) {}
+
+Image::Image(int width, int height, int stride, PixelGrabPixelFormat format,
+             std::shared_ptr<Storage> storage, size_t offset, size_t size)
+    : width_(width),
+      height_(height),
+      stride_(stride),
+      format_(format),
+      storage_(std::move(storage)),
+      offset_(offset),
+      size_(size) {
+  // The new image is created from one already holding the storage, so the
+  // increment needs no ordering.
+  if (storage_) storage_->owners.fetch_add(1, std::memory_order_relaxed);
+}
+
+Image::~Image() { ReleaseStorage(); }
+
+Image& Image::operator=(Image&& other) noexcept {
+  if (this != &other) {
+    ReleaseStorage();
+    width_ = other.width_;
+    height_ = other.height_;
+    stride_ = other.stride_;
+    format_ = other.format_;
+    storage_ = std::move(other.storage_);
+    offset_ = other.offset_;
+    size_ = other.size_;
+  }
+  return *this;
+}
+
+void Image::ReleaseStorage() {
+  if (!storage_) return;
+  storage_->owners.fetch_sub(1, std::memory_order_release);
+  storage_.reset();
+}
 
 static constexpr size_t kMaxImageBytes = 256ULL * 1024 * 1024;  // 256 MB
 
 // static
 std::unique_ptr<Image> Image::Create(int width, int height,
                                      PixelGrabPixelFormat format) {
+  auto img = CreateUninitialized(width, height, format);
+  if (img) std::memset(img->mutable_data(), 0, img->data_size());
+  return img;
+}
+
+// static
+std::unique_ptr<Image> Image::CreateUninitialized(int width, int height,
+                                                  PixelGrabPixelFormat format) {
   if (width <= 0 || height <= 0) return nullptr;
   int bpp = BytesPerPixel(format);
   int stride = width * bpp;
   size_t total = static_cast<size_t>(stride) * static_cast<size_t>(height);
   if (total > kMaxImageBytes) return nullptr;
-  std::vector<uint8_t> data(total, 0);
+  PixelBuffer data = PixelBuffer::Acquire(total);
+  if (data.empty()) return nullptr;
   return std::make_unique<Image>(width, height, stride, format,
                                  std::move(data));
 }
@@ -58,9 +114,41 @@ std::unique_ptr<Image> Image::CreateFromData(int width, int height, int stride,
 }
 
 std::unique_ptr<Image> Image::Clone() const {
-  std::vector<uint8_t> data_copy(data_);
-  return std::make_unique<Image>(width_, height_, stride_, format_,
-                                 std::move(data_copy));
+  return std::unique_ptr<Image>(new Image(width_, height_, stride_, format_,
+                                          storage_, offset_, size_));
+}
+
+std::unique_ptr<Image> Image::CreateView(int x, int y, int width,
+                                         int height) const {
+  if (!storage_ || x < 0 || y < 0 || width <= 0 || height <= 0 ||
+      width > width_ - x || height > height_ - y) {
+    return nullptr;
+  }
+  size_t bpp = static_cast<size_t>(BytesPerPixel(format_));
+  size_t offset = offset_ + static_cast<size_t>(y) * stride_ +
+                  static_cast<size_t>(x) * bpp;
+  size_t size = static_cast<size_t>(height - 1) * stride_ +
+                static_cast<size_t>(width) * bpp;
+  return std::unique_ptr<Image>(
+      new Image(width, height, stride_, format_, storage_, offset, size));
+}
+
+uint8_t* Image::mutable_data() {
+  if (!storage_) return nullptr;
+  if (is_shared()) {
+    // Shared with a clone or view: detach before the caller writes.  The
+    // copy keeps the stride so callers may read stride() beforehand.
+    size_t full = static_cast<size_t>(stride_) * height_;
+    PixelBuffer copy = PixelBuffer::Acquire(full);
+    if (copy.empty()) return nullptr;
+    std::memcpy(copy.data(), data(), size_);
+    if (full > size_) std::memset(copy.data() + size_, 0, full - size_);
+    ReleaseStorage();
+    storage_ = std::make_shared<Storage>(std::move(copy));
+    offset_ = 0;
+    size_ = full;
+  }
+  return storage_->pixels.data() + offset_;
 }
 
 }  // namespace internal
@@ -3,58 +3,130 @@
 #ifndef PIXELGRAB_CORE_IMAGE_H_
 #define PIXELGRAB_CORE_IMAGE_H_
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <vector>
 
+#include "core/image_buffer_pool.h"
 #include "pixelgrab/pixelgrab.h"
 
 namespace pixelgrab {
 namespace internal {
 
 /// Internal image representation holding captured pixel data.
+///
+/// Pixel storage comes from the process-wide ImageBufferPool (64-byte
+/// aligned) unless the image adopted a caller-built vector; either way it is
+/// returned when the last image referencing it is destroyed.
+///
+/// Storage is reference-counted and copy-on-write: Clone() shares the
+/// pixels, and the first mutable_data() call on an image whose storage is
+/// shared detaches it with a private copy.  Pointers previously returned by
+/// mutable_data() must therefore not be written to after a Clone().
+///
+/// Whether the storage is shared is decided from an explicit owner count
+/// rather than shared_ptr::use_count(), which is only a relaxed load: an
+/// image released on another thread drops its count with release order, so
+/// a writer that observes itself as the sole owner also observes every
+/// read that thread made through the storage.
+///
+/// CreateView() yields a sub-rectangle sharing the same storage: data()
+/// points at the view's first pixel and stride() stays the parent's.
 class Image {
  public:
   Image(int width, int height, int stride, PixelGrabPixelFormat format,
         std::vector<uint8_t> data);
-  ~Image() = default;
+  Image(int width, int height, int stride, PixelGrabPixelFormat format,
+        PixelBuffer data);
+  ~Image();
 
   // Non-copyable, movable.
   Image(const Image&) = delete;
   Image& operator=(const Image&) = delete;
   Image(Image&&) = default;
-  Image& operator=(Image&&) = default;
+  Image& operator=(Image&& other) noexcept;
 
   int width() const { return width_; }
   int height() const { return height_; }
   int stride() const { return stride_; }
   PixelGrabPixelFormat format() const { return format_; }
-  const uint8_t* data() const { return data_.data(); }
-  size_t data_size() const { return data_.size(); }
+  const uint8_t* data() const {
+    return storage_ ? storage_->pixels.data() + offset_ : nullptr;
+  }
+  /// Bytes from data() to the end of the last row's pixels.  Equals
+  /// stride * height except for views, whose last row stops at the right
+  /// edge of the view.
+  size_t data_size() const { return size_; }
 
   /// Create an image with pre-allocated buffer (to be filled by caller).
+  /// The pixels are zero-initialized.
   static std::unique_ptr<Image> Create(int width, int height,
                                        PixelGrabPixelFormat format);
 
+  /// Like Create(), but leaves the pixels undefined.  For callers that
+  /// overwrite every byte; skips the memset on recycled pool buffers.
+  static std::unique_ptr<Image> CreateUninitialized(
+      int width, int height, PixelGrabPixelFormat format);
+
   /// Create an image from existing data (takes ownership via move).
   static std::unique_ptr<Image> CreateFromData(int width, int height,
                                                int stride,
                                                PixelGrabPixelFormat format,
                                                std::vector<uint8_t> data);
 
-  /// Create a deep copy of this image.
+  /// Create a copy of this image.  The pixels are shared until either side
+  /// calls mutable_data().
   std::unique_ptr<Image> Clone() const;
 
-  /// Get a mutable pointer to pixel data (for backends to fill).
-  uint8_t* mutable_data() { return data_.data(); }
+  /// Create a view of the rectangle (x, y, width, height) sharing this
+  /// image's pixels.  Returns nullptr unless the rectangle is non-empty and
+  /// lies inside the image.
+  std::unique_ptr<Image> CreateView(int x, int y, int width, int height) const;
+
+  /// Get a mutable pointer to pixel data (for backends to fill).  Copies the
+  /// pixels first if the storage is shared with another image (or view);
+  /// the stride is preserved.
+  uint8_t* mutable_data();
+
+  /// Relabel the pixel format without touching the pixels.  Only for
+  /// callers that rewrite the pixels to match (see ConvertImageFormat).
+  void set_format(PixelGrabPixelFormat format) { format_ = format; }
+
+  /// True if another image (clone or view) currently references this
+  /// image's pixels, i.e. mutable_data() would copy.
+  bool is_shared() const {
+    return storage_ && storage_->owners.load(std::memory_order_acquire) > 1;
+  }
+
+  /// True if this image and |other| currently reference the same pixels.
+  bool SharesDataWith(const Image& other) const {
+    return storage_ && storage_ == other.storage_;
+  }
 
  private:
+  /// Pixels plus the number of Image objects referencing them.  The
+  /// shared_ptr only manages lifetime; copy-on-write decisions use |owners|.
+  struct Storage {
+    explicit Storage(PixelBuffer buffer) : pixels(std::move(buffer)) {}
+    PixelBuffer pixels;
+    std::atomic<int> owners{1};
+  };
+
+  Image(int width, int height, int stride, PixelGrabPixelFormat format,
+        std::shared_ptr<Storage> storage, size_t offset, size_t size);
+
+  /// Drop this image's reference to storage_ (release order, see above).
+  void ReleaseStorage();
+
   int width_;
   int height_;
   int stride_;
   PixelGrabPixelFormat format_;
-  std::vector<uint8_t> data_;
+  std::shared_ptr<Storage> storage_;
+  size_t offset_ = 0;  // Byte offset of pixel (0, 0) within storage_.
+  size_t size_ = 0;    // See data_size().
 };
 
 }  // namespace internal
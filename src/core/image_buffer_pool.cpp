@@ -0,0 +1,206 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Process-wide, size-classed pool of aligned pixel buffers.
+
+#include "core/image_buffer_pool.h"
+
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <utility>
+
+namespace pixelgrab {
+namespace internal {
+
+namespace {
+
+constexpr size_t kSmallClassLimit = 4096;
+
+}  // namespace
+
+// static
+ImageBufferPool& ImageBufferPool::Instance() {
+  static ImageBufferPool* pool = new ImageBufferPool();
+  return *pool;
+}
+
+ImageBufferPool::~ImageBufferPool() { Trim(); }
+
+// static
+size_t ImageBufferPool::SizeClass(size_t size) {
+  if (size == 0) return kPixelBufferAlignment;
+  if (size <= kSmallClassLimit) {
+    return (size + kPixelBufferAlignment - 1) & ~(kPixelBufferAlignment - 1);
+  }
+  size_t pow2 = kSmallClassLimit;
+  while (pow2 <= size / 2) pow2 <<= 1;  // Largest power of two <= size.
+  size_t step = pow2 / 4;
+  return (size + step - 1) / step * step;
+}
+
+// static
+uint8_t* ImageBufferPool::AllocateBlock(size_t capacity) {
+  return static_cast<uint8_t*>(::operator new(
+      capacity, std::align_val_t(kPixelBufferAlignment), std::nothrow));
+}
+
+// static
+void ImageBufferPool::FreeBlock(uint8_t* block) {
+  ::operator delete(block, std::align_val_t(kPixelBufferAlignment));
+}
+
+uint8_t* ImageBufferPool::Acquire(size_t size, size_t* out_capacity) {
+  size_t capacity = SizeClass(size);
+  uint8_t* block = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    ++acquire_count_;
+    auto it = idle_.find(capacity);
+    if (it != idle_.end() && !it->second.empty()) {
+      block = it->second.back().ptr;
+      it->second.pop_back();
+      if (it->second.empty()) idle_.erase(it);
+      pooled_bytes_ -= capacity;
+      ++hit_count_;
+    }
+    in_use_bytes_ += capacity;
+    peak_in_use_bytes_ = std::max(peak_in_use_bytes_, in_use_bytes_);
+  }
+  if (!block) {
+    block = AllocateBlock(capacity);
+    if (!block) {
+      std::lock_guard<std::mutex> lock(mu_);
+      in_use_bytes_ -= capacity;
+      return nullptr;
+    }
+  }
+  if (out_capacity) *out_capacity = capacity;
+  return block;
+}
+
+void ImageBufferPool::Release(uint8_t* block, size_t capacity) {
+  if (!block) return;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    in_use_bytes_ -= capacity;
+    if (capacity <= max_pooled_bytes_) {
+      EvictLocked(max_pooled_bytes_ - capacity);
+      idle_[capacity].push_back({block, ++release_seq_});
+      pooled_bytes_ += capacity;
+      return;
+    }
+    ++evict_count_;
+  }
+  FreeBlock(block);
+}
+
+void ImageBufferPool::EvictLocked(size_t limit) {
+  while (pooled_bytes_ > limit) {
+    // The oldest block of each class sits at the front of its vector.
+    auto oldest = idle_.end();
+    uint64_t oldest_seq = std::numeric_limits<uint64_t>::max();
+    for (auto it = idle_.begin(); it != idle_.end(); ++it) {
+      if (it->second.front().released_at < oldest_seq) {
+        oldest_seq = it->second.front().released_at;
+        oldest = it;
+      }
+    }
+    if (oldest == idle_.end()) break;
+    FreeBlock(oldest->second.front().ptr);
+    oldest->second.erase(oldest->second.begin());
+    pooled_bytes_ -= oldest->first;
+    ++evict_count_;
+    if (oldest->second.empty()) idle_.erase(oldest);
+  }
+}
+
+void ImageBufferPool::SetMaxPooledBytes(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mu_);
+  max_pooled_bytes_ = bytes;
+  EvictLocked(bytes);
+}
+
+void ImageBufferPool::Trim() {
+  std::lock_guard<std::mutex> lock(mu_);
+  for (auto& bucket : idle_) {
+    for (const auto& b : bucket.second) FreeBlock(b.ptr);
+  }
+  idle_.clear();
+  pooled_bytes_ = 0;
+}
+
+PixelGrabBufferPoolStats ImageBufferPool::GetStats() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  PixelGrabBufferPoolStats s{};
+  s.acquire_count = acquire_count_;
+  s.hit_count = hit_count_;
+  s.miss_count = acquire_count_ - hit_count_;
+  s.evict_count = evict_count_;
+  s.bytes_in_use = in_use_bytes_;
+  s.peak_bytes_in_use = peak_in_use_bytes_;
+  s.bytes_pooled = pooled_bytes_;
+  s.max_pooled_bytes = max_pooled_bytes_;
+  return s;
+}
+
+// ---------------------------------------------------------------------------
+// PixelBuffer
+// ---------------------------------------------------------------------------
+
+PixelBuffer::PixelBuffer(PixelBuffer&& other) noexcept
+    : data_(other.data_),
+      size_(other.size_),
+      capacity_(other.capacity_),
+      adopted_(std::move(other.adopted_)) {
+  other.data_ = nullptr;
+  other.size_ = 0;
+  other.capacity_ = 0;
+}
+
+PixelBuffer& PixelBuffer::operator=(PixelBuffer&& other) noexcept {
+  if (this != &other) {
+    Reset();
+    data_ = other.data_;
+    size_ = other.size_;
+    capacity_ = other.capacity_;
+    adopted_ = std::move(other.adopted_);
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.capacity_ = 0;
+  }
+  return *this;
+}
+
+// static
+PixelBuffer PixelBuffer::Acquire(size_t size) {
+  PixelBuffer buf;
+  size_t capacity = 0;
+  uint8_t* block = ImageBufferPool::Instance().Acquire(size, &capacity);
+  if (!block) return buf;
+  buf.data_ = block;
+  buf.size_ = size;
+  buf.capacity_ = capacity;
+  return buf;
+}
+
+// static
+PixelBuffer PixelBuffer::Adopt(std::vector<uint8_t> data) {
+  PixelBuffer buf;
+  buf.adopted_ = std::move(data);
+  buf.data_ = buf.adopted_.data();
+  buf.size_ = buf.adopted_.size();
+  return buf;
+}
+
+void PixelBuffer::Reset() {
+  if (capacity_ != 0) {
+    ImageBufferPool::Instance().Release(data_, capacity_);
+  }
+  adopted_.clear();
+  adopted_.shrink_to_fit();
+  data_ = nullptr;
+  size_ = 0;
+  capacity_ = 0;
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
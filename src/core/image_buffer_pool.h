@@ -0,0 +1,128 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Process-wide, size-classed pool of aligned pixel buffers.
+
+#ifndef PIXELGRAB_CORE_IMAGE_BUFFER_POOL_H_
+#define PIXELGRAB_CORE_IMAGE_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "pixelgrab/pixelgrab.h"
+
+namespace pixelgrab {
+namespace internal {
+
+/// Alignment of every pooled block (one cache line, enough for AVX-512).
+constexpr size_t kPixelBufferAlignment = 64;
+
+/// Recycles pixel storage between images of the same (or similar) size.
+///
+/// Requests are rounded up to a size class: 64-byte steps below 4 KB, then
+/// four classes per power of two (at most 25% slack).  Released blocks are
+/// kept per class and handed out again LIFO, so a capture loop at a fixed
+/// resolution stops touching the allocator -- and stops page-faulting fresh
+/// memory -- after the first frame.
+///
+/// Idle blocks are capped by a high-water mark; releasing past it frees the
+/// least recently released blocks first.  Thread-safe.
+class ImageBufferPool {
+ public:
+  /// The process-wide instance.  Intentionally never destroyed so images
+  /// released during static destruction still have somewhere to go.
+  static ImageBufferPool& Instance();
+
+  ImageBufferPool() = default;
+  ~ImageBufferPool();
+
+  // Non-copyable.
+  ImageBufferPool(const ImageBufferPool&) = delete;
+  ImageBufferPool& operator=(const ImageBufferPool&) = delete;
+
+  /// Get a block of at least |size| bytes with undefined contents.
+  /// |out_capacity| receives the class size that must be passed back to
+  /// Release().  Returns nullptr on allocation failure.
+  uint8_t* Acquire(size_t size, size_t* out_capacity);
+
+  /// Return a block obtained from Acquire().
+  void Release(uint8_t* block, size_t capacity);
+
+  /// Set the maximum number of idle bytes kept for reuse (0 disables
+  /// pooling).  Excess idle blocks are freed immediately.
+  void SetMaxPooledBytes(size_t bytes);
+
+  /// Free every idle block.
+  void Trim();
+
+  PixelGrabBufferPoolStats GetStats() const;
+
+  /// Size class that a request of |size| bytes is rounded up to.
+  static size_t SizeClass(size_t size);
+
+ private:
+  struct IdleBlock {
+    uint8_t* ptr;
+    uint64_t released_at;  // release_seq_ value, for oldest-first eviction
+  };
+
+  static uint8_t* AllocateBlock(size_t capacity);
+  static void FreeBlock(uint8_t* block);
+
+  // Free idle blocks, oldest first, until pooled_bytes_ <= |limit|.
+  void EvictLocked(size_t limit);
+
+  mutable std::mutex mu_;
+  std::map<size_t, std::vector<IdleBlock>> idle_;  // class -> blocks
+  size_t max_pooled_bytes_ = 256ULL * 1024 * 1024;  // 256 MB
+  size_t pooled_bytes_ = 0;
+  size_t in_use_bytes_ = 0;
+  size_t peak_in_use_bytes_ = 0;
+  uint64_t release_seq_ = 0;
+  uint64_t acquire_count_ = 0;
+  uint64_t hit_count_ = 0;
+  uint64_t evict_count_ = 0;
+};
+
+/// Owning handle for pixel memory: either a block checked out of
+/// ImageBufferPool (returned on destruction) or an adopted std::vector for
+/// callers that already built their pixels in one.  Move-only.
+class PixelBuffer {
+ public:
+  PixelBuffer() = default;
+  ~PixelBuffer() { Reset(); }
+
+  PixelBuffer(PixelBuffer&& other) noexcept;
+  PixelBuffer& operator=(PixelBuffer&& other) noexcept;
+
+  // Non-copyable.
+  PixelBuffer(const PixelBuffer&) = delete;
+  PixelBuffer& operator=(const PixelBuffer&) = delete;
+
+  /// Check out |size| bytes from the process-wide pool.  Contents are
+  /// undefined.  Returns an empty buffer on allocation failure.
+  static PixelBuffer Acquire(size_t size);
+
+  /// Wrap an existing vector without copying.  Not returned to the pool.
+  static PixelBuffer Adopt(std::vector<uint8_t> data);
+
+  uint8_t* data() { return data_; }
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return data_ == nullptr; }
+
+  /// Release the storage (back to the pool when pooled).
+  void Reset();
+
+ private:
+  uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;           // Non-zero iff pooled.
+  std::vector<uint8_t> adopted_;  // Backing store when adopted.
+};
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_CORE_IMAGE_BUFFER_POOL_H_
@@ -26,8 +26,14 @@
 #endif
 
 #include "core/image.h"
+#include "core/metrics.h"
+#include "core/pixel_convert.h"
 
 using pixelgrab::internal::Image;
+using pixelgrab::internal::IsBgraLayout;
+using pixelgrab::internal::MetricsRegistry;
+using pixelgrab::internal::StageTimer;
+using pixelgrab::internal::SwapRedBlue;
 
 struct PixelGrabImage;  // Forward declaration (defined in pixelgrab_api.cpp).
 
@@ -51,21 +57,25 @@ PixelGrabError pixelgrab_image_export(const PixelGrabImage* image,
   const Image* img = GetImpl(image);
   if (!img) return kPixelGrabErrorInvalidParam;
 
+  // Context-free, so only the process-wide statistics see it.
+  StageTimer timer(&MetricsRegistry::Global(), kPixelGrabStageExport);
+  timer.set_bytes(img->data_size());
+
   int w = img->width();
   int h = img->height();
   int stride = img->stride();
   const uint8_t* src = img->data();
 
-  // Convert BGRA → RGBA for stb_image_write.
+  // stb_image_write wants tightly packed RGBA.
+  bool bgra = IsBgraLayout(img->format());
   std::vector<uint8_t> rgba(static_cast<size_t>(w) * h * 4);
   for (int y = 0; y < h; ++y) {
-    const uint8_t* row = src + y * stride;
-    uint8_t* dst = rgba.data() + y * w * 4;
-    for (int x = 0; x < w; ++x) {
-      dst[x * 4 + 0] = row[x * 4 + 2];  // R ← B
-      dst[x * 4 + 1] = row[x * 4 + 1];  // G
-      dst[x * 4 + 2] = row[x * 4 + 0];  // B ← R
-      dst[x * 4 + 3] = row[x * 4 + 3];  // A
+    const uint8_t* row = src + static_cast<size_t>(y) * stride;
+    uint8_t* dst = rgba.data() + static_cast<size_t>(y) * w * 4;
+    if (bgra) {
+      SwapRedBlue(row, dst, static_cast<size_t>(w), false);
+    } else {
+      std::memcpy(dst, row, static_cast<size_t>(w) * 4);
     }
   }
 
@@ -82,8 +92,10 @@ PixelGrabError pixelgrab_image_export(const PixelGrabImage* image,
       result = stbi_write_bmp(path, w, h, 4, rgba.data());
       break;
     default:
+      timer.Fail();
       return kPixelGrabErrorInvalidParam;
   }
 
+  if (!result) timer.Fail();
   return result ? kPixelGrabOk : kPixelGrabErrorCaptureFailed;
 }
@@ -0,0 +1,396 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Separable fixed-point image resampling (box, bilinear, Lanczos).
+//
+// Weights are Q14 integers, so every kernel is a multiply-accumulate of
+// 8-bit samples by 16-bit weights into 32-bit sums -- _mm_madd_epi16 on
+// SSE2, vmlal_s16 on NEON.  The horizontal pass writes 8-bit rows (the
+// rounding loss is below what 8-bit output can show); the vertical pass
+// reads them back.
+
+#include "core/image_resample.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "core/image.h"
+#include "core/pixel_convert.h"
+#include "core/simd_support.h"
+
+namespace pixelgrab {
+namespace internal {
+
+namespace {
+
+constexpr int kWeightBits = 14;
+constexpr int kWeightOne = 1 << kWeightBits;
+constexpr int kRound = 1 << (kWeightBits - 1);
+
+constexpr double kPi = 3.14159265358979323846;
+
+inline uint8_t ClampToByte(int v) {
+  return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+double Sinc(double x) {
+  if (x == 0.0) return 1.0;
+  x *= kPi;
+  return std::sin(x) / x;
+}
+
+// Filter radius in source pixels at scale 1.
+double FilterRadius(PixelGrabResizeFilter filter) {
+  switch (filter) {
+    case kPixelGrabFilterBilinear:
+      return 1.0;
+    case kPixelGrabFilterLanczos3:
+      return 3.0;
+    default:
+      return 0.5;
+  }
+}
+
+double FilterWeight(PixelGrabResizeFilter filter, double t) {
+  t = std::fabs(t);
+  switch (filter) {
+    case kPixelGrabFilterBilinear:
+      return t < 1.0 ? 1.0 - t : 0.0;
+    case kPixelGrabFilterLanczos3:
+      return t < 3.0 ? Sinc(t) * Sinc(t / 3.0) : 0.0;
+    default:
+      return t <= 0.5 ? 1.0 : 0.0;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Scalar kernels
+// ---------------------------------------------------------------------------
+
+using HorizontalFn = void (*)(const uint8_t* src, uint8_t* dst, int dst_width,
+                              const int* first, const int* count,
+                              const int16_t* weights, int max_taps);
+using VerticalFn = void (*)(const uint8_t* const* rows, const int16_t* weights,
+                            int taps, uint8_t* dst, int bytes);
+
+void HorizontalScalar(const uint8_t* src, uint8_t* dst, int dst_width,
+                      const int* first, const int* count,
+                      const int16_t* weights, int max_taps) {
+  for (int i = 0; i < dst_width; ++i) {
+    const uint8_t* p = src + static_cast<size_t>(first[i]) * 4;
+    const int16_t* w = weights + static_cast<size_t>(i) * max_taps;
+    int acc0 = kRound, acc1 = kRound, acc2 = kRound, acc3 = kRound;
+    for (int k = 0; k < count[i]; ++k) {
+      acc0 += p[k * 4 + 0] * w[k];
+      acc1 += p[k * 4 + 1] * w[k];
+      acc2 += p[k * 4 + 2] * w[k];
+      acc3 += p[k * 4 + 3] * w[k];
+    }
+    dst[i * 4 + 0] = ClampToByte(acc0 >> kWeightBits);
+    dst[i * 4 + 1] = ClampToByte(acc1 >> kWeightBits);
+    dst[i * 4 + 2] = ClampToByte(acc2 >> kWeightBits);
+    dst[i * 4 + 3] = ClampToByte(acc3 >> kWeightBits);
+  }
+}
+
+void VerticalScalar(const uint8_t* const* rows, const int16_t* weights,
+                    int taps, uint8_t* dst, int bytes) {
+  for (int x = 0; x < bytes; ++x) {
+    int acc = kRound;
+    for (int k = 0; k < taps; ++k) acc += rows[k][x] * weights[k];
+    dst[x] = ClampToByte(acc >> kWeightBits);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// SSE2 kernels
+// ---------------------------------------------------------------------------
+
+#if defined(PIXELGRAB_HAVE_SSE2)
+
+// Two Q14 weights as the (even, odd) int16 pair _mm_madd_epi16 expects.
+inline __m128i WeightPair(int16_t w0, int16_t w1) {
+  return _mm_set1_epi32(static_cast<int>(
+      static_cast<uint16_t>(w0) | (static_cast<uint32_t>(
+                                       static_cast<uint16_t>(w1)) << 16)));
+}
+
+void HorizontalSse2(const uint8_t* src, uint8_t* dst, int dst_width,
+                    const int* first, const int* count,
+                    const int16_t* weights, int max_taps) {
+  const __m128i zero = _mm_setzero_si128();
+  for (int i = 0; i < dst_width; ++i) {
+    const uint8_t* p = src + static_cast<size_t>(first[i]) * 4;
+    const int16_t* w = weights + static_cast<size_t>(i) * max_taps;
+    const int n = count[i];
+    __m128i acc = _mm_set1_epi32(kRound);
+    int k = 0;
+    for (; k + 2 <= n; k += 2) {
+      // a0 a1 a2 a3 b0 b1 b2 b3 -> a0 b0 a1 b1 a2 b2 a3 b3
+      __m128i px = _mm_unpacklo_epi8(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + k * 4)), zero);
+      px = _mm_unpacklo_epi16(px, _mm_unpackhi_epi64(px, px));
+      acc = _mm_add_epi32(acc, _mm_madd_epi16(px, WeightPair(w[k], w[k + 1])));
+    }
+    if (k < n) {
+      int32_t last;
+      std::memcpy(&last, p + k * 4, 4);
+      __m128i px = _mm_unpacklo_epi8(_mm_cvtsi32_si128(last), zero);
+      px = _mm_unpacklo_epi16(px, zero);
+      acc = _mm_add_epi32(acc, _mm_madd_epi16(px, WeightPair(w[k], 0)));
+    }
+    acc = _mm_srai_epi32(acc, kWeightBits);
+    acc = _mm_packs_epi32(acc, acc);
+    int32_t out = _mm_cvtsi128_si32(_mm_packus_epi16(acc, acc));
+    std::memcpy(dst + i * 4, &out, 4);
+  }
+}
+
+void VerticalSse2(const uint8_t* const* rows, const int16_t* weights,
+                  int taps, uint8_t* dst, int bytes) {
+  const __m128i zero = _mm_setzero_si128();
+  int x = 0;
+  for (; x + 16 <= bytes; x += 16) {
+    __m128i acc0 = _mm_set1_epi32(kRound);
+    __m128i acc1 = acc0, acc2 = acc0, acc3 = acc0;
+    for (int k = 0; k < taps; k += 2) {
+      __m128i a =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + x));
+      __m128i b = k + 1 < taps ? _mm_loadu_si128(reinterpret_cast<
+                                     const __m128i*>(rows[k + 1] + x))
+                               : zero;
+      __m128i w = WeightPair(weights[k], k + 1 < taps ? weights[k + 1] : 0);
+      __m128i a_lo = _mm_unpacklo_epi8(a, zero);
+      __m128i a_hi = _mm_unpackhi_epi8(a, zero);
+      __m128i b_lo = _mm_unpacklo_epi8(b, zero);
+      __m128i b_hi = _mm_unpackhi_epi8(b, zero);
+      acc0 = _mm_add_epi32(acc0,
+                           _mm_madd_epi16(_mm_unpacklo_epi16(a_lo, b_lo), w));
+      acc1 = _mm_add_epi32(acc1,
+                           _mm_madd_epi16(_mm_unpackhi_epi16(a_lo, b_lo), w));
+      acc2 = _mm_add_epi32(acc2,
+                           _mm_madd_epi16(_mm_unpacklo_epi16(a_hi, b_hi), w));
+      acc3 = _mm_add_epi32(acc3,
+                           _mm_madd_epi16(_mm_unpackhi_epi16(a_hi, b_hi), w));
+    }
+    __m128i lo = _mm_packs_epi32(_mm_srai_epi32(acc0, kWeightBits),
+                                 _mm_srai_epi32(acc1, kWeightBits));
+    __m128i hi = _mm_packs_epi32(_mm_srai_epi32(acc2, kWeightBits),
+                                 _mm_srai_epi32(acc3, kWeightBits));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x),
+                     _mm_packus_epi16(lo, hi));
+  }
+  for (; x < bytes; ++x) {
+    int acc = kRound;
+    for (int k = 0; k < taps; ++k) acc += rows[k][x] * weights[k];
+    dst[x] = ClampToByte(acc >> kWeightBits);
+  }
+}
+
+#endif  // PIXELGRAB_HAVE_SSE2
+
+// ---------------------------------------------------------------------------
+// NEON kernels (vertical pass; the horizontal pass stays scalar)
+// ---------------------------------------------------------------------------
+
+#if defined(PIXELGRAB_HAVE_NEON)
+
+void VerticalNeon(const uint8_t* const* rows, const int16_t* weights,
+                  int taps, uint8_t* dst, int bytes) {
+  int x = 0;
+  for (; x + 8 <= bytes; x += 8) {
+    int32x4_t acc_lo = vdupq_n_s32(kRound);
+    int32x4_t acc_hi = acc_lo;
+    for (int k = 0; k < taps; ++k) {
+      int16x8_t v = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(rows[k] + x)));
+      acc_lo = vmlal_n_s16(acc_lo, vget_low_s16(v), weights[k]);
+      acc_hi = vmlal_n_s16(acc_hi, vget_high_s16(v), weights[k]);
+    }
+    uint16x8_t out = vcombine_u16(vqshrun_n_s32(acc_lo, kWeightBits),
+                                  vqshrun_n_s32(acc_hi, kWeightBits));
+    vst1_u8(dst + x, vqmovn_u16(out));
+  }
+  for (; x < bytes; ++x) {
+    int acc = kRound;
+    for (int k = 0; k < taps; ++k) acc += rows[k][x] * weights[k];
+    dst[x] = ClampToByte(acc >> kWeightBits);
+  }
+}
+
+#endif  // PIXELGRAB_HAVE_NEON
+
+struct ResampleKernels {
+  HorizontalFn horizontal;
+  VerticalFn vertical;
+};
+
+const ResampleKernels& GetResampleKernels() {
+  static const ResampleKernels kernels = [] {
+    ResampleKernels k = {HorizontalScalar, VerticalScalar};
+    switch (ActiveSimdLevel()) {
+#if defined(PIXELGRAB_HAVE_SSE2)
+      case SimdLevel::kSse2:
+      case SimdLevel::kAvx2:
+        k = {HorizontalSse2, VerticalSse2};
+        break;
+#endif
+#if defined(PIXELGRAB_HAVE_NEON)
+      case SimdLevel::kNeon:
+        k = {HorizontalScalar, VerticalNeon};
+        break;
+#endif
+      default:
+        break;
+    }
+    return k;
+  }();
+  return kernels;
+}
+
+}  // namespace
+
+bool IsValidResizeFilter(PixelGrabResizeFilter filter) {
+  return filter == kPixelGrabFilterBox || filter == kPixelGrabFilterBilinear ||
+         filter == kPixelGrabFilterLanczos3;
+}
+
+ImageResampler::Taps ImageResampler::ComputeTaps(
+    int src_size, int dst_size, PixelGrabResizeFilter filter) {
+  Taps taps;
+  taps.first.resize(dst_size);
+  taps.count.resize(dst_size);
+  const double scale = static_cast<double>(src_size) / dst_size;
+  // Widen the filter when shrinking so every source pixel contributes.
+  const double filter_scale = std::max(scale, 1.0);
+  const double support = FilterRadius(filter) * filter_scale;
+
+  std::vector<std::vector<double>> all(dst_size);
+  for (int i = 0; i < dst_size; ++i) {
+    const double center = (i + 0.5) * scale;
+    int lo = std::max(0, static_cast<int>(std::floor(center - support)));
+    int hi = std::min(src_size, static_cast<int>(std::ceil(center + support)));
+    std::vector<double>& w = all[i];
+    double sum = 0.0;
+    for (int j = lo; j < hi; ++j) {
+      double v;
+      if (filter == kPixelGrabFilterBox && scale >= 1.0) {
+        // Exact area coverage of source pixel j by output pixel i.
+        v = std::min<double>(j + 1, (i + 1) * scale) -
+            std::max<double>(j, i * scale);
+        if (v < 0.0) v = 0.0;
+      } else {
+        v = FilterWeight(filter, (j + 0.5 - center) / filter_scale);
+      }
+      w.push_back(v);
+      sum += v;
+    }
+    if (sum == 0.0) {  // Upscaling box between centers: nearest pixel.
+      int nearest = std::min(src_size - 1, static_cast<int>(center));
+      lo = nearest;
+      w.assign(1, 1.0);
+      sum = 1.0;
+    }
+    // Trim zero taps at both ends.
+    size_t begin = 0, end = w.size();
+    while (begin < end && w[begin] == 0.0) ++begin;
+    while (end > begin && w[end - 1] == 0.0) --end;
+    w = std::vector<double>(w.begin() + begin, w.begin() + end);
+    for (double& v : w) v /= sum;
+    taps.first[i] = lo + static_cast<int>(begin);
+    taps.count[i] = static_cast<int>(w.size());
+    taps.max_taps = std::max(taps.max_taps, taps.count[i]);
+  }
+
+  taps.weights.assign(static_cast<size_t>(dst_size) * taps.max_taps, 0);
+  taps.identity = src_size == dst_size;
+  for (int i = 0; i < dst_size; ++i) {
+    int16_t* q = taps.weights.data() + static_cast<size_t>(i) * taps.max_taps;
+    int total = 0;
+    int largest = 0;
+    for (int k = 0; k < taps.count[i]; ++k) {
+      q[k] = static_cast<int16_t>(std::lround(all[i][k] * kWeightOne));
+      total += q[k];
+      if (q[k] > q[largest]) largest = k;
+    }
+    // Keep flat areas exact: the quantized weights must sum to 1.0.
+    q[largest] = static_cast<int16_t>(q[largest] + kWeightOne - total);
+    if (taps.count[i] != 1 || taps.first[i] != i) taps.identity = false;
+  }
+  return taps;
+}
+
+ImageResampler::ImageResampler(int src_width, int src_height, int dst_width,
+                               int dst_height, PixelGrabResizeFilter filter)
+    : src_width_(src_width),
+      src_height_(src_height),
+      dst_width_(dst_width),
+      dst_height_(dst_height) {
+  h_taps_ = ComputeTaps(src_width, dst_width, filter);
+  v_taps_ = ComputeTaps(src_height, dst_height, filter);
+  ring_rows_ = std::max(1, v_taps_.max_taps);
+  ring_.resize(static_cast<size_t>(ring_rows_) * dst_width * 4);
+  row_ptrs_.resize(ring_rows_);
+}
+
+void ImageResampler::PushRows(const uint8_t* src, int src_stride, int rows,
+                              uint8_t* dst, int dst_stride) {
+  const ResampleKernels& k = GetResampleKernels();
+  const size_t ring_stride = static_cast<size_t>(dst_width_) * 4;
+  for (int r = 0; r < rows && next_src_row_ < src_height_; ++r) {
+    const int row = next_src_row_++;
+    const uint8_t* in = src + static_cast<ptrdiff_t>(r) * src_stride;
+
+    // Rows below the next output's first tap are never needed again.
+    if (done() || row < v_taps_.first[next_dst_row_]) continue;
+
+    uint8_t* slot = ring_.data() + (row % ring_rows_) * ring_stride;
+    if (h_taps_.identity) {
+      std::memcpy(slot, in, ring_stride);
+    } else {
+      k.horizontal(in, slot, dst_width_, h_taps_.first.data(),
+                   h_taps_.count.data(), h_taps_.weights.data(),
+                   h_taps_.max_taps);
+    }
+
+    while (!done()) {
+      const int y = next_dst_row_;
+      const int first = v_taps_.first[y];
+      const int count = v_taps_.count[y];
+      if (first + count - 1 > row) break;
+      for (int t = 0; t < count; ++t) {
+        row_ptrs_[t] = ring_.data() + ((first + t) % ring_rows_) * ring_stride;
+      }
+      uint8_t* out = dst + static_cast<ptrdiff_t>(y) * dst_stride;
+      const int16_t* w =
+          v_taps_.weights.data() + static_cast<size_t>(y) * v_taps_.max_taps;
+      if (count == 1 && w[0] == kWeightOne) {
+        std::memcpy(out, row_ptrs_[0], ring_stride);
+      } else {
+        k.vertical(row_ptrs_.data(), w, count, out,
+                   static_cast<int>(ring_stride));
+      }
+      ++next_dst_row_;
+    }
+  }
+}
+
+void ResizePixels(const uint8_t* src, int src_stride, int src_width,
+                  int src_height, uint8_t* dst, int dst_stride, int dst_width,
+                  int dst_height, PixelGrabResizeFilter filter) {
+  ImageResampler resampler(src_width, src_height, dst_width, dst_height,
+                           filter);
+  resampler.PushRows(src, src_stride, src_height, dst, dst_stride);
+}
+
+std::unique_ptr<Image> ResizeImage(const Image& image, int width, int height,
+                                   PixelGrabResizeFilter filter) {
+  auto out = Image::CreateUninitialized(width, height, image.format());
+  if (!out) return nullptr;
+  uint8_t* dst = out->mutable_data();
+  if (!dst) return nullptr;
+  ResizePixels(image.data(), image.stride(), image.width(), image.height(),
+               dst, out->stride(), width, height, filter);
+  return out;
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
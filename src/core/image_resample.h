@@ -0,0 +1,90 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Separable fixed-point image resampling (box, bilinear, Lanczos).
+
+#ifndef PIXELGRAB_CORE_IMAGE_RESAMPLE_H_
+#define PIXELGRAB_CORE_IMAGE_RESAMPLE_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "pixelgrab/pixelgrab.h"
+
+namespace pixelgrab {
+namespace internal {
+
+class Image;
+
+/// True for the filters declared in PixelGrabResizeFilter.
+bool IsValidResizeFilter(PixelGrabResizeFilter filter);
+
+/// Resamples 4-byte pixels (any channel order; channels are filtered
+/// independently, alpha is not premultiplied) from one size to another.
+///
+/// The filter is applied separably with 14-bit fixed-point weights computed
+/// once per instance: each source row is first resampled horizontally into
+/// a small ring of |dst_width|-wide rows, and each output row is a weighted
+/// sum of the ring rows it covers.  Source rows are fed incrementally with
+/// PushRows(), so a caller can produce the source in strips and never hold
+/// the full-resolution frame; only as many horizontal rows as the vertical
+/// filter spans are kept.  The inner loops use SSE2 or NEON (see
+/// ActiveSimdLevel()).  Not thread-safe.
+class ImageResampler {
+ public:
+  ImageResampler(int src_width, int src_height, int dst_width, int dst_height,
+                 PixelGrabResizeFilter filter);
+
+  // Non-copyable.
+  ImageResampler(const ImageResampler&) = delete;
+  ImageResampler& operator=(const ImageResampler&) = delete;
+
+  /// Feed the next |rows| source rows.  Every output row whose source rows
+  /// are now all available is written to |dst| + y * |dst_stride|.
+  void PushRows(const uint8_t* src, int src_stride, int rows, uint8_t* dst,
+                int dst_stride);
+
+  /// True once every output row has been written.
+  bool done() const { return next_dst_row_ >= dst_height_; }
+
+ private:
+  // Taps of one axis: output i reads |count[i]| source pixels starting at
+  // |first[i]| with weights[i * max_taps ...].
+  struct Taps {
+    std::vector<int> first;
+    std::vector<int> count;
+    std::vector<int16_t> weights;
+    int max_taps = 0;
+    bool identity = false;  // One tap of weight 1.0 at the same index.
+  };
+
+  static Taps ComputeTaps(int src_size, int dst_size,
+                          PixelGrabResizeFilter filter);
+
+  int src_width_;
+  int src_height_;
+  int dst_width_;
+  int dst_height_;
+  Taps h_taps_;
+  Taps v_taps_;
+  int next_src_row_ = 0;
+  int next_dst_row_ = 0;
+  // Horizontally resampled rows; source row r lives in slot r % ring_rows_.
+  int ring_rows_ = 0;
+  std::vector<uint8_t> ring_;
+  std::vector<const uint8_t*> row_ptrs_;
+};
+
+/// Resample a whole buffer of 4-byte pixels.
+void ResizePixels(const uint8_t* src, int src_stride, int src_width,
+                  int src_height, uint8_t* dst, int dst_stride, int dst_width,
+                  int dst_height, PixelGrabResizeFilter filter);
+
+/// New |width| x |height| image in the format of |image|.  nullptr if the
+/// output cannot be allocated.
+std::unique_ptr<Image> ResizeImage(const Image& image, int width, int height,
+                                   PixelGrabResizeFilter filter);
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_CORE_IMAGE_RESAMPLE_H_
@@ -0,0 +1,167 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Per-stage operation counters and latency histograms.
+
+#include "core/metrics.h"
+
+#include <cstdio>
+
+namespace pixelgrab {
+namespace internal {
+
+namespace {
+
+const char* const kStageNames[kPixelGrabStageCount] = {
+    "capture", "convert", "history_compress", "export", "ocr", "recorder"};
+
+double ToMs(uint64_t nanoseconds) {
+  return static_cast<double>(nanoseconds) / 1e6;
+}
+
+}  // namespace
+
+MetricsRegistry::MetricsRegistry(MetricsRegistry* parent) : parent_(parent) {}
+
+MetricsRegistry& MetricsRegistry::Global() {
+  static MetricsRegistry* global = new MetricsRegistry();  // Never destroyed.
+  return *global;
+}
+
+int MetricsRegistry::BucketOf(uint64_t nanoseconds) {
+  if (nanoseconds < 8) return static_cast<int>(nanoseconds);
+  int exponent = 63;
+  while (!(nanoseconds >> exponent)) --exponent;
+  if (exponent > kMaxExponent) return kBuckets - 1;
+  // Bucket group (exponent - 2), split by the 3 bits after the leading one.
+  return (exponent - 2) * 8 +
+         static_cast<int>((nanoseconds >> (exponent - 3)) & 7);
+}
+
+uint64_t MetricsRegistry::BucketUpperBound(int bucket) {
+  if (bucket < 8) return static_cast<uint64_t>(bucket);
+  const int shift = bucket / 8 - 1;  // exponent - 3
+  const uint64_t lower = static_cast<uint64_t>(8 + bucket % 8) << shift;
+  return lower + (uint64_t{1} << shift) - 1;
+}
+
+void MetricsRegistry::Record(PixelGrabStage stage, uint64_t nanoseconds,
+                             uint64_t bytes, bool ok) {
+  const int index = static_cast<int>(stage);
+  if (index < 0 || index >= kPixelGrabStageCount) return;
+  Stage& s = stages_[index];
+  s.count.fetch_add(1, std::memory_order_relaxed);
+  if (!ok) s.failures.fetch_add(1, std::memory_order_relaxed);
+  s.bytes.fetch_add(bytes, std::memory_order_relaxed);
+  s.total_ns.fetch_add(nanoseconds, std::memory_order_relaxed);
+  uint64_t max = s.max_ns.load(std::memory_order_relaxed);
+  while (nanoseconds > max &&
+         !s.max_ns.compare_exchange_weak(max, nanoseconds,
+                                         std::memory_order_relaxed)) {
+  }
+  s.buckets[BucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+  if (parent_) parent_->Record(stage, nanoseconds, bytes, ok);
+}
+
+bool MetricsRegistry::GetStats(PixelGrabStage stage,
+                               PixelGrabStageStats* out) const {
+  const int index = static_cast<int>(stage);
+  if (!out || index < 0 || index >= kPixelGrabStageCount) return false;
+  const Stage& s = stages_[index];
+
+  // Concurrent Record() calls may land between these loads; the snapshot is
+  // then off by those few samples, never torn within a counter.
+  uint64_t counts[kBuckets];
+  uint64_t histogram_total = 0;
+  for (int b = 0; b < kBuckets; ++b) {
+    counts[b] = s.buckets[b].load(std::memory_order_relaxed);
+    histogram_total += counts[b];
+  }
+  const uint64_t max_ns = s.max_ns.load(std::memory_order_relaxed);
+  auto percentile = [&](double q) -> double {
+    if (histogram_total == 0) return 0.0;
+    // Smallest bucket covering rank ceil(q * n).
+    uint64_t rank = static_cast<uint64_t>(q * histogram_total);
+    if (static_cast<double>(rank) < q * histogram_total) ++rank;
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < kBuckets; ++b) {
+      seen += counts[b];
+      if (seen >= rank) {
+        // The last bucket is open-ended.
+        const uint64_t bound =
+            b == kBuckets - 1 ? max_ns : BucketUpperBound(b);
+        return ToMs(bound < max_ns ? bound : max_ns);
+      }
+    }
+    return ToMs(max_ns);
+  };
+
+  *out = {};
+  out->count = s.count.load(std::memory_order_relaxed);
+  out->failures = s.failures.load(std::memory_order_relaxed);
+  out->bytes = s.bytes.load(std::memory_order_relaxed);
+  out->total_ms = ToMs(s.total_ns.load(std::memory_order_relaxed));
+  out->mean_ms = out->count ? out->total_ms / out->count : 0.0;
+  out->p50_ms = percentile(0.50);
+  out->p90_ms = percentile(0.90);
+  out->p99_ms = percentile(0.99);
+  out->max_ms = ToMs(max_ns);
+  return true;
+}
+
+void MetricsRegistry::Reset() {
+  for (Stage& s : stages_) {
+    s.count.store(0, std::memory_order_relaxed);
+    s.failures.store(0, std::memory_order_relaxed);
+    s.bytes.store(0, std::memory_order_relaxed);
+    s.total_ns.store(0, std::memory_order_relaxed);
+    s.max_ns.store(0, std::memory_order_relaxed);
+    for (auto& bucket : s.buckets) bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+std::string MetricsRegistry::Dump(PixelGrabStatsFormat format) const {
+  std::string out;
+  char line[320];
+  if (format == kPixelGrabStatsJson) {
+    out = "{";
+    for (int i = 0; i < kPixelGrabStageCount; ++i) {
+      PixelGrabStageStats st;
+      GetStats(static_cast<PixelGrabStage>(i), &st);
+      std::snprintf(
+          line, sizeof(line),
+          "%s\"%s\":{\"count\":%llu,\"failures\":%llu,\"bytes\":%llu,"
+          "\"total_ms\":%.3f,\"mean_ms\":%.3f,\"p50_ms\":%.3f,"
+          "\"p90_ms\":%.3f,\"p99_ms\":%.3f,\"max_ms\":%.3f}",
+          i ? "," : "", kStageNames[i],
+          static_cast<unsigned long long>(st.count),
+          static_cast<unsigned long long>(st.failures),
+          static_cast<unsigned long long>(st.bytes), st.total_ms, st.mean_ms,
+          st.p50_ms, st.p90_ms, st.p99_ms, st.max_ms);
+      out += line;
+    }
+    out += "}";
+    return out;
+  }
+
+  std::snprintf(line, sizeof(line),
+                "%-16s %10s %8s %10s %10s %10s %10s %10s %12s\n", "stage",
+                "count", "failed", "mean ms", "p50 ms", "p90 ms", "p99 ms",
+                "max ms", "MB");
+  out = line;
+  for (int i = 0; i < kPixelGrabStageCount; ++i) {
+    PixelGrabStageStats st;
+    GetStats(static_cast<PixelGrabStage>(i), &st);
+    std::snprintf(line, sizeof(line),
+                  "%-16s %10llu %8llu %10.3f %10.3f %10.3f %10.3f %10.3f "
+                  "%12.1f\n",
+                  kStageNames[i], static_cast<unsigned long long>(st.count),
+                  static_cast<unsigned long long>(st.failures), st.mean_ms,
+                  st.p50_ms, st.p90_ms, st.p99_ms, st.max_ms,
+                  static_cast<double>(st.bytes) / (1024.0 * 1024.0));
+    out += line;
+  }
+  return out;
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
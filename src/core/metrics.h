@@ -0,0 +1,119 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Per-stage operation counters and latency histograms.
+
+#ifndef PIXELGRAB_CORE_METRICS_H_
+#define PIXELGRAB_CORE_METRICS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "pixelgrab/pixelgrab.h"
+
+namespace pixelgrab {
+namespace internal {
+
+/// Counters and a latency histogram for every PixelGrabStage.
+///
+/// Recording is lock-free (a handful of relaxed atomic adds), so it can stay
+/// enabled in production.  Latencies go into log-linear buckets -- 8 per
+/// power of two of nanoseconds -- so percentiles are within 12.5% of the
+/// true value; they are reported as the bucket's upper bound (never above
+/// the observed maximum).  A registry may forward every sample to a parent,
+/// which is how the process-wide totals are kept alongside each context's.
+class MetricsRegistry {
+ public:
+  /// |parent| (optional) also receives every sample; it must outlive this.
+  explicit MetricsRegistry(MetricsRegistry* parent = nullptr);
+
+  // Non-copyable.
+  MetricsRegistry(const MetricsRegistry&) = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+  /// Process-wide registry: every context plus context-free operations.
+  static MetricsRegistry& Global();
+
+  /// Record one operation of |stage| that took |nanoseconds| and processed
+  /// |bytes| of pixel data.  Out-of-range stages are ignored.
+  void Record(PixelGrabStage stage, uint64_t nanoseconds, uint64_t bytes,
+              bool ok);
+
+  /// Current counters and percentiles of |stage|; false if out of range.
+  bool GetStats(PixelGrabStage stage, PixelGrabStageStats* out) const;
+
+  /// Zero every stage (the parent is not affected).
+  void Reset();
+
+  /// All stages as an aligned text table or a JSON object keyed by stage
+  /// name.
+  std::string Dump(PixelGrabStatsFormat format) const;
+
+ private:
+  // Values below 2^(kMaxExponent + 1) ns (about 19 hours) are bucketed;
+  // longer ones land in the last bucket.
+  static constexpr int kMaxExponent = 45;
+  static constexpr int kBuckets = (kMaxExponent - 1) * 8;
+
+  struct Stage {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> failures{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> max_ns{0};
+    std::array<std::atomic<uint64_t>, kBuckets> buckets{};
+  };
+
+  static int BucketOf(uint64_t nanoseconds);
+  static uint64_t BucketUpperBound(int bucket);
+
+  MetricsRegistry* const parent_;
+  std::array<Stage, kPixelGrabStageCount> stages_;
+};
+
+/// Times one operation and records it on destruction.
+///
+/// \code
+///   StageTimer timer(&metrics, kPixelGrabStageCapture);
+///   auto image = backend->CaptureRegion(...);
+///   if (!image) timer.Fail(); else timer.set_bytes(image->data_size());
+/// \endcode
+class StageTimer {
+ public:
+  /// |registry| may be nullptr (nothing is recorded).
+  StageTimer(MetricsRegistry* registry, PixelGrabStage stage)
+      : registry_(registry),
+        stage_(stage),
+        start_(std::chrono::steady_clock::now()) {}
+
+  ~StageTimer() {
+    if (!registry_) return;
+    auto elapsed = std::chrono::steady_clock::now() - start_;
+    registry_->Record(
+        stage_,
+        static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                .count()),
+        bytes_, ok_);
+  }
+
+  // Non-copyable.
+  StageTimer(const StageTimer&) = delete;
+  StageTimer& operator=(const StageTimer&) = delete;
+
+  void set_bytes(uint64_t bytes) { bytes_ = bytes; }
+  void Fail() { ok_ = false; }
+
+ private:
+  MetricsRegistry* const registry_;
+  const PixelGrabStage stage_;
+  const std::chrono::steady_clock::time_point start_;
+  uint64_t bytes_ = 0;
+  bool ok_ = true;
+};
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_CORE_METRICS_H_
@@ -0,0 +1,531 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Vectorized pixel format conversion kernels.
+//
+// Every kernel has a portable scalar version.  SIMD variants are compiled
+// for the host architecture (SSE2 and AVX2 on x86, NEON on little-endian
+// ARM) and one set is picked at runtime from CPUID; AVX2 functions carry a
+// per-function target attribute so the rest of the library keeps the
+// baseline ISA.
+
+#include "core/pixel_convert.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "core/image.h"
+#include "core/logger.h"
+#include "core/simd_support.h"
+
+namespace pixelgrab {
+namespace internal {
+
+namespace {
+
+// Output byte k of a kShift32 pixel is (value >> s[k]) & 0xFF.
+struct Shift32 {
+  int s0;
+  int s1;
+  int s2;
+  bool msb_first;  // Packed value is stored most significant byte first.
+};
+
+using CopyFn = void (*)(const uint8_t*, uint8_t*, size_t);
+using SwapFn = void (*)(const uint8_t*, uint8_t*, size_t, bool);
+using UnpackFn = void (*)(const uint8_t*, uint8_t*, size_t, const Shift32&);
+
+struct Kernels {
+  SimdLevel level;
+  CopyFn copy_opaque;
+  SwapFn swap_rb;
+  UnpackFn unpack32;
+};
+
+// ---------------------------------------------------------------------------
+// Scalar kernels (byte-addressed, independent of host endianness)
+// ---------------------------------------------------------------------------
+
+void CopyOpaqueScalar(const uint8_t* src, uint8_t* dst, size_t n) {
+  if (src != dst) std::memcpy(dst, src, n * 4);
+  for (size_t i = 0; i < n; ++i) dst[i * 4 + 3] = 0xFF;
+}
+
+void SwapRedBlueScalar(const uint8_t* src, uint8_t* dst, size_t n,
+                       bool opaque) {
+  for (size_t i = 0; i < n; ++i) {
+    uint8_t b = src[i * 4 + 0];
+    uint8_t g = src[i * 4 + 1];
+    uint8_t r = src[i * 4 + 2];
+    uint8_t a = src[i * 4 + 3];
+    dst[i * 4 + 0] = r;
+    dst[i * 4 + 1] = g;
+    dst[i * 4 + 2] = b;
+    dst[i * 4 + 3] = opaque ? 0xFF : a;
+  }
+}
+
+inline uint32_t LoadPacked32(const uint8_t* p, bool msb_first) {
+  if (msb_first) {
+    return (static_cast<uint32_t>(p[0]) << 24) |
+           (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+  }
+  return (static_cast<uint32_t>(p[3]) << 24) |
+         (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[1]) << 8) | p[0];
+}
+
+void Unpack32Scalar(const uint8_t* src, uint8_t* dst, size_t n,
+                    const Shift32& s) {
+  for (size_t i = 0; i < n; ++i) {
+    uint32_t v = LoadPacked32(src + i * 4, s.msb_first);
+    dst[i * 4 + 0] = static_cast<uint8_t>(v >> s.s0);
+    dst[i * 4 + 1] = static_cast<uint8_t>(v >> s.s1);
+    dst[i * 4 + 2] = static_cast<uint8_t>(v >> s.s2);
+    dst[i * 4 + 3] = 0xFF;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// SSE2 kernels (4 pixels per step)
+// ---------------------------------------------------------------------------
+
+#if defined(PIXELGRAB_HAVE_SSE2)
+
+inline __m128i ByteSwap32Sse2(__m128i v) {
+  __m128i t = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+  t = _mm_shufflelo_epi16(t, _MM_SHUFFLE(2, 3, 0, 1));
+  return _mm_shufflehi_epi16(t, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+void CopyOpaqueSse2(const uint8_t* src, uint8_t* dst, size_t n) {
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4),
+                     _mm_or_si128(v, alpha));
+  }
+  CopyOpaqueScalar(src + i * 4, dst + i * 4, n - i);
+}
+
+void SwapRedBlueSse2(const uint8_t* src, uint8_t* dst, size_t n,
+                     bool opaque) {
+  const __m128i ga = _mm_set1_epi32(static_cast<int>(0xFF00FF00u));
+  const __m128i lo = _mm_set1_epi32(0xFF);
+  const __m128i alpha =
+      _mm_set1_epi32(opaque ? static_cast<int>(0xFF000000u) : 0);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+    __m128i out = _mm_and_si128(v, ga);
+    out = _mm_or_si128(out, _mm_and_si128(_mm_srli_epi32(v, 16), lo));
+    out = _mm_or_si128(out, _mm_slli_epi32(_mm_and_si128(v, lo), 16));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4),
+                     _mm_or_si128(out, alpha));
+  }
+  SwapRedBlueScalar(src + i * 4, dst + i * 4, n - i, opaque);
+}
+
+void Unpack32Sse2(const uint8_t* src, uint8_t* dst, size_t n,
+                  const Shift32& s) {
+  const __m128i lo = _mm_set1_epi32(0xFF);
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+  const __m128i c0 = _mm_cvtsi32_si128(s.s0);
+  const __m128i c1 = _mm_cvtsi32_si128(s.s1);
+  const __m128i c2 = _mm_cvtsi32_si128(s.s2);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+    if (s.msb_first) v = ByteSwap32Sse2(v);
+    __m128i out = _mm_and_si128(_mm_srl_epi32(v, c0), lo);
+    out = _mm_or_si128(
+        out, _mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(v, c1), lo), 8));
+    out = _mm_or_si128(
+        out, _mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(v, c2), lo), 16));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4),
+                     _mm_or_si128(out, alpha));
+  }
+  Unpack32Scalar(src + i * 4, dst + i * 4, n - i, s);
+}
+
+#endif  // PIXELGRAB_HAVE_SSE2
+
+// ---------------------------------------------------------------------------
+// AVX2 kernels (8 pixels per step)
+// ---------------------------------------------------------------------------
+
+#if defined(PIXELGRAB_HAVE_AVX2)
+
+PIXELGRAB_TARGET_AVX2
+void CopyOpaqueAvx2(const uint8_t* src, uint8_t* dst, size_t n) {
+  const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4),
+                        _mm256_or_si256(v, alpha));
+  }
+  CopyOpaqueScalar(src + i * 4, dst + i * 4, n - i);
+}
+
+PIXELGRAB_TARGET_AVX2
+void SwapRedBlueAvx2(const uint8_t* src, uint8_t* dst, size_t n,
+                     bool opaque) {
+  const __m256i shuffle = _mm256_setr_epi8(
+      2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+      2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+  const __m256i alpha =
+      _mm256_set1_epi32(opaque ? static_cast<int>(0xFF000000u) : 0);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+    v = _mm256_or_si256(_mm256_shuffle_epi8(v, shuffle), alpha);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), v);
+  }
+  SwapRedBlueScalar(src + i * 4, dst + i * 4, n - i, opaque);
+}
+
+PIXELGRAB_TARGET_AVX2
+void Unpack32Avx2(const uint8_t* src, uint8_t* dst, size_t n,
+                  const Shift32& s) {
+  const __m256i bswap = _mm256_setr_epi8(
+      3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+      3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  const __m256i lo = _mm256_set1_epi32(0xFF);
+  const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+  const __m128i c0 = _mm_cvtsi32_si128(s.s0);
+  const __m128i c1 = _mm_cvtsi32_si128(s.s1);
+  const __m128i c2 = _mm_cvtsi32_si128(s.s2);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+    if (s.msb_first) v = _mm256_shuffle_epi8(v, bswap);
+    __m256i out = _mm256_and_si256(_mm256_srl_epi32(v, c0), lo);
+    out = _mm256_or_si256(
+        out,
+        _mm256_slli_epi32(_mm256_and_si256(_mm256_srl_epi32(v, c1), lo), 8));
+    out = _mm256_or_si256(
+        out,
+        _mm256_slli_epi32(_mm256_and_si256(_mm256_srl_epi32(v, c2), lo), 16));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4),
+                        _mm256_or_si256(out, alpha));
+  }
+  Unpack32Scalar(src + i * 4, dst + i * 4, n - i, s);
+}
+
+bool CpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4] = {};
+  __cpuid(info, 0);
+  if (info[0] < 7) return false;
+  __cpuid(info, 1);
+  bool osxsave = (info[2] & (1 << 27)) != 0;
+  bool avx = (info[2] & (1 << 28)) != 0;
+  if (!osxsave || !avx) return false;
+  if ((_xgetbv(0) & 0x6) != 0x6) return false;  // XMM + YMM state enabled
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif  // PIXELGRAB_HAVE_AVX2
+
+// ---------------------------------------------------------------------------
+// NEON kernels
+// ---------------------------------------------------------------------------
+
+#if defined(PIXELGRAB_HAVE_NEON)
+
+void CopyOpaqueNeon(const uint8_t* src, uint8_t* dst, size_t n) {
+  const uint8x16_t alpha = vreinterpretq_u8_u32(vdupq_n_u32(0xFF000000u));
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    vst1q_u8(dst + i * 4, vorrq_u8(vld1q_u8(src + i * 4), alpha));
+  }
+  CopyOpaqueScalar(src + i * 4, dst + i * 4, n - i);
+}
+
+void SwapRedBlueNeon(const uint8_t* src, uint8_t* dst, size_t n,
+                     bool opaque) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint8x16x4_t px = vld4q_u8(src + i * 4);
+    uint8x16_t tmp = px.val[0];
+    px.val[0] = px.val[2];
+    px.val[2] = tmp;
+    if (opaque) px.val[3] = vdupq_n_u8(0xFF);
+    vst4q_u8(dst + i * 4, px);
+  }
+  SwapRedBlueScalar(src + i * 4, dst + i * 4, n - i, opaque);
+}
+
+void Unpack32Neon(const uint8_t* src, uint8_t* dst, size_t n,
+                  const Shift32& s) {
+  const uint32x4_t lo = vdupq_n_u32(0xFF);
+  const uint32x4_t alpha = vdupq_n_u32(0xFF000000u);
+  const int32x4_t c0 = vdupq_n_s32(-s.s0);
+  const int32x4_t c1 = vdupq_n_s32(-s.s1);
+  const int32x4_t c2 = vdupq_n_s32(-s.s2);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    uint8x16_t bytes = vld1q_u8(src + i * 4);
+    if (s.msb_first) bytes = vrev32q_u8(bytes);
+    uint32x4_t v = vreinterpretq_u32_u8(bytes);
+    uint32x4_t out = vandq_u32(vshlq_u32(v, c0), lo);
+    out = vorrq_u32(out, vshlq_n_u32(vandq_u32(vshlq_u32(v, c1), lo), 8));
+    out = vorrq_u32(out, vshlq_n_u32(vandq_u32(vshlq_u32(v, c2), lo), 16));
+    vst1q_u8(dst + i * 4, vreinterpretq_u8_u32(vorrq_u32(out, alpha)));
+  }
+  Unpack32Scalar(src + i * 4, dst + i * 4, n - i, s);
+}
+
+#endif  // PIXELGRAB_HAVE_NEON
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+
+SimdLevel DetectSimdLevel() {
+#if defined(PIXELGRAB_HAVE_AVX2)
+  if (CpuHasAvx2()) return SimdLevel::kAvx2;
+#endif
+#if defined(PIXELGRAB_HAVE_SSE2)
+  return SimdLevel::kSse2;
+#elif defined(PIXELGRAB_HAVE_NEON)
+  return SimdLevel::kNeon;
+#else
+  return SimdLevel::kScalar;
+#endif
+}
+
+// Optional cap from PIXELGRAB_SIMD; returns |detected| if unset or unknown.
+SimdLevel ApplySimdOverride(SimdLevel detected) {
+  std::string value;
+#ifdef _WIN32
+  char* env = nullptr;
+  size_t env_len = 0;
+  if (_dupenv_s(&env, &env_len, "PIXELGRAB_SIMD") == 0 && env) {
+    value = env;
+    free(env);
+  }
+#else
+  const char* env = std::getenv("PIXELGRAB_SIMD");
+  if (env) value = env;
+#endif
+  if (value.empty()) return detected;
+
+  SimdLevel requested = detected;
+  if (value == "scalar") {
+    requested = SimdLevel::kScalar;
+  } else if (value == "sse2") {
+    requested = SimdLevel::kSse2;
+  } else if (value == "avx2") {
+    requested = SimdLevel::kAvx2;
+  } else if (value == "neon") {
+    requested = SimdLevel::kNeon;
+  } else {
+    PIXELGRAB_LOG_WARN("Ignoring unknown PIXELGRAB_SIMD value '{}'", value);
+    return detected;
+  }
+  // Only scalar or a level below the detected one on the same family can
+  // be forced; anything else falls back to what the CPU supports.
+  if (requested == SimdLevel::kScalar) return requested;
+  if (requested == SimdLevel::kSse2 && detected == SimdLevel::kAvx2) {
+    return requested;
+  }
+  return detected;
+}
+
+Kernels MakeKernels(SimdLevel level) {
+  Kernels k = {SimdLevel::kScalar, CopyOpaqueScalar, SwapRedBlueScalar,
+               Unpack32Scalar};
+  switch (level) {
+#if defined(PIXELGRAB_HAVE_AVX2)
+    case SimdLevel::kAvx2:
+      k = {level, CopyOpaqueAvx2, SwapRedBlueAvx2, Unpack32Avx2};
+      break;
+#endif
+#if defined(PIXELGRAB_HAVE_SSE2)
+    case SimdLevel::kSse2:
+      k = {level, CopyOpaqueSse2, SwapRedBlueSse2, Unpack32Sse2};
+      break;
+#endif
+#if defined(PIXELGRAB_HAVE_NEON)
+    case SimdLevel::kNeon:
+      k = {level, CopyOpaqueNeon, SwapRedBlueNeon, Unpack32Neon};
+      break;
+#endif
+    default:
+      break;
+  }
+  return k;
+}
+
+const Kernels& GetKernels() {
+  static const Kernels kernels = [] {
+    Kernels k = MakeKernels(ApplySimdOverride(DetectSimdLevel()));
+    PIXELGRAB_LOG_DEBUG("Pixel conversion kernels: {}",
+                        SimdLevelName(k.level));
+    return k;
+  }();
+  return kernels;
+}
+
+}  // namespace
+
+SimdLevel ActiveSimdLevel() { return GetKernels().level; }
+
+const char* SimdLevelName(SimdLevel level) {
+  switch (level) {
+    case SimdLevel::kScalar:
+      return "scalar";
+    case SimdLevel::kSse2:
+      return "sse2";
+    case SimdLevel::kAvx2:
+      return "avx2";
+    case SimdLevel::kNeon:
+      return "neon";
+  }
+  return "unknown";
+}
+
+void CopyOpaque(const uint8_t* src, uint8_t* dst, size_t pixels) {
+  GetKernels().copy_opaque(src, dst, pixels);
+}
+
+void SwapRedBlue(const uint8_t* src, uint8_t* dst, size_t pixels,
+                 bool opaque) {
+  GetKernels().swap_rb(src, dst, pixels, opaque);
+}
+
+// ---------------------------------------------------------------------------
+// PixelUnpacker
+// ---------------------------------------------------------------------------
+
+PixelUnpacker::PixelUnpacker(const PackedPixelLayout& layout,
+                             PixelGrabPixelFormat format)
+    : layout_(layout) {
+  int bpp = layout.bytes_per_pixel;
+  if (bpp < 2 || bpp > 4) return;
+
+  Channel red, green, blue;
+  const struct {
+    uint32_t mask;
+    Channel* channel;
+  } channels[] = {{layout.red_mask, &red},
+                  {layout.green_mask, &green},
+                  {layout.blue_mask, &blue}};
+  for (const auto& c : channels) {
+    uint32_t mask = c.mask;
+    if (mask == 0) return;
+    int shift = 0;
+    while (!(mask & 1u)) {
+      mask >>= 1;
+      ++shift;
+    }
+    int bits = 0;
+    while (mask & 1u) {
+      mask >>= 1;
+      ++bits;
+    }
+    if (mask != 0 || shift + bits > bpp * 8) return;  // Non-contiguous.
+    c.channel->shift = shift;
+    c.channel->bits = bits;
+    if (bits <= 8) {
+      uint32_t max = (1u << bits) - 1;
+      for (uint32_t v = 0; v <= max; ++v) {
+        c.channel->expand[v] = static_cast<uint8_t>((v * 255 + max / 2) / max);
+      }
+    }
+  }
+
+  bool rgba = !IsBgraLayout(format);
+  out_[0] = rgba ? red : blue;
+  out_[1] = green;
+  out_[2] = rgba ? blue : red;
+
+  if (bpp == 4 && red.bits == 8 && green.bits == 8 && blue.bits == 8) {
+    if (!layout.msb_first && red.shift == 16 && green.shift == 8 &&
+        blue.shift == 0) {
+      mode_ = rgba ? Mode::kSwapOpaque : Mode::kCopyOpaque;
+    } else {
+      mode_ = Mode::kShift32;
+    }
+  } else {
+    mode_ = Mode::kGeneric;
+  }
+}
+
+void PixelUnpacker::Run(const uint8_t* src, uint8_t* dst,
+                        size_t pixels) const {
+  const Kernels& k = GetKernels();
+  switch (mode_) {
+    case Mode::kCopyOpaque:
+      k.copy_opaque(src, dst, pixels);
+      break;
+    case Mode::kSwapOpaque:
+      k.swap_rb(src, dst, pixels, true);
+      break;
+    case Mode::kShift32: {
+      Shift32 s = {out_[0].shift, out_[1].shift, out_[2].shift,
+                   layout_.msb_first};
+      k.unpack32(src, dst, pixels, s);
+      break;
+    }
+    case Mode::kGeneric:
+      RunGeneric(src, dst, pixels);
+      break;
+    case Mode::kInvalid:
+      break;
+  }
+}
+
+void PixelUnpacker::RunGeneric(const uint8_t* src, uint8_t* dst,
+                               size_t pixels) const {
+  const int bpp = layout_.bytes_per_pixel;
+  for (size_t i = 0; i < pixels; ++i) {
+    const uint8_t* p = src + i * bpp;
+    uint32_t v = 0;
+    for (int b = 0; b < bpp; ++b) {
+      int byte_index = layout_.msb_first ? b : bpp - 1 - b;
+      v = (v << 8) | p[byte_index];
+    }
+    for (int c = 0; c < 3; ++c) {
+      const Channel& ch = out_[c];
+      uint32_t raw = (v >> ch.shift) & ((1u << ch.bits) - 1);
+      dst[i * 4 + c] = ch.bits <= 8 ? ch.expand[raw]
+                                    : static_cast<uint8_t>(raw >> (ch.bits - 8));
+    }
+    dst[i * 4 + 3] = 0xFF;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Whole-image conversion
+// ---------------------------------------------------------------------------
+
+bool ConvertImageFormat(Image* image, PixelGrabPixelFormat format) {
+  if (!image) return false;
+  if (IsBgraLayout(image->format()) != IsBgraLayout(format)) {
+    int stride = image->stride();
+    uint8_t* data = image->mutable_data();
+    if (!data) return false;
+    size_t width = static_cast<size_t>(image->width());
+    for (int y = 0; y < image->height(); ++y) {
+      uint8_t* row = data + static_cast<size_t>(y) * stride;
+      SwapRedBlue(row, row, width, false);
+    }
+  }
+  image->set_format(format);
+  return true;
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
@@ -0,0 +1,96 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Vectorized pixel format conversion kernels.
+
+#ifndef PIXELGRAB_CORE_PIXEL_CONVERT_H_
+#define PIXELGRAB_CORE_PIXEL_CONVERT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pixelgrab/pixelgrab.h"
+
+namespace pixelgrab {
+namespace internal {
+
+class Image;
+
+/// Instruction set used by the conversion kernels.
+enum class SimdLevel {
+  kScalar = 0,
+  kSse2,
+  kAvx2,
+  kNeon,
+};
+
+/// Best level supported by this CPU, detected once.  The PIXELGRAB_SIMD
+/// environment variable ("scalar", "sse2", "avx2", "neon") caps it, which
+/// is useful for benchmarking and for ruling out a kernel bug.
+SimdLevel ActiveSimdLevel();
+
+const char* SimdLevelName(SimdLevel level);
+
+/// True for formats stored as B, G, R, A bytes (Bgra8 and Native).
+inline bool IsBgraLayout(PixelGrabPixelFormat format) {
+  return format != kPixelGrabFormatRgba8;
+}
+
+/// Copy 32-bit pixels forcing alpha to 0xFF (BGRX -> BGRA).
+/// |src| may equal |dst|.
+void CopyOpaque(const uint8_t* src, uint8_t* dst, size_t pixels);
+
+/// Swap the R and B channels (BGRA <-> RGBA).  |opaque| additionally forces
+/// alpha to 0xFF.  |src| may equal |dst|.
+void SwapRedBlue(const uint8_t* src, uint8_t* dst, size_t pixels, bool opaque);
+
+/// Layout of packed source pixels, e.g. an X11 visual.
+struct PackedPixelLayout {
+  int bytes_per_pixel = 4;  ///< 2, 3 or 4
+  bool msb_first = false;   ///< Byte order of the packed value in memory.
+  uint32_t red_mask = 0x00FF0000;
+  uint32_t green_mask = 0x0000FF00;
+  uint32_t blue_mask = 0x000000FF;
+};
+
+/// Unpacks rows of packed pixels into opaque 8-bit BGRA or RGBA.
+///
+/// The constructor inspects the layout once and picks the cheapest kernel:
+/// a plain copy + alpha fill or a swizzle for the standard 32-bit masks, a
+/// vector shift-and-mask for any other 32-bit layout with 8-bit channels
+/// (including byte-swapped servers), and a table-driven scalar path for
+/// 16/24-bit and odd channel widths.
+class PixelUnpacker {
+ public:
+  PixelUnpacker(const PackedPixelLayout& layout, PixelGrabPixelFormat format);
+
+  /// False if the layout is not supported (the caller must fall back).
+  bool valid() const { return mode_ != Mode::kInvalid; }
+
+  /// Convert |pixels| pixels from |src| into |dst| (4 bytes per pixel).
+  void Run(const uint8_t* src, uint8_t* dst, size_t pixels) const;
+
+ private:
+  enum class Mode { kInvalid, kCopyOpaque, kSwapOpaque, kShift32, kGeneric };
+
+  struct Channel {
+    int shift = 0;
+    int bits = 0;
+    uint8_t expand[256] = {};  // value -> 8 bits, when bits <= 8
+  };
+
+  void RunGeneric(const uint8_t* src, uint8_t* dst, size_t pixels) const;
+
+  Mode mode_ = Mode::kInvalid;
+  PackedPixelLayout layout_;
+  // Output byte 0 / 1 / 2 come from these channels (B,G,R or R,G,B).
+  Channel out_[3];
+};
+
+/// Convert |image| to |format| in place.  Bgra8 <-> Native is a relabel;
+/// anything involving Rgba8 is a swizzle (shared storage is detached first).
+/// Returns false if the pixels could not be made writable.
+bool ConvertImageFormat(Image* image, PixelGrabPixelFormat format);
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_CORE_PIXEL_CONVERT_H_
@@ -5,10 +5,12 @@
 
 #include "pixelgrab/pixelgrab.h"
 
+#include <algorithm>
 #include <chrono>
 #include <new>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include <cstdlib>
 #include <cstring>
@@ -18,9 +20,15 @@
 #include "annotation/shape.h"
 #include "core/audio_backend.h"
 #include "core/callback_sink.h"
+#include "core/capture_stream.h"
 #include "core/color_utils.h"
+#include "core/frame_diff.h"
 #include "core/image.h"
+#include "core/image_buffer_pool.h"
+#include "core/image_resample.h"
 #include "core/logger.h"
+#include "core/metrics.h"
+#include "core/pixel_convert.h"
 #include "core/pixelgrab_context.h"
 #include "core/recorder_backend.h"
 #include "pin/pin_window_manager.h"
@@ -28,13 +36,23 @@
 
 using pixelgrab::internal::AnnotationRenderer;
 using pixelgrab::internal::AnnotationSession;
+using pixelgrab::internal::CaptureBackend;
+using pixelgrab::internal::CaptureStream;
+using pixelgrab::internal::ConvertImageFormat;
+using pixelgrab::internal::DiffImageTiles;
 using pixelgrab::internal::Image;
+using pixelgrab::internal::ImageBufferPool;
+using pixelgrab::internal::IsBgraLayout;
+using pixelgrab::internal::IsValidResizeFilter;
+using pixelgrab::internal::MetricsRegistry;
 using pixelgrab::internal::PinWindowManager;
+using pixelgrab::internal::TileTracker;
 using pixelgrab::internal::PixelGrabContextImpl;
 using pixelgrab::internal::RecorderBackend;
 using pixelgrab::internal::RecordConfig;
 using pixelgrab::internal::RecordState;
 using pixelgrab::internal::ShapeStyle;
+using pixelgrab::internal::StageTimer;
 using pixelgrab::internal::WatermarkRenderer;
 
 // ---------------------------------------------------------------------------
@@ -59,6 +77,20 @@ static PixelGrabImage* WrapImage(Image* raw) {
   return new (std::nothrow) PixelGrabImage(raw);
 }
 
+// Renderers, pin windows and OCR backends read B,G,R,A pixels.  Returns
+// |image| itself if it already has that layout, otherwise a swizzled copy
+// owned by |*holder| (nullptr if the copy failed).
+static const Image* AsBgra(const Image* image,
+                           std::unique_ptr<Image>* holder) {
+  if (IsBgraLayout(image->format())) return image;
+  *holder = image->Clone();
+  if (!*holder ||
+      !ConvertImageFormat(holder->get(), kPixelGrabFormatBgra8)) {
+    return nullptr;
+  }
+  return holder->get();
+}
+
 // ---------------------------------------------------------------------------
 // The opaque PixelGrabAnnotation struct wraps AnnotationSession.
 // ---------------------------------------------------------------------------
@@ -107,10 +139,28 @@ PixelGrabContext* pixelgrab_context_create(void) {
   return ctx;
 }
 
+PixelGrabContext* pixelgrab_context_create_with_options(
+    const PixelGrabContextOptions* options) {
+  auto* ctx = new (std::nothrow) PixelGrabContext();
+  if (!ctx) return nullptr;
+
+  PixelGrabContextOptions defaults{};
+  if (!ctx->impl.Initialize(options ? *options : defaults)) {
+    delete ctx;
+    return nullptr;
+  }
+  return ctx;
+}
+
 void pixelgrab_context_destroy(PixelGrabContext* ctx) {
   delete ctx;
 }
 
+PixelGrabBackendType pixelgrab_get_backend_type(const PixelGrabContext* ctx) {
+  if (!ctx) return kPixelGrabBackendDefault;
+  return ctx->impl.backend_type();
+}
+
 // ---------------------------------------------------------------------------
 // Error handling
 // ---------------------------------------------------------------------------
@@ -157,12 +207,92 @@ PixelGrabImage* pixelgrab_capture_region(PixelGrabContext* ctx, int x, int y,
   return WrapImage(ctx->impl.CaptureRegion(x, y, width, height));
 }
 
+PixelGrabError pixelgrab_capture_regions(PixelGrabContext* ctx,
+                                         const PixelGrabRect* rects, int count,
+                                         PixelGrabImage** out_images) {
+  if (!ctx) return kPixelGrabErrorInvalidParam;
+  std::vector<Image*> raw(count > 0 ? static_cast<size_t>(count) : 0);
+  PixelGrabError err = ctx->impl.CaptureRegions(
+      rects, count, out_images ? raw.data() : nullptr);
+  if (!out_images) return err;
+  for (int i = 0; i < count; ++i) {
+    out_images[i] = WrapImage(raw[i]);
+    if (raw[i] && !out_images[i]) {
+      delete raw[i];
+      err = kPixelGrabErrorOutOfMemory;
+    }
+  }
+  return err;
+}
+
+PixelGrabError pixelgrab_capture_region_into(PixelGrabContext* ctx, int x,
+                                             int y, int width, int height,
+                                             uint8_t* dst, int dst_stride) {
+  if (!ctx) return kPixelGrabErrorInvalidParam;
+  return ctx->impl.CaptureRegionInto(x, y, width, height, dst, dst_stride);
+}
+
+PixelGrabError pixelgrab_capture_screen_into(PixelGrabContext* ctx,
+                                             int screen_index, uint8_t* dst,
+                                             int dst_stride) {
+  if (!ctx) return kPixelGrabErrorInvalidParam;
+  return ctx->impl.CaptureScreenInto(screen_index, dst, dst_stride);
+}
+
+PixelGrabImage* pixelgrab_capture_region_scaled(PixelGrabContext* ctx, int x,
+                                                int y, int width, int height,
+                                                int out_width, int out_height,
+                                                PixelGrabResizeFilter filter) {
+  if (!ctx) return nullptr;
+  return WrapImage(ctx->impl.CaptureRegionScaled(x, y, width, height,
+                                                 out_width, out_height,
+                                                 filter));
+}
+
+PixelGrabImage* pixelgrab_capture_region_incremental(
+    PixelGrabContext* ctx, int x, int y, int width, int height,
+    PixelGrabRect* out_changed, int max_changed, int* out_changed_count) {
+  if (out_changed_count) *out_changed_count = 0;
+  if (!ctx) return nullptr;
+  return WrapImage(ctx->impl.CaptureRegionIncremental(
+      x, y, width, height, out_changed, max_changed, out_changed_count));
+}
+
+void pixelgrab_capture_incremental_reset(PixelGrabContext* ctx) {
+  if (!ctx) return;
+  ctx->impl.ResetIncrementalCapture();
+}
+
 PixelGrabImage* pixelgrab_capture_window(PixelGrabContext* ctx,
                                          PixelGrabWindowId window_id) {
   if (!ctx) return nullptr;
   return WrapImage(ctx->impl.CaptureWindow(window_id));
 }
 
+PixelGrabError pixelgrab_set_capture_format(PixelGrabContext* ctx,
+                                            PixelGrabPixelFormat format) {
+  if (!ctx) return kPixelGrabErrorInvalidParam;
+  return ctx->impl.SetCaptureFormat(format);
+}
+
+PixelGrabPixelFormat pixelgrab_get_capture_format(
+    const PixelGrabContext* ctx) {
+  if (!ctx) return kPixelGrabFormatBgra8;
+  return ctx->impl.GetCaptureFormat();
+}
+
+PixelGrabError pixelgrab_set_window_capture_mode(
+    PixelGrabContext* ctx, PixelGrabWindowCaptureMode mode) {
+  if (!ctx) return kPixelGrabErrorInvalidParam;
+  return ctx->impl.SetWindowCaptureMode(mode);
+}
+
+PixelGrabWindowCaptureMode pixelgrab_get_window_capture_mode(
+    const PixelGrabContext* ctx) {
+  if (!ctx) return kPixelGrabWindowCaptureScreen;
+  return ctx->impl.GetWindowCaptureMode();
+}
+
 // ---------------------------------------------------------------------------
 // Window enumeration
 // ---------------------------------------------------------------------------
@@ -212,6 +342,42 @@ void pixelgrab_image_destroy(PixelGrabImage* image) {
   delete image;
 }
 
+PixelGrabImage* pixelgrab_image_create_view(const PixelGrabImage* image,
+                                            int x, int y, int width,
+                                            int height) {
+  if (!image || !image->impl) return nullptr;
+  auto view = image->impl->CreateView(x, y, width, height);
+  if (!view) return nullptr;
+  return WrapImage(view.release());
+}
+
+PixelGrabImage* pixelgrab_image_resize(const PixelGrabImage* image,
+                                       int width, int height,
+                                       PixelGrabResizeFilter filter) {
+  if (!image || !image->impl || width <= 0 || height <= 0 ||
+      !IsValidResizeFilter(filter)) {
+    return nullptr;
+  }
+  auto resized =
+      pixelgrab::internal::ResizeImage(*image->impl, width, height, filter);
+  if (!resized) return nullptr;
+  return WrapImage(resized.release());
+}
+
+void pixelgrab_buffer_pool_set_limit(uint64_t max_pooled_bytes) {
+  ImageBufferPool::Instance().SetMaxPooledBytes(
+      static_cast<size_t>(max_pooled_bytes));
+}
+
+void pixelgrab_buffer_pool_trim(void) { ImageBufferPool::Instance().Trim(); }
+
+PixelGrabError pixelgrab_buffer_pool_get_stats(
+    PixelGrabBufferPoolStats* out_stats) {
+  if (!out_stats) return kPixelGrabErrorInvalidParam;
+  *out_stats = ImageBufferPool::Instance().GetStats();
+  return kPixelGrabOk;
+}
+
 // ---------------------------------------------------------------------------
 // DPI awareness
 // ---------------------------------------------------------------------------
@@ -303,12 +469,11 @@ PixelGrabAnnotation* pixelgrab_annotation_create(PixelGrabContext* ctx,
     return nullptr;
   }
 
-  const Image* src = base_image->impl.get();
-  std::vector<uint8_t> data(src->data(), src->data() + src->data_size());
-  auto base_copy = Image::CreateFromData(src->width(), src->height(),
-                                         src->stride(), src->format(),
-                                         std::move(data));
-  if (!base_copy) {
+  // Shares the caller's pixels; the session never writes to its base.
+  // Sessions always draw on B,G,R,A pixels.
+  auto base_copy = base_image->impl->Clone();
+  if (!base_copy ||
+      !ConvertImageFormat(base_copy.get(), kPixelGrabFormatBgra8)) {
     ctx->impl.SetError(kPixelGrabErrorOutOfMemory,
                        "Failed to copy base image for annotation");
     return nullptr;
@@ -566,6 +731,14 @@ PixelGrabImage* pixelgrab_history_recapture(PixelGrabContext* ctx,
   return WrapImage(img);
 }
 
+PixelGrabImage* pixelgrab_history_get_thumbnail(PixelGrabContext* ctx,
+                                                int history_id) {
+  if (!ctx) return nullptr;
+  auto* img = ctx->impl.HistoryGetThumbnail(history_id);
+  if (!img) return nullptr;
+  return WrapImage(img);
+}
+
 PixelGrabImage* pixelgrab_recapture_last(PixelGrabContext* ctx) {
   if (!ctx) return nullptr;
   auto* img = ctx->impl.RecaptureLast();
@@ -584,6 +757,37 @@ void pixelgrab_history_set_max_count(PixelGrabContext* ctx, int max_count) {
   ctx->impl.HistorySetMaxCount(max_count);
 }
 
+PixelGrabError pixelgrab_history_set_codec(PixelGrabContext* ctx,
+                                           PixelGrabHistoryCodec codec) {
+  if (!ctx) return kPixelGrabErrorInvalidParam;
+  return ctx->impl.HistorySetCodec(codec);
+}
+
+PixelGrabError pixelgrab_history_get_usage(PixelGrabContext* ctx,
+                                           PixelGrabHistoryUsage* out_usage) {
+  if (!ctx) return kPixelGrabErrorInvalidParam;
+  return ctx->impl.HistoryGetUsage(out_usage);
+}
+
+PixelGrabError pixelgrab_history_set_keyframe_interval(PixelGrabContext* ctx,
+                                                      int interval) {
+  if (!ctx) return kPixelGrabErrorInvalidParam;
+  return ctx->impl.HistorySetKeyframeInterval(interval);
+}
+
+PixelGrabError pixelgrab_history_set_thumbnail_size(PixelGrabContext* ctx,
+                                                    int max_size) {
+  if (!ctx) return kPixelGrabErrorInvalidParam;
+  return ctx->impl.HistorySetThumbnailSize(max_size);
+}
+
+PixelGrabError pixelgrab_history_set_queue(
+    PixelGrabContext* ctx, int max_pending,
+    PixelGrabHistoryBackpressure policy) {
+  if (!ctx) return kPixelGrabErrorInvalidParam;
+  return ctx->impl.HistorySetQueue(max_pending, policy);
+}
+
 // ---------------------------------------------------------------------------
 // Pin Windows (Floating Overlay)
 // ---------------------------------------------------------------------------
@@ -597,7 +801,9 @@ PixelGrabPinWindow* pixelgrab_pin_image(PixelGrabContext* ctx,
                        "Pin image is NULL or empty");
     return nullptr;
   }
-  int id = ctx->impl.pin_manager().PinImage(image->impl.get(), x, y);
+  std::unique_ptr<Image> converted;
+  const Image* bgra = AsBgra(image->impl.get(), &converted);
+  int id = bgra ? ctx->impl.pin_manager().PinImage(bgra, x, y) : 0;
   if (id <= 0) {
     ctx->impl.SetError(kPixelGrabErrorWindowCreateFailed,
                        "Failed to create image pin window");
@@ -782,7 +988,9 @@ PixelGrabError pixelgrab_pin_set_image(PixelGrabPinWindow* pin,
                                        const PixelGrabImage* image) {
   if (!pin || !pin->ctx || !image || !image->impl)
     return kPixelGrabErrorInvalidParam;
-  if (!pin->ctx->impl.pin_manager().SetImage(pin->pin_id, image->impl.get())) {
+  std::unique_ptr<Image> converted;
+  const Image* bgra = AsBgra(image->impl.get(), &converted);
+  if (!bgra || !pin->ctx->impl.pin_manager().SetImage(pin->pin_id, bgra)) {
     return kPixelGrabErrorInvalidParam;
   }
   return kPixelGrabOk;
@@ -894,6 +1102,7 @@ void pixelgrab_free_string(char* str) {
 // ---------------------------------------------------------------------------
 struct PixelGrabRecorder {
   PixelGrabContext* ctx;
+  std::unique_ptr<CaptureBackend> capture;  // Auto-capture; outlives backend.
   std::unique_ptr<RecorderBackend> backend;
   std::unique_ptr<WatermarkRenderer> watermark;
   PixelGrabTextWatermarkConfig watermark_config;
@@ -973,7 +1182,10 @@ PixelGrabRecorder* pixelgrab_recorder_create(
 
   // Set up auto-capture dependencies.
   if (rec->auto_capture) {
-    rec->config.capture_backend = ctx->impl.capture_backend();
+    // A backend of its own: the recorder thread captures without leasing
+    // one from the context's pool.
+    rec->capture = ctx->impl.CreateRecorderCaptureBackend();
+    rec->config.capture_backend = rec->capture.get();
     if (need_renderer && rec->watermark) {
       rec->config.watermark_renderer = rec->watermark.get();
     }
@@ -1081,12 +1293,165 @@ PixelGrabError pixelgrab_recorder_write_frame(PixelGrabRecorder* recorder,
     return kPixelGrabErrorRecordFailed;
   }
 
+  StageTimer timer(recorder->ctx ? &recorder->ctx->impl.metrics() : nullptr,
+                   kPixelGrabStageRecorder);
+  timer.set_bytes(frame->impl->data_size());
   if (!recorder->backend->WriteFrame(*frame->impl)) {
+    timer.Fail();
     return kPixelGrabErrorRecordFailed;
   }
   return kPixelGrabOk;
 }
 
+// ---------------------------------------------------------------------------
+// The opaque PixelGrabStream struct wraps a CaptureStream.
+// ---------------------------------------------------------------------------
+struct PixelGrabStream {
+  PixelGrabContext* ctx;  // Parent context (non-owning).
+  std::unique_ptr<CaptureStream> impl;
+};
+
+// ---------------------------------------------------------------------------
+// Capture streams
+// ---------------------------------------------------------------------------
+
+PixelGrabStream* pixelgrab_stream_create(PixelGrabContext* ctx,
+                                         const PixelGrabRect* region, int fps,
+                                         int ring_depth) {
+  if (!ctx) return nullptr;
+  auto impl = ctx->impl.CreateStream(region, fps, ring_depth);
+  if (!impl) return nullptr;
+
+  auto* stream = new (std::nothrow) PixelGrabStream();
+  if (!stream) {
+    ctx->impl.SetError(kPixelGrabErrorOutOfMemory,
+                       "Failed to allocate stream handle");
+    return nullptr;
+  }
+  stream->ctx = ctx;
+  stream->impl = std::move(impl);
+  return stream;
+}
+
+void pixelgrab_stream_destroy(PixelGrabStream* stream) {
+  if (!stream) return;
+  if (stream->impl) stream->impl->Stop();
+  delete stream;
+}
+
+PixelGrabError pixelgrab_stream_set_callback(
+    PixelGrabStream* stream, pixelgrab_stream_callback_t callback,
+    void* userdata) {
+  if (!stream || !stream->impl) return kPixelGrabErrorInvalidParam;
+  if (!callback) {
+    stream->impl->SetFrameCallback(nullptr);
+    return kPixelGrabOk;
+  }
+  stream->impl->SetFrameCallback(
+      [stream, callback, userdata](const Image& frame, uint64_t sequence) {
+        // Borrowed wrapper: released, not deleted, after the call.
+        PixelGrabImage view(const_cast<Image*>(&frame));
+        callback(stream, &view, sequence, userdata);
+        view.impl.release();
+      });
+  return kPixelGrabOk;
+}
+
+PixelGrabImage* pixelgrab_stream_poll(PixelGrabStream* stream, int timeout_ms,
+                                      uint64_t* out_sequence) {
+  if (!stream || !stream->impl) return nullptr;
+  return WrapImage(stream->impl->Poll(timeout_ms, out_sequence).release());
+}
+
+PixelGrabError pixelgrab_stream_get_stats(const PixelGrabStream* stream,
+                                          PixelGrabStreamStats* out_stats) {
+  if (!stream || !stream->impl || !out_stats) {
+    return kPixelGrabErrorInvalidParam;
+  }
+  *out_stats = stream->impl->GetStats();
+  return kPixelGrabOk;
+}
+
+// ---------------------------------------------------------------------------
+// Change detection
+// ---------------------------------------------------------------------------
+
+struct PixelGrabTileTracker {
+  explicit PixelGrabTileTracker(int tile_size) : impl(tile_size) {}
+  TileTracker impl;
+};
+
+// Copy |tiles| to the caller's array, collapsing them into their bounding
+// box if there are more than |max_tiles|.
+static void WriteChangedTiles(const std::vector<PixelGrabRect>& tiles,
+                              PixelGrabRect* out_tiles, int max_tiles,
+                              int* out_count) {
+  int count = static_cast<int>(tiles.size());
+  if (out_tiles && count > max_tiles) {
+    int x0 = tiles[0].x, y0 = tiles[0].y;
+    int x1 = x0 + tiles[0].width, y1 = y0 + tiles[0].height;
+    for (const auto& r : tiles) {
+      x0 = std::min(x0, r.x);
+      y0 = std::min(y0, r.y);
+      x1 = std::max(x1, r.x + r.width);
+      y1 = std::max(y1, r.y + r.height);
+    }
+    out_tiles[0] = {x0, y0, x1 - x0, y1 - y0};
+    count = 1;
+  } else if (out_tiles) {
+    for (int i = 0; i < count; ++i) out_tiles[i] = tiles[i];
+  }
+  if (out_count) *out_count = count;
+}
+
+PixelGrabError pixelgrab_image_diff(const PixelGrabImage* a,
+                                    const PixelGrabImage* b, int tile_size,
+                                    PixelGrabRect* out_tiles, int max_tiles,
+                                    int* out_count) {
+  if (out_count) *out_count = 0;
+  if (!a || !a->impl || !b || !b->impl || tile_size <= 0 ||
+      (out_tiles && max_tiles <= 0)) {
+    return kPixelGrabErrorInvalidParam;
+  }
+  const Image& ia = *a->impl;
+  const Image& ib = *b->impl;
+  if (ia.width() != ib.width() || ia.height() != ib.height() ||
+      IsBgraLayout(ia.format()) != IsBgraLayout(ib.format())) {
+    return kPixelGrabErrorInvalidParam;
+  }
+  std::vector<PixelGrabRect> tiles;
+  DiffImageTiles(ia, ib, tile_size, &tiles);
+  WriteChangedTiles(tiles, out_tiles, max_tiles, out_count);
+  return kPixelGrabOk;
+}
+
+PixelGrabTileTracker* pixelgrab_tile_tracker_create(int tile_size) {
+  if (tile_size <= 0) return nullptr;
+  return new (std::nothrow) PixelGrabTileTracker(tile_size);
+}
+
+void pixelgrab_tile_tracker_destroy(PixelGrabTileTracker* tracker) {
+  delete tracker;
+}
+
+PixelGrabError pixelgrab_tile_tracker_update(PixelGrabTileTracker* tracker,
+                                             const PixelGrabImage* frame,
+                                             PixelGrabRect* out_tiles,
+                                             int max_tiles, int* out_count) {
+  if (out_count) *out_count = 0;
+  if (!tracker || !frame || !frame->impl || (out_tiles && max_tiles <= 0)) {
+    return kPixelGrabErrorInvalidParam;
+  }
+  std::vector<PixelGrabRect> tiles;
+  tracker->impl.Update(*frame->impl, &tiles);
+  WriteChangedTiles(tiles, out_tiles, max_tiles, out_count);
+  return kPixelGrabOk;
+}
+
+void pixelgrab_tile_tracker_reset(PixelGrabTileTracker* tracker) {
+  if (tracker) tracker->impl.Reset();
+}
+
 // ---------------------------------------------------------------------------
 // Watermark
 // ---------------------------------------------------------------------------
@@ -1111,7 +1476,14 @@ PixelGrabError pixelgrab_watermark_apply_text(
     return kPixelGrabErrorNotSupported;
   }
 
-  if (!renderer->ApplyTextWatermark(image->impl.get(), *config)) {
+  // Render on B,G,R,A pixels; RGBA images are swizzled around the call.
+  Image* target = image->impl.get();
+  bool rgba = !IsBgraLayout(target->format());
+  PixelGrabPixelFormat original = target->format();
+  if (rgba) ConvertImageFormat(target, kPixelGrabFormatBgra8);
+  bool applied = renderer->ApplyTextWatermark(target, *config);
+  if (rgba) ConvertImageFormat(target, original);
+  if (!applied) {
     ctx->impl.SetError(kPixelGrabErrorWatermarkFailed,
                        "Failed to apply text watermark");
     return kPixelGrabErrorWatermarkFailed;
@@ -1133,8 +1505,16 @@ PixelGrabError pixelgrab_watermark_apply_image(
     return kPixelGrabErrorNotSupported;
   }
 
-  if (!renderer->ApplyImageWatermark(image->impl.get(), *watermark->impl,
-                                     x, y, opacity)) {
+  std::unique_ptr<Image> converted;
+  const Image* source = AsBgra(watermark->impl.get(), &converted);
+  Image* target = image->impl.get();
+  bool rgba = !IsBgraLayout(target->format());
+  PixelGrabPixelFormat original = target->format();
+  if (rgba) ConvertImageFormat(target, kPixelGrabFormatBgra8);
+  bool applied = source && renderer->ApplyImageWatermark(target, *source, x,
+                                                         y, opacity);
+  if (rgba) ConvertImageFormat(target, original);
+  if (!applied) {
     ctx->impl.SetError(kPixelGrabErrorWatermarkFailed,
                        "Failed to apply image watermark");
     return kPixelGrabErrorWatermarkFailed;
@@ -1233,17 +1613,26 @@ PixelGrabError pixelgrab_ocr_recognize(PixelGrabContext* ctx,
     return kPixelGrabErrorNotSupported;
   }
 
-  const uint8_t* data = image->impl->data();
-  int w = image->impl->width();
-  int h = image->impl->height();
-  int stride = image->impl->stride();
+  std::unique_ptr<Image> converted;
+  const Image* bgra =
+      image->impl ? AsBgra(image->impl.get(), &converted) : nullptr;
+  const uint8_t* data = bgra ? bgra->data() : nullptr;
+  int w = bgra ? bgra->width() : 0;
+  int h = bgra ? bgra->height() : 0;
+  int stride = bgra ? bgra->stride() : 0;
 
   if (!data || w <= 0 || h <= 0) {
     ctx->impl.SetError(kPixelGrabErrorInvalidParam, "Invalid image for OCR");
     return kPixelGrabErrorInvalidParam;
   }
 
-  std::string text = backend->RecognizeText(data, w, h, stride, language);
+  std::string text;
+  {
+    StageTimer timer(&ctx->impl.metrics(), kPixelGrabStageOcr);
+    timer.set_bytes(static_cast<uint64_t>(stride) * h);
+    text = backend->RecognizeText(data, w, h, stride, language);
+    if (text.empty()) timer.Fail();
+  }
   if (text.empty()) {
     ctx->impl.SetError(kPixelGrabErrorOcrFailed, "OCR returned no text");
     return kPixelGrabErrorOcrFailed;
@@ -1334,6 +1723,44 @@ PixelGrabError pixelgrab_translate_text(PixelGrabContext* ctx, const char* text,
   return kPixelGrabOk;
 }
 
+// ---------------------------------------------------------------------------
+// Performance statistics
+// ---------------------------------------------------------------------------
+
+namespace {
+
+const MetricsRegistry& StatsOf(const PixelGrabContext* ctx) {
+  return ctx ? ctx->impl.metrics() : MetricsRegistry::Global();
+}
+
+}  // namespace
+
+PixelGrabError pixelgrab_get_stats(const PixelGrabContext* ctx,
+                                   PixelGrabStage stage,
+                                   PixelGrabStageStats* out_stats) {
+  if (!StatsOf(ctx).GetStats(stage, out_stats)) {
+    return kPixelGrabErrorInvalidParam;
+  }
+  return kPixelGrabOk;
+}
+
+char* pixelgrab_stats_dump(const PixelGrabContext* ctx,
+                           PixelGrabStatsFormat format) {
+  std::string text = StatsOf(ctx).Dump(format);
+  char* result = static_cast<char*>(std::malloc(text.size() + 1));
+  if (!result) return nullptr;
+  std::memcpy(result, text.c_str(), text.size() + 1);
+  return result;
+}
+
+void pixelgrab_stats_reset(PixelGrabContext* ctx) {
+  if (ctx) {
+    ctx->impl.metrics().Reset();
+  } else {
+    MetricsRegistry::Global().Reset();
+  }
+}
+
 // ---------------------------------------------------------------------------
 // Version information
 // ---------------------------------------------------------------------------
@@ -6,22 +6,72 @@
 #include <cmath>
 #include <cstring>
 #include <mutex>
+#include <thread>
 #include <utility>
 
+#include "core/history_codec.h"
+#include "core/image_resample.h"
 #include "core/logger.h"
+#include "core/pixel_convert.h"
+#include "core/region_batch.h"
+#include "core/synthetic_capture_backend.h"
 
 namespace pixelgrab {
 namespace internal {
 
-PixelGrabContextImpl::PixelGrabContextImpl() = default;
+namespace {
 
-PixelGrabContextImpl::~PixelGrabContextImpl() {
-  if (backend_) {
-    backend_->Shutdown();
+// Source rows read per backend request by CaptureRegionScaled(): 128 rows of
+// an 8K-wide region is 4 MB, against 128 MB for the whole 8K frame.
+constexpr int kScaledCaptureStripRows = 128;
+
+// Has the backend emit |format| for the duration of one capture, where it
+// supports converting directly; restores BGRA (which the magnifier, color
+// picker and recorder rely on) afterwards.
+class ScopedOutputFormat {
+ public:
+  ScopedOutputFormat(CaptureBackend* backend, PixelGrabPixelFormat format)
+      : backend_(backend) {
+    if (format != kPixelGrabFormatBgra8) {
+      active_ = backend_->SetOutputFormat(format);
+    }
+  }
+  ~ScopedOutputFormat() {
+    if (active_) backend_->SetOutputFormat(kPixelGrabFormatBgra8);
+  }
+
+  // Non-copyable.
+  ScopedOutputFormat(const ScopedOutputFormat&) = delete;
+  ScopedOutputFormat& operator=(const ScopedOutputFormat&) = delete;
+
+ private:
+  CaptureBackend* backend_;
+  bool active_ = false;
+};
+
+// Completes |timer| for a backend read that produced |image| (nullptr if
+// it failed).
+void NoteCapture(StageTimer* timer, const Image* image) {
+  if (image) {
+    timer->set_bytes(image->data_size());
+  } else {
+    timer->Fail();
   }
 }
 
-bool PixelGrabContextImpl::Initialize() {
+}  // namespace
+
+// Upper bound on capture connections when the options leave it open.
+static constexpr int kDefaultMaxCaptureConnections = 4;
+
+// Size cap of the history directory when the options leave it open.
+static constexpr uint64_t kDefaultHistoryDiskBytes = 4ULL << 30;
+
+PixelGrabContextImpl::PixelGrabContextImpl() = default;
+
+PixelGrabContextImpl::~PixelGrabContextImpl() { backends_.Shutdown(); }
+
+bool PixelGrabContextImpl::Initialize(const PixelGrabContextOptions& options) {
   std::lock_guard<std::mutex> lock(mu_);
   if (initialized_) {
     return true;
@@ -29,20 +79,69 @@ bool PixelGrabContextImpl::Initialize() {
 
   PIXELGRAB_LOG_INFO("Initializing pixelgrab context...");
 
-  backend_ = CreatePlatformBackend();
-  if (!backend_) {
+  backend_type_ = options.backend;
+  if (backend_type_ == kPixelGrabBackendDefault &&
+      SyntheticBackendRequestedByEnv()) {
+    backend_type_ = kPixelGrabBackendSynthetic;
+  }
+  if (backend_type_ == kPixelGrabBackendSynthetic) {
+    // Every connection renders from one clock so that pooled captures and
+    // streams agree on the frame.
+    PixelGrabSyntheticConfig config =
+        options.synthetic ? NormalizeSyntheticConfig(options.synthetic)
+                          : SyntheticConfigFromEnv();
+    auto clock = std::make_shared<SyntheticClock>(config.fps);
+    backend_factory_ = [config, clock]() -> std::unique_ptr<CaptureBackend> {
+      return std::make_unique<SyntheticCaptureBackend>(config, clock);
+    };
+    PIXELGRAB_LOG_INFO("Using the synthetic capture backend: {} x {}x{}, "
+                       "{}% damage",
+                       config.screen_count, config.screen_width,
+                       config.screen_height, config.damage_percent);
+  } else {
+    PixelGrabBackendType type = backend_type_;
+    backend_factory_ = [type] { return CreateCaptureBackend(type); };
+  }
+  auto backend = backend_factory_();
+  if (!backend && backend_type_ != kPixelGrabBackendDefault) {
+    PIXELGRAB_LOG_WARN("Capture backend {} not available in this build, "
+                       "using the default",
+                       static_cast<int>(backend_type_));
+    backend_type_ = kPixelGrabBackendDefault;
+    backend_factory_ = [] { return CreatePlatformBackend(); };
+    backend = backend_factory_();
+  }
+  if (!backend) {
     PIXELGRAB_LOG_WARN(
         "Platform capture backend unavailable (no display server?)");
-  } else if (!backend_->Initialize()) {
+  } else if (!backend->Initialize()) {
     PIXELGRAB_LOG_WARN(
         "Platform capture backend failed to initialize (no display server?)");
-    backend_.reset();
+    backend.reset();
   } else {
     PIXELGRAB_LOG_DEBUG("Platform capture backend initialized");
   }
 
+  // Concurrent callers get extra connections, opened on first contention.
+  int max_backends = options.max_capture_connections;
+  if (max_backends <= 0) {
+    max_backends = static_cast<int>(std::thread::hardware_concurrency());
+    max_backends = std::max(1, std::min(max_backends,
+                                        kDefaultMaxCaptureConnections));
+  }
+  backends_.Reset(std::move(backend), backend_factory_, max_backends);
+
+  // Element detection, the clipboard and pin windows share connections
+  // from here instead of opening their own per call or window.
+  display_manager_ = CreatePlatformDisplayManager();
+  pin_manager_.SetDisplayManager(display_manager_.get());
+
   // Initialize element detection (best-effort; failure is not fatal).
-  element_detector_ = CreatePlatformElementDetector();
+  // The synthetic scene has no real windows to detect elements in.
+  if (backend_type_ != kPixelGrabBackendSynthetic) {
+    element_detector_ =
+        CreateElementDetector(backend_type_, display_manager_.get());
+  }
   if (element_detector_) {
     snap_engine_ = std::make_unique<SnapEngine>(element_detector_.get());
     PIXELGRAB_LOG_DEBUG("Element detector and snap engine initialized");
@@ -50,48 +149,123 @@ bool PixelGrabContextImpl::Initialize() {
     PIXELGRAB_LOG_WARN("Element detector unavailable on this platform");
   }
 
+  // Best-effort as well: without it the history stays in memory.
+  if (options.history_directory && options.history_directory[0]) {
+    const uint64_t disk_bytes = options.history_disk_bytes
+                                    ? options.history_disk_bytes
+                                    : kDefaultHistoryDiskBytes;
+    if (!capture_history_.OpenStore(options.history_directory, disk_bytes)) {
+      PIXELGRAB_LOG_WARN("History directory {} unavailable, keeping the "
+                         "history in memory only",
+                         options.history_directory);
+    }
+  }
+
   initialized_ = true;
   PIXELGRAB_LOG_INFO("pixelgrab context initialized successfully");
   ClearError();
   return true;
 }
 
+bool PixelGrabContextImpl::ConvertCaptured(Image* image,
+                                           PixelGrabPixelFormat format) {
+  if (IsBgraLayout(image->format()) == IsBgraLayout(format)) {
+    return ConvertImageFormat(image, format);  // Relabel only.
+  }
+  StageTimer timer(&metrics_, kPixelGrabStageConvert);
+  timer.set_bytes(image->data_size());
+  if (ConvertImageFormat(image, format)) return true;
+  timer.Fail();
+  return false;
+}
+
+PixelGrabError PixelGrabContextImpl::last_error() const {
+  std::lock_guard<std::mutex> lock(error_mu_);
+  return last_error_;
+}
+
+const char* PixelGrabContextImpl::last_error_message() const {
+  // Another thread may overwrite the message; hand out a per-thread copy
+  // that stays valid until this thread asks again.
+  thread_local std::string message;
+  std::lock_guard<std::mutex> lock(error_mu_);
+  message = last_error_message_;
+  return message.c_str();
+}
+
 void PixelGrabContextImpl::SetError(PixelGrabError code,
                                     const std::string& message) {
-  last_error_ = code;
-  last_error_message_ = message;
+  {
+    std::lock_guard<std::mutex> lock(error_mu_);
+    last_error_ = code;
+    last_error_message_ = message;
+  }
   PIXELGRAB_LOG_ERROR("Error {}: {}", static_cast<int>(code), message);
 }
 
 void PixelGrabContextImpl::ClearError() {
+  std::lock_guard<std::mutex> lock(error_mu_);
   last_error_ = kPixelGrabOk;
   last_error_message_ = "No error";
 }
 
+// Only used for backends that cannot report screen layout changes.
 static constexpr auto kScreensCacheTtl = std::chrono::seconds(1);
 
-void PixelGrabContextImpl::RefreshScreens() {
-  if (!backend_) return;
+std::shared_ptr<const PixelGrabContextImpl::ScreenList>
+PixelGrabContextImpl::Screens() {
+  auto screens = std::atomic_load(&screens_);
+  std::unique_lock<std::mutex> refresh(screens_mu_, std::try_to_lock);
+  if (!refresh.owns_lock()) {
+    // Someone else is refreshing; the current list is at most that stale.
+    if (screens) return screens;
+    refresh.lock();
+    screens = std::atomic_load(&screens_);
+  }
+
+  CaptureBackend* primary = backends_.primary();
+  if (!primary) {
+    if (!screens) {
+      screens = std::make_shared<const ScreenList>();
+      std::atomic_store(&screens_, screens);
+    }
+    return screens;
+  }
+
   auto now = std::chrono::steady_clock::now();
-  if (!cached_screens_.empty() && (now - screens_cache_time_) < kScreensCacheTtl)
-    return;
-  cached_screens_ = backend_->GetScreens();
+  if (screens && !screens_dirty_) {
+    if (primary->SupportsScreenChangeEvents()) {
+      // Notifications queue up on the connection; if it is busy they are
+      // picked up by a later call.
+      auto backend = backends_.TryLockPrimary();
+      if (!backend || !backend->ScreensChanged()) return screens;
+    } else if ((now - screens_cache_time_) < kScreensCacheTtl) {
+      return screens;
+    }
+  }
+
+  auto backend = backends_.LockPrimary();
+  if (backend) {
+    screens = std::make_shared<const ScreenList>(backend->GetScreens());
+  } else if (!screens) {
+    screens = std::make_shared<const ScreenList>();
+  }
+  std::atomic_store(&screens_, screens);
   screens_cache_time_ = now;
+  screens_dirty_ = false;
+  return screens;
 }
 
 int PixelGrabContextImpl::GetScreenCount() {
-  std::lock_guard<std::mutex> lock(mu_);
   if (!initialized_) {
     SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
     return -1;
   }
-  RefreshScreens();
-  return static_cast<int>(cached_screens_.size());
+  return static_cast<int>(Screens()->size());
 }
 
 PixelGrabError PixelGrabContextImpl::GetScreenInfo(
     int screen_index, PixelGrabScreenInfo* out_info) {
-  std::lock_guard<std::mutex> lock(mu_);
   if (!initialized_) {
     SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
     return kPixelGrabErrorNotInitialized;
@@ -101,35 +275,41 @@ PixelGrabError PixelGrabContextImpl::GetScreenInfo(
     return kPixelGrabErrorInvalidParam;
   }
 
-  RefreshScreens();
-
+  auto screens = Screens();
   if (screen_index < 0 ||
-      screen_index >= static_cast<int>(cached_screens_.size())) {
+      screen_index >= static_cast<int>(screens->size())) {
     SetError(kPixelGrabErrorInvalidParam, "Screen index out of range");
     return kPixelGrabErrorInvalidParam;
   }
 
-  *out_info = cached_screens_[screen_index];
+  *out_info = (*screens)[screen_index];
   ClearError();
   return kPixelGrabOk;
 }
 
 Image* PixelGrabContextImpl::CaptureScreen(int screen_index) {
-  std::lock_guard<std::mutex> lock(mu_);
   if (!initialized_) {
     SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
     return nullptr;
   }
 
-  if (!backend_) {
+  auto backend = backends_.Acquire();
+  if (!backend) {
     SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
     return nullptr;
   }
+  const PixelGrabPixelFormat capture_format = capture_format_;
 
   PIXELGRAB_LOG_DEBUG("CaptureScreen(screen_index={})", screen_index);
 
-  auto image = backend_->CaptureScreen(screen_index);
-  if (!image) {
+  std::unique_ptr<Image> image;
+  {
+    ScopedOutputFormat format(backend.get(), capture_format);
+    StageTimer timer(&metrics_, kPixelGrabStageCapture);
+    image = backend->CaptureScreen(screen_index);
+    NoteCapture(&timer, image.get());
+  }
+  if (!image || !ConvertCaptured(image.get(), capture_format)) {
     SetError(kPixelGrabErrorCaptureFailed, "Screen capture failed");
     return nullptr;
   }
@@ -142,7 +322,6 @@ Image* PixelGrabContextImpl::CaptureScreen(int screen_index) {
 
 Image* PixelGrabContextImpl::CaptureRegion(int x, int y, int width,
                                            int height) {
-  std::lock_guard<std::mutex> lock(mu_);
   if (!initialized_) {
     SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
     return nullptr;
@@ -153,20 +332,30 @@ Image* PixelGrabContextImpl::CaptureRegion(int x, int y, int width,
     return nullptr;
   }
 
-  if (!backend_) {
+  auto backend = backends_.Acquire();
+  if (!backend) {
     SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
     return nullptr;
   }
+  const PixelGrabPixelFormat capture_format = capture_format_;
 
   PIXELGRAB_LOG_DEBUG("CaptureRegion(x={}, y={}, w={}, h={})", x, y, width,
                       height);
 
-  auto image = backend_->CaptureRegion(x, y, width, height);
-  if (!image) {
+  std::unique_ptr<Image> image;
+  {
+    ScopedOutputFormat format(backend.get(), capture_format);
+    StageTimer timer(&metrics_, kPixelGrabStageCapture);
+    image = backend->CaptureRegion(x, y, width, height);
+    NoteCapture(&timer, image.get());
+  }
+  if (!image || !ConvertCaptured(image.get(), capture_format)) {
     SetError(kPixelGrabErrorCaptureFailed, "Region capture failed");
     return nullptr;
   }
 
+  // The clone shares the pixels (copy-on-write); the history compresses
+  // it on its worker thread.
   capture_history_.Record(x, y, width, height, image->Clone());
 
   PIXELGRAB_LOG_INFO("Region captured: ({},{}) {}x{}", x, y, width, height);
@@ -174,8 +363,421 @@ Image* PixelGrabContextImpl::CaptureRegion(int x, int y, int width,
   return image.release();
 }
 
+PixelGrabError PixelGrabContextImpl::CaptureRegions(const PixelGrabRect* rects,
+                                                    int count,
+                                                    Image** out_images) {
+  if (out_images) {
+    for (int i = 0; i < count; ++i) out_images[i] = nullptr;
+  }
+  if (!initialized_) {
+    SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
+    return kPixelGrabErrorNotInitialized;
+  }
+  if (!rects || !out_images || count <= 0) {
+    SetError(kPixelGrabErrorInvalidParam,
+             "rects or out_images is NULL, or count is not positive");
+    return kPixelGrabErrorInvalidParam;
+  }
+  for (int i = 0; i < count; ++i) {
+    if (rects[i].width <= 0 || rects[i].height <= 0) {
+      SetError(kPixelGrabErrorInvalidParam,
+               "Region width and height must be positive");
+      return kPixelGrabErrorInvalidParam;
+    }
+  }
+
+  // Before leasing: refreshing the snapshot may need the primary backend.
+  auto screens = Screens();
+  auto backend = backends_.Acquire();
+  if (!backend) {
+    SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
+    return kPixelGrabErrorNotSupported;
+  }
+  const PixelGrabPixelFormat capture_format = capture_format_;
+
+  // Clip to the virtual desktop like a single capture would, so each
+  // cluster read comes back exactly the size of its bounding box.
+  int dx0 = 0, dy0 = 0, dx1 = 0, dy1 = 0;
+  for (size_t i = 0; i < screens->size(); ++i) {
+    const auto& s = (*screens)[i];
+    dx0 = i ? std::min(dx0, s.x) : s.x;
+    dy0 = i ? std::min(dy0, s.y) : s.y;
+    dx1 = i ? std::max(dx1, s.x + s.width) : s.x + s.width;
+    dy1 = i ? std::max(dy1, s.y + s.height) : s.y + s.height;
+  }
+  std::vector<PixelGrabRect> clipped;
+  std::vector<int> source_index;
+  for (int i = 0; i < count; ++i) {
+    const PixelGrabRect& r = rects[i];
+    int x0 = std::max(r.x, dx0);
+    int y0 = std::max(r.y, dy0);
+    int x1 = std::min(r.x + r.width, dx1);
+    int y1 = std::min(r.y + r.height, dy1);
+    if (x1 <= x0 || y1 <= y0) continue;  // Entirely off-screen.
+    clipped.push_back({x0, y0, x1 - x0, y1 - y0});
+    source_index.push_back(i);
+  }
+
+  int captured = 0;
+  ScopedOutputFormat format(backend.get(), capture_format);
+  auto clusters = CoalesceRegions(clipped);
+  std::vector<PixelGrabRect> bounds;
+  bounds.reserve(clusters.size());
+  for (const RegionCluster& cluster : clusters) {
+    bounds.push_back(cluster.bounds);
+  }
+  // One batch, so pipelining backends pay a single round-trip.
+  std::vector<std::unique_ptr<Image>> blocks;
+  {
+    StageTimer timer(&metrics_, kPixelGrabStageCapture);
+    blocks = backend->CaptureRegions(bounds);
+    uint64_t bytes = 0;
+    for (const auto& block : blocks) bytes += block ? block->data_size() : 0;
+    timer.set_bytes(bytes);
+    if (bytes == 0 && !bounds.empty()) timer.Fail();
+  }
+  for (size_t c = 0; c < clusters.size(); ++c) {
+    const RegionCluster& cluster = clusters[c];
+    const PixelGrabRect& b = cluster.bounds;
+    std::unique_ptr<Image> block =
+        c < blocks.size() ? std::move(blocks[c]) : nullptr;
+    if (block && (block->width() != b.width || block->height() != b.height ||
+                  !ConvertCaptured(block.get(), capture_format))) {
+      block.reset();
+    }
+    for (int member : cluster.members) {
+      const PixelGrabRect& r = clipped[member];
+      std::unique_ptr<Image> image;
+      if (block) {
+        // Zero-copy slice of the shared read.
+        image = block->CreateView(r.x - b.x, r.y - b.y, r.width, r.height);
+      } else {
+        {
+          StageTimer timer(&metrics_, kPixelGrabStageCapture);
+          image = backend->CaptureRegion(r.x, r.y, r.width, r.height);
+          NoteCapture(&timer, image.get());
+        }
+        if (image && !ConvertCaptured(image.get(), capture_format)) {
+          image.reset();
+        }
+      }
+      if (!image) continue;
+      out_images[source_index[member]] = image.release();
+      ++captured;
+    }
+  }
+
+  PIXELGRAB_LOG_DEBUG("CaptureRegions: {} of {} regions captured", captured,
+                      count);
+  if (captured < count) {
+    SetError(kPixelGrabErrorCaptureFailed,
+             "Some regions could not be captured");
+    return kPixelGrabErrorCaptureFailed;
+  }
+  ClearError();
+  return kPixelGrabOk;
+}
+
+PixelGrabError PixelGrabContextImpl::SetCaptureFormat(
+    PixelGrabPixelFormat format) {
+  if (format != kPixelGrabFormatBgra8 && format != kPixelGrabFormatRgba8 &&
+      format != kPixelGrabFormatNative) {
+    SetError(kPixelGrabErrorInvalidParam, "Unknown pixel format");
+    return kPixelGrabErrorInvalidParam;
+  }
+  capture_format_ = format;
+  ClearError();
+  return kPixelGrabOk;
+}
+
+PixelGrabPixelFormat PixelGrabContextImpl::GetCaptureFormat() const {
+  return capture_format_;
+}
+
+PixelGrabError PixelGrabContextImpl::SetWindowCaptureMode(
+    PixelGrabWindowCaptureMode mode) {
+  if (!initialized_) {
+    SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
+    return kPixelGrabErrorNotInitialized;
+  }
+  if (mode != kPixelGrabWindowCaptureScreen &&
+      mode != kPixelGrabWindowCaptureContent) {
+    SetError(kPixelGrabErrorInvalidParam, "Unknown window capture mode");
+    return kPixelGrabErrorInvalidParam;
+  }
+  // Window captures always run on the primary backend.
+  auto backend = backends_.LockPrimary();
+  if (!backend || !backend->SetWindowCaptureMode(mode)) {
+    SetError(kPixelGrabErrorNotSupported,
+             "Window capture mode not supported on this platform");
+    return kPixelGrabErrorNotSupported;
+  }
+  window_capture_mode_ = mode;
+  PIXELGRAB_LOG_INFO("Window capture mode: {}",
+                     mode == kPixelGrabWindowCaptureContent ? "content"
+                                                            : "screen");
+  ClearError();
+  return kPixelGrabOk;
+}
+
+PixelGrabWindowCaptureMode PixelGrabContextImpl::GetWindowCaptureMode() const {
+  return window_capture_mode_;
+}
+
+PixelGrabError PixelGrabContextImpl::CaptureRegionInto(int x, int y, int width,
+                                                       int height, uint8_t* dst,
+                                                       int dst_stride) {
+  if (!initialized_) {
+    SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
+    return kPixelGrabErrorNotInitialized;
+  }
+  if (width <= 0 || height <= 0) {
+    SetError(kPixelGrabErrorInvalidParam,
+             "Region width and height must be positive");
+    return kPixelGrabErrorInvalidParam;
+  }
+  if (!dst || dst_stride / 4 < width) {
+    SetError(kPixelGrabErrorInvalidParam,
+             "Destination is NULL or dst_stride is smaller than width * 4");
+    return kPixelGrabErrorInvalidParam;
+  }
+
+  auto backend = backends_.Acquire();
+  if (!backend) {
+    SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
+    return kPixelGrabErrorNotSupported;
+  }
+
+  StageTimer timer(&metrics_, kPixelGrabStageCapture);
+  timer.set_bytes(static_cast<uint64_t>(width) * height * 4);
+  if (!backend->CaptureRegionInto(x, y, width, height, dst, dst_stride)) {
+    timer.Fail();
+    SetError(kPixelGrabErrorCaptureFailed, "Region capture failed");
+    return kPixelGrabErrorCaptureFailed;
+  }
+
+  ClearError();
+  return kPixelGrabOk;
+}
+
+Image* PixelGrabContextImpl::CaptureRegionScaled(int x, int y, int width,
+                                                 int height, int out_width,
+                                                 int out_height,
+                                                 PixelGrabResizeFilter filter) {
+  if (!initialized_) {
+    SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
+    return nullptr;
+  }
+  if (width <= 0 || height <= 0 || out_width <= 0 || out_height <= 0) {
+    SetError(kPixelGrabErrorInvalidParam,
+             "Region and output sizes must be positive");
+    return nullptr;
+  }
+  if (!IsValidResizeFilter(filter)) {
+    SetError(kPixelGrabErrorInvalidParam, "Unknown resize filter");
+    return nullptr;
+  }
+
+  auto backend = backends_.Acquire();
+  if (!backend) {
+    SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
+    return nullptr;
+  }
+  const PixelGrabPixelFormat capture_format = capture_format_;
+
+  auto image =
+      Image::CreateUninitialized(out_width, out_height, kPixelGrabFormatBgra8);
+  if (!image) {
+    SetError(kPixelGrabErrorOutOfMemory, "Failed to allocate scaled image");
+    return nullptr;
+  }
+
+  PIXELGRAB_LOG_DEBUG("CaptureRegionScaled(x={}, y={}, w={}, h={} -> {}x{})",
+                      x, y, width, height, out_width, out_height);
+
+  ImageResampler resampler(width, height, out_width, out_height, filter);
+  const int strip_stride = width * 4;
+  std::vector<uint8_t> strip(static_cast<size_t>(strip_stride) *
+                             std::min(height, kScaledCaptureStripRows));
+  bool any_captured = false;
+  for (int row = 0; row < height && !resampler.done();
+       row += kScaledCaptureStripRows) {
+    const int rows = std::min(kScaledCaptureStripRows, height - row);
+    // Off-screen parts are left untouched by the backend; keep them black.
+    std::memset(strip.data(), 0, strip.size());
+    {
+      StageTimer timer(&metrics_, kPixelGrabStageCapture);
+      timer.set_bytes(static_cast<uint64_t>(strip_stride) * rows);
+      if (backend->CaptureRegionInto(x, y + row, width, rows, strip.data(),
+                                     strip_stride)) {
+        any_captured = true;
+      } else {
+        timer.Fail();
+      }
+    }
+    resampler.PushRows(strip.data(), strip_stride, rows,
+                       image->mutable_data(), image->stride());
+  }
+  if (!any_captured || !ConvertCaptured(image.get(), capture_format)) {
+    SetError(kPixelGrabErrorCaptureFailed, "Scaled region capture failed");
+    return nullptr;
+  }
+
+  ClearError();
+  return image.release();
+}
+
+PixelGrabError PixelGrabContextImpl::CaptureScreenInto(int screen_index,
+                                                       uint8_t* dst,
+                                                       int dst_stride) {
+  PixelGrabScreenInfo info{};
+  {
+    if (!initialized_) {
+      SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
+      return kPixelGrabErrorNotInitialized;
+    }
+    auto screens = Screens();
+    if (screen_index < 0 ||
+        screen_index >= static_cast<int>(screens->size())) {
+      SetError(kPixelGrabErrorInvalidParam, "Screen index out of range");
+      return kPixelGrabErrorInvalidParam;
+    }
+    info = (*screens)[screen_index];
+  }
+  return CaptureRegionInto(info.x, info.y, info.width, info.height, dst,
+                           dst_stride);
+}
+
+Image* PixelGrabContextImpl::CaptureRegionIncremental(
+    int x, int y, int width, int height, PixelGrabRect* out_changed,
+    int max_changed, int* out_changed_count) {
+  if (out_changed_count) *out_changed_count = 0;
+  if (!initialized_) {
+    SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
+    return nullptr;
+  }
+  if (width <= 0 || height <= 0) {
+    SetError(kPixelGrabErrorInvalidParam,
+             "Region width and height must be positive");
+    return nullptr;
+  }
+  if (out_changed && max_changed <= 0) {
+    SetError(kPixelGrabErrorInvalidParam,
+             "max_changed must be positive when out_changed is given");
+    return nullptr;
+  }
+
+  auto backend = backends_.LockPrimary();
+  if (!backend) {
+    SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
+    return nullptr;
+  }
+  const PixelGrabPixelFormat capture_format = capture_format_;
+
+  std::vector<PixelGrabRect> changed;
+  std::unique_ptr<Image> image;
+  {
+    StageTimer timer(&metrics_, kPixelGrabStageCapture);
+    image = backend->CaptureRegionIncremental(x, y, width, height, &changed);
+    NoteCapture(&timer, image.get());
+  }
+  if (!image || !ConvertCaptured(image.get(), capture_format)) {
+    SetError(kPixelGrabErrorCaptureFailed, "Incremental capture failed");
+    return nullptr;
+  }
+
+  int count = static_cast<int>(changed.size());
+  if (out_changed && count > max_changed) {
+    // Too many to return individually: report their bounding box.
+    PixelGrabRect bbox = changed[0];
+    int x1 = bbox.x + bbox.width, y1 = bbox.y + bbox.height;
+    for (const auto& r : changed) {
+      bbox.x = std::min(bbox.x, r.x);
+      bbox.y = std::min(bbox.y, r.y);
+      x1 = std::max(x1, r.x + r.width);
+      y1 = std::max(y1, r.y + r.height);
+    }
+    bbox.width = x1 - bbox.x;
+    bbox.height = y1 - bbox.y;
+    changed.assign(1, bbox);
+    count = 1;
+  }
+  if (out_changed) {
+    for (int i = 0; i < count; ++i) out_changed[i] = changed[i];
+  }
+  if (out_changed_count) *out_changed_count = count;
+
+  PIXELGRAB_LOG_DEBUG("Incremental capture ({},{}) {}x{}: {} changed rects",
+                      x, y, width, height, count);
+  ClearError();
+  return image.release();
+}
+
+void PixelGrabContextImpl::ResetIncrementalCapture() {
+  auto backend = backends_.LockPrimary();
+  if (backend) backend->ResetIncrementalCapture();
+}
+
+std::unique_ptr<CaptureStream> PixelGrabContextImpl::CreateStream(
+    const PixelGrabRect* region, int fps, int ring_depth) {
+  if (!initialized_) {
+    SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
+    return nullptr;
+  }
+  if (!region || region->width <= 0 || region->height <= 0) {
+    SetError(kPixelGrabErrorInvalidParam,
+             "Region is NULL or has a non-positive size");
+    return nullptr;
+  }
+  if (fps < 1 || fps > 240) {
+    SetError(kPixelGrabErrorInvalidParam, "fps must be in 1..240");
+    return nullptr;
+  }
+  if (ring_depth < 2 || ring_depth > 64) {
+    SetError(kPixelGrabErrorInvalidParam, "ring_depth must be in 2..64");
+    return nullptr;
+  }
+
+  if (!backends_.primary()) {
+    SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
+    return nullptr;
+  }
+  const PixelGrabPixelFormat capture_format = capture_format_;
+
+  // The stream thread gets its own backend (and display connection) so it
+  // never needs this context's lock.
+  auto stream_backend = backend_factory_();
+  if (!stream_backend || !stream_backend->Initialize()) {
+    SetError(kPixelGrabErrorCaptureFailed,
+             "Failed to initialize stream capture backend");
+    return nullptr;
+  }
+
+  auto stream = std::make_unique<CaptureStream>(
+      std::move(stream_backend), *region, fps, ring_depth, capture_format);
+  if (!stream->Start()) {
+    SetError(kPixelGrabErrorOutOfMemory, "Failed to allocate stream frames");
+    return nullptr;
+  }
+
+  ClearError();
+  return stream;
+}
+
+std::unique_ptr<CaptureBackend>
+PixelGrabContextImpl::CreateRecorderCaptureBackend() {
+  if (!initialized_ || !backends_.primary()) return nullptr;
+  // Like a stream, the recorder captures on its own connection so that it
+  // never competes with leases on the pool.
+  auto backend = backend_factory_();
+  if (!backend || !backend->Initialize()) {
+    PIXELGRAB_LOG_WARN("Failed to initialize recorder capture backend");
+    return nullptr;
+  }
+  return backend;
+}
+
 Image* PixelGrabContextImpl::CaptureWindow(uint64_t window_handle) {
-  std::lock_guard<std::mutex> lock(mu_);
   if (!initialized_) {
     SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
     return nullptr;
@@ -185,15 +787,23 @@ Image* PixelGrabContextImpl::CaptureWindow(uint64_t window_handle) {
     return nullptr;
   }
 
-  if (!backend_) {
+  auto backend = backends_.LockPrimary();
+  if (!backend) {
     SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
     return nullptr;
   }
+  const PixelGrabPixelFormat capture_format = capture_format_;
 
   PIXELGRAB_LOG_DEBUG("CaptureWindow(handle=0x{:X})", window_handle);
 
-  auto image = backend_->CaptureWindow(window_handle);
-  if (!image) {
+  std::unique_ptr<Image> image;
+  {
+    ScopedOutputFormat format(backend.get(), capture_format);
+    StageTimer timer(&metrics_, kPixelGrabStageCapture);
+    image = backend->CaptureWindow(window_handle);
+    NoteCapture(&timer, image.get());
+  }
+  if (!image || !ConvertCaptured(image.get(), capture_format)) {
     SetError(kPixelGrabErrorCaptureFailed, "Window capture failed");
     return nullptr;
   }
@@ -206,6 +816,7 @@ Image* PixelGrabContextImpl::CaptureWindow(uint64_t window_handle) {
 
 int PixelGrabContextImpl::EnumerateWindows(PixelGrabWindowInfo* out_windows,
                                            int max_count) {
+  // The primary backend keeps the window cache, updated during enumeration.
   if (!initialized_) {
     SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
     return -1;
@@ -216,12 +827,13 @@ int PixelGrabContextImpl::EnumerateWindows(PixelGrabWindowInfo* out_windows,
     return -1;
   }
 
-  if (!backend_) {
+  auto backend = backends_.LockPrimary();
+  if (!backend) {
     SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
     return -1;
   }
 
-  auto windows = backend_->EnumerateWindows();
+  auto windows = backend->EnumerateWindows();
   int count = std::min(static_cast<int>(windows.size()), max_count);
   for (int i = 0; i < count; ++i) {
     out_windows[i] = windows[i];
@@ -241,19 +853,22 @@ PixelGrabError PixelGrabContextImpl::EnableDpiAwareness() {
     return kPixelGrabErrorNotInitialized;
   }
 
-  if (!backend_) {
-    SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
-    return kPixelGrabErrorNotSupported;
-  }
+  {
+    auto backend = backends_.LockPrimary();
+    if (!backend) {
+      SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
+      return kPixelGrabErrorNotSupported;
+    }
 
-  if (!backend_->EnableDpiAwareness()) {
-    SetError(kPixelGrabErrorNotSupported, "DPI awareness not supported");
-    return kPixelGrabErrorNotSupported;
+    if (!backend->EnableDpiAwareness()) {
+      SetError(kPixelGrabErrorNotSupported, "DPI awareness not supported");
+      return kPixelGrabErrorNotSupported;
+    }
   }
 
   // Invalidate cache and refresh screens after DPI change.
-  screens_cache_time_ = {};
-  RefreshScreens();
+  screens_dirty_ = true;
+  Screens();
   ClearError();
   return kPixelGrabOk;
 }
@@ -269,12 +884,13 @@ PixelGrabError PixelGrabContextImpl::GetDpiInfo(int screen_index,
     return kPixelGrabErrorInvalidParam;
   }
 
-  if (!backend_) {
+  auto backend = backends_.LockPrimary();
+  if (!backend) {
     SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
     return kPixelGrabErrorNotSupported;
   }
 
-  if (!backend_->GetDpiInfo(screen_index, out_info)) {
+  if (!backend->GetDpiInfo(screen_index, out_info)) {
     SetError(kPixelGrabErrorInvalidParam,
              "Failed to get DPI info for screen index");
     return kPixelGrabErrorInvalidParam;
@@ -296,13 +912,14 @@ PixelGrabError PixelGrabContextImpl::LogicalToPhysical(
     return kPixelGrabErrorInvalidParam;
   }
 
-  if (!backend_) {
+  auto backend = backends_.LockPrimary();
+  if (!backend) {
     SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
     return kPixelGrabErrorNotSupported;
   }
 
   PixelGrabDpiInfo dpi = {};
-  if (!backend_->GetDpiInfo(screen_index, &dpi)) {
+  if (!backend->GetDpiInfo(screen_index, &dpi)) {
     SetError(kPixelGrabErrorInvalidParam, "Invalid screen index for DPI");
     return kPixelGrabErrorInvalidParam;
   }
@@ -325,13 +942,14 @@ PixelGrabError PixelGrabContextImpl::PhysicalToLogical(
     return kPixelGrabErrorInvalidParam;
   }
 
-  if (!backend_) {
+  auto backend = backends_.LockPrimary();
+  if (!backend) {
     SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
     return kPixelGrabErrorNotSupported;
   }
 
   PixelGrabDpiInfo dpi = {};
-  if (!backend_->GetDpiInfo(screen_index, &dpi)) {
+  if (!backend->GetDpiInfo(screen_index, &dpi)) {
     SetError(kPixelGrabErrorInvalidParam, "Invalid screen index for DPI");
     return kPixelGrabErrorInvalidParam;
   }
@@ -353,7 +971,6 @@ PixelGrabError PixelGrabContextImpl::PhysicalToLogical(
 
 PixelGrabError PixelGrabContextImpl::PickColor(int x, int y,
                                                PixelGrabColor* out_color) {
-  std::lock_guard<std::mutex> lock(mu_);
   if (!initialized_) {
     SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
     return kPixelGrabErrorNotInitialized;
@@ -363,13 +980,14 @@ PixelGrabError PixelGrabContextImpl::PickColor(int x, int y,
     return kPixelGrabErrorInvalidParam;
   }
 
-  if (!backend_) {
+  auto backend = backends_.Acquire();
+  if (!backend) {
     SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
     return kPixelGrabErrorNotSupported;
   }
 
   uint8_t bgra[4];
-  if (!backend_->GetPixelColor(x, y, bgra)) {
+  if (!backend->GetPixelColor(x, y, bgra)) {
     SetError(kPixelGrabErrorCaptureFailed, "Failed to capture pixel");
     return kPixelGrabErrorCaptureFailed;
   }
@@ -393,7 +1011,6 @@ static constexpr int kMaxMagnifierRadius = 500;
 
 Image* PixelGrabContextImpl::GetMagnifier(int x, int y, int radius,
                                           int magnification) {
-  std::lock_guard<std::mutex> lock(mu_);
   if (!initialized_) {
     SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
     return nullptr;
@@ -410,7 +1027,8 @@ Image* PixelGrabContextImpl::GetMagnifier(int x, int y, int radius,
     return nullptr;
   }
 
-  if (!backend_) {
+  auto backend = backends_.Acquire();
+  if (!backend) {
     SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
     return nullptr;
   }
@@ -426,7 +1044,12 @@ Image* PixelGrabContextImpl::GetMagnifier(int x, int y, int radius,
   int src_x = x - radius;
   int src_y = y - radius;
 
-  auto src = backend_->CaptureRegion(src_x, src_y, src_size, src_size);
+  std::unique_ptr<Image> src;
+  {
+    StageTimer timer(&metrics_, kPixelGrabStageCapture);
+    src = backend->CaptureRegion(src_x, src_y, src_size, src_size);
+    NoteCapture(&timer, src.get());
+  }
   if (!src) {
     SetError(kPixelGrabErrorCaptureFailed, "Failed to capture magnifier region");
     return nullptr;
@@ -619,14 +1242,13 @@ PixelGrabError PixelGrabContextImpl::HistoryGetEntry(
 }
 
 Image* PixelGrabContextImpl::HistoryRecapture(int history_id) {
-  std::lock_guard<std::mutex> lock(mu_);
   if (!initialized_) {
     SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
     return nullptr;
   }
 
-  const HistoryEntry* entry = capture_history_.FindById(history_id);
-  if (!entry) {
+  HistoryEntry entry;
+  if (!capture_history_.FindById(history_id, &entry)) {
     SetError(kPixelGrabErrorHistoryEmpty, "History entry not found");
     return nullptr;
   }
@@ -638,14 +1260,21 @@ Image* PixelGrabContextImpl::HistoryRecapture(int history_id) {
   }
 
   // Fallback: recapture from screen if no stored image is available.
-  if (!backend_) {
+  auto backend = backends_.Acquire();
+  if (!backend) {
     SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
     return nullptr;
   }
-  auto image = backend_->CaptureRegion(entry->region_x, entry->region_y,
-                                       entry->region_width,
-                                       entry->region_height);
-  if (!image) {
+  const PixelGrabPixelFormat capture_format = capture_format_;
+  std::unique_ptr<Image> image;
+  {
+    ScopedOutputFormat format(backend.get(), capture_format);
+    StageTimer timer(&metrics_, kPixelGrabStageCapture);
+    image = backend->CaptureRegion(entry.region_x, entry.region_y,
+                                   entry.region_width, entry.region_height);
+    NoteCapture(&timer, image.get());
+  }
+  if (!image || !ConvertCaptured(image.get(), capture_format)) {
     SetError(kPixelGrabErrorCaptureFailed, "Recapture failed");
     return nullptr;
   }
@@ -655,7 +1284,6 @@ Image* PixelGrabContextImpl::HistoryRecapture(int history_id) {
 }
 
 Image* PixelGrabContextImpl::RecaptureLast() {
-  std::lock_guard<std::mutex> lock(mu_);
   if (!initialized_) {
     SetError(kPixelGrabErrorNotInitialized, "Context not initialized");
     return nullptr;
@@ -679,14 +1307,21 @@ Image* PixelGrabContextImpl::RecaptureLast() {
   }
 
   // Fallback: recapture from screen if no stored image is available.
-  if (!backend_) {
+  auto backend = backends_.Acquire();
+  if (!backend) {
     SetError(kPixelGrabErrorNotSupported, "Capture backend not available");
     return nullptr;
   }
-  auto image = backend_->CaptureRegion(entry.region_x, entry.region_y,
-                                       entry.region_width,
-                                       entry.region_height);
-  if (!image) {
+  const PixelGrabPixelFormat capture_format = capture_format_;
+  std::unique_ptr<Image> image;
+  {
+    ScopedOutputFormat format(backend.get(), capture_format);
+    StageTimer timer(&metrics_, kPixelGrabStageCapture);
+    image = backend->CaptureRegion(entry.region_x, entry.region_y,
+                                   entry.region_width, entry.region_height);
+    NoteCapture(&timer, image.get());
+  }
+  if (!image || !ConvertCaptured(image.get(), capture_format)) {
     SetError(kPixelGrabErrorCaptureFailed, "Recapture failed");
     return nullptr;
   }
@@ -695,6 +1330,21 @@ Image* PixelGrabContextImpl::RecaptureLast() {
   return image.release();
 }
 
+Image* PixelGrabContextImpl::HistoryGetThumbnail(int history_id) {
+  if (!capture_history_.FindById(history_id, nullptr)) {
+    SetError(kPixelGrabErrorHistoryEmpty, "History entry not found");
+    return nullptr;
+  }
+  auto thumbnail = capture_history_.GetThumbnail(history_id);
+  if (!thumbnail) {
+    SetError(kPixelGrabErrorHistoryEmpty,
+             "No stored image for this history entry");
+    return nullptr;
+  }
+  ClearError();
+  return thumbnail.release();
+}
+
 void PixelGrabContextImpl::HistoryClear() {
   capture_history_.Clear();
 }
@@ -703,6 +1353,64 @@ void PixelGrabContextImpl::HistorySetMaxCount(int max_count) {
   capture_history_.SetMaxCount(max_count);
 }
 
+PixelGrabError PixelGrabContextImpl::HistorySetCodec(
+    PixelGrabHistoryCodec codec) {
+  if (!IsValidHistoryCodec(codec)) {
+    SetError(kPixelGrabErrorInvalidParam, "Unknown history codec");
+    return kPixelGrabErrorInvalidParam;
+  }
+  capture_history_.SetCodec(codec);
+  ClearError();
+  return kPixelGrabOk;
+}
+
+PixelGrabError PixelGrabContextImpl::HistoryGetUsage(
+    PixelGrabHistoryUsage* out_usage) {
+  if (!out_usage) {
+    SetError(kPixelGrabErrorInvalidParam, "out_usage is NULL");
+    return kPixelGrabErrorInvalidParam;
+  }
+  *out_usage = capture_history_.GetUsage();
+  ClearError();
+  return kPixelGrabOk;
+}
+
+PixelGrabError PixelGrabContextImpl::HistorySetKeyframeInterval(
+    int interval) {
+  if (interval < 1) {
+    SetError(kPixelGrabErrorInvalidParam,
+             "Keyframe interval must be at least 1");
+    return kPixelGrabErrorInvalidParam;
+  }
+  capture_history_.SetKeyframeInterval(interval);
+  ClearError();
+  return kPixelGrabOk;
+}
+
+PixelGrabError PixelGrabContextImpl::HistorySetThumbnailSize(int max_size) {
+  if (max_size < 1) {
+    SetError(kPixelGrabErrorInvalidParam,
+             "Thumbnail size must be at least 1");
+    return kPixelGrabErrorInvalidParam;
+  }
+  capture_history_.SetThumbnailSize(max_size);
+  ClearError();
+  return kPixelGrabOk;
+}
+
+PixelGrabError PixelGrabContextImpl::HistorySetQueue(
+    int max_pending, PixelGrabHistoryBackpressure policy) {
+  if (max_pending < 0 || policy < kPixelGrabHistoryBackpressureInline ||
+      policy > kPixelGrabHistoryBackpressureDrop) {
+    SetError(kPixelGrabErrorInvalidParam,
+             "Invalid history queue depth or backpressure policy");
+    return kPixelGrabErrorInvalidParam;
+  }
+  capture_history_.SetQueue(max_pending, policy);
+  ClearError();
+  return kPixelGrabOk;
+}
+
 // ---------------------------------------------------------------------------
 // Clipboard reader (lazy init)
 // ---------------------------------------------------------------------------
@@ -710,7 +1418,7 @@ void PixelGrabContextImpl::HistorySetMaxCount(int max_count) {
 ClipboardReader* PixelGrabContextImpl::clipboard_reader() {
   if (!clipboard_reader_) {
     PIXELGRAB_LOG_DEBUG("Lazy-initializing clipboard reader");
-    clipboard_reader_ = CreatePlatformClipboardReader();
+    clipboard_reader_ = CreatePlatformClipboardReader(display_manager_.get());
   }
   return clipboard_reader_.get();
 }
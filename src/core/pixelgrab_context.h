@@ -3,6 +3,7 @@
 #ifndef PIXELGRAB_CORE_PIXELGRAB_CONTEXT_H_
 #define PIXELGRAB_CORE_PIXELGRAB_CONTEXT_H_
 
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <mutex>
@@ -11,11 +12,15 @@
 
 #include "core/audio_backend.h"
 #include "core/capture_backend.h"
+#include "core/capture_backend_pool.h"
 #include "ocr/ocr_backend.h"
 #include "translate/translate_backend.h"
 #include "core/capture_history.h"
+#include "core/capture_stream.h"
 #include "core/color_utils.h"
+#include "core/display_manager.h"
 #include "core/image.h"
+#include "core/metrics.h"
 #include "detection/element_detector.h"
 #include "detection/snap_engine.h"
 #include "pin/clipboard_reader.h"
@@ -30,6 +35,12 @@ namespace internal {
 ///
 /// Owns the platform backend and provides the bridge between the public C API
 /// and the internal C++ implementation.
+///
+/// Captures lease a backend from |backends_|, so calls from different
+/// threads only wait for each other when they need the same connection
+/// (window capture, damage tracking and enumeration use the primary one).
+/// The screen list is published as an immutable snapshot and the history
+/// locks internally; |mu_| only serializes initialization.
 class PixelGrabContextImpl {
  public:
   PixelGrabContextImpl();
@@ -40,15 +51,18 @@ class PixelGrabContextImpl {
   PixelGrabContextImpl& operator=(const PixelGrabContextImpl&) = delete;
 
   /// Initialize the context and its backend.
-  bool Initialize();
+  bool Initialize(const PixelGrabContextOptions& options = {});
+
+  /// Backend in use (the default one if the requested type is unavailable).
+  PixelGrabBackendType backend_type() const { return backend_type_; }
 
   /// Check if the context has been successfully initialized.
   bool is_initialized() const { return initialized_; }
 
   // -- Error state --
 
-  PixelGrabError last_error() const { return last_error_; }
-  const char* last_error_message() const { return last_error_message_.c_str(); }
+  PixelGrabError last_error() const;
+  const char* last_error_message() const;
 
   void SetError(PixelGrabError code, const std::string& message);
   void ClearError();
@@ -66,6 +80,46 @@ class PixelGrabContextImpl {
   Image* CaptureRegion(int x, int y, int width, int height);
   Image* CaptureWindow(uint64_t window_handle);
 
+  /// Pixel format of images returned by the capture calls above, the
+  /// incremental capture and history recaptures.  Defaults to Bgra8.
+  PixelGrabError SetCaptureFormat(PixelGrabPixelFormat format);
+  PixelGrabPixelFormat GetCaptureFormat() const;
+
+  /// How CaptureWindow() reads window pixels.  Applied to the backend
+  /// immediately; NotSupported if the backend cannot provide |mode|.
+  PixelGrabError SetWindowCaptureMode(PixelGrabWindowCaptureMode mode);
+  PixelGrabWindowCaptureMode GetWindowCaptureMode() const;
+
+  /// Capture several regions with as few backend reads as possible; see
+  /// pixelgrab_capture_regions.  |out_images| receives |count| entries.
+  PixelGrabError CaptureRegions(const PixelGrabRect* rects, int count,
+                                Image** out_images);
+
+  /// Capture into caller-owned BGRA8 memory (no Image allocation, not
+  /// recorded in history).
+  PixelGrabError CaptureRegionInto(int x, int y, int width, int height,
+                                   uint8_t* dst, int dst_stride);
+  PixelGrabError CaptureScreenInto(int screen_index, uint8_t* dst,
+                                   int dst_stride);
+
+  /// Capture a region in horizontal strips, resampling each strip towards
+  /// |out_width| x |out_height| as it arrives (not recorded in history).
+  /// See pixelgrab_capture_region_scaled.
+  Image* CaptureRegionScaled(int x, int y, int width, int height,
+                             int out_width, int out_height,
+                             PixelGrabResizeFilter filter);
+
+  /// Damage-tracked region capture; see pixelgrab_capture_region_incremental.
+  Image* CaptureRegionIncremental(int x, int y, int width, int height,
+                                  PixelGrabRect* out_changed, int max_changed,
+                                  int* out_changed_count);
+  void ResetIncrementalCapture();
+
+  /// Validate the arguments and start a capture stream with a dedicated
+  /// backend instance.  Returns nullptr (with the error set) on failure.
+  std::unique_ptr<CaptureStream> CreateStream(const PixelGrabRect* region,
+                                              int fps, int ring_depth);
+
   // -- Window enumeration --
 
   int EnumerateWindows(PixelGrabWindowInfo* out_windows, int max_count);
@@ -102,9 +156,16 @@ class PixelGrabContextImpl {
   int HistoryCount() const;
   PixelGrabError HistoryGetEntry(int index, PixelGrabHistoryEntry* out_entry);
   Image* HistoryRecapture(int history_id);
+  Image* HistoryGetThumbnail(int history_id);
   Image* RecaptureLast();
   void HistoryClear();
   void HistorySetMaxCount(int max_count);
+  PixelGrabError HistorySetCodec(PixelGrabHistoryCodec codec);
+  PixelGrabError HistoryGetUsage(PixelGrabHistoryUsage* out_usage);
+  PixelGrabError HistorySetKeyframeInterval(int interval);
+  PixelGrabError HistorySetThumbnailSize(int max_size);
+  PixelGrabError HistorySetQueue(int max_pending,
+                                PixelGrabHistoryBackpressure policy);
 
   // -- Pin windows --
 
@@ -135,26 +196,59 @@ class PixelGrabContextImpl {
   /// Get the audio backend (lazy-initialized).
   AudioBackend* audio_backend();
 
+  // -- Statistics --
+
+  /// Per-stage counters and latencies of this context; samples are also
+  /// forwarded to MetricsRegistry::Global().
+  MetricsRegistry& metrics() { return metrics_; }
+  const MetricsRegistry& metrics() const { return metrics_; }
+
   // -- Recorder support --
 
-  /// Get the capture backend (used by Recorder for frame capture).
-  CaptureBackend* capture_backend() { return backend_.get(); }
+  /// A dedicated, initialized capture backend for a recorder's capture
+  /// thread, or nullptr if none can be opened.
+  std::unique_ptr<CaptureBackend> CreateRecorderCaptureBackend();
 
  private:
-  /// Ensure screens cache is populated.
-  void RefreshScreens();
+  using ScreenList = std::vector<PixelGrabScreenInfo>;
 
-  std::unique_ptr<CaptureBackend> backend_;
-  std::vector<PixelGrabScreenInfo> cached_screens_;
-  std::chrono::steady_clock::time_point screens_cache_time_{};
+  /// Current screen list, refreshed first if stale.  Backends that report
+  /// layout changes are re-queried only after a change notification; others
+  /// fall back to a short TTL.  While another thread refreshes (or holds
+  /// the primary backend) the previous snapshot is returned.  Never null.
+  std::shared_ptr<const ScreenList> Screens();
+
+  /// ConvertImageFormat() on a non-null captured image, timed as
+  /// kPixelGrabStageConvert when pixels actually move.
+  bool ConvertCaptured(Image* image, PixelGrabPixelFormat format);
+
+  CaptureBackendPool backends_;
+  PixelGrabBackendType backend_type_ = kPixelGrabBackendDefault;
+  CaptureBackendPool::Factory backend_factory_;  // Set by Initialize().
   bool initialized_ = false;
+  std::atomic<PixelGrabPixelFormat> capture_format_{kPixelGrabFormatBgra8};
+  std::atomic<PixelGrabWindowCaptureMode> window_capture_mode_{
+      kPixelGrabWindowCaptureScreen};
+
+  // Screen list snapshot; read and replaced with std::atomic_load/store.
+  std::shared_ptr<const ScreenList> screens_;
+  std::atomic<bool> screens_dirty_{true};
+  std::mutex screens_mu_;  // Serializes refreshes.
+  std::chrono::steady_clock::time_point screens_cache_time_{};  // screens_mu_
+
+  // Shared display connections for the subsystems below (null on
+  // platforms that don't need them).  Declared first so it outlives them.
+  std::unique_ptr<DisplayManager> display_manager_;
 
   // Element detection.
   std::unique_ptr<ElementDetector> element_detector_;
   std::unique_ptr<SnapEngine> snap_engine_;
 
+  // Statistics; declared before the members that record into it.
+  MetricsRegistry metrics_{&MetricsRegistry::Global()};
+
   // Capture history.
-  CaptureHistory capture_history_;
+  CaptureHistory capture_history_{&metrics_};
 
   // Pin window management.
   PinWindowManager pin_manager_;
@@ -174,14 +268,13 @@ class PixelGrabContextImpl {
   // Audio backend (lazy-initialized).
   std::unique_ptr<AudioBackend> audio_backend_;
 
-  // Error state (per-context, so thread-safe across contexts).
+  // Error state (per-context; with concurrent callers it reflects the call
+  // that finished last).
+  mutable std::mutex error_mu_;
   PixelGrabError last_error_ = kPixelGrabOk;
   std::string last_error_message_ = "No error";
 
-  // Guards all mutable state on a single context instance.
-  // The public API documents that concurrent calls on the SAME context
-  // require external synchronization; this mutex provides it internally
-  // so callers sharing a context don't need their own lock.
+  // Serializes Initialize().  Captures do not take it.
   mutable std::mutex mu_;
 };
 
@@ -0,0 +1,84 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Grouping of capture rectangles into shared fetches.
+
+#include "core/region_batch.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+namespace pixelgrab {
+namespace internal {
+
+namespace {
+
+int64_t Area(const PixelGrabRect& r) {
+  return static_cast<int64_t>(r.width) * r.height;
+}
+
+PixelGrabRect Union(const PixelGrabRect& a, const PixelGrabRect& b) {
+  int x0 = std::min(a.x, b.x);
+  int y0 = std::min(a.y, b.y);
+  int x1 = std::max(a.x + a.width, b.x + b.width);
+  int y1 = std::max(a.y + a.height, b.y + b.height);
+  return {x0, y0, x1 - x0, y1 - y0};
+}
+
+struct Working {
+  RegionCluster cluster;
+  int64_t covered = 0;  // Sum of member areas (overlaps counted twice).
+};
+
+}  // namespace
+
+std::vector<RegionCluster> CoalesceRegions(
+    const std::vector<PixelGrabRect>& rects, int64_t max_waste_pixels) {
+  std::vector<Working> work;
+  work.reserve(rects.size());
+  for (size_t i = 0; i < rects.size(); ++i) {
+    Working w;
+    w.cluster.bounds = rects[i];
+    w.cluster.members.push_back(static_cast<int>(i));
+    w.covered = Area(rects[i]);
+    work.push_back(std::move(w));
+  }
+
+  // Repeatedly merge the pair with the least wasted area until no pair is
+  // cheap enough.  Batches are tens of rectangles, so O(n^3) is fine.
+  for (;;) {
+    int64_t best_waste = max_waste_pixels + 1;
+    size_t best_a = 0, best_b = 0;
+    for (size_t a = 0; a < work.size(); ++a) {
+      for (size_t b = a + 1; b < work.size(); ++b) {
+        PixelGrabRect u = Union(work[a].cluster.bounds, work[b].cluster.bounds);
+        int64_t waste = Area(u) - work[a].covered - work[b].covered;
+        if (waste < best_waste) {
+          best_waste = waste;
+          best_a = a;
+          best_b = b;
+        }
+      }
+    }
+    if (best_waste > max_waste_pixels) break;
+
+    Working& into = work[best_a];
+    Working& from = work[best_b];
+    into.cluster.bounds = Union(into.cluster.bounds, from.cluster.bounds);
+    into.cluster.members.insert(into.cluster.members.end(),
+                                from.cluster.members.begin(),
+                                from.cluster.members.end());
+    // Never let "covered" exceed the box, or overlapping members would
+    // make every further merge look free.
+    into.covered = std::min(into.covered + from.covered,
+                            Area(into.cluster.bounds));
+    work.erase(work.begin() + static_cast<std::ptrdiff_t>(best_b));
+  }
+
+  std::vector<RegionCluster> clusters;
+  clusters.reserve(work.size());
+  for (auto& w : work) clusters.push_back(std::move(w.cluster));
+  return clusters;
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
@@ -0,0 +1,37 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Grouping of capture rectangles into shared fetches.
+
+#ifndef PIXELGRAB_CORE_REGION_BATCH_H_
+#define PIXELGRAB_CORE_REGION_BATCH_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "pixelgrab/pixelgrab.h"
+
+namespace pixelgrab {
+namespace internal {
+
+/// Extra pixels worth fetching to save one server round trip.  About
+/// 256 KB of BGRA: below this, reading the gap between two rectangles is
+/// cheaper than a second XGetImage / XShmGetImage request.
+constexpr int64_t kRoundTripPixels = 256 * 256;
+
+/// A set of rectangles fetched together through their bounding box.
+struct RegionCluster {
+  PixelGrabRect bounds;      ///< Bounding box of all members.
+  std::vector<int> members;  ///< Indices into the input rectangles.
+};
+
+/// Greedily merge |rects| (all non-empty) into clusters.  Two clusters are
+/// merged while the pixels their combined bounding box adds on top of the
+/// pixels they already cover stay within |max_waste_pixels|.  Every input
+/// index appears in exactly one cluster.
+std::vector<RegionCluster> CoalesceRegions(
+    const std::vector<PixelGrabRect>& rects,
+    int64_t max_waste_pixels = kRoundTripPixels);
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_CORE_REGION_BATCH_H_
@@ -0,0 +1,38 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Compile-time SIMD availability shared by the vectorized kernels.
+//
+// Defines PIXELGRAB_HAVE_SSE2 / PIXELGRAB_HAVE_AVX2 / PIXELGRAB_HAVE_NEON
+// for the instruction sets the host compiler can emit, and includes their
+// intrinsics headers.  AVX2 functions must be marked PIXELGRAB_TARGET_AVX2
+// and only called after ActiveSimdLevel() reports kAvx2; the rest of the
+// library keeps the baseline ISA.
+
+#ifndef PIXELGRAB_CORE_SIMD_SUPPORT_H_
+#define PIXELGRAB_CORE_SIMD_SUPPORT_H_
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIXELGRAB_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define PIXELGRAB_HAVE_AVX2 1
+#define PIXELGRAB_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#define PIXELGRAB_HAVE_AVX2 1
+#define PIXELGRAB_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#endif
+
+#if (defined(__ARM_NEON) || defined(_M_ARM64)) && \
+    !(defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define PIXELGRAB_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#endif  // PIXELGRAB_CORE_SIMD_SUPPORT_H_
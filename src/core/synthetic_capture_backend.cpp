@@ -0,0 +1,428 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Display-less capture backend that renders a reproducible animated scene.
+
+#include "core/synthetic_capture_backend.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "core/logger.h"
+#include "core/pixel_convert.h"
+
+namespace pixelgrab {
+namespace internal {
+
+namespace {
+
+constexpr int kTile = 64;
+constexpr int kTextureSize = 256;  // Power of two; coordinates wrap.
+constexpr int kWindowsPerScreen = 3;
+constexpr int kMaxScreens = 16;
+constexpr int kMaxScreenSize = 16384;
+
+// Tile kinds.  Animated kinds compare >= kTileAnimatedGradient.
+constexpr int kTileFlat = 0;
+constexpr int kTileStaticGradient = 1;
+constexpr int kTileAnimatedGradient = 2;
+constexpr int kTileScrollingText = 3;
+
+// Light UI panel colours plus a dark one, as B, G, R.
+constexpr uint8_t kPanelColors[4][3] = {
+    {0xF3, 0xF3, 0xF3}, {0xFF, 0xFF, 0xFF}, {0x2B, 0x2B, 0x2B},
+    {0xEE, 0xE6, 0xE1}};
+
+uint64_t Mix(uint64_t seed, uint64_t a, uint64_t b) {
+  // splitmix64 finalizer over the combined inputs.
+  uint64_t z =
+      seed ^ (a * 0x9E3779B97F4A7C15ull) ^ (b * 0xC2B2AE3D27D4EB4Full);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+std::string ReadEnv(const char* name) {
+  std::string value;
+#ifdef _WIN32
+  char* env = nullptr;
+  size_t env_len = 0;
+  if (_dupenv_s(&env, &env_len, name) == 0 && env) {
+    value = env;
+    free(env);
+  }
+#else
+  const char* env = std::getenv(name);
+  if (env) value = env;
+#endif
+  return value;
+}
+
+inline void Put(uint8_t* p, int b, int g, int r) {
+  p[0] = static_cast<uint8_t>(b);
+  p[1] = static_cast<uint8_t>(g);
+  p[2] = static_cast<uint8_t>(r);
+  p[3] = 0xFF;
+}
+
+bool Intersect(const PixelGrabRect& a, const PixelGrabRect& b,
+               PixelGrabRect* out) {
+  int x0 = std::max(a.x, b.x);
+  int y0 = std::max(a.y, b.y);
+  int x1 = std::min(a.x + a.width, b.x + b.width);
+  int y1 = std::min(a.y + a.height, b.y + b.height);
+  if (x1 <= x0 || y1 <= y0) return false;
+  *out = {x0, y0, x1 - x0, y1 - y0};
+  return true;
+}
+
+}  // namespace
+
+PixelGrabSyntheticConfig NormalizeSyntheticConfig(
+    const PixelGrabSyntheticConfig* config) {
+  PixelGrabSyntheticConfig c = {};
+  if (config) {
+    c = *config;
+  } else {
+    c.damage_percent = 10;
+  }
+  if (c.screen_count <= 0) c.screen_count = 1;
+  if (c.screen_width <= 0) c.screen_width = 1920;
+  if (c.screen_height <= 0) c.screen_height = 1080;
+  c.screen_count = std::min(c.screen_count, kMaxScreens);
+  c.screen_width = std::min(c.screen_width, kMaxScreenSize);
+  c.screen_height = std::min(c.screen_height, kMaxScreenSize);
+  c.damage_percent = std::max(0, std::min(c.damage_percent, 100));
+  c.fps = std::max(0, std::min(c.fps, 1000));
+  return c;
+}
+
+bool SyntheticBackendRequestedByEnv() {
+  return ReadEnv("PIXELGRAB_BACKEND") == "synthetic";
+}
+
+PixelGrabSyntheticConfig SyntheticConfigFromEnv() {
+  PixelGrabSyntheticConfig c = NormalizeSyntheticConfig(nullptr);
+  const std::string spec = ReadEnv("PIXELGRAB_SYNTHETIC");
+  size_t pos = 0;
+  while (pos < spec.size()) {
+    size_t end = spec.find(',', pos);
+    if (end == std::string::npos) end = spec.size();
+    const std::string item = spec.substr(pos, end - pos);
+    pos = end + 1;
+    const size_t eq = item.find('=');
+    if (eq == std::string::npos) continue;
+    const std::string key = item.substr(0, eq);
+    const long value = std::strtol(item.c_str() + eq + 1, nullptr, 10);
+    if (key == "screens") {
+      c.screen_count = static_cast<int>(value);
+    } else if (key == "width") {
+      c.screen_width = static_cast<int>(value);
+    } else if (key == "height") {
+      c.screen_height = static_cast<int>(value);
+    } else if (key == "damage") {
+      c.damage_percent = static_cast<int>(value);
+    } else if (key == "fps") {
+      c.fps = static_cast<int>(value);
+    } else if (key == "seed") {
+      c.seed = static_cast<uint32_t>(value);
+    } else {
+      PIXELGRAB_LOG_WARN("Ignoring unknown PIXELGRAB_SYNTHETIC key '{}'",
+                         key);
+    }
+  }
+  return NormalizeSyntheticConfig(&c);
+}
+
+// ---------------------------------------------------------------------------
+// SyntheticClock
+// ---------------------------------------------------------------------------
+
+SyntheticClock::SyntheticClock(int fps)
+    : fps_(fps), start_(std::chrono::steady_clock::now()) {}
+
+uint64_t SyntheticClock::Next() {
+  if (fps_ <= 0) return counter_.fetch_add(1, std::memory_order_relaxed);
+  auto elapsed = std::chrono::steady_clock::now() - start_;
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+          .count() *
+      fps_ / 1000000);
+}
+
+// ---------------------------------------------------------------------------
+// SyntheticCaptureBackend
+// ---------------------------------------------------------------------------
+
+SyntheticCaptureBackend::SyntheticCaptureBackend(
+    const PixelGrabSyntheticConfig& config,
+    std::shared_ptr<SyntheticClock> clock)
+    : config_(NormalizeSyntheticConfig(&config)),
+      clock_(std::move(clock)),
+      desktop_width_(config_.screen_count * config_.screen_width),
+      desktop_height_(config_.screen_height) {}
+
+bool SyntheticCaptureBackend::Initialize() {
+  // Lines of 12-pixel glyph cells (6x10 ink) with word gaps.
+  text_.assign(static_cast<size_t>(kTextureSize) * kTextureSize, 0);
+  uint64_t state = Mix(config_.seed, 0x7E47, 0);
+  auto next = [&state]() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  };
+  for (int line = 0; line + 16 <= kTextureSize; line += 16) {
+    for (int cell = 0; cell + 8 <= kTextureSize; cell += 8) {
+      if (next() % 10 >= 7) continue;  // Space.
+      for (int gy = 2; gy < 12; ++gy) {
+        uint64_t bits = next();
+        for (int gx = 1; gx < 7; ++gx) {
+          if ((bits >> (gx * 5)) % 5 < 2) {
+            text_[(line + gy) * kTextureSize + cell + gx] = 1;
+          }
+        }
+      }
+    }
+  }
+  PIXELGRAB_LOG_DEBUG("Synthetic backend: {} screen(s) of {}x{}, {}% damage",
+                      config_.screen_count, config_.screen_width,
+                      config_.screen_height, config_.damage_percent);
+  return true;
+}
+
+void SyntheticCaptureBackend::Shutdown() { ResetIncrementalCapture(); }
+
+std::vector<PixelGrabScreenInfo> SyntheticCaptureBackend::GetScreens() {
+  std::vector<PixelGrabScreenInfo> screens;
+  for (int i = 0; i < config_.screen_count; ++i) {
+    PixelGrabScreenInfo info = {};
+    info.index = i;
+    info.x = i * config_.screen_width;
+    info.y = 0;
+    info.width = config_.screen_width;
+    info.height = config_.screen_height;
+    info.is_primary = i == 0 ? 1 : 0;
+    std::snprintf(info.name, sizeof(info.name), "SYNTHETIC-%d", i + 1);
+    screens.push_back(info);
+  }
+  return screens;
+}
+
+bool SyntheticCaptureBackend::SetOutputFormat(PixelGrabPixelFormat format) {
+  output_format_ = format;
+  return true;
+}
+
+int SyntheticCaptureBackend::TileKind(int tx, int ty) const {
+  const uint64_t h = Mix(config_.seed, static_cast<uint64_t>(tx),
+                         static_cast<uint64_t>(ty));
+  if (static_cast<int>(h % 100) < config_.damage_percent) {
+    return (h >> 32) & 1 ? kTileScrollingText : kTileAnimatedGradient;
+  }
+  return ((h >> 40) & 3) == 0 ? kTileStaticGradient : kTileFlat;
+}
+
+void SyntheticCaptureBackend::Render(uint64_t frame, int x, int y, int width,
+                                     int height, uint8_t* dst,
+                                     int dst_stride) const {
+  const int f = static_cast<int>(frame & 0xFFFFFF);
+  const int scroll = static_cast<int>((frame * 2) % kTextureSize);
+  for (int row = 0; row < height; ++row) {
+    const int py = y + row;
+    const uint8_t* text =
+        text_.data() + ((py + scroll) & (kTextureSize - 1)) * kTextureSize;
+    int px = x;
+    while (px < x + width) {
+      const int tile_end = std::min(x + width, (px / kTile + 1) * kTile);
+      uint8_t* out = dst + static_cast<ptrdiff_t>(row) * dst_stride +
+                     (px - x) * 4;
+      switch (TileKind(px / kTile, py / kTile)) {
+        case kTileFlat: {
+          const uint8_t* c = kPanelColors[Mix(config_.seed, px / (kTile * 4),
+                                              py / (kTile * 4)) %
+                                          4];
+          for (; px < tile_end; ++px, out += 4) Put(out, c[0], c[1], c[2]);
+          break;
+        }
+        case kTileStaticGradient:
+          for (; px < tile_end; ++px, out += 4) {
+            Put(out, (px >> 2) & 0xFF, (py >> 2) & 0xFF,
+                ((px + py) >> 3) & 0xFF);
+          }
+          break;
+        case kTileAnimatedGradient:
+          for (; px < tile_end; ++px, out += 4) {
+            Put(out, (px * 2 + f * 5) & 0xFF, (py * 2 + f * 3) & 0xFF,
+                (px + py + f * 7) & 0xFF);
+          }
+          break;
+        default:  // kTileScrollingText
+          for (; px < tile_end; ++px, out += 4) {
+            const int v = text[px & (kTextureSize - 1)] ? 0x1E : 0xFA;
+            Put(out, v, v, v);
+          }
+          break;
+      }
+    }
+  }
+}
+
+bool SyntheticCaptureBackend::ClipToDesktop(int* x, int* y, int* width,
+                                            int* height) const {
+  PixelGrabRect clipped;
+  if (!Intersect({*x, *y, *width, *height},
+                 {0, 0, desktop_width_, desktop_height_}, &clipped)) {
+    return false;
+  }
+  *x = clipped.x;
+  *y = clipped.y;
+  *width = clipped.width;
+  *height = clipped.height;
+  return true;
+}
+
+std::unique_ptr<Image> SyntheticCaptureBackend::RenderImage(
+    uint64_t frame, int x, int y, int width, int height) const {
+  auto image = Image::CreateUninitialized(width, height, kPixelGrabFormatBgra8);
+  if (!image) return nullptr;
+  uint8_t* dst = image->mutable_data();
+  if (!dst) return nullptr;
+  Render(frame, x, y, width, height, dst, image->stride());
+  if (output_format_ != kPixelGrabFormatBgra8 &&
+      !ConvertImageFormat(image.get(), output_format_)) {
+    return nullptr;
+  }
+  return image;
+}
+
+std::unique_ptr<Image> SyntheticCaptureBackend::CaptureScreen(
+    int screen_index) {
+  if (screen_index < 0 || screen_index >= config_.screen_count) {
+    return nullptr;
+  }
+  return CaptureRegion(screen_index * config_.screen_width, 0,
+                       config_.screen_width, config_.screen_height);
+}
+
+std::unique_ptr<Image> SyntheticCaptureBackend::CaptureRegion(int x, int y,
+                                                              int width,
+                                                              int height) {
+  if (!ClipToDesktop(&x, &y, &width, &height)) return nullptr;
+  return RenderImage(clock_->Next(), x, y, width, height);
+}
+
+std::unique_ptr<Image> SyntheticCaptureBackend::CaptureWindow(
+    uint64_t window_handle) {
+  for (const auto& w : EnumerateWindows()) {
+    if (w.id == window_handle) {
+      return CaptureRegion(w.x, w.y, w.width, w.height);
+    }
+  }
+  return nullptr;
+}
+
+bool SyntheticCaptureBackend::CaptureRegionInto(int x, int y, int width,
+                                                int height, uint8_t* dst,
+                                                int dst_stride) {
+  if (!dst) return false;
+  int cx = x, cy = y, cw = width, ch = height;
+  if (!ClipToDesktop(&cx, &cy, &cw, &ch)) return false;
+  Render(clock_->Next(), cx, cy, cw, ch,
+         dst + static_cast<ptrdiff_t>(cy - y) * dst_stride + (cx - x) * 4,
+         dst_stride);
+  return true;
+}
+
+std::vector<std::unique_ptr<Image>> SyntheticCaptureBackend::CaptureRegions(
+    const std::vector<PixelGrabRect>& rects) {
+  // One frame for the whole batch, like a single read on a real display.
+  const uint64_t frame = clock_->Next();
+  std::vector<std::unique_ptr<Image>> images;
+  images.reserve(rects.size());
+  for (const auto& r : rects) {
+    int x = r.x, y = r.y, w = r.width, h = r.height;
+    images.push_back(ClipToDesktop(&x, &y, &w, &h)
+                         ? RenderImage(frame, x, y, w, h)
+                         : nullptr);
+  }
+  return images;
+}
+
+std::unique_ptr<Image> SyntheticCaptureBackend::CaptureRegionIncremental(
+    int x, int y, int width, int height,
+    std::vector<PixelGrabRect>* out_changed) {
+  if (out_changed) out_changed->clear();
+  const PixelGrabRect region = {x, y, width, height};
+  if (!ClipToDesktop(&x, &y, &width, &height)) return nullptr;
+  const uint64_t frame = clock_->Next();
+  auto image = RenderImage(frame, x, y, width, height);
+  if (!image) return nullptr;
+
+  const PixelGrabRect clipped = {x, y, width, height};
+  const bool same_region =
+      tracking_ && std::memcmp(&region, &tracked_region_, sizeof(region)) == 0;
+  if (out_changed && !same_region) {
+    out_changed->push_back(clipped);
+  } else if (out_changed && frame != tracked_frame_) {
+    // Exactly the animated tiles changed.
+    for (int ty = y / kTile; ty * kTile < y + height; ++ty) {
+      for (int tx = x / kTile; tx * kTile < x + width; ++tx) {
+        PixelGrabRect part;
+        if (TileKind(tx, ty) >= kTileAnimatedGradient &&
+            Intersect({tx * kTile, ty * kTile, kTile, kTile}, clipped,
+                      &part)) {
+          out_changed->push_back(part);
+        }
+      }
+    }
+  }
+  tracking_ = true;
+  tracked_region_ = region;
+  tracked_frame_ = frame;
+  return image;
+}
+
+void SyntheticCaptureBackend::ResetIncrementalCapture() { tracking_ = false; }
+
+std::vector<PixelGrabWindowInfo> SyntheticCaptureBackend::EnumerateWindows() {
+  const int sw = config_.screen_width;
+  const int sh = config_.screen_height;
+  std::vector<PixelGrabWindowInfo> windows;
+  for (int s = 0; s < config_.screen_count; ++s) {
+    for (int k = 0; k < kWindowsPerScreen; ++k) {
+      PixelGrabWindowInfo info = {};
+      info.id = static_cast<PixelGrabWindowId>((s + 1) << 8 | (k + 1));
+      info.x = s * sw + sw / 8 + k * sw / 4;
+      info.y = sh / 8 + k * sh / 6;
+      info.width = sw / 3;
+      info.height = sh / 3;
+      info.is_visible = 1;
+      std::snprintf(info.title, sizeof(info.title), "Synthetic window %d.%d",
+                    s + 1, k + 1);
+      std::snprintf(info.process_name, sizeof(info.process_name),
+                    "pixelgrab-synthetic");
+      windows.push_back(info);
+    }
+  }
+  return windows;
+}
+
+bool SyntheticCaptureBackend::EnableDpiAwareness() { return true; }
+
+bool SyntheticCaptureBackend::GetDpiInfo(int screen_index,
+                                         PixelGrabDpiInfo* out_info) {
+  if (!out_info || screen_index < 0 || screen_index >= config_.screen_count) {
+    return false;
+  }
+  out_info->screen_index = screen_index;
+  out_info->scale_x = 1.0f;
+  out_info->scale_y = 1.0f;
+  out_info->dpi_x = 96;
+  out_info->dpi_y = 96;
+  return true;
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
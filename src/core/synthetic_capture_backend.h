@@ -0,0 +1,120 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Display-less capture backend that renders a reproducible animated scene.
+
+#ifndef PIXELGRAB_CORE_SYNTHETIC_CAPTURE_BACKEND_H_
+#define PIXELGRAB_CORE_SYNTHETIC_CAPTURE_BACKEND_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/capture_backend.h"
+#include "pixelgrab/pixelgrab.h"
+
+namespace pixelgrab {
+namespace internal {
+
+/// |config| with zero sizes and counts replaced by the defaults
+/// (1 screen of 1920x1080) and the damage rate clamped to 0..100.
+/// nullptr yields the defaults with 10% damage.
+PixelGrabSyntheticConfig NormalizeSyntheticConfig(
+    const PixelGrabSyntheticConfig* config);
+
+/// True if the PIXELGRAB_BACKEND environment variable is "synthetic".
+bool SyntheticBackendRequestedByEnv();
+
+/// Scene configuration from the PIXELGRAB_SYNTHETIC environment variable,
+/// a comma-separated list of key=value pairs (screens, width, height,
+/// damage, fps, seed), e.g. "screens=2,width=3840,height=2160,damage=25".
+/// Unset or unknown keys keep their defaults.  Normalized.
+PixelGrabSyntheticConfig SyntheticConfigFromEnv();
+
+/// Frame counter shared by every backend instance of one context, so that
+/// pooled connections and streams see the same scene.
+class SyntheticClock {
+ public:
+  /// |fps| 0 steps one frame per capture call; otherwise the frame number
+  /// follows the wall clock at |fps| frames per second.
+  explicit SyntheticClock(int fps);
+
+  /// Frame number for the next capture.
+  uint64_t Next();
+
+ private:
+  const int fps_;
+  const std::chrono::steady_clock::time_point start_;
+  std::atomic<uint64_t> counter_{0};
+};
+
+/// CaptureBackend without a display server.
+///
+/// Screens are laid out left to right.  The desktop is divided into
+/// 64x64 tiles; a seeded hash marks damage_percent of them as animated --
+/// half scroll a block of pseudo-text upwards, half cycle a colour
+/// gradient -- while the rest show static gradients or flat panels.  A
+/// pixel is a pure function of (seed, frame, x, y), so the same
+/// configuration reproduces the same frames on every host, and incremental
+/// capture reports exactly the animated tiles.  A few fixed windows are
+/// reported per screen.  Thread-compatible (one instance per connection,
+/// as with the platform backends).
+class SyntheticCaptureBackend : public CaptureBackend {
+ public:
+  SyntheticCaptureBackend(const PixelGrabSyntheticConfig& config,
+                          std::shared_ptr<SyntheticClock> clock);
+  ~SyntheticCaptureBackend() override = default;
+
+  bool Initialize() override;
+  void Shutdown() override;
+  std::vector<PixelGrabScreenInfo> GetScreens() override;
+  bool SetOutputFormat(PixelGrabPixelFormat format) override;
+  std::unique_ptr<Image> CaptureScreen(int screen_index) override;
+  std::unique_ptr<Image> CaptureRegion(int x, int y, int width,
+                                       int height) override;
+  std::unique_ptr<Image> CaptureWindow(uint64_t window_handle) override;
+  bool CaptureRegionInto(int x, int y, int width, int height, uint8_t* dst,
+                         int dst_stride) override;
+  std::vector<std::unique_ptr<Image>> CaptureRegions(
+      const std::vector<PixelGrabRect>& rects) override;
+  std::unique_ptr<Image> CaptureRegionIncremental(
+      int x, int y, int width, int height,
+      std::vector<PixelGrabRect>* out_changed) override;
+  void ResetIncrementalCapture() override;
+  std::vector<PixelGrabWindowInfo> EnumerateWindows() override;
+  bool EnableDpiAwareness() override;
+  bool GetDpiInfo(int screen_index, PixelGrabDpiInfo* out_info) override;
+
+ private:
+  /// Clip a region to the desktop; false if nothing is left.
+  bool ClipToDesktop(int* x, int* y, int* width, int* height) const;
+
+  /// Render the clipped region (x, y, width, height) of |frame| into BGRA
+  /// rows.
+  void Render(uint64_t frame, int x, int y, int width, int height,
+              uint8_t* dst, int dst_stride) const;
+
+  /// Render one clipped region as a new image in output_format_.
+  std::unique_ptr<Image> RenderImage(uint64_t frame, int x, int y, int width,
+                                     int height) const;
+
+  /// Kind of the tile at tile coordinates (tx, ty); see the .cpp file.
+  int TileKind(int tx, int ty) const;
+
+  const PixelGrabSyntheticConfig config_;
+  const std::shared_ptr<SyntheticClock> clock_;
+  const int desktop_width_;
+  const int desktop_height_;
+  std::vector<uint8_t> text_;  // kTextureSize^2 glyph coverage bytes.
+  PixelGrabPixelFormat output_format_ = kPixelGrabFormatBgra8;
+
+  // Incremental capture state.
+  bool tracking_ = false;
+  PixelGrabRect tracked_region_ = {};
+  uint64_t tracked_frame_ = 0;
+};
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_CORE_SYNTHETIC_CAPTURE_BACKEND_H_
@@ -7,6 +7,9 @@
 #include <memory>
 #include <string>
 
+#include "core/display_manager.h"
+#include "pixelgrab/pixelgrab.h"
+
 namespace pixelgrab {
 namespace internal {
 
@@ -44,8 +47,15 @@ class ElementDetector {
   ElementDetector() = default;
 };
 
-/// Factory: creates the platform-specific detector.
-std::unique_ptr<ElementDetector> CreatePlatformElementDetector();
+/// Factory: creates the platform-specific detector.  |displays| (may be
+/// null) supplies the context's shared display connection.
+std::unique_ptr<ElementDetector> CreatePlatformElementDetector(
+    DisplayManager* displays);
+
+/// Factory: creates the detector matching the capture backend |type|
+/// (see CreateCaptureBackend()); nullptr if |type| is unavailable.
+std::unique_ptr<ElementDetector> CreateElementDetector(
+    PixelGrabBackendType type, DisplayManager* displays);
 
 }  // namespace internal
 }  // namespace pixelgrab
@@ -7,6 +7,7 @@
 #include <memory>
 #include <string>
 
+#include "core/display_manager.h"
 #include "pixelgrab/pixelgrab.h"
 
 namespace pixelgrab {
@@ -32,8 +33,10 @@ class ClipboardReader {
   ClipboardReader() = default;
 };
 
-/// Factory: creates the platform-specific clipboard reader.
-std::unique_ptr<ClipboardReader> CreatePlatformClipboardReader();
+/// Factory: creates the platform-specific clipboard reader.  |displays|
+/// (may be null) supplies the context's shared display connection.
+std::unique_ptr<ClipboardReader> CreatePlatformClipboardReader(
+    DisplayManager* displays);
 
 }  // namespace internal
 }  // namespace pixelgrab
@@ -6,6 +6,8 @@
 
 #include <memory>
 
+#include "core/display_manager.h"
+
 namespace pixelgrab {
 namespace internal {
 
@@ -78,8 +80,10 @@ class PinWindowBackend {
   PinWindowBackend() = default;
 };
 
-/// Factory: creates the platform-specific pin window backend.
-std::unique_ptr<PinWindowBackend> CreatePlatformPinWindowBackend();
+/// Factory: creates the platform-specific pin window backend.  |displays|
+/// (may be null) supplies the shared display connection its window lives on.
+std::unique_ptr<PinWindowBackend> CreatePlatformPinWindowBackend(
+    DisplayManager* displays);
 
 }  // namespace internal
 }  // namespace pixelgrab
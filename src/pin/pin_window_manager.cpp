@@ -19,7 +19,7 @@ PinWindowManager::~PinWindowManager() {
 int PinWindowManager::PinImage(const Image* image, int x, int y) {
   if (!image) return 0;
 
-  auto backend = CreatePlatformPinWindowBackend();
+  auto backend = CreatePlatformPinWindowBackend(displays_);
   if (!backend) return 0;
 
   PinWindowConfig config;
@@ -48,7 +48,7 @@ static constexpr int kDefaultTextPinHeight = 200;
 int PinWindowManager::PinText(const char* text, int x, int y) {
   if (!text) return 0;
 
-  auto backend = CreatePlatformPinWindowBackend();
+  auto backend = CreatePlatformPinWindowBackend(displays_);
   if (!backend) return 0;
 
   PinWindowConfig config;
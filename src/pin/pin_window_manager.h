@@ -19,6 +19,10 @@ class PinWindowManager {
   PinWindowManager();
   ~PinWindowManager();
 
+  /// Display connections for windows created from now on (may be null).
+  /// Not owned; must outlive the calls that create windows.
+  void SetDisplayManager(DisplayManager* displays) { displays_ = displays; }
+
   // -- Create pin windows (return pin_id > 0 on success, 0 on failure) --
 
   int PinImage(const Image* image, int x, int y);
@@ -84,6 +88,7 @@ class PinWindowManager {
 
   std::map<int, PinEntry> windows_;
   int next_id_ = 1;
+  DisplayManager* displays_ = nullptr;
 };
 
 }  // namespace internal
@@ -13,9 +13,20 @@
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/Xatom.h>
+#if defined(PIXELGRAB_HAS_XRANDR)
+#include <X11/extensions/Xrandr.h>
+#endif
 
 #include "core/image.h"
 #include "core/logger.h"
+#include "platform/linux/x11_composite_capture.h"
+#include "platform/linux/x11_damage_tracker.h"
+#include "platform/linux/x11_image_convert.h"
+#include "platform/linux/x11_shm_image.h"
+#include "platform/linux/x11_window_list.h"
+#if defined(PIXELGRAB_HAS_XCB)
+#include "platform/linux/xcb_capture_backend.h"
+#endif
 
 namespace pixelgrab {
 namespace internal {
@@ -31,97 +42,254 @@ bool X11CaptureBackend::Initialize() {
     return false;
   }
   display_ = dpy;
+  shm_ = std::make_unique<X11ShmImage>();
+  shm_->Initialize(dpy);
+
+#if defined(PIXELGRAB_HAS_XRANDR)
+  int rr_error_base = 0;
+  int rr_major = 0, rr_minor = 0;
+  if (XRRQueryExtension(dpy, &randr_event_base_, &rr_error_base) &&
+      XRRQueryVersion(dpy, &rr_major, &rr_minor)) {
+    has_randr_ = rr_major > 1 || (rr_major == 1 && rr_minor >= 2);
+    has_randr_monitors_ = rr_major > 1 || (rr_major == 1 && rr_minor >= 5);
+  }
+  if (has_randr_) {
+    XRRSelectInput(dpy, RootWindow(dpy, DefaultScreen(dpy)),
+                   RRScreenChangeNotifyMask | RRCrtcChangeNotifyMask |
+                       RROutputChangeNotifyMask);
+  } else {
+    PIXELGRAB_LOG_INFO("XRandR 1.2 not available, reporting a single screen");
+  }
+#endif
+
+  screens_dirty_ = true;
   initialized_ = true;
   return true;
 }
 
 void X11CaptureBackend::Shutdown() {
+  // Server-side resources must be released while the connection is open.
+  composite_.reset();
+  window_capture_mode_ = kPixelGrabWindowCaptureScreen;
+  window_list_.reset();
+  damage_.reset();
+  shm_.reset();
   if (display_) {
     XCloseDisplay(static_cast<Display*>(display_));
     display_ = nullptr;
   }
+  has_randr_ = false;
+  has_randr_monitors_ = false;
+  screens_.clear();
+  screens_dirty_ = true;
   initialized_ = false;
 }
 
-static std::unique_ptr<Image> XImageToImage(XImage* ximg) {
+static std::unique_ptr<Image> XImageToImage(XImage* ximg,
+                                            PixelGrabPixelFormat format) {
   if (!ximg) return nullptr;
 
-  int w = ximg->width;
-  int h = ximg->height;
-  int stride = w * 4;
-  std::vector<uint8_t> pixels(static_cast<size_t>(stride) * h);
-
-  // Fast path: 32bpp little-endian with standard RGB masks (most common).
-  // In-memory layout is already B G R pad — just copy and set alpha.
-  if (ximg->bits_per_pixel == 32 && ximg->byte_order == LSBFirst &&
-      ximg->red_mask == 0xFF0000 && ximg->green_mask == 0x00FF00 &&
-      ximg->blue_mask == 0x0000FF) {
-    for (int y = 0; y < h; ++y) {
-      const uint8_t* src =
-          reinterpret_cast<const uint8_t*>(ximg->data) +
-          static_cast<ptrdiff_t>(y) * ximg->bytes_per_line;
-      uint8_t* dst = pixels.data() + static_cast<ptrdiff_t>(y) * stride;
-      std::memcpy(dst, src, static_cast<size_t>(w) * 4);
-      for (int x = 0; x < w; ++x) dst[x * 4 + 3] = 0xFF;
-    }
-  } else {
-    // Generic fallback via XGetPixel.
-    for (int y = 0; y < h; ++y) {
-      uint8_t* dst = pixels.data() + static_cast<ptrdiff_t>(y) * stride;
-      for (int x = 0; x < w; ++x) {
-        unsigned long px = XGetPixel(ximg, x, y);
-        dst[x * 4 + 0] = static_cast<uint8_t>((px >> 0) & 0xFF);
-        dst[x * 4 + 1] = static_cast<uint8_t>((px >> 8) & 0xFF);
-        dst[x * 4 + 2] = static_cast<uint8_t>((px >> 16) & 0xFF);
-        dst[x * 4 + 3] = 0xFF;
-      }
+  auto img = Image::CreateUninitialized(ximg->width, ximg->height, format);
+  if (!img) return nullptr;
+  ConvertXImage(ximg, img->mutable_data(), img->stride(), format);
+  return img;
+}
+
+bool X11CaptureBackend::ReadRootInto(int x, int y, int width, int height,
+                                     uint8_t* dst, int dst_stride,
+                                     PixelGrabPixelFormat format) {
+  auto* dpy = static_cast<Display*>(display_);
+  Window root = RootWindow(dpy, DefaultScreen(dpy));
+
+  if (shm_ && shm_->available()) {
+    // The shared XImage is owned by shm_ and reused; convert, don't destroy.
+    XImage* shared = shm_->Get(root, x, y, width, height);
+    if (shared) {
+      ConvertXImage(shared, dst, dst_stride, format);
+      return true;
     }
   }
 
-  return Image::CreateFromData(w, h, stride, kPixelGrabFormatBgra8,
-                               std::move(pixels));
+  XImage* ximg = XGetImage(dpy, root, x, y, static_cast<unsigned int>(width),
+                           static_cast<unsigned int>(height), AllPlanes,
+                           ZPixmap);
+  if (!ximg) {
+    PIXELGRAB_LOG_ERROR("XGetImage failed for {}x{} at ({}, {})", width,
+                        height, x, y);
+    return false;
+  }
+  ConvertXImage(ximg, dst, dst_stride, format);
+  XDestroyImage(ximg);
+  return true;
+}
+
+std::unique_ptr<Image> X11CaptureBackend::GrabRoot(int x, int y, int width,
+                                                   int height) {
+  auto img = Image::CreateUninitialized(width, height, output_format_);
+  if (!img) return nullptr;
+  if (!ReadRootInto(x, y, width, height, img->mutable_data(), img->stride(),
+                    output_format_)) {
+    return nullptr;
+  }
+  return img;
 }
 
 // -----------------------------------------------------------------------
 
-std::vector<PixelGrabScreenInfo> X11CaptureBackend::GetScreens() {
-  std::vector<PixelGrabScreenInfo> screens;
-  if (!initialized_) return screens;
+bool X11CaptureBackend::SupportsScreenChangeEvents() const {
+  return has_randr_;
+}
 
+bool X11CaptureBackend::ScreensChanged() {
+  if (!initialized_) return false;
+  PumpRandrEvents();
+  bool changed = screens_changed_;
+  screens_changed_ = false;
+  return changed;
+}
+
+void X11CaptureBackend::PumpRandrEvents() {
+#if defined(PIXELGRAB_HAS_XRANDR)
+  if (!has_randr_) return;
+  auto* dpy = static_cast<Display*>(display_);
+  // XCheckTypedEvent never blocks and leaves unrelated events queued.
+  XEvent ev;
+  bool changed = false;
+  while (XCheckTypedEvent(dpy, randr_event_base_ + RRScreenChangeNotify,
+                          &ev)) {
+    // Keeps DisplayWidth()/DisplayHeight() in sync with the new root size.
+    XRRUpdateConfiguration(&ev);
+    changed = true;
+  }
+  while (XCheckTypedEvent(dpy, randr_event_base_ + RRNotify, &ev)) {
+    changed = true;
+  }
+  if (changed) {
+    PIXELGRAB_LOG_DEBUG("XRandR screen configuration changed");
+    screens_dirty_ = true;
+    screens_changed_ = true;
+  }
+#endif
+}
+
+void X11CaptureBackend::QueryScreens() {
   auto* dpy = static_cast<Display*>(display_);
   int scr = DefaultScreen(dpy);
+  screens_.clear();
+
+#if defined(PIXELGRAB_HAS_XRANDR)
+  Window root = RootWindow(dpy, scr);
+  if (has_randr_monitors_) {
+    int n = 0;
+    XRRMonitorInfo* monitors = XRRGetMonitors(dpy, root, True, &n);
+    for (int i = 0; i < n && monitors; ++i) {
+      const XRRMonitorInfo& m = monitors[i];
+      if (m.width <= 0 || m.height <= 0) continue;
+      PixelGrabScreenInfo info{};
+      info.x = m.x;
+      info.y = m.y;
+      info.width = m.width;
+      info.height = m.height;
+      info.is_primary = m.primary ? 1 : 0;
+      char* name = m.name != None ? XGetAtomName(dpy, m.name) : nullptr;
+      if (name) {
+        std::snprintf(info.name, sizeof(info.name), "%s", name);
+        XFree(name);
+      } else {
+        std::snprintf(info.name, sizeof(info.name), "Monitor %d", i);
+      }
+      screens_.push_back(info);
+    }
+    if (monitors) XRRFreeMonitors(monitors);
+  } else if (has_randr_) {
+    // RandR 1.2-1.4: one screen per active CRTC, named after its first output.
+    XRRScreenResources* res = XRRGetScreenResourcesCurrent(dpy, root);
+    RROutput primary = XRRGetOutputPrimary(dpy, root);
+    for (int i = 0; res && i < res->ncrtc; ++i) {
+      XRRCrtcInfo* crtc = XRRGetCrtcInfo(dpy, res, res->crtcs[i]);
+      if (!crtc) continue;
+      if (crtc->mode != None && crtc->width > 0 && crtc->height > 0) {
+        PixelGrabScreenInfo info{};
+        info.x = crtc->x;
+        info.y = crtc->y;
+        info.width = static_cast<int>(crtc->width);
+        info.height = static_cast<int>(crtc->height);
+        std::snprintf(info.name, sizeof(info.name), "CRTC %d", i);
+        for (int o = 0; o < crtc->noutput; ++o) {
+          if (crtc->outputs[o] == primary) info.is_primary = 1;
+        }
+        if (crtc->noutput > 0) {
+          XRROutputInfo* out = XRRGetOutputInfo(dpy, res, crtc->outputs[0]);
+          if (out) {
+            std::snprintf(info.name, sizeof(info.name), "%.*s",
+                          out->nameLen, out->name);
+            XRRFreeOutputInfo(out);
+          }
+        }
+        screens_.push_back(info);
+      }
+      XRRFreeCrtcInfo(crtc);
+    }
+    if (res) XRRFreeScreenResources(res);
+  }
+#endif
+
+  if (screens_.empty()) {
+    PixelGrabScreenInfo info{};
+    info.width = DisplayWidth(dpy, scr);
+    info.height = DisplayHeight(dpy, scr);
+    info.is_primary = 1;
+    std::snprintf(info.name, sizeof(info.name), "Screen %d", scr);
+    screens_.push_back(info);
+  }
+
+  // Keep the primary monitor at index 0, preserving the server order
+  // for the rest.
+  std::stable_partition(
+      screens_.begin(), screens_.end(),
+      [](const PixelGrabScreenInfo& s) { return s.is_primary != 0; });
+  bool seen_primary = false;
+  for (size_t i = 0; i < screens_.size(); ++i) {
+    screens_[i].index = static_cast<int>(i);
+    if (screens_[i].is_primary) {
+      if (seen_primary) screens_[i].is_primary = 0;
+      seen_primary = true;
+    }
+  }
+  if (!seen_primary) screens_[0].is_primary = 1;
 
-  PixelGrabScreenInfo info{};
-  info.index = 0;
-  info.x = 0;
-  info.y = 0;
-  info.width = DisplayWidth(dpy, scr);
-  info.height = DisplayHeight(dpy, scr);
-  info.is_primary = 1;
-  std::snprintf(info.name, sizeof(info.name), "Screen %d", scr);
-  screens.push_back(info);
-  return screens;
+  screens_dirty_ = false;
+}
+
+std::vector<PixelGrabScreenInfo> X11CaptureBackend::GetScreens() {
+  if (!initialized_) return {};
+  PumpRandrEvents();
+  if (screens_dirty_ || screens_.empty()) QueryScreens();
+  return screens_;
 }
 
 std::unique_ptr<Image> X11CaptureBackend::CaptureScreen(int screen_index) {
-  (void)screen_index;
   if (!initialized_) return nullptr;
 
-  auto* dpy = static_cast<Display*>(display_);
-  int scr = DefaultScreen(dpy);
-  Window root = RootWindow(dpy, scr);
-  int w = DisplayWidth(dpy, scr);
-  int h = DisplayHeight(dpy, scr);
-
-  XImage* ximg = XGetImage(dpy, root, 0, 0, w, h, AllPlanes, ZPixmap);
-  if (!ximg) {
-    PIXELGRAB_LOG_ERROR("XGetImage failed for screen capture");
+  PumpRandrEvents();
+  if (screens_dirty_ || screens_.empty()) QueryScreens();
+  if (screen_index < 0 ||
+      screen_index >= static_cast<int>(screens_.size())) {
+    PIXELGRAB_LOG_ERROR("Screen index {} out of range ({} screens)",
+                        screen_index, screens_.size());
     return nullptr;
   }
 
-  auto img = XImageToImage(ximg);
-  XDestroyImage(ximg);
-  return img;
+  // Read only this monitor's rectangle, clipped to the root window.
+  auto* dpy = static_cast<Display*>(display_);
+  int scr = DefaultScreen(dpy);
+  const PixelGrabScreenInfo& s = screens_[screen_index];
+  int x0 = std::max(s.x, 0);
+  int y0 = std::max(s.y, 0);
+  int x1 = std::min(s.x + s.width, DisplayWidth(dpy, scr));
+  int y1 = std::min(s.y + s.height, DisplayHeight(dpy, scr));
+  if (x1 <= x0 || y1 <= y0) return nullptr;
+  return GrabRoot(x0, y0, x1 - x0, y1 - y0);
 }
 
 std::unique_ptr<Image> X11CaptureBackend::CaptureRegion(int x, int y,
@@ -129,9 +297,11 @@ std::unique_ptr<Image> X11CaptureBackend::CaptureRegion(int x, int y,
                                                         int height) {
   if (!initialized_) return nullptr;
 
+  // Clip against the current root size, not the one before a resize.
+  PumpRandrEvents();
+
   auto* dpy = static_cast<Display*>(display_);
   int scr = DefaultScreen(dpy);
-  Window root = RootWindow(dpy, scr);
   int scr_w = DisplayWidth(dpy, scr);
   int scr_h = DisplayHeight(dpy, scr);
 
@@ -141,22 +311,115 @@ std::unique_ptr<Image> X11CaptureBackend::CaptureRegion(int x, int y,
   if (y + height > scr_h) height = scr_h - y;
   if (width <= 0 || height <= 0) return nullptr;
 
-  XImage* ximg = XGetImage(dpy, root, x, y, width, height,
-                           AllPlanes, ZPixmap);
-  if (!ximg) {
-    PIXELGRAB_LOG_ERROR("XGetImage failed for region capture");
-    return nullptr;
+  return GrabRoot(x, y, width, height);
+}
+
+bool X11CaptureBackend::SetOutputFormat(PixelGrabPixelFormat format) {
+  output_format_ = format;
+  return true;
+}
+
+bool X11CaptureBackend::SetWindowCaptureMode(PixelGrabWindowCaptureMode mode) {
+  if (mode == kPixelGrabWindowCaptureScreen) {
+    // Un-redirects every window still held for content capture.
+    composite_.reset();
+    window_capture_mode_ = mode;
+    return true;
   }
+  if (mode != kPixelGrabWindowCaptureContent || !initialized_) return false;
 
-  auto img = XImageToImage(ximg);
-  XDestroyImage(ximg);
-  return img;
+  if (!composite_) {
+    composite_ = std::make_unique<X11CompositeCapture>();
+    composite_->Initialize(static_cast<Display*>(display_), shm_.get());
+  }
+  if (!composite_->available()) {
+    composite_.reset();
+    return false;
+  }
+  window_capture_mode_ = mode;
+  return true;
+}
+
+bool X11CaptureBackend::CaptureRegionInto(int x, int y, int width, int height,
+                                          uint8_t* dst, int dst_stride) {
+  if (!initialized_ || !dst) return false;
+
+  PumpRandrEvents();
+
+  auto* dpy = static_cast<Display*>(display_);
+  int scr = DefaultScreen(dpy);
+  int x0 = std::max(x, 0);
+  int y0 = std::max(y, 0);
+  int x1 = std::min(x + width, DisplayWidth(dpy, scr));
+  int y1 = std::min(y + height, DisplayHeight(dpy, scr));
+  if (x1 <= x0 || y1 <= y0) return false;
+
+  // Keep the destination aligned with the requested rectangle; pixels that
+  // fall outside the root window are left untouched.
+  uint8_t* origin = dst + static_cast<ptrdiff_t>(y0 - y) * dst_stride +
+                    static_cast<ptrdiff_t>(x0 - x) * 4;
+  return ReadRootInto(x0, y0, x1 - x0, y1 - y0, origin, dst_stride,
+                      kPixelGrabFormatBgra8);
+}
+
+std::unique_ptr<Image> X11CaptureBackend::CaptureRegionIncremental(
+    int x, int y, int width, int height,
+    std::vector<PixelGrabRect>* out_changed) {
+  if (out_changed) out_changed->clear();
+  if (!initialized_) return nullptr;
+
+  auto* dpy = static_cast<Display*>(display_);
+  if (!damage_) {
+    damage_ = std::make_unique<X11DamageTracker>();
+    damage_->Initialize(dpy, shm_.get());
+  }
+  if (!damage_->available()) {
+    return CaptureBackend::CaptureRegionIncremental(x, y, width, height,
+                                                    out_changed);
+  }
+
+  // Picks up root size changes before the tracker compares dimensions.
+  PumpRandrEvents();
+
+  std::vector<PixelGrabRect> damaged;
+  if (!damage_->Update(&damaged)) {
+    return CaptureBackend::CaptureRegionIncremental(x, y, width, height,
+                                                    out_changed);
+  }
+
+  int scr = DefaultScreen(dpy);
+  int scr_w = DisplayWidth(dpy, scr);
+  int scr_h = DisplayHeight(dpy, scr);
+  if (x < 0) { width += x; x = 0; }
+  if (y < 0) { height += y; y = 0; }
+  if (x + width > scr_w) width = scr_w - x;
+  if (y + height > scr_h) height = scr_h - y;
+  if (width <= 0 || height <= 0) return nullptr;
+
+  if (out_changed) {
+    for (const auto& r : damaged) {
+      int x0 = std::max(r.x, x);
+      int y0 = std::max(r.y, y);
+      int x1 = std::min(r.x + r.width, x + width);
+      int y1 = std::min(r.y + r.height, y + height);
+      if (x1 > x0 && y1 > y0) {
+        out_changed->push_back({x0, y0, x1 - x0, y1 - y0});
+      }
+    }
+  }
+  return damage_->Extract(x, y, width, height);
+}
+
+void X11CaptureBackend::ResetIncrementalCapture() {
+  if (damage_) damage_->Stop();
 }
 
 std::unique_ptr<Image> X11CaptureBackend::CaptureWindow(
     uint64_t window_handle) {
   if (!initialized_) return nullptr;
 
+  PumpRandrEvents();
+
   auto* dpy = static_cast<Display*>(display_);
   Window win = static_cast<Window>(window_handle);
 
@@ -166,12 +429,28 @@ std::unique_ptr<Image> X11CaptureBackend::CaptureWindow(
     return nullptr;
   }
 
+  if (window_capture_mode_ == kPixelGrabWindowCaptureContent && composite_) {
+    auto img = composite_->Capture(win, output_format_);
+    if (img) return img;
+    PIXELGRAB_LOG_DEBUG("Window 0x{:X} content capture failed, reading the "
+                        "screen instead", window_handle);
+  }
+
   int scr = DefaultScreen(dpy);
   Window root = RootWindow(dpy, scr);
   int abs_x = 0, abs_y = 0;
   Window child;
   XTranslateCoordinates(dpy, win, root, 0, 0, &abs_x, &abs_y, &child);
 
+  // Fully on-screen windows can be read from the root through SHM.
+  if (abs_x >= 0 && abs_y >= 0 &&
+      abs_x + attrs.width <= DisplayWidth(dpy, scr) &&
+      abs_y + attrs.height <= DisplayHeight(dpy, scr) &&
+      shm_ && shm_->available()) {
+    auto img = GrabRoot(abs_x, abs_y, attrs.width, attrs.height);
+    if (img) return img;
+  }
+
   XImage* ximg = XGetImage(dpy, root, abs_x, abs_y,
                            attrs.width, attrs.height, AllPlanes, ZPixmap);
   if (!ximg) {
@@ -183,132 +462,21 @@ std::unique_ptr<Image> X11CaptureBackend::CaptureWindow(
     }
   }
 
-  auto img = XImageToImage(ximg);
+  auto img = XImageToImage(ximg, output_format_);
   XDestroyImage(ximg);
   return img;
 }
 
 std::vector<PixelGrabWindowInfo> X11CaptureBackend::EnumerateWindows() {
-  std::vector<PixelGrabWindowInfo> result;
-  if (!initialized_) return result;
-
-  auto* dpy = static_cast<Display*>(display_);
-  int scr = DefaultScreen(dpy);
-  Window root = RootWindow(dpy, scr);
-
-  // Prefer EWMH _NET_CLIENT_LIST_STACKING (topmost last).
-  Atom net_cl = XInternAtom(dpy, "_NET_CLIENT_LIST_STACKING", True);
-  if (net_cl == None)
-    net_cl = XInternAtom(dpy, "_NET_CLIENT_LIST", True);
-
-  Window* wins = nullptr;
-  unsigned long n_wins = 0;
-  bool ewmh = false;
-
-  if (net_cl != None) {
-    Atom type;
-    int fmt;
-    unsigned long items, after;
-    unsigned char* data = nullptr;
-    if (XGetWindowProperty(dpy, root, net_cl, 0, ~0L, False, XA_WINDOW,
-                           &type, &fmt, &items, &after, &data) == Success &&
-        data) {
-      wins = reinterpret_cast<Window*>(data);
-      n_wins = items;
-      ewmh = true;
+  if (!initialized_) return {};
+  if (!window_list_) {
+    window_list_ = std::make_unique<X11WindowList>();
+    if (!window_list_->Initialize()) {
+      window_list_.reset();
+      return {};
     }
   }
-
-  Window root_ret, parent_ret;
-  Window* children = nullptr;
-  unsigned int n_children = 0;
-  if (!ewmh) {
-    XQueryTree(dpy, root, &root_ret, &parent_ret, &children, &n_children);
-    wins = children;
-    n_wins = n_children;
-  }
-
-  Atom net_wm_name = XInternAtom(dpy, "_NET_WM_NAME", True);
-  Atom utf8_str = XInternAtom(dpy, "UTF8_STRING", True);
-  Atom net_wm_pid = XInternAtom(dpy, "_NET_WM_PID", True);
-
-  for (unsigned long i = 0; i < n_wins; ++i) {
-    Window w = wins[i];
-    XWindowAttributes a;
-    if (!XGetWindowAttributes(dpy, w, &a)) continue;
-    if (a.map_state != IsViewable || a.width <= 1 || a.height <= 1) continue;
-
-    int ax = 0, ay = 0;
-    Window ch;
-    XTranslateCoordinates(dpy, w, root, 0, 0, &ax, &ay, &ch);
-
-    PixelGrabWindowInfo info{};
-    info.id = static_cast<uint64_t>(w);
-    info.x = ax;
-    info.y = ay;
-    info.width = a.width;
-    info.height = a.height;
-    info.is_visible = 1;
-
-    // Window title: _NET_WM_NAME (UTF-8) > WM_NAME
-    bool got = false;
-    if (net_wm_name != None && utf8_str != None) {
-      Atom type;
-      int fmt;
-      unsigned long items, after;
-      unsigned char* data = nullptr;
-      if (XGetWindowProperty(dpy, w, net_wm_name, 0, 256, False, utf8_str,
-                             &type, &fmt, &items, &after, &data) == Success &&
-          data) {
-        std::strncpy(info.title, reinterpret_cast<char*>(data),
-                     sizeof(info.title) - 1);
-        XFree(data);
-        got = true;
-      }
-    }
-    if (!got) {
-      XTextProperty tp;
-      if (XGetWMName(dpy, w, &tp) && tp.value) {
-        std::strncpy(info.title, reinterpret_cast<char*>(tp.value),
-                     sizeof(info.title) - 1);
-        XFree(tp.value);
-      }
-    }
-
-    // Process name via _NET_WM_PID + /proc/PID/comm
-    if (net_wm_pid != None) {
-      Atom type;
-      int fmt;
-      unsigned long items, after;
-      unsigned char* data = nullptr;
-      if (XGetWindowProperty(dpy, w, net_wm_pid, 0, 1, False, XA_CARDINAL,
-                             &type, &fmt, &items, &after, &data) == Success &&
-          data) {
-        auto pid = *reinterpret_cast<uint32_t*>(data);
-        XFree(data);
-        char path[64];
-        std::snprintf(path, sizeof(path), "/proc/%u/comm", pid);
-        FILE* f = std::fopen(path, "r");
-        if (f) {
-          if (std::fgets(info.process_name, sizeof(info.process_name), f)) {
-            size_t len = std::strlen(info.process_name);
-            if (len > 0 && info.process_name[len - 1] == '\n')
-              info.process_name[len - 1] = '\0';
-          }
-          std::fclose(f);
-        }
-      }
-    }
-
-    result.push_back(info);
-  }
-
-  if (ewmh)
-    XFree(wins);
-  else if (children)
-    XFree(children);
-
-  return result;
+  return window_list_->Snapshot();
 }
 
 bool X11CaptureBackend::EnableDpiAwareness() { return true; }
@@ -357,6 +525,20 @@ std::unique_ptr<CaptureBackend> CreatePlatformBackend() {
   return std::make_unique<X11CaptureBackend>();
 }
 
+std::unique_ptr<CaptureBackend> CreateCaptureBackend(
+    PixelGrabBackendType type) {
+  switch (type) {
+    case kPixelGrabBackendDefault:
+      return CreatePlatformBackend();
+#if defined(PIXELGRAB_HAS_XCB)
+    case kPixelGrabBackendXcb:
+      return std::make_unique<XcbCaptureBackend>();
+#endif
+    default:
+      return nullptr;
+  }
+}
+
 }  // namespace internal
 }  // namespace pixelgrab
 
@@ -12,7 +12,21 @@
 namespace pixelgrab {
 namespace internal {
 
-/// Linux capture backend using X11 (XShmGetImage).
+class X11CompositeCapture;
+class X11DamageTracker;
+class X11ShmImage;
+class X11WindowList;
+
+/// Linux capture backend using X11.
+///
+/// Root-window reads go through a persistent MIT-SHM segment (XShmGetImage)
+/// when the extension is available and fall back to XGetImage otherwise.
+/// Monitors are enumerated through XRandR; the monitor list is cached and
+/// only re-queried after an RRScreenChangeNotify / RRNotify event.
+/// Incremental captures keep an XDamage-tracked copy of the root window.
+/// In kPixelGrabWindowCaptureContent mode windows are read from their
+/// XComposite backing pixmaps instead of the root window.  The window list
+/// is cached and kept current from X events (see X11WindowList).
 class X11CaptureBackend : public CaptureBackend {
  public:
   X11CaptureBackend();
@@ -22,18 +36,62 @@ class X11CaptureBackend : public CaptureBackend {
   void Shutdown() override;
 
   std::vector<PixelGrabScreenInfo> GetScreens() override;
+  bool SupportsScreenChangeEvents() const override;
+  bool ScreensChanged() override;
   std::unique_ptr<Image> CaptureScreen(int screen_index) override;
   std::unique_ptr<Image> CaptureRegion(int x, int y, int width,
                                        int height) override;
   std::unique_ptr<Image> CaptureWindow(uint64_t window_handle) override;
+  bool SetOutputFormat(PixelGrabPixelFormat format) override;
+  bool SetWindowCaptureMode(PixelGrabWindowCaptureMode mode) override;
+  bool CaptureRegionInto(int x, int y, int width, int height, uint8_t* dst,
+                         int dst_stride) override;
+  std::unique_ptr<Image> CaptureRegionIncremental(
+      int x, int y, int width, int height,
+      std::vector<PixelGrabRect>* out_changed) override;
+  void ResetIncrementalCapture() override;
   std::vector<PixelGrabWindowInfo> EnumerateWindows() override;
 
   bool EnableDpiAwareness() override;
   bool GetDpiInfo(int screen_index, PixelGrabDpiInfo* out_info) override;
 
  private:
+  /// Read a rectangle of the root window (already clipped to the screen).
+  std::unique_ptr<Image> GrabRoot(int x, int y, int width, int height);
+
+  /// Read a clipped root rectangle straight into memory at |dst|, laid out
+  /// as |format|.
+  bool ReadRootInto(int x, int y, int width, int height, uint8_t* dst,
+                    int dst_stride, PixelGrabPixelFormat format);
+
+  /// Consume queued RandR events; marks the monitor cache dirty on change.
+  /// Called before every read that clips against the root size, so a
+  /// resize is seen even by callers that never enumerate screens.
+  void PumpRandrEvents();
+
+  /// Re-query monitors (XRandR, or the whole root as a single screen).
+  void QueryScreens();
+
   bool initialized_ = false;
   void* display_ = nullptr;  // Display* from X11
+  PixelGrabPixelFormat output_format_ = kPixelGrabFormatBgra8;
+  std::unique_ptr<X11ShmImage> shm_;
+  std::unique_ptr<X11DamageTracker> damage_;  // Created on first use.
+  PixelGrabWindowCaptureMode window_capture_mode_ =
+      kPixelGrabWindowCaptureScreen;
+  std::unique_ptr<X11CompositeCapture> composite_;  // Content mode only.
+  std::unique_ptr<X11WindowList> window_list_;      // Created on first use.
+
+  // XRandR state.
+  bool has_randr_ = false;
+  bool has_randr_monitors_ = false;  // RandR >= 1.5 (XRRGetMonitors)
+  int randr_event_base_ = 0;
+
+  // Monitor cache.  |screens_dirty_| forces a re-query on the next access;
+  // |screens_changed_| is reported (once) through ScreensChanged().
+  std::vector<PixelGrabScreenInfo> screens_;
+  bool screens_dirty_ = true;
+  bool screens_changed_ = false;
 };
 
 }  // namespace internal
@@ -14,6 +14,7 @@
 
 #include "core/image.h"
 #include "core/logger.h"
+#include "platform/linux/x11_display_manager.h"
 
 namespace pixelgrab {
 namespace internal {
@@ -22,37 +23,28 @@ namespace {
 
 constexpr int kSelectionTimeout = 500;  // ms
 
-struct XDisplayGuard {
-  Display* dpy = nullptr;
-  Window win = None;
-
-  XDisplayGuard() {
-    dpy = XOpenDisplay(nullptr);
-    if (dpy) {
-      win = XCreateSimpleWindow(dpy, DefaultRootWindow(dpy),
-                                0, 0, 1, 1, 0, 0, 0);
-    }
-  }
-  ~XDisplayGuard() {
-    if (dpy) {
-      if (win) XDestroyWindow(dpy, win);
-      XCloseDisplay(dpy);
-    }
-  }
-  explicit operator bool() const { return dpy && win; }
-};
-
 // Request a selection target and wait for SelectionNotify.
 // Returns the property data, or empty vector on failure.
-std::vector<uint8_t> RequestSelection(Display* dpy, Window win,
+std::vector<uint8_t> RequestSelection(X11Connection* conn, Window win,
                                       Atom selection, Atom target) {
-  Atom prop = XInternAtom(dpy, "PIXELGRAB_SEL", False);
-  XConvertSelection(dpy, selection, target, prop, win, CurrentTime);
-  XFlush(dpy);
+  Display* dpy = conn->display();
+  Atom prop;
+  {
+    auto lock = conn->Lock();
+    prop = conn->InternAtom("PIXELGRAB_SEL");
+    XConvertSelection(dpy, selection, target, prop, win, CurrentTime);
+    XFlush(dpy);
+  }
 
   XEvent ev;
   for (int i = 0; i < kSelectionTimeout; ++i) {
+    auto lock = conn->Lock();
     if (XCheckTypedWindowEvent(dpy, win, SelectionNotify, &ev)) {
+      // A late reply to an earlier, timed-out request: keep waiting.
+      if (ev.xselection.selection != selection ||
+          ev.xselection.target != target) {
+        continue;
+      }
       if (ev.xselection.property == None) return {};
 
       Atom type;
@@ -68,6 +60,7 @@ std::vector<uint8_t> RequestSelection(Display* dpy, Window win,
       XFree(data);
       return result;
     }
+    lock.unlock();
     // Sleep 1ms between polls.
     struct timespec ts = {0, 1000000};
     nanosleep(&ts, nullptr);
@@ -76,10 +69,14 @@ std::vector<uint8_t> RequestSelection(Display* dpy, Window win,
 }
 
 // Check if the selection owner advertises a given target.
-bool SelectionSupportsTarget(Display* dpy, Window win,
+bool SelectionSupportsTarget(X11Connection* conn, Window win,
                              Atom selection, Atom target) {
-  Atom targets_atom = XInternAtom(dpy, "TARGETS", False);
-  auto data = RequestSelection(dpy, win, selection, targets_atom);
+  Atom targets_atom;
+  {
+    auto lock = conn->Lock();
+    targets_atom = conn->InternAtom("TARGETS");
+  }
+  auto data = RequestSelection(conn, win, selection, targets_atom);
   if (data.empty()) return false;
 
   size_t count = data.size() / sizeof(Atom);
@@ -92,35 +89,64 @@ bool SelectionSupportsTarget(Display* dpy, Window win,
 
 }  // namespace
 
-PixelGrabClipboardFormat X11ClipboardReader::GetAvailableFormat() const {
-  XDisplayGuard x;
-  if (!x) return kPixelGrabClipboardNone;
+X11ClipboardReader::X11ClipboardReader(DisplayManager* displays)
+    : displays_(displays) {}
 
-  Atom clipboard = XInternAtom(x.dpy, "CLIPBOARD", False);
-  if (XGetSelectionOwner(x.dpy, clipboard) == None)
-    return kPixelGrabClipboardNone;
+X11ClipboardReader::~X11ClipboardReader() {
+  if (conn_ && window_) {
+    auto lock = conn_->Lock();
+    XDestroyWindow(conn_->display(), window_);
+    XFlush(conn_->display());
+  }
+}
 
-  Atom png = XInternAtom(x.dpy, "image/png", False);
-  if (SelectionSupportsTarget(x.dpy, x.win, clipboard, png))
+bool X11ClipboardReader::EnsureWindow() const {
+  if (!conn_) conn_ = AcquireX11Connection(displays_);
+  if (!conn_) return false;
+  if (!window_) {
+    auto lock = conn_->Lock();
+    Display* dpy = conn_->display();
+    window_ = XCreateSimpleWindow(dpy, DefaultRootWindow(dpy),
+                                  0, 0, 1, 1, 0, 0, 0);
+  }
+  return window_ != 0;
+}
+
+PixelGrabClipboardFormat X11ClipboardReader::GetAvailableFormat() const {
+  if (!EnsureWindow()) return kPixelGrabClipboardNone;
+
+  Atom clipboard, png, utf8;
+  {
+    auto lock = conn_->Lock();
+    clipboard = conn_->InternAtom("CLIPBOARD");
+    if (XGetSelectionOwner(conn_->display(), clipboard) == None)
+      return kPixelGrabClipboardNone;
+    png = conn_->InternAtom("image/png");
+    utf8 = conn_->InternAtom("UTF8_STRING");
+  }
+
+  if (SelectionSupportsTarget(conn_.get(), window_, clipboard, png))
     return kPixelGrabClipboardImage;
 
-  Atom utf8 = XInternAtom(x.dpy, "UTF8_STRING", False);
   Atom xa_string = XA_STRING;
-  if (SelectionSupportsTarget(x.dpy, x.win, clipboard, utf8) ||
-      SelectionSupportsTarget(x.dpy, x.win, clipboard, xa_string))
+  if (SelectionSupportsTarget(conn_.get(), window_, clipboard, utf8) ||
+      SelectionSupportsTarget(conn_.get(), window_, clipboard, xa_string))
     return kPixelGrabClipboardText;
 
   return kPixelGrabClipboardNone;
 }
 
 std::unique_ptr<Image> X11ClipboardReader::ReadImage() {
-  XDisplayGuard x;
-  if (!x) return nullptr;
+  if (!EnsureWindow()) return nullptr;
 
-  Atom clipboard = XInternAtom(x.dpy, "CLIPBOARD", False);
-  Atom png = XInternAtom(x.dpy, "image/png", False);
+  Atom clipboard, png;
+  {
+    auto lock = conn_->Lock();
+    clipboard = conn_->InternAtom("CLIPBOARD");
+    png = conn_->InternAtom("image/png");
+  }
 
-  auto data = RequestSelection(x.dpy, x.win, clipboard, png);
+  auto data = RequestSelection(conn_.get(), window_, clipboard, png);
   if (data.empty()) return nullptr;
 
   // Decode PNG data using Cairo.
@@ -170,22 +196,26 @@ std::unique_ptr<Image> X11ClipboardReader::ReadImage() {
 }
 
 std::string X11ClipboardReader::ReadText() {
-  XDisplayGuard x;
-  if (!x) return {};
+  if (!EnsureWindow()) return {};
 
-  Atom clipboard = XInternAtom(x.dpy, "CLIPBOARD", False);
-  Atom utf8 = XInternAtom(x.dpy, "UTF8_STRING", False);
+  Atom clipboard, utf8;
+  {
+    auto lock = conn_->Lock();
+    clipboard = conn_->InternAtom("CLIPBOARD");
+    utf8 = conn_->InternAtom("UTF8_STRING");
+  }
 
-  auto data = RequestSelection(x.dpy, x.win, clipboard, utf8);
+  auto data = RequestSelection(conn_.get(), window_, clipboard, utf8);
   if (data.empty()) {
-    data = RequestSelection(x.dpy, x.win, clipboard, XA_STRING);
+    data = RequestSelection(conn_.get(), window_, clipboard, XA_STRING);
   }
   if (data.empty()) return {};
   return std::string(data.begin(), data.end());
 }
 
-std::unique_ptr<ClipboardReader> CreatePlatformClipboardReader() {
-  return std::make_unique<X11ClipboardReader>();
+std::unique_ptr<ClipboardReader> CreatePlatformClipboardReader(
+    DisplayManager* displays) {
+  return std::make_unique<X11ClipboardReader>(displays);
 }
 
 }  // namespace internal
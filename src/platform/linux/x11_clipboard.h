@@ -4,16 +4,36 @@
 #ifndef PIXELGRAB_PLATFORM_LINUX_X11_CLIPBOARD_H_
 #define PIXELGRAB_PLATFORM_LINUX_X11_CLIPBOARD_H_
 
+#include <memory>
+
 #include "pin/clipboard_reader.h"
 
 namespace pixelgrab {
 namespace internal {
 
+class X11Connection;
+
+/// Reads the CLIPBOARD selection through a 1x1 requestor window on the
+/// context's shared connection.  The window is created on first use and
+/// kept, and the connection is locked only between polls, so a slow
+/// selection owner does not stall element detection or pin windows.
 class X11ClipboardReader : public ClipboardReader {
  public:
+  /// |displays| may be null: a private connection is opened instead.
+  explicit X11ClipboardReader(DisplayManager* displays);
+  ~X11ClipboardReader() override;
+
   PixelGrabClipboardFormat GetAvailableFormat() const override;
   std::unique_ptr<Image> ReadImage() override;
   std::string ReadText() override;
+
+ private:
+  /// Connect and create the requestor window if not done yet.
+  bool EnsureWindow() const;
+
+  DisplayManager* displays_;
+  mutable std::shared_ptr<X11Connection> conn_;
+  mutable unsigned long window_ = 0;  // XID
 };
 
 }  // namespace internal
@@ -0,0 +1,235 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// XComposite backing-pixmap capture for occluded and off-screen windows.
+
+#include "platform/linux/x11_composite_capture.h"
+
+#if defined(__linux__)
+
+#include <algorithm>
+
+#include <X11/Xutil.h>
+#if defined(PIXELGRAB_HAS_XCOMPOSITE)
+#include <X11/extensions/Xcomposite.h>
+#endif
+
+#include "core/logger.h"
+#include "platform/linux/x11_error_trap.h"
+#include "platform/linux/x11_image_convert.h"
+#include "platform/linux/x11_shm_image.h"
+
+namespace pixelgrab {
+namespace internal {
+
+X11CompositeCapture::X11CompositeCapture() = default;
+X11CompositeCapture::~X11CompositeCapture() { Stop(); }
+
+bool X11CompositeCapture::Initialize(Display* dpy, X11ShmImage* shm) {
+  Stop();
+  display_ = dpy;
+  shm_ = shm;
+  available_ = false;
+#if defined(PIXELGRAB_HAS_XCOMPOSITE)
+  if (!dpy) return false;
+  int event_base = 0, error_base = 0;
+  if (!XCompositeQueryExtension(dpy, &event_base, &error_base)) {
+    PIXELGRAB_LOG_INFO("XComposite not available, window content capture "
+                       "is disabled");
+    return false;
+  }
+  // NameWindowPixmap appeared in 0.2.
+  int major = 0, minor = 2;
+  if (!XCompositeQueryVersion(dpy, &major, &minor) ||
+      (major == 0 && minor < 2)) {
+    PIXELGRAB_LOG_INFO("XComposite >= 0.2 required for window pixmaps");
+    return false;
+  }
+  available_ = true;
+#endif
+  return available_;
+}
+
+void X11CompositeCapture::Stop() {
+  for (auto& entry : entries_) Release(&entry, true);
+  entries_.clear();
+}
+
+void X11CompositeCapture::Release(Entry* entry, bool unredirect) {
+#if defined(PIXELGRAB_HAS_XCOMPOSITE)
+  if (!display_) return;
+  // The window may already be gone; errors here are expected and ignored.
+  X11ErrorTrap trap(display_);
+  if (entry->pixmap) XFreePixmap(display_, entry->pixmap);
+  if (unredirect) {
+    XCompositeUnredirectWindow(display_, entry->window,
+                               CompositeRedirectAutomatic);
+    XSelectInput(display_, entry->window, NoEventMask);
+  }
+  trap.Failed();
+#else
+  (void)unredirect;
+#endif
+  entry->pixmap = 0;
+}
+
+void X11CompositeCapture::PumpEvents() {
+  XEvent ev;
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    bool destroyed = false;
+    while (XCheckWindowEvent(display_, it->window, StructureNotifyMask, &ev)) {
+      switch (ev.type) {
+        case ConfigureNotify:
+          // A move keeps the pixmap; only a size change replaces it.
+          if (ev.xconfigure.width != it->width ||
+              ev.xconfigure.height != it->height) {
+            Release(&*it, false);
+          }
+          break;
+        case MapNotify:
+        case UnmapNotify:
+          Release(&*it, false);
+          break;
+        case DestroyNotify:
+          destroyed = true;
+          break;
+        default:
+          break;
+      }
+    }
+    if (destroyed) {
+      Release(&*it, false);
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+X11CompositeCapture::Entry* X11CompositeCapture::Acquire(Window window) {
+#if defined(PIXELGRAB_HAS_XCOMPOSITE)
+  PumpEvents();
+
+  auto it = std::find_if(entries_.begin(), entries_.end(),
+                         [window](const Entry& e) {
+                           return e.window == window;
+                         });
+  if (it != entries_.end() && it->pixmap) {
+    it->last_use = ++use_counter_;
+    return &*it;
+  }
+
+  XWindowAttributes attrs;
+  {
+    X11ErrorTrap trap(display_);
+    Status ok = XGetWindowAttributes(display_, window, &attrs);
+    if (trap.Failed() || !ok) return nullptr;
+  }
+  if (attrs.map_state != IsViewable || attrs.width <= 0 ||
+      attrs.height <= 0) {
+    PIXELGRAB_LOG_DEBUG("Window 0x{:X} is not viewable, no backing pixmap",
+                        window);
+    return nullptr;
+  }
+
+  if (it == entries_.end()) {
+    if (static_cast<int>(entries_.size()) >= kMaxWindows) {
+      auto lru = std::min_element(entries_.begin(), entries_.end(),
+                                  [](const Entry& a, const Entry& b) {
+                                    return a.last_use < b.last_use;
+                                  });
+      Release(&*lru, true);
+      entries_.erase(lru);
+    }
+    // StructureNotify before redirecting, so no size change is missed.
+    X11ErrorTrap trap(display_);
+    XSelectInput(display_, window, StructureNotifyMask);
+    XCompositeRedirectWindow(display_, window, CompositeRedirectAutomatic);
+    if (trap.Failed()) {
+      PIXELGRAB_LOG_WARN("XCompositeRedirectWindow failed for 0x{:X}",
+                         window);
+      XSelectInput(display_, window, NoEventMask);
+      return nullptr;
+    }
+    Entry entry;
+    entry.window = window;
+    entries_.push_back(entry);
+    it = entries_.end() - 1;
+    PIXELGRAB_LOG_DEBUG("Window 0x{:X} redirected for content capture",
+                        window);
+  }
+
+  X11ErrorTrap trap(display_);
+  Pixmap pixmap = XCompositeNameWindowPixmap(display_, window);
+  if (trap.Failed() || !pixmap) {
+    PIXELGRAB_LOG_WARN("XCompositeNameWindowPixmap failed for 0x{:X}",
+                       window);
+    return nullptr;
+  }
+  it->pixmap = pixmap;
+  it->width = attrs.width;
+  it->height = attrs.height;
+  it->depth = attrs.depth;
+  it->visual = attrs.visual;
+  it->last_use = ++use_counter_;
+  return &*it;
+#else
+  (void)window;
+  return nullptr;
+#endif
+}
+
+std::unique_ptr<Image> X11CompositeCapture::Capture(
+    Window window, PixelGrabPixelFormat format) {
+  if (!available_) return nullptr;
+  Entry* entry = Acquire(window);
+  if (!entry) return nullptr;
+
+  auto img = Image::CreateUninitialized(entry->width, entry->height, format);
+  if (!img) return nullptr;
+
+  // The shared segment has the default visual's layout, so it can only
+  // receive pixmaps of the default depth (not e.g. 32-bit ARGB windows).
+  int scr = DefaultScreen(display_);
+  if (shm_ && shm_->available() &&
+      entry->depth == DefaultDepth(display_, scr)) {
+    X11ErrorTrap trap(display_);
+    XImage* shared =
+        shm_->Get(entry->pixmap, 0, 0, entry->width, entry->height);
+    if (shared && !trap.Failed()) {
+      ConvertXImage(shared, img->mutable_data(), img->stride(), format);
+      return img;
+    }
+  }
+
+  XImage* ximg = nullptr;
+  {
+    X11ErrorTrap trap(display_);
+    ximg = XGetImage(display_, entry->pixmap, 0, 0,
+                     static_cast<unsigned int>(entry->width),
+                     static_cast<unsigned int>(entry->height), AllPlanes,
+                     ZPixmap);
+    if (trap.Failed() && ximg) {
+      XDestroyImage(ximg);
+      ximg = nullptr;
+    }
+  }
+  if (!ximg) {
+    // Most likely a resize raced with the read; re-name next time.
+    PIXELGRAB_LOG_WARN("Reading the pixmap of window 0x{:X} failed", window);
+    Release(entry, false);
+    return nullptr;
+  }
+  // Pixmaps carry no visual, so Xlib leaves the channel masks empty.
+  if (!ximg->red_mask && entry->visual) {
+    ximg->red_mask = entry->visual->red_mask;
+    ximg->green_mask = entry->visual->green_mask;
+    ximg->blue_mask = entry->visual->blue_mask;
+  }
+  ConvertXImage(ximg, img->mutable_data(), img->stride(), format);
+  XDestroyImage(ximg);
+  return img;
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // __linux__
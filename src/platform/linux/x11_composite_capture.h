@@ -0,0 +1,94 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// XComposite backing-pixmap capture for occluded and off-screen windows.
+
+#ifndef PIXELGRAB_PLATFORM_LINUX_X11_COMPOSITE_CAPTURE_H_
+#define PIXELGRAB_PLATFORM_LINUX_X11_COMPOSITE_CAPTURE_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <X11/Xlib.h>
+
+#include "core/image.h"
+#include "pixelgrab/pixelgrab.h"
+
+namespace pixelgrab {
+namespace internal {
+
+class X11ShmImage;
+
+/// Reads window contents from the window's own backing pixmap.
+///
+/// The first capture of a window redirects it (CompositeRedirectAutomatic,
+/// so the server keeps painting it on screen) and names its backing pixmap
+/// with XCompositeNameWindowPixmap.  The pixmap is cached and read directly
+/// on later captures, so covered or partly off-screen windows come back
+/// with their own contents and repeated captures cost one image read.
+///
+/// The server allocates a new backing pixmap whenever the window is resized,
+/// mapped or unmapped; StructureNotify events on each cached window mark the
+/// pixmap stale so that it is re-named on the next capture.  At most
+/// kMaxWindows windows stay redirected; the least recently captured one is
+/// released first.  Unmapped (e.g. minimized) windows have no backing pixmap
+/// and cannot be captured this way.
+///
+/// Not thread-safe; owned by X11CaptureBackend.
+class X11CompositeCapture {
+ public:
+  static constexpr int kMaxWindows = 8;
+
+  X11CompositeCapture();
+  ~X11CompositeCapture();
+
+  // Non-copyable.
+  X11CompositeCapture(const X11CompositeCapture&) = delete;
+  X11CompositeCapture& operator=(const X11CompositeCapture&) = delete;
+
+  /// Probe XComposite >= 0.2 on |dpy|.  |shm| (optional, non-owning) is used
+  /// for pixmap reads.  Returns available().
+  bool Initialize(Display* dpy, X11ShmImage* shm);
+
+  /// True if windows can be redirected and their pixmaps named.
+  bool available() const { return available_; }
+
+  /// Capture the contents of |window| as |format|.  Returns nullptr if the
+  /// window cannot be redirected or has no pixmap (the caller falls back to
+  /// reading the screen).
+  std::unique_ptr<Image> Capture(Window window, PixelGrabPixelFormat format);
+
+  /// Free every cached pixmap and undo the redirections.
+  void Stop();
+
+ private:
+  struct Entry {
+    Window window = 0;
+    Pixmap pixmap = 0;  // 0 until named, and again once stale.
+    int width = 0;
+    int height = 0;
+    int depth = 0;
+    Visual* visual = nullptr;
+    uint64_t last_use = 0;
+  };
+
+  /// Find or create the entry for |window|, (re-)naming its pixmap if
+  /// needed.  Returns nullptr on failure.
+  Entry* Acquire(Window window);
+
+  /// Apply queued StructureNotify events of the cached windows.
+  void PumpEvents();
+
+  /// Free the entry's pixmap, optionally undoing the redirection as well.
+  void Release(Entry* entry, bool unredirect);
+
+  Display* display_ = nullptr;
+  X11ShmImage* shm_ = nullptr;
+  bool available_ = false;
+  uint64_t use_counter_ = 0;
+  std::vector<Entry> entries_;
+};
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_PLATFORM_LINUX_X11_COMPOSITE_CAPTURE_H_
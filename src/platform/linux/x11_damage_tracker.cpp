@@ -0,0 +1,230 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// XDamage-driven persistent framebuffer for incremental capture.
+
+#include "platform/linux/x11_damage_tracker.h"
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <cstring>
+
+#include <X11/Xutil.h>
+#if defined(PIXELGRAB_HAS_XDAMAGE)
+#include <X11/extensions/Xdamage.h>
+#include <X11/extensions/Xfixes.h>
+#endif
+
+#include "core/logger.h"
+#include "platform/linux/x11_image_convert.h"
+#include "platform/linux/x11_shm_image.h"
+
+namespace pixelgrab {
+namespace internal {
+
+namespace {
+
+// Above this many damaged rectangles one bounding-box read is cheaper than
+// a round-trip per rectangle.
+constexpr int kMaxDamageRects = 64;
+
+}  // namespace
+
+X11DamageTracker::X11DamageTracker() = default;
+X11DamageTracker::~X11DamageTracker() { Stop(); }
+
+bool X11DamageTracker::Initialize(Display* dpy, X11ShmImage* shm) {
+  Stop();
+  display_ = dpy;
+  shm_ = shm;
+  available_ = false;
+#if defined(PIXELGRAB_HAS_XDAMAGE)
+  if (!dpy) return false;
+  int error_base = 0;
+  int fixes_event_base = 0, fixes_error_base = 0;
+  if (!XDamageQueryExtension(dpy, &damage_event_base_, &error_base) ||
+      !XFixesQueryExtension(dpy, &fixes_event_base, &fixes_error_base)) {
+    PIXELGRAB_LOG_INFO("XDamage/XFixes not available, incremental capture "
+                       "falls back to full reads");
+    return false;
+  }
+  // Both extensions require a version handshake before first use.
+  int major = 1, minor = 1;
+  XDamageQueryVersion(dpy, &major, &minor);
+  major = 2;
+  minor = 0;
+  if (!XFixesQueryVersion(dpy, &major, &minor) || major < 2) {
+    PIXELGRAB_LOG_INFO("XFixes >= 2.0 required for damage regions");
+    return false;
+  }
+  available_ = true;
+#endif
+  return available_;
+}
+
+bool X11DamageTracker::Start() {
+#if defined(PIXELGRAB_HAS_XDAMAGE)
+  int scr = DefaultScreen(display_);
+  Window root = RootWindow(display_, scr);
+  fb_width_ = DisplayWidth(display_, scr);
+  fb_height_ = DisplayHeight(display_, scr);
+  framebuffer_.assign(static_cast<size_t>(fb_width_) * fb_height_ * 4, 0);
+
+  // NonEmpty: one event per empty -> non-empty transition; the actual
+  // rectangles are fetched on demand in Update().
+  damage_ = XDamageCreate(display_, root, XDamageReportNonEmpty);
+  region_ = XFixesCreateRegion(display_, nullptr, 0);
+  if (!damage_ || !region_) {
+    PIXELGRAB_LOG_WARN("XDamageCreate failed, disabling incremental capture");
+    Stop();
+    available_ = false;
+    return false;
+  }
+
+  if (!ReadRect(0, 0, fb_width_, fb_height_)) {
+    Stop();
+    return false;
+  }
+  PIXELGRAB_LOG_DEBUG("Damage tracking started ({}x{})", fb_width_,
+                      fb_height_);
+  return true;
+#else
+  return false;
+#endif
+}
+
+void X11DamageTracker::Stop() {
+#if defined(PIXELGRAB_HAS_XDAMAGE)
+  if (display_) {
+    if (damage_) XDamageDestroy(display_, damage_);
+    if (region_) XFixesDestroyRegion(display_, region_);
+  }
+#endif
+  damage_ = 0;
+  region_ = 0;
+  fb_width_ = 0;
+  fb_height_ = 0;
+  framebuffer_.clear();
+  framebuffer_.shrink_to_fit();
+}
+
+bool X11DamageTracker::ReadRect(int x, int y, int width, int height) {
+  Window root = RootWindow(display_, DefaultScreen(display_));
+  uint8_t* dst = framebuffer_.data() +
+                 (static_cast<size_t>(y) * fb_width_ + x) * 4;
+  int stride = fb_width_ * 4;
+
+  if (shm_ && shm_->available()) {
+    XImage* shared = shm_->Get(root, x, y, width, height);
+    if (shared) {
+      ConvertXImage(shared, dst, stride);
+      return true;
+    }
+  }
+
+  XImage* ximg = XGetImage(display_, root, x, y,
+                           static_cast<unsigned int>(width),
+                           static_cast<unsigned int>(height), AllPlanes,
+                           ZPixmap);
+  if (!ximg) {
+    PIXELGRAB_LOG_ERROR("XGetImage failed for damaged rect {}x{} at ({}, {})",
+                        width, height, x, y);
+    return false;
+  }
+  ConvertXImage(ximg, dst, stride);
+  XDestroyImage(ximg);
+  return true;
+}
+
+bool X11DamageTracker::Update(std::vector<PixelGrabRect>* out_damaged) {
+  if (out_damaged) out_damaged->clear();
+  if (!available_) return false;
+#if defined(PIXELGRAB_HAS_XDAMAGE)
+  int scr = DefaultScreen(display_);
+  if (damage_ && (DisplayWidth(display_, scr) != fb_width_ ||
+                  DisplayHeight(display_, scr) != fb_height_)) {
+    Stop();  // Root resized: restart with a full read.
+  }
+
+  if (!damage_) {
+    if (!Start()) return false;
+    if (out_damaged) out_damaged->push_back({0, 0, fb_width_, fb_height_});
+    return true;
+  }
+
+  // Notifications only tell us damage exists; drop them so the queue does
+  // not grow.  The region below is authoritative.
+  XEvent ev;
+  while (XCheckTypedEvent(display_, damage_event_base_ + XDamageNotify, &ev)) {
+  }
+
+  // Move the accumulated damage into region_ and clear it server-side.
+  // Anything drawn after this point is reported on the next call.
+  XDamageSubtract(display_, damage_, None, region_);
+  int n = 0;
+  XRectangle* rects = XFixesFetchRegion(display_, region_, &n);
+
+  std::vector<PixelGrabRect> damaged;
+  damaged.reserve(static_cast<size_t>(n));
+  for (int i = 0; i < n; ++i) {
+    int x0 = std::max<int>(rects[i].x, 0);
+    int y0 = std::max<int>(rects[i].y, 0);
+    int x1 = std::min<int>(rects[i].x + rects[i].width, fb_width_);
+    int y1 = std::min<int>(rects[i].y + rects[i].height, fb_height_);
+    if (x1 > x0 && y1 > y0) damaged.push_back({x0, y0, x1 - x0, y1 - y0});
+  }
+  if (rects) XFree(rects);
+
+  if (static_cast<int>(damaged.size()) > kMaxDamageRects) {
+    PixelGrabRect bbox = damaged[0];
+    int bx1 = bbox.x + bbox.width, by1 = bbox.y + bbox.height;
+    for (const auto& r : damaged) {
+      bbox.x = std::min(bbox.x, r.x);
+      bbox.y = std::min(bbox.y, r.y);
+      bx1 = std::max(bx1, r.x + r.width);
+      by1 = std::max(by1, r.y + r.height);
+    }
+    bbox.width = bx1 - bbox.x;
+    bbox.height = by1 - bbox.y;
+    damaged.assign(1, bbox);
+  }
+
+  for (const auto& r : damaged) {
+    if (!ReadRect(r.x, r.y, r.width, r.height)) {
+      // The framebuffer may now be stale; force a full re-read next time.
+      Stop();
+      return false;
+    }
+  }
+
+  if (out_damaged) *out_damaged = std::move(damaged);
+  return true;
+#else
+  return false;
+#endif
+}
+
+std::unique_ptr<Image> X11DamageTracker::Extract(int x, int y, int width,
+                                                 int height) const {
+  if (framebuffer_.empty() || x < 0 || y < 0 || width <= 0 || height <= 0 ||
+      x + width > fb_width_ || y + height > fb_height_) {
+    return nullptr;
+  }
+  auto img = Image::CreateUninitialized(width, height, kPixelGrabFormatBgra8);
+  if (!img) return nullptr;
+  size_t src_stride = static_cast<size_t>(fb_width_) * 4;
+  const uint8_t* src =
+      framebuffer_.data() + static_cast<size_t>(y) * src_stride +
+      static_cast<size_t>(x) * 4;
+  uint8_t* dst = img->mutable_data();
+  for (int row = 0; row < height; ++row) {
+    std::memcpy(dst + static_cast<size_t>(row) * img->stride(),
+                src + static_cast<size_t>(row) * src_stride,
+                static_cast<size_t>(width) * 4);
+  }
+  return img;
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // __linux__
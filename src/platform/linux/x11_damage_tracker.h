@@ -0,0 +1,77 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// XDamage-driven persistent framebuffer for incremental capture.
+
+#ifndef PIXELGRAB_PLATFORM_LINUX_X11_DAMAGE_TRACKER_H_
+#define PIXELGRAB_PLATFORM_LINUX_X11_DAMAGE_TRACKER_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <X11/Xlib.h>
+
+#include "core/image.h"
+#include "pixelgrab/pixelgrab.h"
+
+namespace pixelgrab {
+namespace internal {
+
+class X11ShmImage;
+
+/// Keeps a BGRA copy of the root window up to date using the DAMAGE
+/// extension.
+///
+/// The first Update() reads the whole root window.  Subsequent calls fetch
+/// the accumulated damage region (one XDamageSubtract + XFixesFetchRegion
+/// round-trip) and re-read only the damaged rectangles, through MIT-SHM when
+/// available.  A static screen therefore costs a single small round-trip.
+///
+/// Not thread-safe; owned by X11CaptureBackend.
+class X11DamageTracker {
+ public:
+  X11DamageTracker();
+  ~X11DamageTracker();
+
+  // Non-copyable.
+  X11DamageTracker(const X11DamageTracker&) = delete;
+  X11DamageTracker& operator=(const X11DamageTracker&) = delete;
+
+  /// Probe XDamage/XFixes on |dpy|.  |shm| (optional, non-owning) is used for
+  /// rectangle reads.  Returns available().
+  bool Initialize(Display* dpy, X11ShmImage* shm);
+
+  /// True if XDamage and XFixes regions are usable.
+  bool available() const { return available_; }
+
+  /// Bring the framebuffer up to date.  Starts tracking on the first call
+  /// (or after a root size change) with a full read.  |out_damaged| receives
+  /// the rectangles re-read by this call, in root coordinates.
+  bool Update(std::vector<PixelGrabRect>* out_damaged);
+
+  /// Copy a rectangle (already clipped to the root) out of the framebuffer.
+  std::unique_ptr<Image> Extract(int x, int y, int width, int height) const;
+
+  /// Destroy the damage object and release the framebuffer.
+  void Stop();
+
+ private:
+  bool Start();
+  bool ReadRect(int x, int y, int width, int height);
+
+  Display* display_ = nullptr;
+  X11ShmImage* shm_ = nullptr;
+  bool available_ = false;
+  int damage_event_base_ = 0;
+
+  XID damage_ = 0;  // Damage
+  XID region_ = 0;  // XserverRegion receiving the damaged parts
+
+  int fb_width_ = 0;
+  int fb_height_ = 0;
+  std::vector<uint8_t> framebuffer_;  // BGRA8, stride = fb_width_ * 4
+};
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_PLATFORM_LINUX_X11_DAMAGE_TRACKER_H_
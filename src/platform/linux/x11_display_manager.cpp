@@ -0,0 +1,57 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Shared Xlib connection for element detection, clipboard and pin windows.
+
+#include "platform/linux/x11_display_manager.h"
+
+#if defined(__linux__) || (defined(__unix__) && !defined(__APPLE__))
+
+#include "core/logger.h"
+
+namespace pixelgrab {
+namespace internal {
+
+X11Connection::X11Connection(Display* display) : display_(display) {}
+
+X11Connection::~X11Connection() {
+  if (display_) XCloseDisplay(display_);
+}
+
+Atom X11Connection::InternAtom(const char* name, bool only_if_exists) {
+  auto it = atoms_.find(name);
+  if (it != atoms_.end()) return it->second;
+  Atom atom = XInternAtom(display_, name, only_if_exists ? True : False);
+  if (atom != None) atoms_.emplace(name, atom);
+  return atom;
+}
+
+std::shared_ptr<X11Connection> X11DisplayManager::Connection() {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (!connection_) {
+    Display* dpy = XOpenDisplay(nullptr);
+    if (!dpy) {
+      PIXELGRAB_LOG_ERROR("Failed to open shared X11 display");
+      return nullptr;
+    }
+    connection_ = std::make_shared<X11Connection>(dpy);
+  }
+  return connection_;
+}
+
+std::shared_ptr<X11Connection> AcquireX11Connection(DisplayManager* displays) {
+  if (displays) {
+    // Linux builds only ever create X11DisplayManager.
+    return static_cast<X11DisplayManager*>(displays)->Connection();
+  }
+  Display* dpy = XOpenDisplay(nullptr);
+  if (!dpy) return nullptr;
+  return std::make_shared<X11Connection>(dpy);
+}
+
+std::unique_ptr<DisplayManager> CreatePlatformDisplayManager() {
+  return std::make_unique<X11DisplayManager>();
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // __linux__
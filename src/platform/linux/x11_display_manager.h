@@ -0,0 +1,82 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Shared Xlib connection for element detection, clipboard and pin windows.
+
+#ifndef PIXELGRAB_PLATFORM_LINUX_X11_DISPLAY_MANAGER_H_
+#define PIXELGRAB_PLATFORM_LINUX_X11_DISPLAY_MANAGER_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <X11/Xlib.h>
+
+#include "core/display_manager.h"
+
+namespace pixelgrab {
+namespace internal {
+
+/// One Xlib connection and its interned-atom cache.
+///
+/// Xlib is not thread-safe on a single Display (and XInitThreads() is not
+/// called), so every request sequence runs under Lock().  Users that read
+/// events must take only the events of their own windows (XCheckIfEvent,
+/// XCheckTypedWindowEvent) so that they don't steal each other's.
+class X11Connection {
+ public:
+  /// Takes ownership of |display|.
+  explicit X11Connection(Display* display);
+  ~X11Connection();
+
+  // Non-copyable.
+  X11Connection(const X11Connection&) = delete;
+  X11Connection& operator=(const X11Connection&) = delete;
+
+  Display* display() const { return display_; }
+
+  /// Exclusive use of the connection until the returned lock is released.
+  std::unique_lock<std::mutex> Lock() {
+    return std::unique_lock<std::mutex>(mu_);
+  }
+
+  /// Atom for |name|; only the first lookup of a name costs a round-trip.
+  /// With |only_if_exists| an atom unknown to the server yields None, which
+  /// is not cached.  Call with Lock() held.
+  Atom InternAtom(const char* name, bool only_if_exists = false);
+
+ private:
+  Display* display_;
+  std::mutex mu_;
+  std::unordered_map<std::string, Atom> atoms_;  // Guarded by mu_.
+};
+
+/// Linux DisplayManager: hands out one X11Connection shared by every
+/// element detector, clipboard reader and pin window of a context.
+///
+/// Capture backends keep their own connections: they are leased one per
+/// concurrent capture (see CaptureBackendPool) and carry per-connection
+/// state (MIT-SHM segments, damage and window-list event selections).
+/// Thread-safe.
+class X11DisplayManager : public DisplayManager {
+ public:
+  X11DisplayManager() = default;
+  ~X11DisplayManager() override = default;
+
+  /// The shared connection, opened on first use; nullptr if the X server
+  /// cannot be reached (retried on the next call).
+  std::shared_ptr<X11Connection> Connection();
+
+ private:
+  std::mutex mu_;
+  std::shared_ptr<X11Connection> connection_;
+};
+
+/// The shared connection of |displays|, or when |displays| is null (a
+/// subsystem used without a context) a private connection.  nullptr if the
+/// X server cannot be reached.
+std::shared_ptr<X11Connection> AcquireX11Connection(DisplayManager* displays);
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_PLATFORM_LINUX_X11_DISPLAY_MANAGER_H_
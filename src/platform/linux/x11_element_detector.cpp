@@ -15,21 +15,16 @@
 #include <X11/Xatom.h>
 
 #include "core/logger.h"
+#include "platform/linux/x11_display_manager.h"
+#if defined(PIXELGRAB_HAS_XCB)
+#include "platform/linux/xcb_element_detector.h"
+#endif
 
 namespace pixelgrab {
 namespace internal {
 
 namespace {
 
-struct DetectorDisplay {
-  Display* dpy = nullptr;
-  DetectorDisplay() { dpy = XOpenDisplay(nullptr); }
-  ~DetectorDisplay() {
-    if (dpy) XCloseDisplay(dpy);
-  }
-  explicit operator bool() const { return dpy != nullptr; }
-};
-
 // Recursively find the deepest child window containing the point.
 Window FindWindowAt(Display* dpy, Window parent, int x, int y) {
   Window root_ret, parent_ret;
@@ -62,8 +57,9 @@ Window FindWindowAt(Display* dpy, Window parent, int x, int y) {
   return found;
 }
 
-void FillInfo(Display* dpy, Window win, ElementInfo* info) {
+void FillInfo(X11Connection* conn, Window win, ElementInfo* info) {
   *info = ElementInfo{};
+  Display* dpy = conn->display();
 
   XWindowAttributes a;
   if (!XGetWindowAttributes(dpy, win, &a)) return;
@@ -79,8 +75,8 @@ void FillInfo(Display* dpy, Window win, ElementInfo* info) {
   info->height = a.height;
 
   // Window title: _NET_WM_NAME (UTF-8) > WM_NAME
-  Atom net_wm_name = XInternAtom(dpy, "_NET_WM_NAME", True);
-  Atom utf8 = XInternAtom(dpy, "UTF8_STRING", True);
+  Atom net_wm_name = conn->InternAtom("_NET_WM_NAME", true);
+  Atom utf8 = conn->InternAtom("UTF8_STRING", true);
   bool got = false;
   if (net_wm_name != None && utf8 != None) {
     Atom type;
@@ -116,31 +112,39 @@ void FillInfo(Display* dpy, Window win, ElementInfo* info) {
 
 }  // namespace
 
-bool X11ElementDetector::Initialize() { return true; }
+X11ElementDetector::X11ElementDetector(DisplayManager* displays)
+    : displays_(displays) {}
+
+X11ElementDetector::~X11ElementDetector() = default;
+
+bool X11ElementDetector::Initialize() {
+  if (!conn_) conn_ = AcquireX11Connection(displays_);
+  return conn_ != nullptr;
+}
 
 bool X11ElementDetector::DetectElement(int screen_x, int screen_y,
                                        ElementInfo* out_info) {
-  if (!out_info) return false;
-  DetectorDisplay x;
-  if (!x) return false;
+  if (!out_info || !conn_) return false;
+  auto lock = conn_->Lock();
+  Display* dpy = conn_->display();
 
-  Window root = DefaultRootWindow(x.dpy);
-  Window found = FindWindowAt(x.dpy, root, screen_x, screen_y);
+  Window root = DefaultRootWindow(dpy);
+  Window found = FindWindowAt(dpy, root, screen_x, screen_y);
   if (found == root) return false;
 
-  FillInfo(x.dpy, found, out_info);
+  FillInfo(conn_.get(), found, out_info);
   return true;
 }
 
 int X11ElementDetector::DetectElements(int screen_x, int screen_y,
                                        ElementInfo* out_infos,
                                        int max_count) {
-  if (!out_infos || max_count <= 0) return 0;
-  DetectorDisplay x;
-  if (!x) return 0;
+  if (!out_infos || max_count <= 0 || !conn_) return 0;
+  auto lock = conn_->Lock();
+  Display* dpy = conn_->display();
 
-  Window root = DefaultRootWindow(x.dpy);
-  Window found = FindWindowAt(x.dpy, root, screen_x, screen_y);
+  Window root = DefaultRootWindow(dpy);
+  Window found = FindWindowAt(dpy, root, screen_x, screen_y);
   if (found == root) return 0;
 
   // Collect ancestors from deepest to root.
@@ -151,21 +155,40 @@ int X11ElementDetector::DetectElements(int screen_x, int screen_y,
     Window parent_ret, root_ret;
     Window* ch = nullptr;
     unsigned int n = 0;
-    if (!XQueryTree(x.dpy, cur, &root_ret, &parent_ret, &ch, &n)) break;
+    if (!XQueryTree(dpy, cur, &root_ret, &parent_ret, &ch, &n)) break;
     if (ch) XFree(ch);
     cur = parent_ret;
   }
 
   int count = std::min(static_cast<int>(chain.size()), max_count);
   for (int i = 0; i < count; ++i)
-    FillInfo(x.dpy, chain[i], &out_infos[i]);
+    FillInfo(conn_.get(), chain[i], &out_infos[i]);
 
   return count;
 }
 
 // Factory implementation.
-std::unique_ptr<ElementDetector> CreatePlatformElementDetector() {
-  auto detector = std::make_unique<X11ElementDetector>();
+std::unique_ptr<ElementDetector> CreatePlatformElementDetector(
+    DisplayManager* displays) {
+  auto detector = std::make_unique<X11ElementDetector>(displays);
+  if (!detector->Initialize()) return nullptr;
+  return detector;
+}
+
+std::unique_ptr<ElementDetector> CreateElementDetector(
+    PixelGrabBackendType type, DisplayManager* displays) {
+  std::unique_ptr<ElementDetector> detector;
+  switch (type) {
+    case kPixelGrabBackendDefault:
+      return CreatePlatformElementDetector(displays);
+#if defined(PIXELGRAB_HAS_XCB)
+    case kPixelGrabBackendXcb:
+      detector = std::make_unique<XcbElementDetector>();
+      break;
+#endif
+    default:
+      return nullptr;
+  }
   if (!detector->Initialize()) return nullptr;
   return detector;
 }
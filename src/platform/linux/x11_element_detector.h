@@ -4,19 +4,32 @@
 #ifndef PIXELGRAB_PLATFORM_LINUX_X11_ELEMENT_DETECTOR_H_
 #define PIXELGRAB_PLATFORM_LINUX_X11_ELEMENT_DETECTOR_H_
 
+#include <memory>
+
 #include "detection/element_detector.h"
 
 namespace pixelgrab {
 namespace internal {
 
+class X11Connection;
+
 /// Linux implementation using X11 XQueryTree-based window detection.
+/// Runs on the context's shared connection (see X11DisplayManager).
 class X11ElementDetector : public ElementDetector {
  public:
+  /// |displays| may be null: a private connection is opened instead.
+  explicit X11ElementDetector(DisplayManager* displays);
+  ~X11ElementDetector() override;
+
   bool Initialize() override;
   bool DetectElement(int screen_x, int screen_y,
                      ElementInfo* out_info) override;
   int DetectElements(int screen_x, int screen_y,
                      ElementInfo* out_infos, int max_count) override;
+
+ private:
+  DisplayManager* displays_;
+  std::shared_ptr<X11Connection> conn_;
 };
 
 }  // namespace internal
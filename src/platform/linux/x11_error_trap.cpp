@@ -0,0 +1,66 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Scoped X11 protocol error trap.
+
+#include "platform/linux/x11_error_trap.h"
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <mutex>
+
+namespace pixelgrab {
+namespace internal {
+
+namespace {
+
+// Xlib's error handler is process-global, so only one thread may own it at a
+// time.  Traps nest on the same thread (the innermost one on the failing
+// display records the error).
+std::recursive_mutex g_trap_mutex;
+thread_local X11ErrorTrap* g_active_trap = nullptr;
+// The handler replaced by the outermost trap.  Read by Handler() on any
+// thread, including threads that hold no trap.
+std::atomic<XErrorHandler> g_previous_handler{nullptr};
+
+}  // namespace
+
+X11ErrorTrap::X11ErrorTrap(Display* dpy) : display_(dpy) {
+  g_trap_mutex.lock();
+  // Make sure errors from earlier requests are not attributed to this trap.
+  if (display_) XSync(display_, False);
+  outer_ = g_active_trap;
+  g_active_trap = this;
+  if (!outer_) {
+    g_previous_handler.store(XSetErrorHandler(&X11ErrorTrap::Handler));
+  }
+}
+
+X11ErrorTrap::~X11ErrorTrap() {
+  if (display_) XSync(display_, False);
+  if (!outer_) XSetErrorHandler(g_previous_handler.load());
+  g_active_trap = outer_;
+  g_trap_mutex.unlock();
+}
+
+bool X11ErrorTrap::Failed() {
+  if (display_) XSync(display_, False);
+  return error_code_ != 0;
+}
+
+// static
+int X11ErrorTrap::Handler(Display* dpy, XErrorEvent* ev) {
+  // The innermost trap on this thread that watches the failing display.
+  X11ErrorTrap* trap = g_active_trap;
+  while (trap && trap->display_ != ev->display) trap = trap->outer_;
+  if (trap) {
+    if (trap->error_code_ == 0) trap->error_code_ = ev->error_code;
+    return 0;
+  }
+  XErrorHandler previous = g_previous_handler.load();
+  return previous ? previous(dpy, ev) : 0;
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // __linux__
@@ -0,0 +1,50 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Scoped X11 protocol error trap.
+
+#ifndef PIXELGRAB_PLATFORM_LINUX_X11_ERROR_TRAP_H_
+#define PIXELGRAB_PLATFORM_LINUX_X11_ERROR_TRAP_H_
+
+#include <X11/Xlib.h>
+
+namespace pixelgrab {
+namespace internal {
+
+/// Temporarily replaces the process-wide Xlib error handler so that protocol
+/// errors raised by optional requests (MIT-SHM attach on a remote display,
+/// reads outside the root window, ...) are recorded instead of terminating
+/// the process through the default handler.  Errors on other displays, or
+/// raised by threads that hold no trap, go to the handler that was installed
+/// before the outermost trap.
+///
+/// Usage:
+///   X11ErrorTrap trap(dpy);
+///   XShmAttach(dpy, &info);
+///   if (trap.Failed()) { ... fall back ... }
+class X11ErrorTrap {
+ public:
+  explicit X11ErrorTrap(Display* dpy);
+  ~X11ErrorTrap();
+
+  // Non-copyable.
+  X11ErrorTrap(const X11ErrorTrap&) = delete;
+  X11ErrorTrap& operator=(const X11ErrorTrap&) = delete;
+
+  /// Flush outstanding requests and report whether any of them failed since
+  /// the trap was installed.
+  bool Failed();
+
+  /// X error code of the first trapped error (0 if none).
+  int error_code() const { return error_code_; }
+
+ private:
+  static int Handler(Display* dpy, XErrorEvent* ev);
+
+  Display* display_;
+  X11ErrorTrap* outer_ = nullptr;
+  int error_code_ = 0;
+};
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_PLATFORM_LINUX_X11_ERROR_TRAP_H_
@@ -0,0 +1,62 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// XImage to BGRA8 / RGBA8 pixel conversion.
+
+#include "platform/linux/x11_image_convert.h"
+
+#if defined(__linux__)
+
+#include <cstddef>
+
+#include <X11/Xutil.h>
+
+#include "core/pixel_convert.h"
+
+namespace pixelgrab {
+namespace internal {
+
+void ConvertXImage(XImage* ximg, uint8_t* dst, int dst_stride,
+                   PixelGrabPixelFormat format) {
+  if (!ximg || !dst) return;
+
+  int w = ximg->width;
+  int h = ximg->height;
+
+  int bpp = ximg->bits_per_pixel;
+  if (bpp == 16 || bpp == 24 || bpp == 32) {
+    PackedPixelLayout layout;
+    layout.bytes_per_pixel = bpp / 8;
+    layout.msb_first = ximg->byte_order == MSBFirst;
+    layout.red_mask = static_cast<uint32_t>(ximg->red_mask);
+    layout.green_mask = static_cast<uint32_t>(ximg->green_mask);
+    layout.blue_mask = static_cast<uint32_t>(ximg->blue_mask);
+    PixelUnpacker unpacker(layout, format);
+    if (unpacker.valid()) {
+      const uint8_t* src = reinterpret_cast<const uint8_t*>(ximg->data) +
+                           static_cast<ptrdiff_t>(ximg->xoffset) * (bpp / 8);
+      for (int y = 0; y < h; ++y) {
+        unpacker.Run(src + static_cast<ptrdiff_t>(y) * ximg->bytes_per_line,
+                     dst + static_cast<ptrdiff_t>(y) * dst_stride,
+                     static_cast<size_t>(w));
+      }
+      return;
+    }
+  }
+
+  // Generic fallback via XGetPixel (palettized or exotic visuals).
+  int r_index = IsBgraLayout(format) ? 2 : 0;
+  for (int y = 0; y < h; ++y) {
+    uint8_t* row = dst + static_cast<ptrdiff_t>(y) * dst_stride;
+    for (int x = 0; x < w; ++x) {
+      unsigned long px = XGetPixel(ximg, x, y);
+      row[x * 4 + 2 - r_index] = static_cast<uint8_t>((px >> 0) & 0xFF);
+      row[x * 4 + 1] = static_cast<uint8_t>((px >> 8) & 0xFF);
+      row[x * 4 + r_index] = static_cast<uint8_t>((px >> 16) & 0xFF);
+      row[x * 4 + 3] = 0xFF;
+    }
+  }
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // __linux__
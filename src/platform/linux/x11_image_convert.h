@@ -0,0 +1,30 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// XImage to BGRA8 / RGBA8 pixel conversion.
+
+#ifndef PIXELGRAB_PLATFORM_LINUX_X11_IMAGE_CONVERT_H_
+#define PIXELGRAB_PLATFORM_LINUX_X11_IMAGE_CONVERT_H_
+
+#include <cstdint>
+
+#include <X11/Xlib.h>
+
+#include "pixelgrab/pixelgrab.h"
+
+namespace pixelgrab {
+namespace internal {
+
+/// Convert the whole of |ximg| into opaque 8-bit pixels at |dst|
+/// (|dst_stride| bytes per row) laid out as |format| (Bgra8 and Native give
+/// B,G,R,A; Rgba8 gives R,G,B,A).  The destination must hold
+/// ximg->width x ximg->height pixels.
+///
+/// 16, 24 and 32bpp TrueColor images of either byte order are unpacked
+/// row-wise by a PixelUnpacker (SIMD for 32bpp); other depths go through
+/// XGetPixel.
+void ConvertXImage(XImage* ximg, uint8_t* dst, int dst_stride,
+                   PixelGrabPixelFormat format = kPixelGrabFormatBgra8);
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_PLATFORM_LINUX_X11_IMAGE_CONVERT_H_
@@ -15,22 +15,35 @@
 
 #include "core/image.h"
 #include "core/logger.h"
+#include "platform/linux/x11_display_manager.h"
 
 namespace pixelgrab {
 namespace internal {
 
-X11PinWindowBackend::X11PinWindowBackend() = default;
+namespace {
+
+// XCheckIfEvent predicate: events of the window passed in |arg|.
+Bool IsEventForWindow(Display* /*dpy*/, XEvent* ev, XPointer arg) {
+  return ev->xany.window == *reinterpret_cast<Window*>(arg) ? True : False;
+}
+
+}  // namespace
+
+X11PinWindowBackend::X11PinWindowBackend(DisplayManager* displays)
+    : displays_(displays) {}
 
 X11PinWindowBackend::~X11PinWindowBackend() { Destroy(); }
 
 bool X11PinWindowBackend::Create(const PinWindowConfig& config) {
   Destroy();
 
-  display_ = XOpenDisplay(nullptr);
-  if (!display_) {
+  conn_ = AcquireX11Connection(displays_);
+  if (!conn_) {
     PIXELGRAB_LOG_ERROR("PinWindow: failed to open X11 display");
     return false;
   }
+  auto lock = conn_->Lock();
+  display_ = conn_->display();
 
   int scr = DefaultScreen(display_);
   Window root = RootWindow(display_, scr);
@@ -53,8 +66,9 @@ bool X11PinWindowBackend::Create(const PinWindowConfig& config) {
                            CopyFromParent, CWEventMask, &attrs);
   if (!window_) {
     PIXELGRAB_LOG_ERROR("PinWindow: XCreateWindow failed");
-    XCloseDisplay(display_);
     display_ = nullptr;
+    lock.unlock();
+    conn_.reset();
     return false;
   }
 
@@ -62,17 +76,16 @@ bool X11PinWindowBackend::Create(const PinWindowConfig& config) {
 
   // EWMH: always-on-top
   if (config.topmost) {
-    Atom state = XInternAtom(display_, "_NET_WM_STATE", False);
-    Atom above = XInternAtom(display_, "_NET_WM_STATE_ABOVE", False);
+    Atom state = conn_->InternAtom("_NET_WM_STATE");
+    Atom above = conn_->InternAtom("_NET_WM_STATE_ABOVE");
     XChangeProperty(display_, window_, state, XA_ATOM, 32,
                     PropModeReplace,
                     reinterpret_cast<unsigned char*>(&above), 1);
   }
 
   // Window type: utility
-  Atom wm_type = XInternAtom(display_, "_NET_WM_WINDOW_TYPE", False);
-  Atom type_util =
-      XInternAtom(display_, "_NET_WM_WINDOW_TYPE_UTILITY", False);
+  Atom wm_type = conn_->InternAtom("_NET_WM_WINDOW_TYPE");
+  Atom type_util = conn_->InternAtom("_NET_WM_WINDOW_TYPE_UTILITY");
   XChangeProperty(display_, window_, wm_type, XA_ATOM, 32,
                   PropModeReplace,
                   reinterpret_cast<unsigned char*>(&type_util), 1);
@@ -81,10 +94,10 @@ bool X11PinWindowBackend::Create(const PinWindowConfig& config) {
   XStoreName(display_, window_, "PixelGrab Pin");
 
   // WM_DELETE_WINDOW protocol
-  Atom wm_del = XInternAtom(display_, "WM_DELETE_WINDOW", False);
+  Atom wm_del = conn_->InternAtom("WM_DELETE_WINDOW");
   XSetWMProtocols(display_, window_, &wm_del, 1);
 
-  SetOpacity(opacity_);
+  ApplyOpacity();
 
   XMapWindow(display_, window_);
   XFlush(display_);
@@ -97,16 +110,27 @@ bool X11PinWindowBackend::Create(const PinWindowConfig& config) {
 void X11PinWindowBackend::Destroy() {
   if (!display_) return;
 
-  if (gc_) {
-    XFreeGC(display_, reinterpret_cast<GC>(gc_));
-    gc_ = 0;
-  }
-  if (window_) {
-    XDestroyWindow(display_, window_);
-    window_ = 0;
+  {
+    auto lock = conn_->Lock();
+    if (gc_) {
+      XFreeGC(display_, reinterpret_cast<GC>(gc_));
+      gc_ = 0;
+    }
+    if (window_) {
+      XDestroyWindow(display_, window_);
+      // The connection stays open for other users: drop this window's
+      // queued events so they don't pile up there.
+      XSync(display_, False);
+      Window win = window_;
+      XEvent ev;
+      while (XCheckIfEvent(display_, &ev, IsEventForWindow,
+                           reinterpret_cast<XPointer>(&win))) {
+      }
+      window_ = 0;
+    }
   }
-  XCloseDisplay(display_);
   display_ = nullptr;
+  conn_.reset();
   valid_ = false;
   visible_ = false;
   content_.reset();
@@ -119,6 +143,7 @@ bool X11PinWindowBackend::SetImageContent(const Image* image) {
   content_ = image->Clone();
   width_ = image->width();
   height_ = image->height();
+  auto lock = conn_->Lock();
   XResizeWindow(display_, window_,
                 static_cast<unsigned>(width_),
                 static_cast<unsigned>(height_));
@@ -131,7 +156,7 @@ bool X11PinWindowBackend::SetTextContent(const char* text) {
 
   // Render text to a small image using Cairo.
   int w = 300, h = 80;
-  auto img = Image::Create(w, h, kPixelGrabFormatBgra8);
+  auto img = Image::CreateUninitialized(w, h, kPixelGrabFormatBgra8);
   if (!img) return false;
 
   // Fill with white background
@@ -161,6 +186,7 @@ void X11PinWindowBackend::SetPosition(int x, int y) {
   if (!valid_) return;
   x_ = x;
   y_ = y;
+  auto lock = conn_->Lock();
   XMoveWindow(display_, window_, x, y);
   XFlush(display_);
 }
@@ -169,6 +195,7 @@ void X11PinWindowBackend::SetSize(int w, int h) {
   if (!valid_ || w <= 0 || h <= 0) return;
   width_ = w;
   height_ = h;
+  auto lock = conn_->Lock();
   XResizeWindow(display_, window_,
                 static_cast<unsigned>(w), static_cast<unsigned>(h));
   XFlush(display_);
@@ -177,10 +204,13 @@ void X11PinWindowBackend::SetSize(int w, int h) {
 void X11PinWindowBackend::SetOpacity(float o) {
   opacity_ = o;
   if (!valid_) return;
+  auto lock = conn_->Lock();
+  ApplyOpacity();
+}
 
-  Atom opacity_atom =
-      XInternAtom(display_, "_NET_WM_WINDOW_OPACITY", False);
-  auto val = static_cast<uint32_t>(o * 0xFFFFFFFF);
+void X11PinWindowBackend::ApplyOpacity() {
+  Atom opacity_atom = conn_->InternAtom("_NET_WM_WINDOW_OPACITY");
+  auto val = static_cast<uint32_t>(opacity_ * 0xFFFFFFFF);
   XChangeProperty(display_, window_, opacity_atom, XA_CARDINAL, 32,
                   PropModeReplace,
                   reinterpret_cast<unsigned char*>(&val), 1);
@@ -191,6 +221,7 @@ float X11PinWindowBackend::GetOpacity() const { return opacity_; }
 
 void X11PinWindowBackend::SetVisible(bool v) {
   if (!valid_) return;
+  auto lock = conn_->Lock();
   if (v && !visible_) {
     XMapWindow(display_, window_);
     visible_ = true;
@@ -220,13 +251,15 @@ void* X11PinWindowBackend::GetNativeHandle() const {
 bool X11PinWindowBackend::ProcessEvents() {
   if (!valid_) return false;
 
-  Atom wm_protocols = XInternAtom(display_, "WM_PROTOCOLS", False);
-  Atom wm_del = XInternAtom(display_, "WM_DELETE_WINDOW", False);
-
-  while (XPending(display_)) {
-    XEvent ev;
-    XNextEvent(display_, &ev);
+  auto lock = conn_->Lock();
+  Atom wm_protocols = conn_->InternAtom("WM_PROTOCOLS");
+  Atom wm_del = conn_->InternAtom("WM_DELETE_WINDOW");
 
+  // Other pins' events stay queued for them.
+  Window win = window_;
+  XEvent ev;
+  while (XCheckIfEvent(display_, &ev, IsEventForWindow,
+                       reinterpret_cast<XPointer>(&win))) {
     switch (ev.type) {
       case Expose:
         if (ev.xexpose.count == 0) Repaint();
@@ -240,6 +273,7 @@ bool X11PinWindowBackend::ProcessEvents() {
       case ClientMessage:
         if (static_cast<Atom>(ev.xclient.message_type) == wm_protocols &&
             static_cast<Atom>(ev.xclient.data.l[0]) == wm_del) {
+          lock.unlock();
           Destroy();
           return false;
         }
@@ -287,8 +321,9 @@ void X11PinWindowBackend::Repaint() {
   XDestroyImage(ximg);
 }
 
-std::unique_ptr<PinWindowBackend> CreatePlatformPinWindowBackend() {
-  return std::make_unique<X11PinWindowBackend>();
+std::unique_ptr<PinWindowBackend> CreatePlatformPinWindowBackend(
+    DisplayManager* displays) {
+  return std::make_unique<X11PinWindowBackend>(displays);
 }
 
 }  // namespace internal
@@ -15,9 +15,15 @@ typedef unsigned long XID;
 namespace pixelgrab {
 namespace internal {
 
+class X11Connection;
+
+/// Pin window on the context's shared connection (see X11DisplayManager).
+/// ProcessEvents() only takes the events of its own window, so any number
+/// of pins can share one connection.
 class X11PinWindowBackend : public PinWindowBackend {
  public:
-  X11PinWindowBackend();
+  /// |displays| may be null: a private connection is opened instead.
+  explicit X11PinWindowBackend(DisplayManager* displays);
   ~X11PinWindowBackend() override;
 
   bool Create(const PinWindowConfig& config) override;
@@ -38,9 +44,13 @@ class X11PinWindowBackend : public PinWindowBackend {
   bool ProcessEvents() override;
 
  private:
+  // Called with the connection locked.
   void Repaint();
+  void ApplyOpacity();
 
-  Display* display_ = nullptr;
+  DisplayManager* displays_;
+  std::shared_ptr<X11Connection> conn_;
+  Display* display_ = nullptr;  // conn_->display() while valid.
   XID window_ = 0;
   void* gc_ = nullptr;
   int x_ = 0, y_ = 0;
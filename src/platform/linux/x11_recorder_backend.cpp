@@ -46,7 +46,9 @@ class X11RecorderBackend : public RecorderBackend {
       frame_width_ = 1920;
       frame_height_ = 1080;
     }
-    // H.264 requires even dimensions.
+    // H.264 requires even dimensions; the padding repeats the last pixels.
+    capture_width_ = frame_width_;
+    capture_height_ = frame_height_;
     frame_width_ = (frame_width_ + 1) & ~1;
     frame_height_ = (frame_height_ + 1) & ~1;
 
@@ -282,23 +284,52 @@ class X11RecorderBackend : public RecorderBackend {
     }
   }
 
+  /// Fill the padding column and row of an odd-sized region with copies
+  /// of the last captured ones.
+  void PadFrame(Image* frame) const {
+    uint8_t* data = frame->mutable_data();
+    const size_t stride = static_cast<size_t>(frame->stride());
+    if (capture_width_ < frame_width_) {
+      const size_t last = static_cast<size_t>(capture_width_ - 1) * 4;
+      for (int row = 0; row < capture_height_; ++row) {
+        uint8_t* line = data + row * stride;
+        std::memcpy(line + last + 4, line + last, 4);
+      }
+    }
+    if (capture_height_ < frame_height_) {
+      std::memcpy(data + capture_height_ * stride,
+                  data + (capture_height_ - 1) * stride,
+                  static_cast<size_t>(frame_width_) * 4);
+    }
+  }
+
   /// Background thread: capture → watermark → encode loop.
   void CaptureLoopFunc() {
     const auto interval = std::chrono::microseconds(1'000'000 / fps_);
 
+    // One encoder-sized frame for the whole recording: the backend converts
+    // straight into it every tick, so the loop does not allocate.
+    auto frame_img =
+        Image::Create(frame_width_, frame_height_, kPixelGrabFormatBgra8);
+    if (!frame_img) {
+      PIXELGRAB_LOG_ERROR("Failed to allocate {}x{} capture frame",
+                          frame_width_, frame_height_);
+      return;
+    }
+
     while (capture_running_.load(std::memory_order_acquire)) {
       auto tick_start = std::chrono::steady_clock::now();
 
       if (!paused_.load(std::memory_order_acquire)) {
-        auto frame_img = config_.capture_backend->CaptureRegion(
-            config_.region_x, config_.region_y,
-            config_.region_width, config_.region_height);
-
-        if (frame_img) {
+        if (config_.capture_backend->CaptureRegionInto(
+                config_.region_x, config_.region_y, capture_width_,
+                capture_height_, frame_img->mutable_data(),
+                frame_img->stride())) {
           if (config_.has_watermark && config_.watermark_renderer) {
             config_.watermark_renderer->ApplyTextWatermark(
                 frame_img.get(), config_.watermark_config);
           }
+          PadFrame(frame_img.get());
           WriteFrame(*frame_img);
         }
       }
@@ -311,8 +342,10 @@ class X11RecorderBackend : public RecorderBackend {
   }
 
   RecordConfig config_;
-  int frame_width_ = 0;
+  int frame_width_ = 0;   // Encoder size (even).
   int frame_height_ = 0;
+  int capture_width_ = 0;  // Region size.
+  int capture_height_ = 0;
   int fps_ = 30;
   guint64 frame_duration_ns_ = 0;
   int64_t frame_count_ = 0;
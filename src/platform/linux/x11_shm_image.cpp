@@ -0,0 +1,209 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Persistent MIT-SHM image segment for fast X11 reads.
+
+#include "platform/linux/x11_shm_image.h"
+
+#if defined(__linux__)
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(PIXELGRAB_HAS_XSHM)
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#endif
+
+#include "core/logger.h"
+#include "platform/linux/x11_error_trap.h"
+
+namespace pixelgrab {
+namespace internal {
+
+#if defined(PIXELGRAB_HAS_XSHM)
+
+struct X11ShmImage::Segment {
+  XShmSegmentInfo info{};
+  XImage* image = nullptr;
+  int capacity_width = 0;
+  int capacity_height = 0;
+  bool attached = false;
+};
+
+#else
+
+struct X11ShmImage::Segment {};
+
+#endif  // PIXELGRAB_HAS_XSHM
+
+X11ShmImage::X11ShmImage() = default;
+X11ShmImage::~X11ShmImage() { Reset(); }
+
+bool X11ShmImage::Initialize(Display* dpy) {
+  Reset();
+  display_ = dpy;
+  available_ = false;
+#if defined(PIXELGRAB_HAS_XSHM)
+  if (!dpy) return false;
+
+  const char* disable = std::getenv("PIXELGRAB_DISABLE_XSHM");
+  if (disable && disable[0] != '\0' && std::strcmp(disable, "0") != 0) {
+    PIXELGRAB_LOG_INFO("MIT-SHM disabled by PIXELGRAB_DISABLE_XSHM");
+    return false;
+  }
+
+  if (!XShmQueryExtension(dpy)) {
+    PIXELGRAB_LOG_INFO("MIT-SHM extension not available, using XGetImage");
+    return false;
+  }
+  available_ = true;
+#endif
+  return available_;
+}
+
+void X11ShmImage::Reset() {
+#if defined(PIXELGRAB_HAS_XSHM)
+  if (segment_) {
+    if (segment_->attached && display_) {
+      XShmDetach(display_, &segment_->info);
+      XSync(display_, False);
+    }
+    if (segment_->image) {
+      // The pixel buffer lives in the shared segment, not on the Xlib heap.
+      segment_->image->data = nullptr;
+      XDestroyImage(segment_->image);
+    }
+    if (segment_->info.shmaddr &&
+        segment_->info.shmaddr != reinterpret_cast<char*>(-1)) {
+      shmdt(segment_->info.shmaddr);
+    }
+  }
+#endif
+  segment_.reset();
+}
+
+bool X11ShmImage::Allocate(int width, int height) {
+#if defined(PIXELGRAB_HAS_XSHM)
+  Reset();
+
+  int scr = DefaultScreen(display_);
+  auto seg = std::make_unique<Segment>();
+  seg->info.shmid = -1;
+  seg->image = XShmCreateImage(display_, DefaultVisual(display_, scr),
+                               static_cast<unsigned int>(
+                                   DefaultDepth(display_, scr)),
+                               ZPixmap, nullptr, &seg->info,
+                               static_cast<unsigned int>(width),
+                               static_cast<unsigned int>(height));
+  if (!seg->image) {
+    PIXELGRAB_LOG_WARN("XShmCreateImage failed, disabling MIT-SHM");
+    available_ = false;
+    return false;
+  }
+
+  size_t bytes = static_cast<size_t>(seg->image->bytes_per_line) *
+                 static_cast<size_t>(seg->image->height);
+  seg->info.shmid = shmget(IPC_PRIVATE, bytes, IPC_CREAT | 0600);
+  if (seg->info.shmid < 0) {
+    PIXELGRAB_LOG_WARN("shmget({} bytes) failed, disabling MIT-SHM", bytes);
+    XDestroyImage(seg->image);
+    available_ = false;
+    return false;
+  }
+
+  seg->info.shmaddr = static_cast<char*>(shmat(seg->info.shmid, nullptr, 0));
+  if (seg->info.shmaddr == reinterpret_cast<char*>(-1)) {
+    PIXELGRAB_LOG_WARN("shmat failed, disabling MIT-SHM");
+    shmctl(seg->info.shmid, IPC_RMID, nullptr);
+    XDestroyImage(seg->image);
+    available_ = false;
+    return false;
+  }
+  seg->image->data = seg->info.shmaddr;
+  seg->info.readOnly = False;
+
+  // XShmAttach fails asynchronously (BadAccess) when the server cannot see
+  // our segment, e.g. over a forwarded connection.
+  bool attach_failed = false;
+  {
+    X11ErrorTrap trap(display_);
+    XShmAttach(display_, &seg->info);
+    attach_failed = trap.Failed();
+  }
+
+  // Mark for removal now: the kernel frees it once both sides detach, so the
+  // segment cannot leak even if the process crashes.
+  shmctl(seg->info.shmid, IPC_RMID, nullptr);
+
+  if (attach_failed) {
+    PIXELGRAB_LOG_WARN("XShmAttach failed, disabling MIT-SHM");
+    segment_ = std::move(seg);
+    Reset();
+    available_ = false;
+    return false;
+  }
+
+  seg->attached = true;
+  seg->capacity_width = width;
+  seg->capacity_height = height;
+  segment_ = std::move(seg);
+  PIXELGRAB_LOG_DEBUG("MIT-SHM segment attached ({}x{}, {} bytes)", width,
+                      height, bytes);
+  return true;
+#else
+  (void)width;
+  (void)height;
+  return false;
+#endif
+}
+
+XImage* X11ShmImage::Get(Drawable drawable, int x, int y, int width,
+                         int height) {
+#if defined(PIXELGRAB_HAS_XSHM)
+  if (!available_ || width <= 0 || height <= 0) return nullptr;
+
+  if (!segment_ || width > segment_->capacity_width ||
+      height > segment_->capacity_height) {
+    // Grow to the largest read seen so far rather than the whole root: a
+    // context may hold several connections, and one that only ever reads
+    // small regions should not pin a full-screen segment.  Keeping the old
+    // capacity means alternating sizes settle after at most two reallocs.
+    int cap_w = width;
+    int cap_h = height;
+    if (segment_) {
+      if (segment_->capacity_width > cap_w) cap_w = segment_->capacity_width;
+      if (segment_->capacity_height > cap_h) cap_h = segment_->capacity_height;
+    }
+    if (!Allocate(cap_w, cap_h)) return nullptr;
+  }
+
+  // Reuse the segment for a smaller read by shrinking the image header; the
+  // server packs scanlines using the image's own bytes_per_line.
+  XImage* img = segment_->image;
+  img->width = width;
+  img->height = height;
+  img->bytes_per_line =
+      ((width * img->bits_per_pixel + img->bitmap_pad - 1) / img->bitmap_pad) *
+      (img->bitmap_pad / 8);
+
+  if (!XShmGetImage(display_, drawable, img, x, y, AllPlanes)) {
+    PIXELGRAB_LOG_WARN("XShmGetImage failed");
+    return nullptr;
+  }
+  return img;
+#else
+  (void)drawable;
+  (void)x;
+  (void)y;
+  (void)width;
+  (void)height;
+  return nullptr;
+#endif
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // __linux__
@@ -0,0 +1,63 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Persistent MIT-SHM image segment for fast X11 reads.
+
+#ifndef PIXELGRAB_PLATFORM_LINUX_X11_SHM_IMAGE_H_
+#define PIXELGRAB_PLATFORM_LINUX_X11_SHM_IMAGE_H_
+
+#include <memory>
+
+#include <X11/Xlib.h>
+
+namespace pixelgrab {
+namespace internal {
+
+/// Reads drawable contents through the MIT-SHM extension.
+///
+/// A single System V shared-memory segment is attached to the X server on
+/// first use and reused for every subsequent read, so a capture costs one
+/// XShmGetImage round-trip and no per-call allocation.  The segment is sized
+/// for the largest read requested so far and only grows, never shrinks.
+///
+/// When the extension is missing (remote display, Xvfb without MIT-SHM, or
+/// PIXELGRAB_DISABLE_XSHM=1) `available()` returns false and callers should
+/// use XGetImage instead.  Not thread-safe; owned by one backend.
+class X11ShmImage {
+ public:
+  X11ShmImage();
+  ~X11ShmImage();
+
+  // Non-copyable.
+  X11ShmImage(const X11ShmImage&) = delete;
+  X11ShmImage& operator=(const X11ShmImage&) = delete;
+
+  /// Probe the extension on |dpy|.  Returns available().
+  bool Initialize(Display* dpy);
+
+  /// Release the segment.  Must be called before the display is closed.
+  void Reset();
+
+  /// True if MIT-SHM is usable on the display.
+  bool available() const { return available_; }
+
+  /// Read a |width| x |height| rectangle of |drawable| at (x, y).
+  /// Returns an XImage that stays owned by this object and is valid until the
+  /// next call to Get() or Reset() — do NOT XDestroyImage() it.
+  /// Returns nullptr on failure; after an attach failure available() turns
+  /// false so the caller can permanently fall back to XGetImage.
+  XImage* Get(Drawable drawable, int x, int y, int width, int height);
+
+ private:
+  struct Segment;
+
+  /// (Re)create the segment so it can hold at least |width| x |height|.
+  bool Allocate(int width, int height);
+
+  Display* display_ = nullptr;
+  bool available_ = false;
+  std::unique_ptr<Segment> segment_;
+};
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_PLATFORM_LINUX_X11_SHM_IMAGE_H_
@@ -0,0 +1,338 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Event-driven cache of the X11 top-level window list.
+
+#include "platform/linux/x11_window_list.h"
+
+#if defined(__linux__)
+
+#include <cstdio>
+#include <cstring>
+#include <unordered_set>
+
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+
+#include "core/logger.h"
+#include "platform/linux/x11_error_trap.h"
+
+namespace pixelgrab {
+namespace internal {
+
+namespace {
+
+constexpr long kClientEventMask = StructureNotifyMask | PropertyChangeMask;
+
+std::string ReadProcessName(uint32_t pid) {
+  char path[64];
+  std::snprintf(path, sizeof(path), "/proc/%u/comm", pid);
+  FILE* f = std::fopen(path, "r");
+  if (!f) return std::string();
+  char buf[128] = {};
+  if (!std::fgets(buf, sizeof(buf), f)) buf[0] = '\0';
+  std::fclose(f);
+  size_t len = std::strlen(buf);
+  if (len > 0 && buf[len - 1] == '\n') buf[len - 1] = '\0';
+  return buf;
+}
+
+}  // namespace
+
+X11WindowList::X11WindowList() = default;
+X11WindowList::~X11WindowList() { Shutdown(); }
+
+bool X11WindowList::Initialize() {
+  Shutdown();
+  Display* dpy = XOpenDisplay(nullptr);
+  if (!dpy) {
+    PIXELGRAB_LOG_ERROR("Failed to open X11 display for the window list");
+    return false;
+  }
+  display_ = dpy;
+  root_ = DefaultRootWindow(dpy);
+
+  // Created if missing, so a window manager that starts later is noticed
+  // through PropertyNotify on the root.
+  char* names[] = {const_cast<char*>("_NET_CLIENT_LIST_STACKING"),
+                   const_cast<char*>("_NET_CLIENT_LIST"),
+                   const_cast<char*>("_NET_WM_NAME"),
+                   const_cast<char*>("UTF8_STRING"),
+                   const_cast<char*>("_NET_WM_PID")};
+  Atom atoms[5] = {};
+  XInternAtoms(dpy, names, 5, False, atoms);
+  net_client_list_stacking_ = atoms[0];
+  net_client_list_ = atoms[1];
+  net_wm_name_ = atoms[2];
+  utf8_string_ = atoms[3];
+  net_wm_pid_ = atoms[4];
+
+  XSelectInput(dpy, root_, SubstructureNotifyMask | PropertyChangeMask);
+  list_dirty_ = true;
+  return true;
+}
+
+void X11WindowList::Shutdown() {
+  if (display_) {
+    XCloseDisplay(display_);
+    display_ = nullptr;
+  }
+  order_.clear();
+  entries_.clear();
+  process_names_.clear();
+  list_dirty_ = true;
+}
+
+std::vector<PixelGrabWindowInfo> X11WindowList::Snapshot() {
+  std::vector<PixelGrabWindowInfo> result;
+  if (!display_) return result;
+
+  // Windows can vanish between an event and the query answering it.  The
+  // queries report that through their return values; the trap only keeps
+  // the errors from reaching the default handler.
+  X11ErrorTrap trap(display_);
+  PumpEvents();
+  if (list_dirty_) RebuildList();
+
+  result.reserve(order_.size());
+  for (Window w : order_) {
+    auto it = entries_.find(w);
+    if (it == entries_.end()) continue;
+    Entry& entry = it->second;
+    if (entry.dirty) Refresh(w, &entry);
+    if (entry.viewable && entry.info.width > 1 && entry.info.height > 1) {
+      result.push_back(entry.info);
+    }
+  }
+  trap.Failed();
+  return result;
+}
+
+void X11WindowList::PumpEvents() {
+  // Every event on this connection was selected by this class.
+  XEvent ev;
+  while (XPending(display_) > 0) {
+    XNextEvent(display_, &ev);
+    HandleEvent(ev);
+  }
+}
+
+void X11WindowList::HandleEvent(const XEvent& ev) {
+  switch (ev.type) {
+    case PropertyNotify: {
+      Window w = ev.xproperty.window;
+      Atom atom = ev.xproperty.atom;
+      if (w == root_) {
+        if (atom == net_client_list_stacking_ || atom == net_client_list_) {
+          list_dirty_ = true;
+        }
+      } else if (atom == net_wm_name_ || atom == XA_WM_NAME) {
+        MarkDirty(w, kDirtyTitle);
+      } else if (atom == net_wm_pid_) {
+        MarkDirty(w, kDirtyPid);
+      }
+      break;
+    }
+    case ConfigureNotify:
+      // Moving a frame moves its client without an event on the client.
+      MarkDirty(ev.xconfigure.window, kDirtyGeometry);
+      if (!ewmh_ && ev.xconfigure.event == root_) list_dirty_ = true;
+      break;
+    case MapNotify:
+      MarkDirty(ev.xmap.window, kDirtyGeometry);
+      break;
+    case UnmapNotify:
+      MarkDirty(ev.xunmap.window, kDirtyGeometry);
+      break;
+    case ReparentNotify:
+      MarkDirty(ev.xreparent.window, kDirtyGeometry | kDirtyFrame);
+      if (!ewmh_) list_dirty_ = true;
+      break;
+    case DestroyNotify:
+      if (entries_.erase(ev.xdestroywindow.window) > 0 || !ewmh_) {
+        list_dirty_ = true;
+      }
+      break;
+    case CreateNotify:
+    case CirculateNotify:
+      if (!ewmh_) list_dirty_ = true;
+      break;
+    default:
+      break;
+  }
+}
+
+void X11WindowList::MarkDirty(Window window, uint32_t flags) {
+  auto it = entries_.find(window);
+  if (it != entries_.end()) it->second.dirty |= flags;
+  for (auto& kv : entries_) {
+    if (kv.second.frame == window) kv.second.dirty |= flags;
+  }
+}
+
+void X11WindowList::RebuildList() {
+  list_dirty_ = false;
+  std::vector<Window> list;
+
+  // Prefer EWMH _NET_CLIENT_LIST_STACKING (topmost last).
+  ewmh_ = false;
+  for (Atom prop : {net_client_list_stacking_, net_client_list_}) {
+    Atom type;
+    int fmt;
+    unsigned long items, after;
+    unsigned char* data = nullptr;
+    if (XGetWindowProperty(display_, root_, prop, 0, ~0L, False, XA_WINDOW,
+                           &type, &fmt, &items, &after, &data) == Success &&
+        data) {
+      auto* wins = reinterpret_cast<Window*>(data);
+      list.assign(wins, wins + items);
+      XFree(data);
+      ewmh_ = true;
+      break;
+    }
+  }
+  if (!ewmh_) {
+    Window root_ret, parent_ret;
+    Window* children = nullptr;
+    unsigned int n_children = 0;
+    if (XQueryTree(display_, root_, &root_ret, &parent_ret, &children,
+                   &n_children) &&
+        children) {
+      list.assign(children, children + n_children);
+      XFree(children);
+    }
+  }
+
+  std::unordered_map<Window, Entry> next;
+  next.reserve(list.size());
+  for (Window w : list) {
+    auto it = entries_.find(w);
+    if (it != entries_.end()) {
+      next.emplace(w, std::move(it->second));
+      entries_.erase(it);
+    } else {
+      // Select before the first query so no change can be missed.
+      XSelectInput(display_, w, kClientEventMask);
+      next.emplace(w, Entry());
+    }
+  }
+  // Windows that left the list but still exist stop reporting to us.
+  for (const auto& kv : entries_) {
+    XSelectInput(display_, kv.first, NoEventMask);
+  }
+  entries_ = std::move(next);
+  order_ = std::move(list);
+
+  std::unordered_set<uint32_t> live_pids;
+  for (const auto& kv : entries_) live_pids.insert(kv.second.pid);
+  for (auto it = process_names_.begin(); it != process_names_.end();) {
+    if (live_pids.count(it->first)) {
+      ++it;
+    } else {
+      it = process_names_.erase(it);
+    }
+  }
+  PIXELGRAB_LOG_DEBUG("Window list rebuilt: {} windows ({})", order_.size(),
+                      ewmh_ ? "EWMH" : "root children");
+}
+
+void X11WindowList::Refresh(Window window, Entry* entry) {
+  uint32_t dirty = entry->dirty;
+  entry->dirty = 0;
+  entry->info.id = static_cast<uint64_t>(window);
+
+  if (dirty & kDirtyFrame) {
+    // Walk up to the root's child (the window manager's frame).
+    entry->frame = window;
+    Window w = window;
+    for (;;) {
+      Window root_ret, parent = 0;
+      Window* children = nullptr;
+      unsigned int n = 0;
+      if (!XQueryTree(display_, w, &root_ret, &parent, &children, &n)) break;
+      if (children) XFree(children);
+      if (parent == root_ || parent == 0) break;
+      w = parent;
+    }
+    entry->frame = w;
+  }
+
+  if (dirty & kDirtyGeometry) {
+    XWindowAttributes a;
+    int ax = 0, ay = 0;
+    Window child;
+    if (XGetWindowAttributes(display_, window, &a) &&
+        XTranslateCoordinates(display_, window, root_, 0, 0, &ax, &ay,
+                              &child)) {
+      entry->viewable = a.map_state == IsViewable;
+      entry->info.x = ax;
+      entry->info.y = ay;
+      entry->info.width = a.width;
+      entry->info.height = a.height;
+    } else {
+      entry->viewable = false;
+    }
+    entry->info.is_visible = entry->viewable ? 1 : 0;
+  }
+
+  if (dirty & kDirtyTitle) RefreshTitle(window, entry);
+  if (dirty & kDirtyPid) RefreshPid(window, entry);
+}
+
+void X11WindowList::RefreshTitle(Window window, Entry* entry) {
+  // Window title: _NET_WM_NAME (UTF-8) > WM_NAME
+  std::memset(entry->info.title, 0, sizeof(entry->info.title));
+  Atom type;
+  int fmt;
+  unsigned long items, after;
+  unsigned char* data = nullptr;
+  if (XGetWindowProperty(display_, window, net_wm_name_, 0, 256, False,
+                         utf8_string_, &type, &fmt, &items, &after,
+                         &data) == Success &&
+      data) {
+    std::strncpy(entry->info.title, reinterpret_cast<char*>(data),
+                 sizeof(entry->info.title) - 1);
+    XFree(data);
+    return;
+  }
+  XTextProperty tp;
+  if (XGetWMName(display_, window, &tp) && tp.value) {
+    std::strncpy(entry->info.title, reinterpret_cast<char*>(tp.value),
+                 sizeof(entry->info.title) - 1);
+    XFree(tp.value);
+  }
+}
+
+void X11WindowList::RefreshPid(Window window, Entry* entry) {
+  // Process name via _NET_WM_PID + /proc/PID/comm, cached per PID.
+  std::memset(entry->info.process_name, 0, sizeof(entry->info.process_name));
+  entry->pid = 0;
+  Atom type;
+  int fmt;
+  unsigned long items, after;
+  unsigned char* data = nullptr;
+  if (XGetWindowProperty(display_, window, net_wm_pid_, 0, 1, False,
+                         XA_CARDINAL, &type, &fmt, &items, &after,
+                         &data) != Success ||
+      !data) {
+    return;
+  }
+  // Format-32 properties are returned as longs.
+  if (items > 0) {
+    entry->pid =
+        static_cast<uint32_t>(*reinterpret_cast<unsigned long*>(data));
+  }
+  XFree(data);
+  if (entry->pid == 0) return;
+
+  auto it = process_names_.find(entry->pid);
+  if (it == process_names_.end()) {
+    it = process_names_.emplace(entry->pid, ReadProcessName(entry->pid))
+             .first;
+  }
+  std::strncpy(entry->info.process_name, it->second.c_str(),
+               sizeof(entry->info.process_name) - 1);
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // __linux__
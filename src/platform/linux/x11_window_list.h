@@ -0,0 +1,103 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Event-driven cache of the X11 top-level window list.
+
+#ifndef PIXELGRAB_PLATFORM_LINUX_X11_WINDOW_LIST_H_
+#define PIXELGRAB_PLATFORM_LINUX_X11_WINDOW_LIST_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <X11/Xlib.h>
+
+#include "pixelgrab/pixelgrab.h"
+
+namespace pixelgrab {
+namespace internal {
+
+/// Keeps PixelGrabWindowInfo for every client window up to date from X
+/// events instead of re-querying each window on every enumeration.
+///
+/// The list comes from EWMH _NET_CLIENT_LIST_STACKING (or _NET_CLIENT_LIST,
+/// or the root's children without a window manager).  The root is watched
+/// for SubstructureNotify and PropertyNotify, each client for
+/// StructureNotify and PropertyNotify; an event only marks the affected
+/// part of the affected windows dirty (geometry, title or PID), and
+/// Snapshot() re-queries just those.  With nothing changed a snapshot makes
+/// no round-trip.  Process names are cached per PID, so /proc is read once
+/// per process rather than once per window and call.
+///
+/// Uses a dedicated display connection so that its event selection and
+/// queue do not interfere with the capture connection.  Not thread-safe;
+/// owned by X11CaptureBackend.
+class X11WindowList {
+ public:
+  X11WindowList();
+  ~X11WindowList();
+
+  // Non-copyable.
+  X11WindowList(const X11WindowList&) = delete;
+  X11WindowList& operator=(const X11WindowList&) = delete;
+
+  /// Open the connection and start watching the root window.
+  bool Initialize();
+
+  /// Close the connection and drop the cache.
+  void Shutdown();
+
+  /// Apply pending events and return the viewable client windows, bottom
+  /// to top when the window manager reports the stacking order.
+  std::vector<PixelGrabWindowInfo> Snapshot();
+
+ private:
+  // Parts of an entry that must be re-queried.
+  enum Dirty : uint32_t {
+    kDirtyGeometry = 1u << 0,  // Attributes and root position.
+    kDirtyFrame = 1u << 1,     // Top-level ancestor.
+    kDirtyTitle = 1u << 2,
+    kDirtyPid = 1u << 3,
+    kDirtyAll = 0xF,
+  };
+
+  struct Entry {
+    Window frame = 0;  // Child of the root containing the window.
+    uint32_t dirty = kDirtyAll;
+    bool viewable = false;
+    uint32_t pid = 0;
+    PixelGrabWindowInfo info{};
+  };
+
+  void PumpEvents();
+  void HandleEvent(const XEvent& ev);
+
+  /// Mark |window|, and every client framed by it, dirty.
+  void MarkDirty(Window window, uint32_t flags);
+
+  /// Re-read the client list; new windows start fully dirty.
+  void RebuildList();
+
+  void Refresh(Window window, Entry* entry);
+  void RefreshTitle(Window window, Entry* entry);
+  void RefreshPid(Window window, Entry* entry);
+
+  Display* display_ = nullptr;
+  Window root_ = 0;
+  bool ewmh_ = false;
+  bool list_dirty_ = true;
+
+  Atom net_client_list_stacking_ = 0;
+  Atom net_client_list_ = 0;
+  Atom net_wm_name_ = 0;
+  Atom utf8_string_ = 0;
+  Atom net_wm_pid_ = 0;
+
+  std::vector<Window> order_;                  // Current client list.
+  std::unordered_map<Window, Entry> entries_;  // Keyed by client window.
+  std::unordered_map<uint32_t, std::string> process_names_;  // By PID.
+};
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_PLATFORM_LINUX_X11_WINDOW_LIST_H_
@@ -0,0 +1,549 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// XCB capture backend with pipelined requests.
+
+#include "platform/linux/xcb_capture_backend.h"
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "core/logger.h"
+#include "platform/linux/xcb_reply.h"
+
+namespace pixelgrab {
+namespace internal {
+
+namespace {
+
+std::string ReadProcessName(uint32_t pid) {
+  char path[64];
+  std::snprintf(path, sizeof(path), "/proc/%u/comm", pid);
+  FILE* f = std::fopen(path, "r");
+  if (!f) return std::string();
+  char buf[128] = {};
+  if (!std::fgets(buf, sizeof(buf), f)) buf[0] = '\0';
+  std::fclose(f);
+  size_t len = std::strlen(buf);
+  if (len > 0 && buf[len - 1] == '\n') buf[len - 1] = '\0';
+  return buf;
+}
+
+}  // namespace
+
+XcbCaptureBackend::XcbCaptureBackend() = default;
+XcbCaptureBackend::~XcbCaptureBackend() { Shutdown(); }
+
+bool XcbCaptureBackend::Initialize() {
+  if (initialized_) return true;
+  xcb_connection_t* conn = xcb_connect(nullptr, &screen_number_);
+  if (xcb_connection_has_error(conn)) {
+    PIXELGRAB_LOG_ERROR("Failed to open XCB connection");
+    xcb_disconnect(conn);
+    return false;
+  }
+  conn_ = conn;
+
+  const xcb_setup_t* setup = xcb_get_setup(conn);
+  xcb_screen_iterator_t it = xcb_setup_roots_iterator(setup);
+  for (int i = 0; i < screen_number_ && it.rem; ++i) xcb_screen_next(&it);
+  if (!it.rem) {
+    PIXELGRAB_LOG_ERROR("XCB screen {} not found", screen_number_);
+    Shutdown();
+    return false;
+  }
+  const xcb_screen_t* screen = it.data;
+  root_ = screen->root;
+  root_width_ = screen->width_in_pixels;
+  root_height_ = screen->height_in_pixels;
+  root_depth_ = screen->root_depth;
+
+  // Pixel layout of ZPixmap images at the root depth.
+  for (auto f = xcb_setup_pixmap_formats_iterator(setup); f.rem;
+       xcb_format_next(&f)) {
+    if (f.data->depth == root_depth_) {
+      bits_per_pixel_ = f.data->bits_per_pixel;
+      scanline_pad_ = f.data->scanline_pad;
+    }
+  }
+  for (auto d = xcb_screen_allowed_depths_iterator(screen); d.rem;
+       xcb_depth_next(&d)) {
+    for (auto v = xcb_depth_visuals_iterator(d.data); v.rem;
+         xcb_visualtype_next(&v)) {
+      if (v.data->visual_id == screen->root_visual) {
+        layout_.red_mask = v.data->red_mask;
+        layout_.green_mask = v.data->green_mask;
+        layout_.blue_mask = v.data->blue_mask;
+      }
+    }
+  }
+  layout_.bytes_per_pixel = bits_per_pixel_ / 8;
+  layout_.msb_first = setup->image_byte_order == XCB_IMAGE_ORDER_MSB_FIRST;
+  if (!PixelUnpacker(layout_, kPixelGrabFormatBgra8).valid()) {
+    PIXELGRAB_LOG_ERROR("Unsupported root visual ({} bpp, depth {})",
+                        bits_per_pixel_, root_depth_);
+    Shutdown();
+    return false;
+  }
+
+  // Root resizes (RandR, or a VNC/SSH display following its client window)
+  // arrive as ConfigureNotify on the root; see PumpEvents().
+  const uint32_t event_mask = XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+  xcb_change_window_attributes(conn, root_, XCB_CW_EVENT_MASK, &event_mask);
+
+  // All atoms in one round-trip.
+  const char* names[] = {"_NET_CLIENT_LIST_STACKING", "_NET_CLIENT_LIST",
+                         "_NET_WM_NAME", "UTF8_STRING", "_NET_WM_PID"};
+  xcb_atom_t* targets[] = {&net_client_list_stacking_, &net_client_list_,
+                           &net_wm_name_, &utf8_string_, &net_wm_pid_};
+  xcb_intern_atom_cookie_t cookies[5];
+  for (int i = 0; i < 5; ++i) {
+    cookies[i] = xcb_intern_atom(conn, 1,
+                                 static_cast<uint16_t>(std::strlen(names[i])),
+                                 names[i]);
+  }
+  for (int i = 0; i < 5; ++i) {
+    auto reply = WaitReply<xcb_intern_atom_reply_t>(conn, cookies[i],
+                                                    xcb_intern_atom_reply);
+    *targets[i] = reply ? reply->atom : xcb_atom_t{XCB_ATOM_NONE};
+  }
+
+  initialized_ = true;
+  PIXELGRAB_LOG_DEBUG("XCB backend initialized: {}x{}, depth {}, {} bpp",
+                      root_width_, root_height_, root_depth_,
+                      bits_per_pixel_);
+  return true;
+}
+
+void XcbCaptureBackend::Shutdown() {
+  if (conn_) {
+    xcb_disconnect(conn_);
+    conn_ = nullptr;
+  }
+  process_names_.clear();
+  screens_changed_ = false;
+  initialized_ = false;
+}
+
+void XcbCaptureBackend::SetRootSize(int width, int height) {
+  if (width == root_width_ && height == root_height_) return;
+  PIXELGRAB_LOG_DEBUG("XCB root resized: {}x{} -> {}x{}", root_width_,
+                      root_height_, width, height);
+  root_width_ = width;
+  root_height_ = height;
+  screens_changed_ = true;
+}
+
+void XcbCaptureBackend::PumpEvents() {
+  // Non-blocking: reads what the server already sent, never waits.
+  while (xcb_generic_event_t* ev = xcb_poll_for_event(conn_)) {
+    if ((ev->response_type & ~0x80) == XCB_CONFIGURE_NOTIFY) {
+      auto* configure = reinterpret_cast<xcb_configure_notify_event_t*>(ev);
+      if (configure->window == root_) {
+        SetRootSize(configure->width, configure->height);
+      }
+    }
+    std::free(ev);
+  }
+}
+
+bool XcbCaptureBackend::RefreshRootSize() {
+  auto geom = WaitReply<xcb_get_geometry_reply_t>(
+      conn_, xcb_get_geometry(conn_, root_), xcb_get_geometry_reply);
+  if (!geom) return false;
+  const int old_width = root_width_;
+  const int old_height = root_height_;
+  SetRootSize(geom->width, geom->height);
+  return root_width_ != old_width || root_height_ != old_height;
+}
+
+bool XcbCaptureBackend::ScreensChanged() {
+  if (!initialized_) return false;
+  PumpEvents();
+  bool changed = screens_changed_;
+  screens_changed_ = false;
+  return changed;
+}
+
+std::vector<PixelGrabScreenInfo> XcbCaptureBackend::GetScreens() {
+  if (!initialized_) return {};
+  PumpEvents();
+  PixelGrabScreenInfo info{};
+  info.width = root_width_;
+  info.height = root_height_;
+  info.is_primary = 1;
+  std::snprintf(info.name, sizeof(info.name), "Screen %d", screen_number_);
+  return {info};
+}
+
+bool XcbCaptureBackend::ClipToRoot(int* x, int* y, int* width,
+                                   int* height) const {
+  int x0 = std::max(*x, 0);
+  int y0 = std::max(*y, 0);
+  int x1 = std::min(*x + *width, root_width_);
+  int y1 = std::min(*y + *height, root_height_);
+  if (x1 <= x0 || y1 <= y0) return false;
+  *x = x0;
+  *y = y0;
+  *width = x1 - x0;
+  *height = y1 - y0;
+  return true;
+}
+
+xcb_get_image_cookie_t XcbCaptureBackend::RequestImage(
+    xcb_drawable_t drawable, int x, int y, int width, int height) {
+  return xcb_get_image(conn_, XCB_IMAGE_FORMAT_Z_PIXMAP, drawable,
+                       static_cast<int16_t>(x), static_cast<int16_t>(y),
+                       static_cast<uint16_t>(width),
+                       static_cast<uint16_t>(height), ~0u);
+}
+
+bool XcbCaptureBackend::ReceiveImage(xcb_get_image_cookie_t cookie, int width,
+                                     int height, uint8_t* dst, int dst_stride,
+                                     PixelGrabPixelFormat format) {
+  auto reply =
+      WaitReply<xcb_get_image_reply_t>(conn_, cookie, xcb_get_image_reply);
+  if (!reply) {
+    PIXELGRAB_LOG_ERROR("xcb_get_image failed for {}x{}", width, height);
+    return false;
+  }
+  if (reply->depth != root_depth_) {
+    PIXELGRAB_LOG_ERROR("xcb_get_image returned depth {}, expected {}",
+                        reply->depth, root_depth_);
+    return false;
+  }
+  // Scanlines are padded to the format's scanline_pad bits.
+  size_t row_bytes =
+      ((static_cast<size_t>(width) * bits_per_pixel_ + scanline_pad_ - 1) /
+       scanline_pad_) *
+      (scanline_pad_ / 8);
+  if (static_cast<size_t>(xcb_get_image_data_length(reply.get())) <
+      row_bytes * height) {
+    PIXELGRAB_LOG_ERROR("Short xcb_get_image reply");
+    return false;
+  }
+  PixelUnpacker unpacker(layout_, format);
+  const uint8_t* src = xcb_get_image_data(reply.get());
+  for (int row = 0; row < height; ++row) {
+    unpacker.Run(src + row * row_bytes,
+                 dst + static_cast<ptrdiff_t>(row) * dst_stride,
+                 static_cast<size_t>(width));
+  }
+  return true;
+}
+
+std::unique_ptr<Image> XcbCaptureBackend::ReceiveImage(
+    xcb_get_image_cookie_t cookie, int width, int height) {
+  auto img = Image::CreateUninitialized(width, height, output_format_);
+  if (!img) {
+    xcb_discard_reply(conn_, cookie.sequence);
+    return nullptr;
+  }
+  if (!ReceiveImage(cookie, width, height, img->mutable_data(),
+                    img->stride(), output_format_)) {
+    return nullptr;
+  }
+  return img;
+}
+
+std::unique_ptr<Image> XcbCaptureBackend::CaptureScreen(int screen_index) {
+  if (!initialized_) return nullptr;
+  if (screen_index != 0) {
+    PIXELGRAB_LOG_ERROR("Screen index {} out of range (1 screen)",
+                        screen_index);
+    return nullptr;
+  }
+  PumpEvents();
+  return CaptureRegion(0, 0, root_width_, root_height_);
+}
+
+std::unique_ptr<Image> XcbCaptureBackend::CaptureRegion(int x, int y,
+                                                        int width,
+                                                        int height) {
+  if (!initialized_) return nullptr;
+  PumpEvents();
+  // A read past the root fails with BadMatch.  If the root shrank before
+  // its ConfigureNotify came in, re-clip against the real size once.
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    int x0 = x, y0 = y, w = width, h = height;
+    if (!ClipToRoot(&x0, &y0, &w, &h)) return nullptr;
+    auto img = ReceiveImage(RequestImage(root_, x0, y0, w, h), w, h);
+    if (img || !RefreshRootSize()) return img;
+  }
+  return nullptr;
+}
+
+bool XcbCaptureBackend::SetOutputFormat(PixelGrabPixelFormat format) {
+  output_format_ = format;
+  return true;
+}
+
+bool XcbCaptureBackend::CaptureRegionInto(int x, int y, int width, int height,
+                                          uint8_t* dst, int dst_stride) {
+  if (!initialized_ || !dst) return false;
+  PumpEvents();
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    int x0 = x, y0 = y, w = width, h = height;
+    if (!ClipToRoot(&x0, &y0, &w, &h)) return false;
+    uint8_t* origin = dst + static_cast<ptrdiff_t>(y0 - y) * dst_stride +
+                      static_cast<ptrdiff_t>(x0 - x) * 4;
+    if (ReceiveImage(RequestImage(root_, x0, y0, w, h), w, h, origin,
+                     dst_stride, kPixelGrabFormatBgra8)) {
+      return true;
+    }
+    if (!RefreshRootSize()) return false;
+  }
+  return false;
+}
+
+std::vector<std::unique_ptr<Image>> XcbCaptureBackend::CaptureRegions(
+    const std::vector<PixelGrabRect>& rects) {
+  std::vector<std::unique_ptr<Image>> images(rects.size());
+  if (!initialized_) return images;
+  PumpEvents();
+
+  // Send every read first; the replies then stream back in one round-trip.
+  struct Pending {
+    bool sent = false;
+    PixelGrabRect rect{};
+    xcb_get_image_cookie_t cookie{};
+  };
+  std::vector<Pending> pending(rects.size());
+  for (size_t i = 0; i < rects.size(); ++i) {
+    PixelGrabRect r = rects[i];
+    if (!ClipToRoot(&r.x, &r.y, &r.width, &r.height)) continue;
+    pending[i].sent = true;
+    pending[i].rect = r;
+    pending[i].cookie = RequestImage(root_, r.x, r.y, r.width, r.height);
+  }
+  bool failed = false;
+  for (size_t i = 0; i < rects.size(); ++i) {
+    if (!pending[i].sent) continue;
+    images[i] = ReceiveImage(pending[i].cookie, pending[i].rect.width,
+                             pending[i].rect.height);
+    if (!images[i]) failed = true;
+  }
+  // Reads clipped against a stale root size: redo them against the new one.
+  if (failed && RefreshRootSize()) {
+    for (size_t i = 0; i < rects.size(); ++i) {
+      if (images[i]) continue;
+      const PixelGrabRect& r = rects[i];
+      images[i] = CaptureRegion(r.x, r.y, r.width, r.height);
+    }
+  }
+  return images;
+}
+
+std::unique_ptr<Image> XcbCaptureBackend::CaptureWindow(
+    uint64_t window_handle) {
+  if (!initialized_) return nullptr;
+  PumpEvents();
+  auto win = static_cast<xcb_window_t>(window_handle);
+
+  auto attrs_cookie = xcb_get_window_attributes(conn_, win);
+  auto geom_cookie = xcb_get_geometry(conn_, win);
+  auto pos_cookie = xcb_translate_coordinates(conn_, win, root_, 0, 0);
+  auto attrs = WaitReply<xcb_get_window_attributes_reply_t>(
+      conn_, attrs_cookie, xcb_get_window_attributes_reply);
+  auto geom = WaitReply<xcb_get_geometry_reply_t>(conn_, geom_cookie,
+                                             xcb_get_geometry_reply);
+  auto pos = WaitReply<xcb_translate_coordinates_reply_t>(
+      conn_, pos_cookie, xcb_translate_coordinates_reply);
+  if (!attrs || !geom || !pos) {
+    PIXELGRAB_LOG_ERROR("Window 0x{:X} attribute query failed", window_handle);
+    return nullptr;
+  }
+  // An unmapped (e.g. minimized) window has no pixels on screen: the root
+  // read below would return whatever lies where it used to be, and reading
+  // the window itself fails with BadMatch.
+  if (attrs->map_state != XCB_MAP_STATE_VIEWABLE) {
+    PIXELGRAB_LOG_ERROR("Window 0x{:X} is not viewable", window_handle);
+    return nullptr;
+  }
+  int x = pos->dst_x, y = pos->dst_y;
+  int width = geom->width, height = geom->height;
+
+  // Fully on-screen windows are read from the root (includes child windows
+  // of other depths); otherwise, or if the root shrank meanwhile, read the
+  // window itself.
+  if (x >= 0 && y >= 0 && x + width <= root_width_ &&
+      y + height <= root_height_) {
+    auto img = ReceiveImage(RequestImage(root_, x, y, width, height), width,
+                            height);
+    if (img || !RefreshRootSize()) return img;
+  }
+  return ReceiveImage(RequestImage(win, 0, 0, width, height), width, height);
+}
+
+std::vector<PixelGrabWindowInfo> XcbCaptureBackend::EnumerateWindows() {
+  std::vector<PixelGrabWindowInfo> result;
+  if (!initialized_) return result;
+
+  // Round-trip 1: every source of the window list at once.
+  auto stacking_cookie =
+      xcb_get_property(conn_, 0, root_, net_client_list_stacking_,
+                       XCB_ATOM_WINDOW, 0, ~0u >> 2);
+  auto client_cookie = xcb_get_property(conn_, 0, root_, net_client_list_,
+                                        XCB_ATOM_WINDOW, 0, ~0u >> 2);
+  auto tree_cookie = xcb_query_tree(conn_, root_);
+
+  std::vector<xcb_window_t> wins;
+  // Prefer EWMH _NET_CLIENT_LIST_STACKING (topmost last).
+  for (auto cookie : {stacking_cookie, client_cookie}) {
+    auto reply = WaitReply<xcb_get_property_reply_t>(conn_, cookie,
+                                                     xcb_get_property_reply);
+    if (wins.empty() && reply && reply->format == 32 &&
+        reply->type == XCB_ATOM_WINDOW) {
+      auto* data =
+          static_cast<xcb_window_t*>(xcb_get_property_value(reply.get()));
+      wins.assign(data, data + xcb_get_property_value_length(reply.get()) / 4);
+    }
+  }
+  auto tree = WaitReply<xcb_query_tree_reply_t>(conn_, tree_cookie,
+                                                xcb_query_tree_reply);
+  if (wins.empty() && tree) {
+    xcb_window_t* children = xcb_query_tree_children(tree.get());
+    wins.assign(children,
+                children + xcb_query_tree_children_length(tree.get()));
+  }
+
+  // Round-trip 2: everything about every window.
+  struct Pending {
+    xcb_get_window_attributes_cookie_t attrs;
+    xcb_get_geometry_cookie_t geom;
+    xcb_translate_coordinates_cookie_t pos;
+    xcb_get_property_cookie_t net_name;
+    xcb_get_property_cookie_t wm_name;
+    xcb_get_property_cookie_t pid;
+  };
+  std::vector<Pending> pending(wins.size());
+  for (size_t i = 0; i < wins.size(); ++i) {
+    xcb_window_t w = wins[i];
+    Pending& p = pending[i];
+    p.attrs = xcb_get_window_attributes(conn_, w);
+    p.geom = xcb_get_geometry(conn_, w);
+    p.pos = xcb_translate_coordinates(conn_, w, root_, 0, 0);
+    p.net_name =
+        xcb_get_property(conn_, 0, w, net_wm_name_, utf8_string_, 0, 64);
+    p.wm_name = xcb_get_property(conn_, 0, w, XCB_ATOM_WM_NAME,
+                                 XCB_GET_PROPERTY_TYPE_ANY, 0, 64);
+    p.pid = xcb_get_property(conn_, 0, w, net_wm_pid_, XCB_ATOM_CARDINAL, 0,
+                             1);
+  }
+
+  std::unordered_map<uint32_t, std::string> live_names;
+  for (size_t i = 0; i < wins.size(); ++i) {
+    Pending& p = pending[i];
+    auto attrs = WaitReply<xcb_get_window_attributes_reply_t>(
+        conn_, p.attrs, xcb_get_window_attributes_reply);
+    auto geom = WaitReply<xcb_get_geometry_reply_t>(conn_, p.geom,
+                                                    xcb_get_geometry_reply);
+    auto pos = WaitReply<xcb_translate_coordinates_reply_t>(
+        conn_, p.pos, xcb_translate_coordinates_reply);
+    auto net_name = WaitReply<xcb_get_property_reply_t>(conn_, p.net_name,
+                                                   xcb_get_property_reply);
+    auto wm_name = WaitReply<xcb_get_property_reply_t>(conn_, p.wm_name,
+                                                  xcb_get_property_reply);
+    auto pid = WaitReply<xcb_get_property_reply_t>(conn_, p.pid,
+                                                   xcb_get_property_reply);
+
+    if (!attrs || !geom || !pos) continue;
+    if (attrs->map_state != XCB_MAP_STATE_VIEWABLE || geom->width <= 1 ||
+        geom->height <= 1) {
+      continue;
+    }
+
+    PixelGrabWindowInfo info{};
+    info.id = static_cast<uint64_t>(wins[i]);
+    info.x = pos->dst_x;
+    info.y = pos->dst_y;
+    info.width = geom->width;
+    info.height = geom->height;
+    info.is_visible = 1;
+
+    // Window title: _NET_WM_NAME (UTF-8) > WM_NAME
+    for (const auto* name : {net_name.get(), wm_name.get()}) {
+      if (!name || name->format != 8) continue;
+      int len = xcb_get_property_value_length(name);
+      if (len <= 0) continue;
+      std::snprintf(info.title, sizeof(info.title), "%.*s", len,
+                    static_cast<const char*>(xcb_get_property_value(name)));
+      break;
+    }
+
+    // Process name via _NET_WM_PID + /proc/PID/comm, cached per PID.
+    if (pid && pid->format == 32 && xcb_get_property_value_length(pid.get())) {
+      uint32_t id = *static_cast<uint32_t*>(xcb_get_property_value(pid.get()));
+      auto cached = process_names_.find(id);
+      auto& name = live_names[id];
+      if (name.empty()) {
+        name = cached != process_names_.end() ? cached->second
+                                              : ReadProcessName(id);
+      }
+      std::snprintf(info.process_name, sizeof(info.process_name), "%s",
+                    name.c_str());
+    }
+
+    result.push_back(info);
+  }
+  // Forget processes that no longer own a window.
+  process_names_ = std::move(live_names);
+  return result;
+}
+
+bool XcbCaptureBackend::EnableDpiAwareness() { return true; }
+
+bool XcbCaptureBackend::GetDpiInfo(int screen_index,
+                                   PixelGrabDpiInfo* out_info) {
+  if (!out_info) return false;
+
+  out_info->screen_index = screen_index;
+  out_info->scale_x = 1.0f;
+  out_info->scale_y = 1.0f;
+  out_info->dpi_x = 96;
+  out_info->dpi_y = 96;
+
+  if (!initialized_) return true;
+
+  // Xft.dpi from the RESOURCE_MANAGER string (what XGetDefault reads).
+  auto cookie = xcb_get_property(conn_, 0, root_, XCB_ATOM_RESOURCE_MANAGER,
+                                 XCB_ATOM_STRING, 0, 16384);
+  auto reply = WaitReply<xcb_get_property_reply_t>(conn_, cookie,
+                                                   xcb_get_property_reply);
+  if (reply && reply->format == 8) {
+    std::string resources(
+        static_cast<const char*>(xcb_get_property_value(reply.get())),
+        xcb_get_property_value_length(reply.get()));
+    size_t at = resources.find("Xft.dpi:");
+    if (at != std::string::npos) {
+      int dpi = std::atoi(resources.c_str() + at + 8);
+      if (dpi > 0) {
+        out_info->dpi_x = dpi;
+        out_info->dpi_y = dpi;
+        out_info->scale_x = static_cast<float>(dpi) / 96.0f;
+        out_info->scale_y = static_cast<float>(dpi) / 96.0f;
+        return true;
+      }
+    }
+  }
+
+  const char* gdk_scale = std::getenv("GDK_SCALE");
+  if (gdk_scale) {
+    float scale = static_cast<float>(std::atof(gdk_scale));
+    if (scale > 0.0f) {
+      out_info->scale_x = scale;
+      out_info->scale_y = scale;
+      out_info->dpi_x = static_cast<int>(96.0f * scale);
+      out_info->dpi_y = static_cast<int>(96.0f * scale);
+    }
+  }
+
+  return true;
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // __linux__
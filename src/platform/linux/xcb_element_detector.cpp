@@ -0,0 +1,190 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Linux element detector on XCB with pipelined window queries.
+
+#include "platform/linux/xcb_element_detector.h"
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <cstring>
+
+#include "core/logger.h"
+#include "platform/linux/xcb_reply.h"
+
+namespace pixelgrab {
+namespace internal {
+
+XcbElementDetector::~XcbElementDetector() {
+  if (conn_) xcb_disconnect(conn_);
+}
+
+bool XcbElementDetector::Initialize() {
+  if (conn_) return true;
+  int screen_number = 0;
+  xcb_connection_t* conn = xcb_connect(nullptr, &screen_number);
+  if (xcb_connection_has_error(conn)) {
+    PIXELGRAB_LOG_WARN("Failed to open XCB connection for element detection");
+    xcb_disconnect(conn);
+    return false;
+  }
+  xcb_screen_iterator_t it = xcb_setup_roots_iterator(xcb_get_setup(conn));
+  for (int i = 0; i < screen_number && it.rem; ++i) xcb_screen_next(&it);
+  if (!it.rem) {
+    xcb_disconnect(conn);
+    return false;
+  }
+  conn_ = conn;
+  root_ = it.data->root;
+
+  auto name_cookie = xcb_intern_atom(conn_, 1, 12, "_NET_WM_NAME");
+  auto utf8_cookie = xcb_intern_atom(conn_, 1, 11, "UTF8_STRING");
+  auto name = WaitReply<xcb_intern_atom_reply_t>(conn_, name_cookie,
+                                                 xcb_intern_atom_reply);
+  auto utf8 = WaitReply<xcb_intern_atom_reply_t>(conn_, utf8_cookie,
+                                                 xcb_intern_atom_reply);
+  net_wm_name_ = name ? name->atom : xcb_atom_t{XCB_ATOM_NONE};
+  utf8_string_ = utf8 ? utf8->atom : xcb_atom_t{XCB_ATOM_NONE};
+  return true;
+}
+
+std::vector<xcb_window_t> XcbElementDetector::FindPath(int x, int y) {
+  std::vector<xcb_window_t> path;
+  xcb_window_t parent = root_;
+  int origin_x = 0, origin_y = 0;  // Root position of |parent|'s interior.
+
+  for (;;) {
+    auto tree = WaitReply<xcb_query_tree_reply_t>(
+        conn_, xcb_query_tree(conn_, parent), xcb_query_tree_reply);
+    if (!tree) break;
+    const xcb_window_t* children = xcb_query_tree_children(tree.get());
+    int n = xcb_query_tree_children_length(tree.get());
+
+    // One round-trip for the whole level.
+    std::vector<xcb_get_window_attributes_cookie_t> attrs(n);
+    std::vector<xcb_get_geometry_cookie_t> geoms(n);
+    for (int i = 0; i < n; ++i) {
+      attrs[i] = xcb_get_window_attributes(conn_, children[i]);
+      geoms[i] = xcb_get_geometry(conn_, children[i]);
+    }
+
+    // Walk children back-to-front (topmost last in X11 stacking order).
+    xcb_window_t hit = 0;
+    int hit_x = 0, hit_y = 0;
+    for (int i = n - 1; i >= 0; --i) {
+      auto a = WaitReply<xcb_get_window_attributes_reply_t>(
+          conn_, attrs[i], xcb_get_window_attributes_reply);
+      auto g = WaitReply<xcb_get_geometry_reply_t>(conn_, geoms[i],
+                                                   xcb_get_geometry_reply);
+      if (hit || !a || !g || a->map_state != XCB_MAP_STATE_VIEWABLE) {
+        continue;
+      }
+      int abs_x = origin_x + g->x + g->border_width;
+      int abs_y = origin_y + g->y + g->border_width;
+      if (x >= abs_x && x < abs_x + g->width && y >= abs_y &&
+          y < abs_y + g->height) {
+        hit = children[i];
+        hit_x = abs_x;
+        hit_y = abs_y;
+      }
+    }
+    if (!hit) break;
+    path.push_back(hit);
+    parent = hit;
+    origin_x = hit_x;
+    origin_y = hit_y;
+  }
+  return path;
+}
+
+void XcbElementDetector::FillInfos(const std::vector<xcb_window_t>& windows,
+                                   ElementInfo* out) {
+  struct Pending {
+    xcb_get_geometry_cookie_t geom;
+    xcb_translate_coordinates_cookie_t pos;
+    xcb_get_property_cookie_t net_name;
+    xcb_get_property_cookie_t wm_name;
+    xcb_get_property_cookie_t wm_class;
+  };
+  std::vector<Pending> pending(windows.size());
+  for (size_t i = 0; i < windows.size(); ++i) {
+    xcb_window_t w = windows[i];
+    pending[i].geom = xcb_get_geometry(conn_, w);
+    pending[i].pos = xcb_translate_coordinates(conn_, w, root_, 0, 0);
+    pending[i].net_name =
+        xcb_get_property(conn_, 0, w, net_wm_name_, utf8_string_, 0, 256);
+    pending[i].wm_name = xcb_get_property(conn_, 0, w, XCB_ATOM_WM_NAME,
+                                          XCB_GET_PROPERTY_TYPE_ANY, 0, 256);
+    pending[i].wm_class = xcb_get_property(conn_, 0, w, XCB_ATOM_WM_CLASS,
+                                           XCB_ATOM_STRING, 0, 256);
+  }
+
+  for (size_t i = 0; i < windows.size(); ++i) {
+    const Pending& p = pending[i];
+    ElementInfo* info = &out[i];
+    *info = ElementInfo{};
+    auto geom = WaitReply<xcb_get_geometry_reply_t>(conn_, p.geom,
+                                                    xcb_get_geometry_reply);
+    auto pos = WaitReply<xcb_translate_coordinates_reply_t>(
+        conn_, p.pos, xcb_translate_coordinates_reply);
+    auto net_name = WaitReply<xcb_get_property_reply_t>(
+        conn_, p.net_name, xcb_get_property_reply);
+    auto wm_name = WaitReply<xcb_get_property_reply_t>(
+        conn_, p.wm_name, xcb_get_property_reply);
+    auto wm_class = WaitReply<xcb_get_property_reply_t>(
+        conn_, p.wm_class, xcb_get_property_reply);
+    if (!geom || !pos) continue;
+
+    info->x = pos->dst_x;
+    info->y = pos->dst_y;
+    info->width = geom->width;
+    info->height = geom->height;
+
+    // Window title: _NET_WM_NAME (UTF-8) > WM_NAME
+    for (const auto* name : {net_name.get(), wm_name.get()}) {
+      if (!name || name->format != 8) continue;
+      int len = xcb_get_property_value_length(name);
+      if (len <= 0) continue;
+      info->name.assign(static_cast<const char*>(xcb_get_property_value(name)),
+                        static_cast<size_t>(len));
+      break;
+    }
+
+    // WM_CLASS ("instance\0class\0") as the "role"
+    if (wm_class && wm_class->format == 8) {
+      const char* value =
+          static_cast<const char*>(xcb_get_property_value(wm_class.get()));
+      int len = xcb_get_property_value_length(wm_class.get());
+      const char* sep = static_cast<const char*>(std::memchr(value, '\0', len));
+      if (sep && sep + 1 < value + len) {
+        info->role.assign(sep + 1, strnlen(sep + 1, value + len - sep - 1));
+      }
+    }
+  }
+}
+
+bool XcbElementDetector::DetectElement(int screen_x, int screen_y,
+                                       ElementInfo* out_info) {
+  if (!out_info || !conn_) return false;
+  auto path = FindPath(screen_x, screen_y);
+  if (path.empty()) return false;
+  FillInfos({path.back()}, out_info);
+  return true;
+}
+
+int XcbElementDetector::DetectElements(int screen_x, int screen_y,
+                                       ElementInfo* out_infos,
+                                       int max_count) {
+  if (!out_infos || max_count <= 0 || !conn_) return 0;
+  auto path = FindPath(screen_x, screen_y);
+
+  // Deepest first, like X11ElementDetector.
+  std::reverse(path.begin(), path.end());
+  if (static_cast<int>(path.size()) > max_count) path.resize(max_count);
+  FillInfos(path, out_infos);
+  return static_cast<int>(path.size());
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // __linux__
@@ -0,0 +1,38 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Ownership helpers for XCB replies.
+
+#ifndef PIXELGRAB_PLATFORM_LINUX_XCB_REPLY_H_
+#define PIXELGRAB_PLATFORM_LINUX_XCB_REPLY_H_
+
+#include <cstdlib>
+#include <memory>
+
+#include <xcb/xcb.h>
+
+namespace pixelgrab {
+namespace internal {
+
+/// Frees an XCB reply (malloc'ed by libxcb).
+template <typename T>
+struct XcbReplyDeleter {
+  void operator()(T* p) const { std::free(p); }
+};
+
+template <typename T>
+using XcbReply = std::unique_ptr<T, XcbReplyDeleter<T>>;
+
+/// Wait for the reply to |cookie| using the matching xcb_*_reply function.
+/// Protocol errors (e.g. a window destroyed meanwhile) are dropped and
+/// reported as a null reply.
+template <typename T, typename Cookie, typename ReplyFn>
+XcbReply<T> WaitReply(xcb_connection_t* conn, Cookie cookie, ReplyFn fn) {
+  xcb_generic_error_t* error = nullptr;
+  XcbReply<T> reply(fn(conn, cookie, &error));
+  if (error) std::free(error);
+  return reply;
+}
+
+}  // namespace internal
+}  // namespace pixelgrab
+
+#endif  // PIXELGRAB_PLATFORM_LINUX_XCB_REPLY_H_
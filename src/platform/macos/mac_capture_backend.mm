@@ -9,6 +9,7 @@
 #include <cstring>
 #include <string>
 
+#include "core/display_manager.h"
 #include "core/image.h"
 
 namespace pixelgrab {
@@ -77,6 +78,17 @@ std::unique_ptr<CaptureBackend> CreatePlatformBackend() {
   return std::make_unique<MacCaptureBackend>();
 }
 
+std::unique_ptr<CaptureBackend> CreateCaptureBackend(
+    PixelGrabBackendType type) {
+  if (type != kPixelGrabBackendDefault) return nullptr;
+  return CreatePlatformBackend();
+}
+
+// Subsystems call the system APIs directly; nothing to share.
+std::unique_ptr<DisplayManager> CreatePlatformDisplayManager() {
+  return nullptr;
+}
+
 }  // namespace internal
 }  // namespace pixelgrab
 
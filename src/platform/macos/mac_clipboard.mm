@@ -22,7 +22,8 @@ std::string MacClipboardReader::ReadText() {
   return "";
 }
 
-std::unique_ptr<ClipboardReader> CreatePlatformClipboardReader() {
+std::unique_ptr<ClipboardReader> CreatePlatformClipboardReader(
+    DisplayManager* /*displays*/) {
   return std::make_unique<MacClipboardReader>();
 }
 
@@ -36,7 +36,8 @@ void MacPinWindowBackend::SetVisible(bool v) { (void)v; }
 bool MacPinWindowBackend::IsVisible() const { return valid_; }
 bool MacPinWindowBackend::ProcessEvents() { return valid_; }
 
-std::unique_ptr<PinWindowBackend> CreatePlatformPinWindowBackend() {
+std::unique_ptr<PinWindowBackend> CreatePlatformPinWindowBackend(
+    DisplayManager* /*displays*/) {
   return std::make_unique<MacPinWindowBackend>();
 }
 
@@ -18,7 +18,9 @@
 #include <string>
 #include <vector>
 
+#include "core/display_manager.h"
 #include "core/image.h"
+#include "core/pixel_convert.h"
 
 namespace pixelgrab {
 namespace internal {
@@ -341,23 +343,23 @@ std::unique_ptr<Image> WinCaptureBackend::CaptureRegionGdi(int x, int y,
   bmi.biBitCount = 32;
   bmi.biCompression = BI_RGB;
 
-  int stride = width * 4;
-  std::vector<uint8_t> data(static_cast<size_t>(stride) * height);
-  GetDIBits(mem_dc, bitmap, 0, height, data.data(),
-            reinterpret_cast<BITMAPINFO*>(&bmi), DIB_RGB_COLORS);
+  // Pooled storage: repeated same-size captures reuse the same block.
+  auto img = Image::CreateUninitialized(width, height, kPixelGrabFormatBgra8);
+  if (img) {
+    uint8_t* data = img->mutable_data();
+    GetDIBits(mem_dc, bitmap, 0, height, data,
+              reinterpret_cast<BITMAPINFO*>(&bmi), DIB_RGB_COLORS);
 
-  // GDI captures leave alpha=0x00; set to 0xFF (opaque) so that GDI+
-  // SourceOver compositing works correctly in annotation rendering.
-  for (size_t i = 3; i < data.size(); i += 4) {
-    data[i] = 0xFF;
+    // GDI captures leave alpha=0x00; set to 0xFF (opaque) so that GDI+
+    // SourceOver compositing works correctly in annotation rendering.
+    CopyOpaque(data, data, img->data_size() / 4);
   }
 
   DeleteObject(bitmap);
   DeleteDC(mem_dc);
   ReleaseDC(nullptr, screen_dc);
 
-  return Image::CreateFromData(width, height, stride, kPixelGrabFormatBgra8,
-                               std::move(data));
+  return img;
 }
 
 std::unique_ptr<Image> WinCaptureBackend::CaptureWindowGdi(
@@ -410,9 +412,7 @@ std::unique_ptr<Image> WinCaptureBackend::CaptureWindowGdi(
 
   // GDI captures leave alpha=0x00; set to 0xFF (opaque) so that GDI+
   // SourceOver compositing works correctly in annotation rendering.
-  for (size_t i = 3; i < data.size(); i += 4) {
-    data[i] = 0xFF;
-  }
+  CopyOpaque(data.data(), data.data(), data.size() / 4);
 
   DeleteObject(bitmap);
   DeleteDC(mem_dc);
@@ -430,6 +430,17 @@ std::unique_ptr<CaptureBackend> CreatePlatformBackend() {
   return std::make_unique<WinCaptureBackend>();
 }
 
+std::unique_ptr<CaptureBackend> CreateCaptureBackend(
+    PixelGrabBackendType type) {
+  if (type != kPixelGrabBackendDefault) return nullptr;
+  return CreatePlatformBackend();
+}
+
+// Subsystems call the system APIs directly; nothing to share.
+std::unique_ptr<DisplayManager> CreatePlatformDisplayManager() {
+  return nullptr;
+}
+
 }  // namespace internal
 }  // namespace pixelgrab
 
@@ -152,7 +152,8 @@ std::string WinClipboardReader::ReadText() {
 }
 
 // Factory implementation.
-std::unique_ptr<ClipboardReader> CreatePlatformClipboardReader() {
+std::unique_ptr<ClipboardReader> CreatePlatformClipboardReader(
+    DisplayManager* /*displays*/) {
   return std::make_unique<WinClipboardReader>();
 }
 
@@ -250,11 +250,18 @@ int WinElementDetector::DetectElements(int screen_x, int screen_y,
 }
 
 // Factory implementation.
-std::unique_ptr<ElementDetector> CreatePlatformElementDetector() {
+std::unique_ptr<ElementDetector> CreatePlatformElementDetector(
+    DisplayManager* /*displays*/) {
   auto detector = std::make_unique<WinElementDetector>();
   if (!detector->Initialize()) return nullptr;
   return detector;
 }
 
+std::unique_ptr<ElementDetector> CreateElementDetector(
+    PixelGrabBackendType type, DisplayManager* displays) {
+  if (type != kPixelGrabBackendDefault) return nullptr;
+  return CreatePlatformElementDetector(displays);
+}
+
 }  // namespace internal
 }  // namespace pixelgrab
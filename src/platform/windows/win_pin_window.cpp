@@ -236,13 +236,8 @@ bool WinPinWindowBackend::SetImageContent(const Image* image) {
   bitmap_height_ = h;
   content_type_ = PinContentType::kImage;
 
-  // Cache a copy of the image data for GetImageContent().
-  image_copy_width_ = w;
-  image_copy_height_ = h;
-  image_copy_stride_ = image->stride();
-  image_copy_format_ = image->format();
-  image_copy_data_.assign(image->data(),
-                          image->data() + image->data_size());
+  // Keep the image for GetImageContent(); Clone() shares the pixels.
+  image_content_ = image->Clone();
 
   // Resize window to match image.
   SetWindowPos(hwnd_, nullptr, 0, 0, w, h,
@@ -257,22 +252,16 @@ bool WinPinWindowBackend::SetTextContent(const char* text) {
   text_content_ = text;
   content_type_ = PinContentType::kText;
   // Clear image cache when switching to text.
-  image_copy_data_.clear();
-  image_copy_width_ = 0;
-  image_copy_height_ = 0;
+  image_content_.reset();
   InvalidateRect(hwnd_, nullptr, TRUE);
   return true;
 }
 
 std::unique_ptr<Image> WinPinWindowBackend::GetImageContent() const {
-  if (content_type_ != PinContentType::kImage || image_copy_data_.empty()) {
+  if (content_type_ != PinContentType::kImage || !image_content_) {
     return nullptr;
   }
-  // Return a deep copy of the cached image data.
-  std::vector<uint8_t> copy(image_copy_data_);
-  return Image::CreateFromData(image_copy_width_, image_copy_height_,
-                               image_copy_stride_, image_copy_format_,
-                               std::move(copy));
+  return image_content_->Clone();
 }
 
 void WinPinWindowBackend::GetPosition(int* out_x, int* out_y) const {
@@ -392,7 +381,8 @@ void WinPinWindowBackend::Paint(HDC hdc) {
 }
 
 // Factory implementation.
-std::unique_ptr<PinWindowBackend> CreatePlatformPinWindowBackend() {
+std::unique_ptr<PinWindowBackend> CreatePlatformPinWindowBackend(
+    DisplayManager* /*displays*/) {
   return std::make_unique<WinPinWindowBackend>();
 }
 
@@ -10,6 +10,7 @@
 #include <windows.h>
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -65,12 +66,8 @@ class WinPinWindowBackend : public PinWindowBackend {
   int bitmap_height_ = 0;
   std::string text_content_;
 
-  // Cached copy of image data for GetImageContent().
-  int image_copy_width_ = 0;
-  int image_copy_height_ = 0;
-  int image_copy_stride_ = 0;
-  PixelGrabPixelFormat image_copy_format_ = kPixelGrabFormatBgra8;
-  std::vector<uint8_t> image_copy_data_;
+  // Image content for GetImageContent() (shares the caller's pixels).
+  std::unique_ptr<Image> image_content_;
 
   // Drag support.
   bool dragging_ = false;
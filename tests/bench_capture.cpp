@@ -3,11 +3,40 @@
 // Simple performance benchmarks for capture operations.
 // Compile: cmake --build build --config Release --target pixelgrab_bench
 // Run:     build/bin/Release/pixelgrab_bench
+// Headless (CI, no display server): set PIXELGRAB_BACKEND=synthetic to
+// run on a reproducible generated scene, configured e.g. with
+// PIXELGRAB_SYNTHETIC=screens=2,width=3840,height=2160,damage=10.
+// History codecs: pass a directory of screenshots (PNG, JPEG, BMP) as the
+// first argument or in PIXELGRAB_BENCH_CORPUS.
 
+#include <algorithm>
 #include <chrono>
 #include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4996)  // fopen deprecation in stb
+#elif defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+#endif
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#elif defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#include "core/history_codec.h"
 #include "pixelgrab/pixelgrab.h"
 
 struct BenchResult {
@@ -46,7 +75,132 @@ void PrintResult(const BenchResult& r) {
               r.name, r.iterations, r.avg_ms, r.min_ms, r.max_ms);
 }
 
-int main() {
+// Wall-clock throughput of |threads| workers sharing one context, each
+// running |iterations| rounds of region capture + color pick, with a window
+// enumeration every 8th round.
+double RunContention(PixelGrabContext* ctx, int threads, int iterations) {
+  auto t0 = std::chrono::high_resolution_clock::now();
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([ctx, t, iterations]() {
+      PixelGrabWindowInfo windows[64];
+      for (int i = 0; i < iterations; ++i) {
+        pixelgrab_image_destroy(
+            pixelgrab_capture_region(ctx, t * 64, 0, 256, 256));
+        PixelGrabColor c = {};
+        pixelgrab_pick_color(ctx, t * 64 + 10, 10, &c);
+        if (i % 8 == 0) pixelgrab_enumerate_windows(ctx, windows, 64);
+      }
+    });
+  }
+  for (auto& w : workers) w.join();
+  auto t1 = std::chrono::high_resolution_clock::now();
+  double s = std::chrono::duration<double>(t1 - t0).count();
+  return threads * iterations / s;
+}
+
+// Mean time of a |width| x |height| region capture on a fresh context
+// whose history queue holds |depth| images (0 = compress in the capture
+// call).  The queue is drained between captures, outside the timing, so
+// queued runs measure the hand-off rather than a full queue.
+double TimeHistoryRecord(int depth, int width, int height, int iterations) {
+  PixelGrabContext* c = pixelgrab_context_create();
+  if (!c) return 0.0;
+  pixelgrab_history_set_queue(c, depth, kPixelGrabHistoryBackpressureInline);
+  double total_ms = 0;
+  PixelGrabHistoryUsage usage = {};
+  for (int i = 0; i < iterations; ++i) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    PixelGrabImage* img = pixelgrab_capture_region(c, 0, 0, width, height);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    pixelgrab_image_destroy(img);
+    pixelgrab_history_get_usage(c, &usage);
+    total_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+  }
+  pixelgrab_context_destroy(c);
+  return total_ms / iterations;
+}
+
+// A screenshot of the codec corpus, converted to BGRA like a capture.
+struct CorpusImage {
+  std::string name;
+  int width;
+  int height;
+  std::vector<uint8_t> bgra;
+};
+
+// Every image in |dir| that stb_image can read, in name order.
+std::vector<CorpusImage> LoadCorpus(const char* dir) {
+  std::vector<CorpusImage> corpus;
+  std::error_code ec;
+  for (const auto& file : std::filesystem::directory_iterator(dir, ec)) {
+    if (!file.is_regular_file()) continue;
+    int w = 0, h = 0, channels = 0;
+    unsigned char* rgba =
+        stbi_load(file.path().string().c_str(), &w, &h, &channels, 4);
+    if (!rgba) continue;
+    const size_t size = static_cast<size_t>(w) * h * 4;
+    CorpusImage img{file.path().filename().string(), w, h,
+                    std::vector<uint8_t>(rgba, rgba + size)};
+    stbi_image_free(rgba);
+    for (size_t i = 0; i < size; i += 4) {
+      std::swap(img.bgra[i], img.bgra[i + 2]);
+    }
+    corpus.push_back(std::move(img));
+  }
+  std::sort(corpus.begin(), corpus.end(),
+            [](const CorpusImage& a, const CorpusImage& b) {
+              return a.name < b.name;
+            });
+  return corpus;
+}
+
+// Compression ratio and encode/decode throughput of each history codec
+// over |corpus|, on one thread.  Decoded images are checked against the
+// originals.
+void BenchHistoryCodecs(const std::vector<CorpusImage>& corpus) {
+  using pixelgrab::internal::DecodeHistoryImage;
+  using pixelgrab::internal::EncodeHistoryImage;
+  struct {
+    PixelGrabHistoryCodec codec;
+    const char* name;
+  } codecs[] = {{kPixelGrabHistoryCodecPixel, "pixel"},
+                {kPixelGrabHistoryCodecRle, "rle"}};
+  for (const auto& c : codecs) {
+    uint64_t raw = 0, stored = 0;
+    double encode_ms = 0, decode_ms = 0;
+    bool lossless = true;
+    std::vector<uint8_t> encoded, decoded;
+    for (const auto& img : corpus) {
+      const int stride = img.width * 4;
+      auto encode = RunBench("encode", 5, [&]() {
+        EncodeHistoryImage(c.codec, img.bgra.data(), img.width, img.height,
+                           stride, &encoded);
+      });
+      decoded.assign(img.bgra.size(), 0);
+      auto decode = RunBench("decode", 5, [&]() {
+        lossless &= DecodeHistoryImage(c.codec, encoded.data(),
+                                       encoded.size(), img.width, img.height,
+                                       decoded.data(), stride);
+      });
+      encode_ms += encode.min_ms;
+      decode_ms += decode.min_ms;
+      lossless &= decoded == img.bgra;
+      raw += img.bgra.size();
+      stored += encoded.size();
+    }
+    const double mb = static_cast<double>(raw) / 1e6;
+    std::printf(
+        "  history codec %-26s  ratio %6.1fx  encode %7.1f MB/s  "
+        "decode %7.1f MB/s%s\n",
+        c.name, stored ? static_cast<double>(raw) / stored : 0.0,
+        encode_ms > 0 ? mb * 1000.0 / encode_ms : 0.0,
+        decode_ms > 0 ? mb * 1000.0 / decode_ms : 0.0,
+        lossless ? "" : "  (MISMATCH)");
+  }
+}
+
+int main(int argc, char** argv) {
   std::printf("PixelGrab Performance Benchmarks\n");
   std::printf("================================\n\n");
 
@@ -57,7 +211,8 @@ int main() {
   }
 
   int screen_count = pixelgrab_get_screen_count(ctx);
-  std::printf("Screens: %d\n\n", screen_count);
+  std::printf("Screens: %d (backend %d)\n\n", screen_count,
+              static_cast<int>(pixelgrab_get_backend_type(ctx)));
 
   // -- Screen capture --
   if (screen_count > 0) {
@@ -88,6 +243,121 @@ int main() {
       pixelgrab_image_destroy(img);
     });
     PrintResult(r4);
+
+    // RGBA output is swizzled during conversion, not in a second pass.
+    pixelgrab_set_capture_format(ctx, kPixelGrabFormatRgba8);
+    auto r4r = RunBench("capture_region(1920x1080) [rgba8]", 20, [&]() {
+      PixelGrabImage* img = pixelgrab_capture_region(ctx, 0, 0, 1920, 1080);
+      pixelgrab_image_destroy(img);
+    });
+    PrintResult(r4r);
+    pixelgrab_set_capture_format(ctx, kPixelGrabFormatBgra8);
+
+    // Same workload into one recycled buffer (no per-frame allocation).
+    std::vector<uint8_t> frame(static_cast<size_t>(1920) * 1080 * 4);
+    auto r4b = RunBench("capture_region_into(1920x1080)", 20, [&]() {
+      pixelgrab_capture_region_into(ctx, 0, 0, 1920, 1080, frame.data(),
+                                    1920 * 4);
+    });
+    PrintResult(r4b);
+
+    // Thumbnail: capture-then-resize against the strip-fused path, which
+    // never holds the full-resolution region.
+    auto r4t = RunBench("capture_region + image_resize(1920x1080 -> 480x270)",
+                        20, [&]() {
+      PixelGrabImage* img = pixelgrab_capture_region(ctx, 0, 0, 1920, 1080);
+      PixelGrabImage* thumb =
+          pixelgrab_image_resize(img, 480, 270, kPixelGrabFilterBilinear);
+      pixelgrab_image_destroy(thumb);
+      pixelgrab_image_destroy(img);
+    });
+    PrintResult(r4t);
+    auto r4f = RunBench("capture_region_scaled(1920x1080 -> 480x270)", 20,
+                        [&]() {
+      pixelgrab_image_destroy(pixelgrab_capture_region_scaled(
+          ctx, 0, 0, 1920, 1080, 480, 270, kPixelGrabFilterBilinear));
+    });
+    PrintResult(r4f);
+
+    // A UI-test style step: 40 small widget rectangles.
+    std::vector<PixelGrabRect> widgets;
+    for (int i = 0; i < 40; ++i) {
+      widgets.push_back({(i % 8) * 120 + 10, (i / 8) * 90 + 10, 96, 24});
+    }
+    std::vector<PixelGrabImage*> batch(widgets.size());
+    auto r4s = RunBench("capture_region x40 (96x24)", 20, [&]() {
+      for (const auto& w : widgets) {
+        pixelgrab_image_destroy(
+            pixelgrab_capture_region(ctx, w.x, w.y, w.width, w.height));
+      }
+    });
+    PrintResult(r4s);
+    auto r4m = RunBench("capture_regions(40 x 96x24)", 20, [&]() {
+      pixelgrab_capture_regions(ctx, widgets.data(),
+                                static_cast<int>(widgets.size()),
+                                batch.data());
+      for (auto* img : batch) pixelgrab_image_destroy(img);
+    });
+    PrintResult(r4m);
+
+    // Damage-tracked polling: after the first call only changed areas are
+    // re-read, so a static screen costs about one round-trip.
+    auto r4i = RunBench("capture_region_incremental(1920x1080)", 20, [&]() {
+      int changed = 0;
+      PixelGrabImage* img = pixelgrab_capture_region_incremental(
+          ctx, 0, 0, 1920, 1080, nullptr, 0, &changed);
+      pixelgrab_image_destroy(img);
+    });
+    PrintResult(r4i);
+    pixelgrab_capture_incremental_reset(ctx);
+
+    // Change detection between consecutive frames: direct comparison reads
+    // both frames, the tile tracker only the new one.
+    PixelGrabImage* prev = pixelgrab_capture_region(ctx, 0, 0, 1920, 1080);
+    PixelGrabImage* next = pixelgrab_capture_region(ctx, 0, 0, 1920, 1080);
+    if (prev && next) {
+      auto r4d = RunBench("image_diff(1920x1080, 64px tiles)", 50, [&]() {
+        int changed = 0;
+        pixelgrab_image_diff(prev, next, 64, nullptr, 0, &changed);
+      });
+      PrintResult(r4d);
+      PixelGrabTileTracker* tracker = pixelgrab_tile_tracker_create(64);
+      auto r4h = RunBench("tile_tracker_update(1920x1080, 64px tiles)", 50,
+                          [&]() {
+        int changed = 0;
+        pixelgrab_tile_tracker_update(tracker, next, nullptr, 0, &changed);
+      });
+      PrintResult(r4h);
+      pixelgrab_tile_tracker_destroy(tracker);
+    }
+    pixelgrab_image_destroy(prev);
+    pixelgrab_image_destroy(next);
+
+#if defined(__linux__)
+    // -- MIT-SHM vs XGetImage (same workload, SHM forced off) --
+    setenv("PIXELGRAB_DISABLE_XSHM", "1", 1);
+    PixelGrabContext* noshm = pixelgrab_context_create();
+    unsetenv("PIXELGRAB_DISABLE_XSHM");
+    if (noshm) {
+      std::printf("\n");
+      auto s1 = RunBench("capture_screen(0) [XGetImage]", 50, [&]() {
+        PixelGrabImage* img = pixelgrab_capture_screen(noshm, 0);
+        pixelgrab_image_destroy(img);
+      });
+      PrintResult(s1);
+
+      auto s2 = RunBench("capture_region(1920x1080) [XGetImage]", 20, [&]() {
+        PixelGrabImage* img =
+            pixelgrab_capture_region(noshm, 0, 0, 1920, 1080);
+        pixelgrab_image_destroy(img);
+      });
+      PrintResult(s2);
+
+      std::printf("  SHM speedup: screen %.2fx, 1080p region %.2fx\n",
+                  s1.avg_ms / r1.avg_ms, s2.avg_ms / r4.avg_ms);
+      pixelgrab_context_destroy(noshm);
+    }
+#endif
   }
 
   // -- Color picker --
@@ -123,6 +393,66 @@ int main() {
   });
   PrintResult(r8);
 
+  // -- Several threads on one context --
+  if (screen_count > 0) {
+    std::printf("\n");
+    PixelGrabContextOptions single = {};
+    single.max_capture_connections = 1;
+    PixelGrabContext* serial = pixelgrab_context_create_with_options(&single);
+    for (int threads : {1, 2, 4, 8}) {
+      double pooled = RunContention(ctx, threads, 40);
+      double one = serial ? RunContention(serial, threads, 40) : 0.0;
+      char label[48];
+      std::snprintf(label, sizeof(label), "shared context, %d thread(s)",
+                    threads);
+      std::printf("  %-40s  %8.1f rounds/s  (single connection: %.1f)\n",
+                  label, pooled, one);
+    }
+    pixelgrab_context_destroy(serial);
+  }
+
+  // -- History gallery: stored thumbnails vs full decodes --
+  if (screen_count > 0) {
+    std::printf("\n");
+    PixelGrabScreenInfo screen = {};
+    pixelgrab_get_screen_info(ctx, 0, &screen);
+    PixelGrabContext* h = pixelgrab_context_create();
+    if (h) {
+      for (int i = 0; i < 10; ++i) {
+        pixelgrab_image_destroy(pixelgrab_capture_region(
+            h, screen.x, screen.y, screen.width, screen.height));
+      }
+      PixelGrabHistoryUsage usage = {};
+      pixelgrab_history_get_usage(h, &usage);
+      int ids[10] = {};
+      for (int i = 0; i < 10; ++i) {
+        PixelGrabHistoryEntry entry = {};
+        pixelgrab_history_get_entry(h, i, &entry);
+        ids[i] = entry.id;
+      }
+      PrintResult(RunBench("history gallery x10 (recapture)", 5, [&]() {
+        for (int id : ids) {
+          pixelgrab_image_destroy(pixelgrab_history_recapture(h, id));
+        }
+      }));
+      PrintResult(RunBench("history gallery x10 (thumbnail)", 20, [&]() {
+        for (int id : ids) {
+          pixelgrab_image_destroy(pixelgrab_history_get_thumbnail(h, id));
+        }
+      }));
+      pixelgrab_context_destroy(h);
+    }
+  }
+
+  // -- History: what recording costs the capturing thread --
+  if (screen_count > 0) {
+    const double queued = TimeHistoryRecord(4, 1920, 1080, 20);
+    const double inline_ms = TimeHistoryRecord(0, 1920, 1080, 20);
+    std::printf("  %-40s  queued %.3f ms  synchronous %.3f ms  (+%.3f ms)\n",
+                "capture_region(1920x1080) + history", queued, inline_ms,
+                inline_ms - queued);
+  }
+
   // -- Context create/destroy --
   auto r9 = RunBench("context_create+destroy", 20, [&]() {
     PixelGrabContext* c = pixelgrab_context_create();
@@ -130,6 +460,29 @@ int main() {
   });
   PrintResult(r9);
 
+  // -- Capture history codecs on a corpus of real screenshots --
+  const char* corpus_dir =
+      argc > 1 ? argv[1] : std::getenv("PIXELGRAB_BENCH_CORPUS");
+  if (corpus_dir) {
+    std::vector<CorpusImage> corpus = LoadCorpus(corpus_dir);
+    double mp = 0;
+    for (const auto& img : corpus) {
+      mp += static_cast<double>(img.width) * img.height / 1e6;
+    }
+    std::printf("\nCorpus %s: %zu images, %.1f MP\n", corpus_dir,
+                corpus.size(), mp);
+    if (!corpus.empty()) BenchHistoryCodecs(corpus);
+  } else {
+    std::printf("\nNo screenshot corpus given; history codecs skipped.\n");
+  }
+
+  // -- Per-stage latencies recorded by the library during the runs above --
+  char* stats = pixelgrab_stats_dump(ctx, kPixelGrabStatsText);
+  if (stats) {
+    std::printf("\nLibrary stage statistics (main context):\n%s", stats);
+    pixelgrab_free_string(stats);
+  }
+
   std::printf("\nDone.\n");
   pixelgrab_context_destroy(ctx);
   return 0;
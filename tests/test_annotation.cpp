@@ -1,6 +1,9 @@
 // Copyright 2026 The loong-pixelgrab Authors
 // Tests for: Annotation engine (17 functions)
 
+#include <cstring>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "pixelgrab/pixelgrab.h"
 
@@ -191,6 +194,42 @@ TEST_F(AnnotationTest, Export) {
   pixelgrab_image_destroy(exported);
 }
 
+TEST_F(AnnotationTest, ExportUnaffectedByLaterEdits) {
+  PixelGrabImage* before = pixelgrab_annotation_export(ann_);
+  ASSERT_NE(before, nullptr);
+  size_t size = pixelgrab_image_get_data_size(before);
+  std::vector<uint8_t> expected(pixelgrab_image_get_data(before),
+                                pixelgrab_image_get_data(before) + size);
+
+  PixelGrabShapeStyle s = DefaultStyle();
+  s.filled = 1;
+  s.fill_color = 0xFF00FF00;
+  ASSERT_GE(pixelgrab_annotation_add_rect(ann_, 0, 0, 64, 64, &s), 0);
+  PixelGrabImage* after = pixelgrab_annotation_export(ann_);
+  ASSERT_NE(after, nullptr);
+
+  EXPECT_EQ(std::memcmp(pixelgrab_image_get_data(before), expected.data(),
+                        size),
+            0);
+  pixelgrab_image_destroy(after);
+  pixelgrab_image_destroy(before);
+}
+
+TEST_F(AnnotationTest, BaseImageUnaffectedByEdits) {
+  size_t size = pixelgrab_image_get_data_size(base_img_);
+  std::vector<uint8_t> expected(pixelgrab_image_get_data(base_img_),
+                                pixelgrab_image_get_data(base_img_) + size);
+
+  PixelGrabShapeStyle s = DefaultStyle();
+  pixelgrab_annotation_add_rect(ann_, 5, 5, 10, 10, &s);
+  pixelgrab_annotation_add_mosaic(ann_, 0, 0, 32, 32, 4);
+  ASSERT_NE(pixelgrab_annotation_get_result(ann_), nullptr);
+
+  EXPECT_EQ(std::memcmp(pixelgrab_image_get_data(base_img_), expected.data(),
+                        size),
+            0);
+}
+
 // ---------------------------------------------------------------------------
 // NULL safety for annotation functions
 // ---------------------------------------------------------------------------
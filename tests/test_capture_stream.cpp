@@ -0,0 +1,205 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Tests for: continuous capture streams.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "pixelgrab/pixelgrab.h"
+#include "test_util.h"
+
+namespace {
+
+class CaptureStreamTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ctx_ = pixelgrab_context_create();
+    ASSERT_NE(ctx_, nullptr);
+  }
+  void TearDown() override { pixelgrab_context_destroy(ctx_); }
+
+  bool HasDisplay() const { return pixelgrab_get_screen_count(ctx_) > 0; }
+
+  static PixelGrabStreamStats Stats(const PixelGrabStream* stream) {
+    PixelGrabStreamStats s = {};
+    EXPECT_EQ(pixelgrab_stream_get_stats(stream, &s), kPixelGrabOk);
+    return s;
+  }
+
+  PixelGrabContext* ctx_ = nullptr;
+};
+
+struct CallbackState {
+  std::atomic<int> calls{0};
+  std::atomic<uint64_t> last_sequence{0};
+  std::atomic<int> width{0};
+};
+
+struct SlowCallbackState {
+  std::atomic<bool> inside{false};
+  std::atomic<int> calls{0};
+};
+
+void OnFrameSlowly(PixelGrabStream* /*stream*/, const PixelGrabImage*,
+                   uint64_t /*sequence*/, void* userdata) {
+  auto* state = static_cast<SlowCallbackState*>(userdata);
+  state->inside = true;
+  ++state->calls;
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  state->inside = false;
+}
+
+void OnFrame(PixelGrabStream* /*stream*/, const PixelGrabImage* frame,
+             uint64_t sequence, void* userdata) {
+  auto* state = static_cast<CallbackState*>(userdata);
+  state->width = pixelgrab_image_get_width(frame);
+  state->last_sequence = sequence;
+  ++state->calls;
+}
+
+}  // namespace
+
+TEST_F(CaptureStreamTest, CreateNullArgs) {
+  PixelGrabRect region = {0, 0, 32, 32};
+  EXPECT_EQ(pixelgrab_stream_create(nullptr, &region, 30, 4), nullptr);
+  EXPECT_EQ(pixelgrab_stream_create(ctx_, nullptr, 30, 4), nullptr);
+}
+
+TEST_F(CaptureStreamTest, CreateInvalidParams) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  PixelGrabRect region = {0, 0, 32, 32};
+  PixelGrabRect empty = {0, 0, 0, 32};
+  EXPECT_EQ(pixelgrab_stream_create(ctx_, &empty, 30, 4), nullptr);
+  EXPECT_EQ(pixelgrab_stream_create(ctx_, &region, 0, 4), nullptr);
+  EXPECT_EQ(pixelgrab_stream_create(ctx_, &region, 30, 1), nullptr);
+  EXPECT_EQ(pixelgrab_get_last_error(ctx_), kPixelGrabErrorInvalidParam);
+}
+
+TEST_F(CaptureStreamTest, NullStreamIsSafe) {
+  pixelgrab_stream_destroy(nullptr);
+  EXPECT_EQ(pixelgrab_stream_poll(nullptr, 0, nullptr), nullptr);
+  EXPECT_EQ(pixelgrab_stream_set_callback(nullptr, OnFrame, nullptr),
+            kPixelGrabErrorInvalidParam);
+  PixelGrabStreamStats s = {};
+  EXPECT_EQ(pixelgrab_stream_get_stats(nullptr, &s),
+            kPixelGrabErrorInvalidParam);
+}
+
+TEST_F(CaptureStreamTest, PollDeliversIncreasingFrames) {
+  PixelGrabRect region = {0, 0, 64, 48};
+  PixelGrabStream* stream = pixelgrab_stream_create(ctx_, &region, 60, 3);
+  if (!stream) GTEST_SKIP() << "Capture unavailable";
+
+  uint64_t prev = 0;
+  for (int i = 0; i < 3; ++i) {
+    uint64_t seq = 0;
+    PixelGrabImage* frame = pixelgrab_stream_poll(stream, 2000, &seq);
+    ASSERT_NE(frame, nullptr);
+    EXPECT_GT(seq, prev);
+    prev = seq;
+    EXPECT_EQ(pixelgrab_image_get_width(frame), 64);
+    EXPECT_EQ(pixelgrab_image_get_height(frame), 48);
+    pixelgrab_image_destroy(frame);
+  }
+
+  PixelGrabStreamStats s = Stats(stream);
+  EXPECT_GE(s.frames_captured, 3u);
+  EXPECT_EQ(s.frames_delivered, 3u);
+  EXPECT_LE(s.frames_delivered + s.frames_dropped, s.frames_captured);
+  pixelgrab_stream_destroy(stream);
+}
+
+TEST_F(CaptureStreamTest, HeldFramesAreNotOverwritten) {
+  PixelGrabRect region = {0, 0, 16, 16};
+  PixelGrabStream* stream = pixelgrab_stream_create(ctx_, &region, 120, 2);
+  if (!stream) GTEST_SKIP() << "Capture unavailable";
+
+  // Holding more frames than the ring has slots forces re-allocation
+  // instead of writing into pixels a consumer still references.
+  std::vector<PixelGrabImage*> held;
+  for (int i = 0; i < 4; ++i) {
+    PixelGrabImage* frame = pixelgrab_stream_poll(stream, 2000, nullptr);
+    ASSERT_NE(frame, nullptr);
+    held.push_back(frame);
+  }
+  for (size_t i = 1; i < held.size(); ++i) {
+    EXPECT_NE(pixelgrab_image_get_data(held[i]),
+              pixelgrab_image_get_data(held[i - 1]));
+  }
+  EXPECT_GT(Stats(stream).slots_replaced, 0u);
+  for (auto* frame : held) pixelgrab_image_destroy(frame);
+  pixelgrab_stream_destroy(stream);
+}
+
+TEST_F(CaptureStreamTest, CallbackReceivesFrames) {
+  PixelGrabRect region = {0, 0, 40, 20};
+  PixelGrabStream* stream = pixelgrab_stream_create(ctx_, &region, 60, 4);
+  if (!stream) GTEST_SKIP() << "Capture unavailable";
+
+  CallbackState state;
+  ASSERT_EQ(pixelgrab_stream_set_callback(stream, OnFrame, &state),
+            kPixelGrabOk);
+  for (int i = 0; i < 200 && state.calls < 3; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(pixelgrab_stream_set_callback(stream, nullptr, nullptr),
+            kPixelGrabOk);
+  EXPECT_GE(state.calls.load(), 3);
+  EXPECT_EQ(state.width.load(), 40);
+  EXPECT_GT(state.last_sequence.load(), 0u);
+  pixelgrab_stream_destroy(stream);
+}
+
+TEST(CaptureStreamCallbackTest, RemovingWaitsForRunningCallback) {
+  PixelGrabContext* ctx = CreateSynthetic(320, 240);
+  ASSERT_NE(ctx, nullptr);
+
+  PixelGrabRect region = {0, 0, 32, 32};
+  PixelGrabStream* stream = pixelgrab_stream_create(ctx, &region, 60, 2);
+  ASSERT_NE(stream, nullptr);
+  SlowCallbackState state;
+  ASSERT_EQ(pixelgrab_stream_set_callback(stream, OnFrameSlowly, &state),
+            kPixelGrabOk);
+  for (int i = 0; i < 200 && !state.inside; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_TRUE(state.inside.load());
+  ASSERT_EQ(pixelgrab_stream_set_callback(stream, nullptr, nullptr),
+            kPixelGrabOk);
+  // The call in progress finished, and no new one starts.
+  EXPECT_FALSE(state.inside.load());
+  const int calls = state.calls;
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(state.calls.load(), calls);
+  pixelgrab_stream_destroy(stream);
+  pixelgrab_context_destroy(ctx);
+}
+
+TEST(CaptureStreamFormatTest, RgbaFramesMatchRegionCapture) {
+  // A static synthetic scene, so the stream and a one-shot capture see the
+  // same pixels.
+  PixelGrabContext* ctx = CreateSynthetic(320, 240);
+  ASSERT_NE(ctx, nullptr);
+  ASSERT_EQ(pixelgrab_set_capture_format(ctx, kPixelGrabFormatRgba8),
+            kPixelGrabOk);
+
+  PixelGrabRect region = {10, 20, 60, 60};
+  PixelGrabStream* stream = pixelgrab_stream_create(ctx, &region, 30, 2);
+  ASSERT_NE(stream, nullptr);
+  PixelGrabImage* frame = pixelgrab_stream_poll(stream, 2000, nullptr);
+  ASSERT_NE(frame, nullptr);
+  PixelGrabImage* expected = pixelgrab_capture_region(
+      ctx, region.x, region.y, region.width, region.height);
+  ASSERT_NE(expected, nullptr);
+
+  EXPECT_EQ(pixelgrab_image_get_format(frame), kPixelGrabFormatRgba8);
+  EXPECT_EQ(pixelgrab_image_get_format(expected), kPixelGrabFormatRgba8);
+  EXPECT_TRUE(SamePixels(frame, expected));
+  pixelgrab_image_destroy(expected);
+  pixelgrab_image_destroy(frame);
+  pixelgrab_stream_destroy(stream);
+  pixelgrab_context_destroy(ctx);
+}
@@ -1,6 +1,10 @@
 // Copyright 2026 The loong-pixelgrab Authors
 // Tests for: pixelgrab_context_create, pixelgrab_context_destroy,
-//            pixelgrab_get_last_error, pixelgrab_get_last_error_message
+//            pixelgrab_get_last_error, pixelgrab_get_last_error_message,
+//            concurrent use of one context
+
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "pixelgrab/pixelgrab.h"
@@ -58,3 +62,55 @@ TEST(ContextTest, GetLastErrorWithNullCtx) {
 TEST(ContextTest, GetLastErrorMessageWithNullCtx) {
   pixelgrab_get_last_error_message(nullptr);
 }
+
+// ---------------------------------------------------------------------------
+// Concurrent use
+// ---------------------------------------------------------------------------
+
+TEST(ContextTest, ConcurrentCallsOnOneContext) {
+  PixelGrabContext* ctx = pixelgrab_context_create();
+  ASSERT_NE(ctx, nullptr);
+  bool has_display = pixelgrab_get_screen_count(ctx) > 0;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([ctx, t]() {
+      PixelGrabWindowInfo windows[16];
+      for (int i = 0; i < 20; ++i) {
+        pixelgrab_get_screen_count(ctx);
+        pixelgrab_image_destroy(
+            pixelgrab_capture_region(ctx, t * 8, i, 32, 16));
+        PixelGrabColor c = {};
+        pixelgrab_pick_color(ctx, t, i, &c);
+        pixelgrab_enumerate_windows(ctx, windows, 16);
+        pixelgrab_history_count(ctx);
+        pixelgrab_get_last_error_message(ctx);
+      }
+    });
+  }
+  for (auto& th : threads) th.join();
+
+  // 80 region captures, capped at the default of 50 entries.
+  if (has_display) {
+    EXPECT_EQ(pixelgrab_history_count(ctx), 50);
+  }
+  pixelgrab_context_destroy(ctx);
+}
+
+TEST(ContextTest, SingleConnectionOption) {
+  PixelGrabContextOptions options = {};
+  options.max_capture_connections = 1;
+  PixelGrabContext* ctx = pixelgrab_context_create_with_options(&options);
+  ASSERT_NE(ctx, nullptr);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 3; ++t) {
+    threads.emplace_back([ctx]() {
+      for (int i = 0; i < 10; ++i) {
+        pixelgrab_image_destroy(pixelgrab_capture_region(ctx, 0, 0, 16, 16));
+      }
+    });
+  }
+  for (auto& th : threads) th.join();
+  pixelgrab_context_destroy(ctx);
+}
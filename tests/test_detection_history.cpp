@@ -1,8 +1,21 @@
 // Copyright 2026 The loong-pixelgrab Authors
 // Tests for: Element detection (3) + Capture history (6)
 
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
 #include "gtest/gtest.h"
 #include "pixelgrab/pixelgrab.h"
+#include "test_util.h"
 
 class DetectionHistoryTest : public ::testing::Test {
  protected:
@@ -146,3 +159,492 @@ TEST_F(DetectionHistoryTest, HistoryClearNullCtx) {
 TEST_F(DetectionHistoryTest, HistorySetMaxCountNullCtx) {
   pixelgrab_history_set_max_count(nullptr, 10);  // Must not crash.
 }
+
+// ---------------------------------------------------------------------------
+// History codecs (synthetic backend, so they run headless)
+// ---------------------------------------------------------------------------
+
+class HistoryCodecTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ctx_ = CreateSynthetic(640, 480);
+    ASSERT_NE(ctx_, nullptr);
+  }
+  void TearDown() override { pixelgrab_context_destroy(ctx_); }
+
+  // Capture a region, then check the history copy is pixel-identical.
+  void ExpectLosslessRoundTrip(int x, int y, int w, int h) {
+    PixelGrabImage* img = pixelgrab_capture_region(ctx_, x, y, w, h);
+    ASSERT_NE(img, nullptr);
+    // Wait for the background compression so the codec is exercised.
+    PixelGrabHistoryUsage usage = {};
+    ASSERT_EQ(pixelgrab_history_get_usage(ctx_, &usage), kPixelGrabOk);
+    PixelGrabHistoryEntry entry = {};
+    ASSERT_EQ(pixelgrab_history_get_entry(ctx_, 0, &entry), kPixelGrabOk);
+    PixelGrabImage* back = pixelgrab_history_recapture(ctx_, entry.id);
+    ASSERT_NE(back, nullptr);
+    ASSERT_EQ(pixelgrab_image_get_width(back), w);
+    ASSERT_EQ(pixelgrab_image_get_height(back), h);
+    EXPECT_TRUE(SamePixels(img, back));
+    pixelgrab_image_destroy(back);
+    pixelgrab_image_destroy(img);
+  }
+
+  PixelGrabContext* ctx_ = nullptr;
+};
+
+TEST_F(HistoryCodecTest, PixelCodecIsLossless) {
+  ExpectLosslessRoundTrip(0, 0, 640, 480);
+  ExpectLosslessRoundTrip(13, 7, 101, 53);  // Odd sizes.
+  ExpectLosslessRoundTrip(600, 0, 40, 1);   // Single row.
+}
+
+TEST_F(HistoryCodecTest, RleCodecIsLossless) {
+  ASSERT_EQ(pixelgrab_history_set_codec(ctx_, kPixelGrabHistoryCodecRle),
+            kPixelGrabOk);
+  ExpectLosslessRoundTrip(0, 0, 640, 480);
+  ExpectLosslessRoundTrip(13, 7, 101, 53);
+}
+
+TEST_F(HistoryCodecTest, UsageReportsCompression) {
+  PixelGrabHistoryUsage usage = {};
+  ASSERT_EQ(pixelgrab_history_get_usage(ctx_, &usage), kPixelGrabOk);
+  EXPECT_EQ(usage.entry_count, 0);
+  EXPECT_EQ(usage.raw_bytes, 0u);
+
+  for (int i = 0; i < 3; ++i) {
+    pixelgrab_image_destroy(pixelgrab_capture_region(ctx_, 0, 0, 640, 480));
+  }
+  ASSERT_EQ(pixelgrab_history_get_usage(ctx_, &usage), kPixelGrabOk);
+  EXPECT_EQ(usage.entry_count, 3);
+  EXPECT_EQ(usage.image_count, 3);
+  EXPECT_EQ(usage.raw_bytes, 3u * 640 * 480 * 4);
+  EXPECT_GT(usage.stored_bytes, 0u);
+  EXPECT_LT(usage.stored_bytes, usage.raw_bytes);
+
+  pixelgrab_history_clear(ctx_);
+  ASSERT_EQ(pixelgrab_history_get_usage(ctx_, &usage), kPixelGrabOk);
+  EXPECT_EQ(usage.image_count, 0);
+  EXPECT_EQ(usage.stored_bytes, 0u);
+}
+
+TEST_F(HistoryCodecTest, PixelCodecBeatsRle) {
+  pixelgrab_image_destroy(pixelgrab_capture_region(ctx_, 0, 0, 640, 480));
+  PixelGrabHistoryUsage pixel = {};
+  pixelgrab_history_get_usage(ctx_, &pixel);
+
+  pixelgrab_history_clear(ctx_);
+  pixelgrab_history_set_codec(ctx_, kPixelGrabHistoryCodecRle);
+  pixelgrab_image_destroy(pixelgrab_capture_region(ctx_, 0, 0, 640, 480));
+  PixelGrabHistoryUsage rle = {};
+  pixelgrab_history_get_usage(ctx_, &rle);
+
+  EXPECT_LT(pixel.stored_bytes, rle.stored_bytes);
+}
+
+TEST_F(HistoryCodecTest, InvalidParams) {
+  EXPECT_EQ(pixelgrab_history_set_codec(
+                ctx_, static_cast<PixelGrabHistoryCodec>(99)),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(pixelgrab_history_set_codec(nullptr, kPixelGrabHistoryCodecRle),
+            kPixelGrabErrorInvalidParam);
+  PixelGrabHistoryUsage usage = {};
+  EXPECT_EQ(pixelgrab_history_get_usage(nullptr, &usage),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(pixelgrab_history_get_usage(ctx_, nullptr),
+            kPixelGrabErrorInvalidParam);
+}
+
+TEST_F(HistoryCodecTest, EntryVisibleBeforeCompression) {
+  PixelGrabImage* img = pixelgrab_capture_region(ctx_, 0, 0, 640, 480);
+  ASSERT_NE(img, nullptr);
+  // No waiting: the entry and its pixels are available straight away.
+  EXPECT_EQ(pixelgrab_history_count(ctx_), 1);
+  PixelGrabImage* last = pixelgrab_recapture_last(ctx_);
+  ASSERT_NE(last, nullptr);
+  EXPECT_TRUE(SamePixels(img, last));
+  pixelgrab_image_destroy(last);
+  pixelgrab_image_destroy(img);
+}
+
+TEST_F(HistoryCodecTest, SynchronousQueue) {
+  ASSERT_EQ(pixelgrab_history_set_queue(ctx_, 0,
+                                        kPixelGrabHistoryBackpressureInline),
+            kPixelGrabOk);
+  pixelgrab_image_destroy(pixelgrab_capture_region(ctx_, 0, 0, 64, 64));
+  // Compressed before the capture returned.
+  PixelGrabStageStats compress = {};
+  pixelgrab_get_stats(ctx_, kPixelGrabStageHistoryCompress, &compress);
+  EXPECT_EQ(compress.count, 1u);
+}
+
+TEST_F(HistoryCodecTest, BlockPolicyStoresEveryImage) {
+  ASSERT_EQ(pixelgrab_history_set_queue(ctx_, 1,
+                                        kPixelGrabHistoryBackpressureBlock),
+            kPixelGrabOk);
+  for (int i = 0; i < 8; ++i) {
+    pixelgrab_image_destroy(pixelgrab_capture_region(ctx_, 0, 0, 640, 480));
+  }
+  PixelGrabHistoryUsage usage = {};
+  ASSERT_EQ(pixelgrab_history_get_usage(ctx_, &usage), kPixelGrabOk);
+  EXPECT_EQ(usage.image_count, 8);
+  EXPECT_EQ(usage.dropped_images, 0u);
+}
+
+TEST_F(HistoryCodecTest, DropPolicyKeepsEntries) {
+  ASSERT_EQ(pixelgrab_history_set_queue(ctx_, 1,
+                                        kPixelGrabHistoryBackpressureDrop),
+            kPixelGrabOk);
+  for (int i = 0; i < 8; ++i) {
+    pixelgrab_image_destroy(pixelgrab_capture_region(ctx_, 0, 0, 640, 480));
+  }
+  PixelGrabHistoryUsage usage = {};
+  ASSERT_EQ(pixelgrab_history_get_usage(ctx_, &usage), kPixelGrabOk);
+  EXPECT_EQ(usage.entry_count, 8);
+  EXPECT_GE(usage.image_count, 1);
+  EXPECT_EQ(usage.image_count + usage.dropped_images, 8u);
+}
+
+TEST_F(HistoryCodecTest, IdenticalCapturesShareStorage) {
+  // Static scene: past the first capture nothing new is stored, not even
+  // the keyframe that would otherwise start every 16 images.
+  pixelgrab_history_set_max_count(ctx_, 64);
+  PixelGrabHistoryUsage usage = {};
+  uint64_t stored_after_16 = 0;
+  for (int i = 1; i <= 64; ++i) {
+    pixelgrab_image_destroy(pixelgrab_capture_region(ctx_, 0, 0, 640, 480));
+    if (i == 16) {
+      ASSERT_EQ(pixelgrab_history_get_usage(ctx_, &usage), kPixelGrabOk);
+      stored_after_16 = usage.stored_bytes;
+    }
+  }
+  ASSERT_EQ(pixelgrab_history_get_usage(ctx_, &usage), kPixelGrabOk);
+  EXPECT_EQ(usage.image_count, 64);
+  EXPECT_EQ(usage.raw_bytes, 64u * 640 * 480 * 4);
+  EXPECT_EQ(usage.stored_bytes, stored_after_16);
+
+  PixelGrabHistoryEntry oldest = {};
+  ASSERT_EQ(pixelgrab_history_get_entry(ctx_, 63, &oldest), kPixelGrabOk);
+  PixelGrabImage* back = pixelgrab_history_recapture(ctx_, oldest.id);
+  ASSERT_NE(back, nullptr);
+  EXPECT_EQ(pixelgrab_image_get_width(back), 640);
+  pixelgrab_image_destroy(back);
+}
+
+TEST_F(HistoryCodecTest, ThumbnailMatchesBoxResize) {
+  PixelGrabImage* img = pixelgrab_capture_region(ctx_, 0, 0, 640, 480);
+  ASSERT_NE(img, nullptr);
+  PixelGrabHistoryUsage usage = {};
+  ASSERT_EQ(pixelgrab_history_get_usage(ctx_, &usage), kPixelGrabOk);
+  EXPECT_GE(usage.thumbnail_bytes, 200u * 150 * 4);
+  PixelGrabHistoryEntry entry = {};
+  ASSERT_EQ(pixelgrab_history_get_entry(ctx_, 0, &entry), kPixelGrabOk);
+
+  PixelGrabImage* thumb = pixelgrab_history_get_thumbnail(ctx_, entry.id);
+  ASSERT_NE(thumb, nullptr);
+  ASSERT_EQ(pixelgrab_image_get_width(thumb), 200);
+  ASSERT_EQ(pixelgrab_image_get_height(thumb), 150);
+  PixelGrabImage* expected =
+      pixelgrab_image_resize(img, 200, 150, kPixelGrabFilterBox);
+  ASSERT_NE(expected, nullptr);
+  EXPECT_TRUE(SamePixels(thumb, expected));
+  pixelgrab_image_destroy(expected);
+  pixelgrab_image_destroy(thumb);
+  pixelgrab_image_destroy(img);
+}
+
+TEST_F(HistoryCodecTest, ThumbnailSize) {
+  ASSERT_EQ(pixelgrab_history_set_thumbnail_size(ctx_, 64), kPixelGrabOk);
+  // Fits in 64x64 with the aspect ratio kept; small captures stay as-is.
+  const struct {
+    int width, height, thumb_width, thumb_height;
+  } cases[] = {{640, 480, 64, 48}, {100, 400, 16, 64}, {40, 30, 40, 30}};
+  for (const auto& c : cases) {
+    pixelgrab_image_destroy(
+        pixelgrab_capture_region(ctx_, 0, 0, c.width, c.height));
+    PixelGrabHistoryEntry entry = {};
+    ASSERT_EQ(pixelgrab_history_get_entry(ctx_, 0, &entry), kPixelGrabOk);
+    PixelGrabImage* thumb = pixelgrab_history_get_thumbnail(ctx_, entry.id);
+    ASSERT_NE(thumb, nullptr);
+    EXPECT_EQ(pixelgrab_image_get_width(thumb), c.thumb_width);
+    EXPECT_EQ(pixelgrab_image_get_height(thumb), c.thumb_height);
+    pixelgrab_image_destroy(thumb);
+  }
+}
+
+TEST_F(HistoryCodecTest, ThumbnailInvalidParams) {
+  EXPECT_EQ(pixelgrab_history_get_thumbnail(ctx_, 12345), nullptr);
+  EXPECT_EQ(pixelgrab_get_last_error(ctx_), kPixelGrabErrorHistoryEmpty);
+  EXPECT_EQ(pixelgrab_history_get_thumbnail(nullptr, 1), nullptr);
+  EXPECT_EQ(pixelgrab_history_set_thumbnail_size(ctx_, 0),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(pixelgrab_history_set_thumbnail_size(nullptr, 64),
+            kPixelGrabErrorInvalidParam);
+}
+
+TEST(HistoryDeltaTest, RepeatedCapturesStoreDeltas) {
+  // A few tiles animate, so every capture differs from the one before and
+  // each delta carries real patches.
+  PixelGrabContext* ctx = CreateSynthetic(640, 480, 2);
+  ASSERT_NE(ctx, nullptr);
+
+  PixelGrabImage* captured[16] = {};
+  auto stored_after_16 = [&](int interval) {
+    pixelgrab_history_clear(ctx);
+    EXPECT_EQ(pixelgrab_history_set_keyframe_interval(ctx, interval),
+              kPixelGrabOk);
+    for (auto& img : captured) {
+      pixelgrab_image_destroy(img);
+      img = pixelgrab_capture_region(ctx, 0, 0, 640, 480);
+    }
+    PixelGrabHistoryUsage usage = {};
+    pixelgrab_history_get_usage(ctx, &usage);
+    EXPECT_EQ(usage.image_count, 16);
+    return usage.stored_bytes;
+  };
+  const uint64_t independent = stored_after_16(1);
+  const uint64_t deltas = stored_after_16(16);
+  // Smaller than keyframes alone, but far more than the one keyframe a
+  // static scene would store.
+  EXPECT_LT(deltas * 3, independent * 2);
+  EXPECT_GT(deltas, independent / 8);
+
+  // Every entry of the chain restores to the frame it captured.
+  for (int index = 0; index < 16; ++index) {
+    PixelGrabHistoryEntry entry = {};
+    ASSERT_EQ(pixelgrab_history_get_entry(ctx, index, &entry), kPixelGrabOk);
+    PixelGrabImage* back = pixelgrab_history_recapture(ctx, entry.id);
+    ASSERT_NE(back, nullptr);
+    const PixelGrabImage* expected = captured[15 - index];
+    ASSERT_NE(expected, nullptr);
+    EXPECT_TRUE(SamePixels(expected, back)) << "entry " << index;
+    pixelgrab_image_destroy(back);
+  }
+  for (auto* img : captured) pixelgrab_image_destroy(img);
+  pixelgrab_context_destroy(ctx);
+}
+
+TEST(HistoryDeltaTest, InterleavedSizesChainPerGeometry) {
+  // Two region sizes alternate; each capture is a delta of the previous
+  // one of its own size, not a keyframe because the capture before it
+  // had the other size.  Compressing in the capture call stores every
+  // image before the next capture looks for its base.
+  PixelGrabContext* ctx = CreateSynthetic(640, 480, 2);
+  ASSERT_NE(ctx, nullptr);
+  ASSERT_EQ(pixelgrab_history_set_queue(ctx, 0,
+                                        kPixelGrabHistoryBackpressureInline),
+            kPixelGrabOk);
+
+  PixelGrabImage* captured[16] = {};
+  auto stored_after_16 = [&](int interval) {
+    pixelgrab_history_clear(ctx);
+    EXPECT_EQ(pixelgrab_history_set_keyframe_interval(ctx, interval),
+              kPixelGrabOk);
+    for (int i = 0; i < 16; ++i) {
+      pixelgrab_image_destroy(captured[i]);
+      captured[i] = (i % 2) ? pixelgrab_capture_region(ctx, 0, 0, 320, 240)
+                            : pixelgrab_capture_region(ctx, 0, 0, 640, 480);
+    }
+    PixelGrabHistoryUsage usage = {};
+    pixelgrab_history_get_usage(ctx, &usage);
+    EXPECT_EQ(usage.image_count, 16);
+    return usage.stored_bytes;
+  };
+  const uint64_t independent = stored_after_16(1);
+  const uint64_t deltas = stored_after_16(16);
+  EXPECT_LT(deltas * 3, independent * 2);
+
+  for (int index = 0; index < 16; ++index) {
+    PixelGrabHistoryEntry entry = {};
+    ASSERT_EQ(pixelgrab_history_get_entry(ctx, index, &entry), kPixelGrabOk);
+    PixelGrabImage* back = pixelgrab_history_recapture(ctx, entry.id);
+    ASSERT_NE(back, nullptr);
+    EXPECT_TRUE(SamePixels(captured[15 - index], back)) << "entry " << index;
+    pixelgrab_image_destroy(back);
+  }
+  for (auto* img : captured) pixelgrab_image_destroy(img);
+  pixelgrab_context_destroy(ctx);
+}
+
+TEST(HistoryDeltaTest, DeltasSurviveEviction) {
+  // A changing scene, so each delta carries real patches.
+  PixelGrabContext* ctx = CreateSynthetic(320, 240, 20);
+  ASSERT_NE(ctx, nullptr);
+  pixelgrab_history_set_max_count(ctx, 4);
+
+  PixelGrabImage* captured[10] = {};
+  for (auto& img : captured) {
+    img = pixelgrab_capture_region(ctx, 0, 0, 320, 240);
+    ASSERT_NE(img, nullptr);
+  }
+  // The keyframe's entry was purged, but the deltas built on it still
+  // restore, including the oldest one left (not among the recent frames).
+  for (int index = 0; index < 4; ++index) {
+    PixelGrabHistoryEntry entry = {};
+    ASSERT_EQ(pixelgrab_history_get_entry(ctx, index, &entry), kPixelGrabOk);
+    PixelGrabImage* back = pixelgrab_history_recapture(ctx, entry.id);
+    ASSERT_NE(back, nullptr);
+    const PixelGrabImage* expected = captured[9 - index];
+    EXPECT_TRUE(SamePixels(expected, back)) << "entry " << index;
+    pixelgrab_image_destroy(back);
+  }
+  for (auto* img : captured) pixelgrab_image_destroy(img);
+  pixelgrab_context_destroy(ctx);
+}
+
+static int ProcessId() {
+#ifdef _WIN32
+  return _getpid();
+#else
+  return static_cast<int>(getpid());
+#endif
+}
+
+TEST(HistoryStoreTest, EvictedEntriesPersist) {
+  PixelGrabSyntheticConfig scene = {};
+  scene.screen_width = 320;
+  scene.screen_height = 240;
+  scene.damage_percent = 20;
+  // Unique per test and process, so parallel runs do not share it.
+  const std::string directory =
+      ::testing::TempDir() + "pixelgrab_" +
+      ::testing::UnitTest::GetInstance()->current_test_info()->name() + "_" +
+      std::to_string(ProcessId());
+  std::filesystem::remove_all(directory);
+  PixelGrabContext* ctx = CreateSynthetic(scene, directory.c_str());
+  ASSERT_NE(ctx, nullptr);
+  pixelgrab_history_set_max_count(ctx, 2);
+
+  PixelGrabImage* captured[5] = {};
+  for (auto& img : captured) {
+    img = pixelgrab_capture_region(ctx, 0, 0, 320, 240);
+    ASSERT_NE(img, nullptr);
+  }
+  PixelGrabHistoryUsage usage = {};
+  ASSERT_EQ(pixelgrab_history_get_usage(ctx, &usage), kPixelGrabOk);
+  EXPECT_EQ(pixelgrab_history_count(ctx), 5);
+  EXPECT_GE(usage.disk_entry_count, 3);
+  EXPECT_GT(usage.disk_bytes, 0u);
+
+  // Restores the image from disk, not from the screen.
+  const auto expect_restored = [&](int index, const PixelGrabImage* want) {
+    PixelGrabHistoryEntry entry = {};
+    ASSERT_EQ(pixelgrab_history_get_entry(ctx, index, &entry), kPixelGrabOk);
+    PixelGrabImage* back = pixelgrab_history_recapture(ctx, entry.id);
+    ASSERT_NE(back, nullptr);
+    EXPECT_TRUE(SamePixels(want, back)) << "entry " << index;
+    pixelgrab_image_destroy(back);
+  };
+  expect_restored(4, captured[0]);
+
+  // A new context picks up the whole history.
+  pixelgrab_context_destroy(ctx);
+  ctx = CreateSynthetic(scene, directory.c_str());
+  ASSERT_NE(ctx, nullptr);
+  EXPECT_EQ(pixelgrab_history_count(ctx), 5);
+  expect_restored(0, captured[4]);
+  expect_restored(4, captured[0]);
+
+  pixelgrab_history_clear(ctx);
+  ASSERT_EQ(pixelgrab_history_get_usage(ctx, &usage), kPixelGrabOk);
+  EXPECT_EQ(pixelgrab_history_count(ctx), 0);
+  EXPECT_EQ(usage.disk_entry_count, 0);
+  EXPECT_EQ(usage.disk_bytes, 0u);
+  for (auto* img : captured) pixelgrab_image_destroy(img);
+  pixelgrab_context_destroy(ctx);
+  std::filesystem::remove_all(directory);
+}
+
+TEST_F(HistoryCodecTest, InvalidQueueParams) {
+  EXPECT_EQ(pixelgrab_history_set_queue(ctx_, -1,
+                                        kPixelGrabHistoryBackpressureInline),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(pixelgrab_history_set_queue(
+                ctx_, 4, static_cast<PixelGrabHistoryBackpressure>(7)),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(pixelgrab_history_set_queue(nullptr, 4,
+                                        kPixelGrabHistoryBackpressureBlock),
+            kPixelGrabErrorInvalidParam);
+}
+
+TEST_F(HistoryCodecTest, InvalidKeyframeInterval) {
+  EXPECT_EQ(pixelgrab_history_set_keyframe_interval(ctx_, 0),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(pixelgrab_history_set_keyframe_interval(nullptr, 4),
+            kPixelGrabErrorInvalidParam);
+}
+
+TEST(HistoryConcurrencyTest, RecordLookupAndClearFromManyThreads) {
+  // Two threads record while one looks entries up and one clears, for each
+  // queue policy.  Meant to run under ThreadSanitizer as well; on its own
+  // it checks that nothing crashes and that cleared entries stay gone.
+  PixelGrabContext* ctx = CreateSynthetic(320, 240, 20);
+  ASSERT_NE(ctx, nullptr);
+  const struct {
+    int depth;
+    PixelGrabHistoryBackpressure policy;
+  } queues[] = {{0, kPixelGrabHistoryBackpressureInline},
+                {1, kPixelGrabHistoryBackpressureInline},
+                {1, kPixelGrabHistoryBackpressureBlock},
+                {1, kPixelGrabHistoryBackpressureDrop},
+                {4, kPixelGrabHistoryBackpressureBlock}};
+  for (const auto& q : queues) {
+    ASSERT_EQ(pixelgrab_history_set_queue(ctx, q.depth, q.policy),
+              kPixelGrabOk);
+    std::atomic<bool> recording{true};
+    std::vector<std::thread> recorders;
+    for (int t = 0; t < 2; ++t) {
+      recorders.emplace_back([ctx] {
+        for (int i = 0; i < 40; ++i) {
+          pixelgrab_image_destroy(
+              pixelgrab_capture_region(ctx, 0, 0, 320, 240));
+        }
+      });
+    }
+    std::thread reader([ctx, &recording] {
+      while (recording) {
+        PixelGrabHistoryEntry entry = {};
+        if (pixelgrab_history_get_entry(ctx, 0, &entry) != kPixelGrabOk) {
+          continue;
+        }
+        PixelGrabImage* img = pixelgrab_history_recapture(ctx, entry.id);
+        if (img) {
+          EXPECT_EQ(pixelgrab_image_get_width(img), 320);
+          pixelgrab_image_destroy(img);
+        }
+        pixelgrab_image_destroy(
+            pixelgrab_history_get_thumbnail(ctx, entry.id));
+      }
+    });
+    std::thread clearer([ctx, &recording] {
+      while (recording) {
+        pixelgrab_history_clear(ctx);
+        std::this_thread::yield();
+      }
+    });
+    for (auto& t : recorders) t.join();
+    recording = false;
+    reader.join();
+    clearer.join();
+
+    // Whatever was recorded before the last clear is gone for good, and
+    // the history still works.
+    PixelGrabHistoryEntry newest = {};
+    const bool had_entry =
+        pixelgrab_history_get_entry(ctx, 0, &newest) == kPixelGrabOk;
+    pixelgrab_history_clear(ctx);
+    PixelGrabHistoryUsage usage = {};
+    ASSERT_EQ(pixelgrab_history_get_usage(ctx, &usage), kPixelGrabOk);
+    EXPECT_EQ(usage.entry_count, 0);
+    EXPECT_EQ(usage.image_count, 0);
+    EXPECT_EQ(usage.thumbnail_bytes, 0u);
+    if (had_entry) {
+      EXPECT_EQ(pixelgrab_history_get_thumbnail(ctx, newest.id), nullptr);
+    }
+    pixelgrab_image_destroy(pixelgrab_capture_region(ctx, 0, 0, 320, 240));
+    ASSERT_EQ(pixelgrab_history_get_usage(ctx, &usage), kPixelGrabOk);
+    EXPECT_EQ(usage.entry_count, 1);
+    EXPECT_EQ(usage.image_count, 1);
+  }
+  pixelgrab_context_destroy(ctx);
+}
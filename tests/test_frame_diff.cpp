@@ -0,0 +1,207 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Tests for: Change detection (image diff, tile tracker)
+
+#include "gtest/gtest.h"
+#include "pixelgrab/pixelgrab.h"
+
+class FrameDiffTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ctx_ = pixelgrab_context_create();
+    ASSERT_NE(ctx_, nullptr);
+    base_ = pixelgrab_capture_region(ctx_, 0, 0, 128, 96);
+    if (!base_) GTEST_SKIP() << "Capture unavailable (no display)";
+  }
+
+  void TearDown() override {
+    pixelgrab_image_destroy(base_);
+    pixelgrab_context_destroy(ctx_);
+  }
+
+  // Copy of base_ with a filled rectangle of |color| painted on it.
+  PixelGrabImage* Painted(int x, int y, int w, int h, uint32_t color) {
+    PixelGrabAnnotation* ann = pixelgrab_annotation_create(ctx_, base_);
+    if (!ann) return nullptr;
+    PixelGrabShapeStyle style = {};
+    style.stroke_color = color;
+    style.fill_color = color;
+    style.stroke_width = 1.0f;
+    style.filled = 1;
+    pixelgrab_annotation_add_rect(ann, x, y, w, h, &style);
+    PixelGrabImage* out = pixelgrab_annotation_export(ann);
+    pixelgrab_annotation_destroy(ann);
+    return out;
+  }
+
+  PixelGrabContext* ctx_ = nullptr;
+  PixelGrabImage* base_ = nullptr;
+};
+
+// ---------------------------------------------------------------------------
+// pixelgrab_image_diff
+// ---------------------------------------------------------------------------
+
+TEST_F(FrameDiffTest, IdenticalFramesReportNothing) {
+  PixelGrabImage* view = pixelgrab_image_create_view(base_, 0, 0, 128, 96);
+  ASSERT_NE(view, nullptr);
+  PixelGrabRect tiles[16];
+  int count = -1;
+  EXPECT_EQ(pixelgrab_image_diff(base_, view, 32, tiles, 16, &count),
+            kPixelGrabOk);
+  EXPECT_EQ(count, 0);
+  pixelgrab_image_destroy(view);
+}
+
+TEST_F(FrameDiffTest, ReportsChangedAreaPerTile) {
+  // Black vs white over the same rectangle: every pixel inside differs.
+  PixelGrabImage* a = Painted(40, 20, 30, 30, 0xFF000000);
+  PixelGrabImage* b = Painted(40, 20, 30, 30, 0xFFFFFFFF);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+
+  PixelGrabRect tiles[12];
+  int count = 0;
+  ASSERT_EQ(pixelgrab_image_diff(a, b, 32, tiles, 12, &count), kPixelGrabOk);
+  // The rectangle spans tile columns 1-2 and tile rows 0-1.
+  EXPECT_EQ(count, 4);
+  for (int i = 0; i < count; ++i) {
+    const PixelGrabRect& r = tiles[i];
+    // Each box stays inside its own tile...
+    EXPECT_EQ(r.x / 32, (r.x + r.width - 1) / 32);
+    EXPECT_EQ(r.y / 32, (r.y + r.height - 1) / 32);
+    // ...and near the painted rectangle (allowing for edge antialiasing).
+    EXPECT_GE(r.x, 38);
+    EXPECT_GE(r.y, 18);
+    EXPECT_LE(r.x + r.width, 72);
+    EXPECT_LE(r.y + r.height, 52);
+  }
+  // Row-major order.
+  for (int i = 1; i < count; ++i) {
+    EXPECT_TRUE(tiles[i - 1].y / 32 < tiles[i].y / 32 ||
+                (tiles[i - 1].y / 32 == tiles[i].y / 32 &&
+                 tiles[i - 1].x < tiles[i].x));
+  }
+
+  int counted = 0;
+  EXPECT_EQ(pixelgrab_image_diff(a, b, 32, nullptr, 0, &counted),
+            kPixelGrabOk);
+  EXPECT_EQ(counted, count);
+
+  pixelgrab_image_destroy(a);
+  pixelgrab_image_destroy(b);
+}
+
+TEST_F(FrameDiffTest, OverflowCollapsesToBoundingBox) {
+  PixelGrabImage* a = Painted(10, 10, 100, 70, 0xFF000000);
+  PixelGrabImage* b = Painted(10, 10, 100, 70, 0xFFFFFFFF);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  PixelGrabRect bbox = {};
+  int count = 0;
+  ASSERT_EQ(pixelgrab_image_diff(a, b, 16, &bbox, 1, &count), kPixelGrabOk);
+  EXPECT_EQ(count, 1);
+  EXPECT_LE(bbox.x, 10);
+  EXPECT_LE(bbox.y, 10);
+  EXPECT_GE(bbox.x + bbox.width, 110);
+  EXPECT_GE(bbox.y + bbox.height, 80);
+  pixelgrab_image_destroy(a);
+  pixelgrab_image_destroy(b);
+}
+
+TEST_F(FrameDiffTest, DiffInvalidParams) {
+  PixelGrabImage* small = pixelgrab_image_create_view(base_, 0, 0, 64, 64);
+  ASSERT_NE(small, nullptr);
+  PixelGrabRect tiles[4];
+  int count = -1;
+  EXPECT_EQ(pixelgrab_image_diff(base_, small, 32, tiles, 4, &count),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(count, 0);
+  EXPECT_EQ(pixelgrab_image_diff(base_, base_, 0, tiles, 4, &count),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(pixelgrab_image_diff(base_, base_, 32, tiles, 0, &count),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(pixelgrab_image_diff(nullptr, base_, 32, tiles, 4, &count),
+            kPixelGrabErrorInvalidParam);
+  pixelgrab_image_destroy(small);
+}
+
+// ---------------------------------------------------------------------------
+// Tile tracker
+// ---------------------------------------------------------------------------
+
+TEST_F(FrameDiffTest, TrackerReportsOnlyChangedTiles) {
+  PixelGrabTileTracker* tracker = pixelgrab_tile_tracker_create(32);
+  ASSERT_NE(tracker, nullptr);
+  PixelGrabImage* a = Painted(70, 40, 20, 20, 0xFF000000);
+  PixelGrabImage* b = Painted(70, 40, 20, 20, 0xFFFFFFFF);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+
+  PixelGrabRect tiles[12];
+  int count = 0;
+  // First frame: all 4 x 3 tiles.
+  ASSERT_EQ(pixelgrab_tile_tracker_update(tracker, a, tiles, 12, &count),
+            kPixelGrabOk);
+  EXPECT_EQ(count, 12);
+  EXPECT_EQ(tiles[11].x, 96);
+  EXPECT_EQ(tiles[11].y, 64);
+  EXPECT_EQ(tiles[11].width, 32);
+  EXPECT_EQ(tiles[11].height, 32);
+
+  ASSERT_EQ(pixelgrab_tile_tracker_update(tracker, a, tiles, 12, &count),
+            kPixelGrabOk);
+  EXPECT_EQ(count, 0);
+
+  // The painted square lies in tile column 2, row 1 (antialiased edges may
+  // reach a neighbour).
+  ASSERT_EQ(pixelgrab_tile_tracker_update(tracker, b, tiles, 12, &count),
+            kPixelGrabOk);
+  EXPECT_GE(count, 1);
+  EXPECT_LE(count, 4);
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(tiles[i].x % 32, 0);
+    EXPECT_EQ(tiles[i].y % 32, 0);
+    EXPECT_GE(tiles[i].x, 64);
+    EXPECT_GE(tiles[i].y, 32);
+  }
+
+  pixelgrab_tile_tracker_reset(tracker);
+  ASSERT_EQ(pixelgrab_tile_tracker_update(tracker, b, nullptr, 0, &count),
+            kPixelGrabOk);
+  EXPECT_EQ(count, 12);
+
+  pixelgrab_image_destroy(a);
+  pixelgrab_image_destroy(b);
+  pixelgrab_tile_tracker_destroy(tracker);
+}
+
+TEST_F(FrameDiffTest, TrackerSizeChangeReportsEverything) {
+  PixelGrabTileTracker* tracker = pixelgrab_tile_tracker_create(64);
+  ASSERT_NE(tracker, nullptr);
+  PixelGrabImage* part = pixelgrab_image_create_view(base_, 0, 0, 64, 64);
+  ASSERT_NE(part, nullptr);
+  int count = 0;
+  pixelgrab_tile_tracker_update(tracker, base_, nullptr, 0, &count);
+  EXPECT_EQ(count, 4);
+  pixelgrab_tile_tracker_update(tracker, part, nullptr, 0, &count);
+  EXPECT_EQ(count, 1);
+  pixelgrab_image_destroy(part);
+  pixelgrab_tile_tracker_destroy(tracker);
+}
+
+TEST(FrameDiffStandaloneTest, TrackerInvalidParams) {
+  EXPECT_EQ(pixelgrab_tile_tracker_create(0), nullptr);
+  EXPECT_EQ(pixelgrab_tile_tracker_update(nullptr, nullptr, nullptr, 0,
+                                          nullptr),
+            kPixelGrabErrorInvalidParam);
+  PixelGrabTileTracker* tracker = pixelgrab_tile_tracker_create(16);
+  ASSERT_NE(tracker, nullptr);
+  int count = -1;
+  EXPECT_EQ(pixelgrab_tile_tracker_update(tracker, nullptr, nullptr, 0,
+                                          &count),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(count, 0);
+  pixelgrab_tile_tracker_reset(nullptr);
+  pixelgrab_tile_tracker_destroy(tracker);
+  pixelgrab_tile_tracker_destroy(nullptr);
+}
@@ -0,0 +1,93 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Tests for: process-wide image buffer pool.
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "pixelgrab/pixelgrab.h"
+
+namespace {
+
+constexpr uint64_t kDefaultLimit = 256ULL * 1024 * 1024;
+
+class ImagePoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ctx_ = pixelgrab_context_create();
+    ASSERT_NE(ctx_, nullptr);
+  }
+
+  void TearDown() override {
+    pixelgrab_context_destroy(ctx_);
+    pixelgrab_buffer_pool_set_limit(kDefaultLimit);
+  }
+
+  static PixelGrabBufferPoolStats Stats() {
+    PixelGrabBufferPoolStats s = {};
+    EXPECT_EQ(pixelgrab_buffer_pool_get_stats(&s), kPixelGrabOk);
+    return s;
+  }
+
+  PixelGrabContext* ctx_ = nullptr;
+};
+
+}  // namespace
+
+TEST_F(ImagePoolTest, GetStatsNullOut) {
+  EXPECT_EQ(pixelgrab_buffer_pool_get_stats(nullptr),
+            kPixelGrabErrorInvalidParam);
+}
+
+TEST_F(ImagePoolTest, CountersAreConsistent) {
+  PixelGrabBufferPoolStats s = Stats();
+  EXPECT_EQ(s.acquire_count, s.hit_count + s.miss_count);
+  EXPECT_LE(s.bytes_in_use, s.peak_bytes_in_use);
+  EXPECT_LE(s.bytes_pooled, s.max_pooled_bytes);
+}
+
+TEST_F(ImagePoolTest, SetLimitIsReported) {
+  pixelgrab_buffer_pool_set_limit(8 * 1024 * 1024);
+  EXPECT_EQ(Stats().max_pooled_bytes, 8u * 1024 * 1024);
+  EXPECT_LE(Stats().bytes_pooled, 8u * 1024 * 1024);
+}
+
+TEST_F(ImagePoolTest, TrimEmptiesPool) {
+  pixelgrab_buffer_pool_trim();
+  EXPECT_EQ(Stats().bytes_pooled, 0u);
+}
+
+TEST_F(ImagePoolTest, SameSizeCaptureReusesBuffer) {
+  // A queued history image shares the capture's buffer until the worker
+  // compresses it; compress in the capture call instead, so the buffer is
+  // the caller's alone once it returns.
+  ASSERT_EQ(pixelgrab_history_set_queue(ctx_, 0,
+                                        kPixelGrabHistoryBackpressureInline),
+            kPixelGrabOk);
+  PixelGrabImage* first = pixelgrab_capture_region(ctx_, 0, 0, 64, 64);
+  if (!first) GTEST_SKIP() << "Capture unavailable";
+  pixelgrab_image_destroy(first);
+  EXPECT_GT(Stats().bytes_pooled, 0u);
+
+  uint64_t hits_before = Stats().hit_count;
+  PixelGrabImage* second = pixelgrab_capture_region(ctx_, 0, 0, 64, 64);
+  ASSERT_NE(second, nullptr);
+  EXPECT_GT(Stats().hit_count, hits_before);
+  pixelgrab_image_destroy(second);
+}
+
+TEST_F(ImagePoolTest, ImageDataIsAligned) {
+  PixelGrabImage* img = pixelgrab_capture_region(ctx_, 0, 0, 33, 17);
+  if (!img) GTEST_SKIP() << "Capture unavailable";
+  auto addr = reinterpret_cast<uintptr_t>(pixelgrab_image_get_data(img));
+  EXPECT_EQ(addr % 64, 0u);
+  pixelgrab_image_destroy(img);
+}
+
+TEST_F(ImagePoolTest, ZeroLimitDisablesPooling) {
+  pixelgrab_buffer_pool_set_limit(0);
+  EXPECT_EQ(Stats().bytes_pooled, 0u);
+  PixelGrabImage* img = pixelgrab_capture_region(ctx_, 0, 0, 64, 64);
+  if (!img) GTEST_SKIP() << "Capture unavailable";
+  pixelgrab_image_destroy(img);
+  EXPECT_EQ(Stats().bytes_pooled, 0u);
+}
@@ -1,10 +1,15 @@
 // Copyright 2026 The loong-pixelgrab Authors
 // Tests for: Screen, Capture, Window enumeration, Image accessors
 
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "pixelgrab/pixelgrab.h"
+#include "test_util.h"
 
 // Fixture: provides an initialized context.
 class ScreenCaptureTest : public ::testing::Test {
@@ -70,6 +75,43 @@ TEST_F(ScreenCaptureTest, CaptureScreen0) {
   pixelgrab_image_destroy(img);
 }
 
+TEST_F(ScreenCaptureTest, ScreenIndicesAndSinglePrimary) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  int count = pixelgrab_get_screen_count(ctx_);
+  int primaries = 0;
+  for (int i = 0; i < count; ++i) {
+    PixelGrabScreenInfo info = {};
+    ASSERT_EQ(pixelgrab_get_screen_info(ctx_, i, &info), kPixelGrabOk);
+    EXPECT_EQ(info.index, i);
+    if (info.is_primary) ++primaries;
+  }
+  EXPECT_EQ(primaries, 1);
+}
+
+#if defined(__linux__)
+TEST_F(ScreenCaptureTest, CaptureEachScreenMatchesInfo) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  int count = pixelgrab_get_screen_count(ctx_);
+  for (int i = 0; i < count; ++i) {
+    PixelGrabScreenInfo info = {};
+    ASSERT_EQ(pixelgrab_get_screen_info(ctx_, i, &info), kPixelGrabOk);
+    PixelGrabImage* img = pixelgrab_capture_screen(ctx_, i);
+    ASSERT_NE(img, nullptr) << "screen " << i;
+    // Each capture covers only its own monitor, not the whole root.
+    EXPECT_EQ(pixelgrab_image_get_width(img), info.width);
+    EXPECT_EQ(pixelgrab_image_get_height(img), info.height);
+    pixelgrab_image_destroy(img);
+  }
+}
+
+TEST_F(ScreenCaptureTest, CaptureScreenOutOfRange) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  int count = pixelgrab_get_screen_count(ctx_);
+  EXPECT_EQ(pixelgrab_capture_screen(ctx_, count), nullptr);
+  EXPECT_EQ(pixelgrab_capture_screen(ctx_, -1), nullptr);
+}
+#endif
+
 TEST_F(ScreenCaptureTest, CaptureScreenNullCtx) {
   PixelGrabImage* img = pixelgrab_capture_screen(nullptr, 0);
   EXPECT_EQ(img, nullptr);
@@ -97,6 +139,122 @@ TEST_F(ScreenCaptureTest, CaptureRegionNullCtx) {
   EXPECT_EQ(pixelgrab_capture_region(nullptr, 0, 0, 100, 100), nullptr);
 }
 
+// ---------------------------------------------------------------------------
+// Capture into caller-provided buffer
+// ---------------------------------------------------------------------------
+
+TEST_F(ScreenCaptureTest, CaptureRegionIntoRespectsStride) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  const int w = 64, h = 32, stride = w * 4 + 16;  // Padded rows.
+  std::vector<uint8_t> buf(static_cast<size_t>(stride) * h, 0);
+  ASSERT_EQ(pixelgrab_capture_region_into(ctx_, 0, 0, w, h, buf.data(),
+                                          stride),
+            kPixelGrabOk);
+  // Alpha is always opaque; padding bytes are never written.
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x) {
+      EXPECT_EQ(buf[y * stride + x * 4 + 3], 0xFF);
+    }
+    EXPECT_EQ(buf[y * stride + w * 4], 0);
+  }
+}
+
+TEST_F(ScreenCaptureTest, CaptureScreenIntoFillsScreenSizedBuffer) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  PixelGrabScreenInfo info = {};
+  ASSERT_EQ(pixelgrab_get_screen_info(ctx_, 0, &info), kPixelGrabOk);
+  int stride = info.width * 4;
+  std::vector<uint8_t> buf(static_cast<size_t>(stride) * info.height, 0);
+  EXPECT_EQ(pixelgrab_capture_screen_into(ctx_, 0, buf.data(), stride),
+            kPixelGrabOk);
+  EXPECT_EQ(buf[3], 0xFF);
+  EXPECT_EQ(buf[buf.size() - 1], 0xFF);
+}
+
+TEST_F(ScreenCaptureTest, CaptureIntoInvalidParams) {
+  std::vector<uint8_t> buf(100 * 100 * 4);
+  EXPECT_NE(pixelgrab_capture_region_into(ctx_, 0, 0, 100, 100, nullptr, 400),
+            kPixelGrabOk);
+  EXPECT_NE(pixelgrab_capture_region_into(ctx_, 0, 0, 100, 100, buf.data(),
+                                          399),
+            kPixelGrabOk);
+  EXPECT_NE(pixelgrab_capture_region_into(ctx_, 0, 0, 0, 100, buf.data(), 400),
+            kPixelGrabOk);
+  EXPECT_NE(pixelgrab_capture_screen_into(ctx_, 999, buf.data(), 400),
+            kPixelGrabOk);
+}
+
+TEST_F(ScreenCaptureTest, CaptureIntoNullCtx) {
+  uint8_t px[4] = {};
+  EXPECT_EQ(pixelgrab_capture_region_into(nullptr, 0, 0, 1, 1, px, 4),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(pixelgrab_capture_screen_into(nullptr, 0, px, 4),
+            kPixelGrabErrorInvalidParam);
+}
+
+// ---------------------------------------------------------------------------
+// Incremental (damage-tracked) capture
+// ---------------------------------------------------------------------------
+
+TEST_F(ScreenCaptureTest, IncrementalFirstCallReportsWholeRegion) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  PixelGrabRect rects[8] = {};
+  int n = -1;
+  PixelGrabImage* img = pixelgrab_capture_region_incremental(
+      ctx_, 0, 0, 100, 80, rects, 8, &n);
+  ASSERT_NE(img, nullptr);
+  EXPECT_EQ(pixelgrab_image_get_width(img), 100);
+  EXPECT_EQ(pixelgrab_image_get_height(img), 80);
+  ASSERT_EQ(n, 1);
+  EXPECT_EQ(rects[0].x, 0);
+  EXPECT_EQ(rects[0].y, 0);
+  EXPECT_EQ(rects[0].width, 100);
+  EXPECT_EQ(rects[0].height, 80);
+  pixelgrab_image_destroy(img);
+}
+
+TEST_F(ScreenCaptureTest, IncrementalRepeatedCallsStayInsideRegion) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  for (int i = 0; i < 3; ++i) {
+    PixelGrabRect rects[16] = {};
+    int n = -1;
+    PixelGrabImage* img = pixelgrab_capture_region_incremental(
+        ctx_, 10, 20, 64, 48, rects, 16, &n);
+    ASSERT_NE(img, nullptr);
+    ASSERT_GE(n, 0);
+    ASSERT_LE(n, 16);
+    for (int r = 0; r < n; ++r) {
+      EXPECT_GE(rects[r].x, 10);
+      EXPECT_GE(rects[r].y, 20);
+      EXPECT_LE(rects[r].x + rects[r].width, 10 + 64);
+      EXPECT_LE(rects[r].y + rects[r].height, 20 + 48);
+    }
+    pixelgrab_image_destroy(img);
+  }
+  pixelgrab_capture_incremental_reset(ctx_);
+}
+
+TEST_F(ScreenCaptureTest, IncrementalInvalidParams) {
+  int n = -1;
+  EXPECT_EQ(pixelgrab_capture_region_incremental(ctx_, 0, 0, 0, 10, nullptr,
+                                                 0, &n),
+            nullptr);
+  EXPECT_EQ(n, 0);
+  PixelGrabRect rect = {};
+  EXPECT_EQ(pixelgrab_capture_region_incremental(ctx_, 0, 0, 10, 10, &rect,
+                                                 0, nullptr),
+            nullptr);
+}
+
+TEST_F(ScreenCaptureTest, IncrementalNullCtx) {
+  int n = -1;
+  EXPECT_EQ(pixelgrab_capture_region_incremental(nullptr, 0, 0, 10, 10,
+                                                 nullptr, 0, &n),
+            nullptr);
+  EXPECT_EQ(n, 0);
+  pixelgrab_capture_incremental_reset(nullptr);  // Must not crash.
+}
+
 // ---------------------------------------------------------------------------
 // Capture window
 // ---------------------------------------------------------------------------
@@ -109,6 +267,215 @@ TEST_F(ScreenCaptureTest, CaptureWindowNullCtx) {
   EXPECT_EQ(pixelgrab_capture_window(nullptr, 1), nullptr);
 }
 
+TEST_F(ScreenCaptureTest, WindowCaptureModeDefaultsToScreen) {
+  EXPECT_EQ(pixelgrab_get_window_capture_mode(ctx_),
+            kPixelGrabWindowCaptureScreen);
+  EXPECT_EQ(pixelgrab_get_window_capture_mode(nullptr),
+            kPixelGrabWindowCaptureScreen);
+}
+
+TEST_F(ScreenCaptureTest, WindowCaptureModeInvalid) {
+  EXPECT_NE(pixelgrab_set_window_capture_mode(
+                ctx_, static_cast<PixelGrabWindowCaptureMode>(42)),
+            kPixelGrabOk);
+  EXPECT_EQ(pixelgrab_get_window_capture_mode(ctx_),
+            kPixelGrabWindowCaptureScreen);
+  EXPECT_EQ(pixelgrab_set_window_capture_mode(nullptr,
+                                              kPixelGrabWindowCaptureScreen),
+            kPixelGrabErrorInvalidParam);
+}
+
+// ---------------------------------------------------------------------------
+// Backend selection
+// ---------------------------------------------------------------------------
+
+namespace {
+
+// Sets |name| to |value| (or unsets it if |value| is null) for the
+// lifetime of the object, then restores the previous value.
+class ScopedEnv {
+ public:
+  ScopedEnv(const char* name, const char* value) : name_(name) {
+    const char* old = std::getenv(name);
+    had_old_ = old != nullptr;
+    if (had_old_) old_ = old;
+    Set(value);
+  }
+  ~ScopedEnv() { Set(had_old_ ? old_.c_str() : nullptr); }
+
+  ScopedEnv(const ScopedEnv&) = delete;
+  ScopedEnv& operator=(const ScopedEnv&) = delete;
+
+ private:
+  void Set(const char* value) {
+#ifdef _WIN32
+    _putenv_s(name_, value ? value : "");  // Empty removes it.
+#else
+    if (value) {
+      setenv(name_, value, 1);
+    } else {
+      unsetenv(name_);
+    }
+#endif
+  }
+
+  const char* name_;
+  bool had_old_ = false;
+  std::string old_;
+};
+
+}  // namespace
+
+TEST(BackendSelectionTest, NullOptionsUseDefault) {
+  // Headless CI runs set PIXELGRAB_BACKEND=synthetic; without it null
+  // options select the default backend.
+  ScopedEnv backend("PIXELGRAB_BACKEND", nullptr);
+  PixelGrabContext* ctx = pixelgrab_context_create_with_options(nullptr);
+  ASSERT_NE(ctx, nullptr);
+  EXPECT_EQ(pixelgrab_get_backend_type(ctx), kPixelGrabBackendDefault);
+  pixelgrab_context_destroy(ctx);
+}
+
+TEST(BackendSelectionTest, EnvironmentSelectsSynthetic) {
+  ScopedEnv backend("PIXELGRAB_BACKEND", "synthetic");
+  PixelGrabContext* ctx = pixelgrab_context_create_with_options(nullptr);
+  ASSERT_NE(ctx, nullptr);
+  EXPECT_EQ(pixelgrab_get_backend_type(ctx), kPixelGrabBackendSynthetic);
+  pixelgrab_context_destroy(ctx);
+}
+
+TEST(BackendSelectionTest, NullCtxReportsDefault) {
+  EXPECT_EQ(pixelgrab_get_backend_type(nullptr), kPixelGrabBackendDefault);
+}
+
+TEST(BackendSelectionTest, XcbFallsBackWhenUnavailable) {
+  PixelGrabContextOptions options = {};
+  options.backend = kPixelGrabBackendXcb;
+  PixelGrabContext* ctx = pixelgrab_context_create_with_options(&options);
+  ASSERT_NE(ctx, nullptr);
+  PixelGrabBackendType type = pixelgrab_get_backend_type(ctx);
+  EXPECT_TRUE(type == kPixelGrabBackendXcb ||
+              type == kPixelGrabBackendDefault);
+  pixelgrab_context_destroy(ctx);
+}
+
+TEST(BackendSelectionTest, XcbCaptureAndEnumerate) {
+  PixelGrabContextOptions options = {};
+  options.backend = kPixelGrabBackendXcb;
+  PixelGrabContext* xcb = pixelgrab_context_create_with_options(&options);
+  ASSERT_NE(xcb, nullptr);
+  if (pixelgrab_get_screen_count(xcb) <= 0) {
+    pixelgrab_context_destroy(xcb);
+    GTEST_SKIP() << "No display available";
+  }
+
+  PixelGrabImage* img = pixelgrab_capture_region(xcb, 0, 0, 64, 32);
+  ASSERT_NE(img, nullptr);
+  EXPECT_EQ(pixelgrab_image_get_width(img), 64);
+  EXPECT_EQ(pixelgrab_image_get_height(img), 32);
+  pixelgrab_image_destroy(img);
+
+  PixelGrabWindowInfo windows[64];
+  int n = pixelgrab_enumerate_windows(xcb, windows, 64);
+  EXPECT_GE(n, 0);
+
+  pixelgrab_context_destroy(xcb);
+}
+
+namespace {
+
+// Resize the X root window with xrandr(1).  False if that is not possible
+// (no xrandr, no RandR on the server, or the size is out of range).
+bool ResizeRoot(int width, int height) {
+  char command[96];
+  std::snprintf(command, sizeof(command),
+                "xrandr --fb %dx%d >/dev/null 2>&1", width, height);
+  return std::system(command) == 0;
+}
+
+}  // namespace
+
+// The size the XCB backend reports and reads must follow the root window,
+// which on VNC and SSH displays is resized along with the client window.
+TEST(BackendSelectionTest, XcbFollowsRootResize) {
+  PixelGrabContextOptions options = {};
+  options.backend = kPixelGrabBackendXcb;
+  PixelGrabContext* xcb = pixelgrab_context_create_with_options(&options);
+  ASSERT_NE(xcb, nullptr);
+  PixelGrabScreenInfo before = {};
+  if (pixelgrab_get_backend_type(xcb) != kPixelGrabBackendXcb ||
+      pixelgrab_get_screen_info(xcb, 0, &before) != kPixelGrabOk) {
+    pixelgrab_context_destroy(xcb);
+    GTEST_SKIP() << "No XCB display available";
+  }
+  // Growing the framebuffer works on any output mode; shrinking it back
+  // then leaves the backend with a root larger than the real one.
+  const int grown_w = before.width + 64;
+  const int grown_h = before.height + 32;
+  if (!ResizeRoot(grown_w, grown_h)) {
+    pixelgrab_context_destroy(xcb);
+    GTEST_SKIP() << "Cannot resize the root window with xrandr";
+  }
+
+  PixelGrabScreenInfo info = {};
+  EXPECT_EQ(pixelgrab_get_screen_info(xcb, 0, &info), kPixelGrabOk);
+  EXPECT_EQ(info.width, grown_w);
+  EXPECT_EQ(info.height, grown_h);
+  PixelGrabImage* img = pixelgrab_capture_screen(xcb, 0);
+  ASSERT_NE(img, nullptr);
+  EXPECT_EQ(pixelgrab_image_get_width(img), grown_w);
+  EXPECT_EQ(pixelgrab_image_get_height(img), grown_h);
+  pixelgrab_image_destroy(img);
+
+  ASSERT_TRUE(ResizeRoot(before.width, before.height));
+  // A full-screen read at the old, larger size would fail with BadMatch.
+  img = pixelgrab_capture_screen(xcb, 0);
+  ASSERT_NE(img, nullptr);
+  EXPECT_EQ(pixelgrab_image_get_width(img), before.width);
+  EXPECT_EQ(pixelgrab_image_get_height(img), before.height);
+  pixelgrab_image_destroy(img);
+  img = pixelgrab_capture_region(xcb, before.width - 16, before.height - 16,
+                                 64, 64);
+  ASSERT_NE(img, nullptr);
+  EXPECT_EQ(pixelgrab_image_get_width(img), 16);
+  EXPECT_EQ(pixelgrab_image_get_height(img), 16);
+  pixelgrab_image_destroy(img);
+  EXPECT_EQ(pixelgrab_get_screen_info(xcb, 0, &info), kPixelGrabOk);
+  EXPECT_EQ(info.width, before.width);
+  EXPECT_EQ(info.height, before.height);
+
+  pixelgrab_context_destroy(xcb);
+}
+
+TEST_F(ScreenCaptureTest, WindowCaptureContentRepeated) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  PixelGrabWindowInfo windows[16] = {};
+  int n = pixelgrab_enumerate_windows(ctx_, windows, 16);
+  if (n <= 0) GTEST_SKIP() << "No windows to capture";
+  if (pixelgrab_set_window_capture_mode(
+          ctx_, kPixelGrabWindowCaptureContent) != kPixelGrabOk) {
+    GTEST_SKIP() << "Window content capture not supported";
+  }
+  EXPECT_EQ(pixelgrab_get_window_capture_mode(ctx_),
+            kPixelGrabWindowCaptureContent);
+
+  // The second capture reuses the window's backing pixmap.
+  PixelGrabImage* first = pixelgrab_capture_window(ctx_, windows[0].id);
+  if (!first) GTEST_SKIP() << "Capture unavailable";
+  PixelGrabImage* second = pixelgrab_capture_window(ctx_, windows[0].id);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(pixelgrab_image_get_width(first),
+            pixelgrab_image_get_width(second));
+  EXPECT_EQ(pixelgrab_image_get_height(first),
+            pixelgrab_image_get_height(second));
+  pixelgrab_image_destroy(first);
+  pixelgrab_image_destroy(second);
+
+  EXPECT_EQ(pixelgrab_set_window_capture_mode(ctx_,
+                                              kPixelGrabWindowCaptureScreen),
+            kPixelGrabOk);
+}
+
 // ---------------------------------------------------------------------------
 // Window enumeration
 // ---------------------------------------------------------------------------
@@ -169,3 +536,281 @@ TEST_F(ScreenCaptureTest, ImageDataConsistency) {
   EXPECT_EQ(data_size, static_cast<size_t>(stride * h));
   pixelgrab_image_destroy(img);
 }
+
+// ---------------------------------------------------------------------------
+// Image views
+// ---------------------------------------------------------------------------
+
+TEST_F(ScreenCaptureTest, ViewSharesParentPixels) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  PixelGrabImage* img = pixelgrab_capture_region(ctx_, 0, 0, 64, 48);
+  ASSERT_NE(img, nullptr);
+  int stride = pixelgrab_image_get_stride(img);
+
+  PixelGrabImage* view = pixelgrab_image_create_view(img, 8, 4, 20, 10);
+  ASSERT_NE(view, nullptr);
+  EXPECT_EQ(pixelgrab_image_get_width(view), 20);
+  EXPECT_EQ(pixelgrab_image_get_height(view), 10);
+  EXPECT_EQ(pixelgrab_image_get_stride(view), stride);
+  EXPECT_EQ(pixelgrab_image_get_data(view),
+            pixelgrab_image_get_data(img) + 4 * stride + 8 * 4);
+  EXPECT_EQ(pixelgrab_image_get_data_size(view),
+            static_cast<size_t>(9 * stride + 20 * 4));
+
+  pixelgrab_image_destroy(view);
+  pixelgrab_image_destroy(img);
+}
+
+TEST_F(ScreenCaptureTest, ViewOutlivesParent) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  PixelGrabImage* img = pixelgrab_capture_region(ctx_, 0, 0, 32, 32);
+  ASSERT_NE(img, nullptr);
+  PixelGrabImage* view = pixelgrab_image_create_view(img, 16, 16, 16, 16);
+  ASSERT_NE(view, nullptr);
+  std::vector<uint8_t> expected(pixelgrab_image_get_data(view),
+                                pixelgrab_image_get_data(view) + 16 * 4);
+  pixelgrab_image_destroy(img);
+
+  EXPECT_EQ(std::memcmp(pixelgrab_image_get_data(view), expected.data(),
+                        expected.size()),
+            0);
+  PixelGrabImage* nested = pixelgrab_image_create_view(view, 4, 4, 4, 4);
+  EXPECT_NE(nested, nullptr);
+  pixelgrab_image_destroy(nested);
+  pixelgrab_image_destroy(view);
+}
+
+TEST_F(ScreenCaptureTest, ViewInvalidBounds) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  PixelGrabImage* img = pixelgrab_capture_region(ctx_, 0, 0, 32, 32);
+  ASSERT_NE(img, nullptr);
+  EXPECT_EQ(pixelgrab_image_create_view(img, 0, 0, 0, 10), nullptr);
+  EXPECT_EQ(pixelgrab_image_create_view(img, -1, 0, 10, 10), nullptr);
+  EXPECT_EQ(pixelgrab_image_create_view(img, 30, 0, 3, 10), nullptr);
+  EXPECT_EQ(pixelgrab_image_create_view(img, 0, 30, 10, 3), nullptr);
+  PixelGrabImage* whole = pixelgrab_image_create_view(img, 0, 0, 32, 32);
+  EXPECT_NE(whole, nullptr);
+  pixelgrab_image_destroy(whole);
+  pixelgrab_image_destroy(img);
+}
+
+TEST_F(ScreenCaptureTest, ViewNullImage) {
+  EXPECT_EQ(pixelgrab_image_create_view(nullptr, 0, 0, 1, 1), nullptr);
+}
+
+// ---------------------------------------------------------------------------
+// Scaled capture and resize
+// ---------------------------------------------------------------------------
+
+TEST_F(ScreenCaptureTest, CaptureRegionScaledSizeAndFormat) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  const PixelGrabResizeFilter filters[] = {
+      kPixelGrabFilterBox, kPixelGrabFilterBilinear, kPixelGrabFilterLanczos3};
+  for (PixelGrabResizeFilter filter : filters) {
+    // Taller than one strip, so several reads feed the resampler.
+    PixelGrabImage* img =
+        pixelgrab_capture_region_scaled(ctx_, 0, 0, 300, 400, 75, 50, filter);
+    ASSERT_NE(img, nullptr) << "filter " << filter;
+    EXPECT_EQ(pixelgrab_image_get_width(img), 75);
+    EXPECT_EQ(pixelgrab_image_get_height(img), 50);
+    EXPECT_EQ(pixelgrab_image_get_format(img), kPixelGrabFormatBgra8);
+    // Opaque in, opaque out.
+    const uint8_t* data = pixelgrab_image_get_data(img);
+    EXPECT_EQ(data[3], 0xFF);
+    EXPECT_EQ(data[49 * pixelgrab_image_get_stride(img) + 74 * 4 + 3], 0xFF);
+    pixelgrab_image_destroy(img);
+  }
+}
+
+TEST_F(ScreenCaptureTest, CaptureRegionScaledInvalidParams) {
+  EXPECT_EQ(pixelgrab_capture_region_scaled(ctx_, 0, 0, 0, 10, 5, 5,
+                                            kPixelGrabFilterBox),
+            nullptr);
+  EXPECT_EQ(pixelgrab_capture_region_scaled(ctx_, 0, 0, 10, 10, 5, 0,
+                                            kPixelGrabFilterBox),
+            nullptr);
+  EXPECT_EQ(pixelgrab_capture_region_scaled(
+                ctx_, 0, 0, 10, 10, 5, 5,
+                static_cast<PixelGrabResizeFilter>(99)),
+            nullptr);
+  EXPECT_EQ(pixelgrab_get_last_error(ctx_), kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(pixelgrab_capture_region_scaled(nullptr, 0, 0, 10, 10, 5, 5,
+                                            kPixelGrabFilterBox),
+            nullptr);
+}
+
+TEST_F(ScreenCaptureTest, ImageResizeSameSizeBoxIsIdentity) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  PixelGrabImage* img = pixelgrab_capture_region(ctx_, 0, 0, 40, 30);
+  ASSERT_NE(img, nullptr);
+  PixelGrabImage* copy =
+      pixelgrab_image_resize(img, 40, 30, kPixelGrabFilterBox);
+  ASSERT_NE(copy, nullptr);
+  EXPECT_TRUE(SamePixels(img, copy));
+  pixelgrab_image_destroy(copy);
+  pixelgrab_image_destroy(img);
+}
+
+TEST_F(ScreenCaptureTest, ImageResizeKeepsFormatAndSize) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  ASSERT_EQ(pixelgrab_set_capture_format(ctx_, kPixelGrabFormatRgba8),
+            kPixelGrabOk);
+  PixelGrabImage* img = pixelgrab_capture_region(ctx_, 0, 0, 64, 64);
+  ASSERT_NE(img, nullptr);
+  PixelGrabImage* up =
+      pixelgrab_image_resize(img, 100, 90, kPixelGrabFilterLanczos3);
+  ASSERT_NE(up, nullptr);
+  EXPECT_EQ(pixelgrab_image_get_width(up), 100);
+  EXPECT_EQ(pixelgrab_image_get_height(up), 90);
+  EXPECT_EQ(pixelgrab_image_get_format(up), kPixelGrabFormatRgba8);
+  pixelgrab_image_destroy(up);
+  pixelgrab_image_destroy(img);
+}
+
+TEST_F(ScreenCaptureTest, ImageResizeInvalidParams) {
+  EXPECT_EQ(pixelgrab_image_resize(nullptr, 10, 10, kPixelGrabFilterBox),
+            nullptr);
+}
+
+// ---------------------------------------------------------------------------
+// Capture pixel format
+// ---------------------------------------------------------------------------
+
+TEST_F(ScreenCaptureTest, CaptureFormatDefaultsToBgra8) {
+  EXPECT_EQ(pixelgrab_get_capture_format(ctx_), kPixelGrabFormatBgra8);
+}
+
+TEST_F(ScreenCaptureTest, SetCaptureFormatRoundTrip) {
+  EXPECT_EQ(pixelgrab_set_capture_format(ctx_, kPixelGrabFormatRgba8),
+            kPixelGrabOk);
+  EXPECT_EQ(pixelgrab_get_capture_format(ctx_), kPixelGrabFormatRgba8);
+  EXPECT_EQ(pixelgrab_set_capture_format(ctx_, kPixelGrabFormatNative),
+            kPixelGrabOk);
+  EXPECT_EQ(pixelgrab_get_capture_format(ctx_), kPixelGrabFormatNative);
+}
+
+TEST_F(ScreenCaptureTest, SetCaptureFormatInvalid) {
+  EXPECT_EQ(pixelgrab_set_capture_format(
+                ctx_, static_cast<PixelGrabPixelFormat>(42)),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(pixelgrab_get_capture_format(ctx_), kPixelGrabFormatBgra8);
+}
+
+TEST_F(ScreenCaptureTest, CaptureFormatNullCtx) {
+  EXPECT_EQ(pixelgrab_set_capture_format(nullptr, kPixelGrabFormatRgba8),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(pixelgrab_get_capture_format(nullptr), kPixelGrabFormatBgra8);
+}
+
+TEST_F(ScreenCaptureTest, Rgba8CaptureIsOpaque) {
+  PixelGrabImage* bgra = pixelgrab_capture_region(ctx_, 0, 0, 37, 11);
+  if (!bgra) GTEST_SKIP() << "Capture unavailable";
+  ASSERT_EQ(pixelgrab_set_capture_format(ctx_, kPixelGrabFormatRgba8),
+            kPixelGrabOk);
+  PixelGrabImage* rgba = pixelgrab_capture_region(ctx_, 0, 0, 37, 11);
+  ASSERT_NE(rgba, nullptr);
+  EXPECT_EQ(pixelgrab_image_get_format(rgba), kPixelGrabFormatRgba8);
+
+  // The screen may change between the two reads, so only the geometry and
+  // the alpha channel are compared.
+  ASSERT_EQ(pixelgrab_image_get_width(rgba), pixelgrab_image_get_width(bgra));
+  ASSERT_EQ(pixelgrab_image_get_height(rgba),
+            pixelgrab_image_get_height(bgra));
+  const uint8_t* p = pixelgrab_image_get_data(rgba);
+  int stride = pixelgrab_image_get_stride(rgba);
+  for (int y = 0; y < 11; ++y) {
+    for (int x = 0; x < 37; ++x) {
+      EXPECT_EQ(p[y * stride + x * 4 + 3], 0xFF);
+    }
+  }
+  pixelgrab_image_destroy(rgba);
+  pixelgrab_image_destroy(bgra);
+}
+
+TEST_F(ScreenCaptureTest, CaptureFormatDoesNotAffectCaptureInto) {
+  ASSERT_EQ(pixelgrab_set_capture_format(ctx_, kPixelGrabFormatRgba8),
+            kPixelGrabOk);
+  std::vector<uint8_t> buf(8 * 8 * 4);
+  if (pixelgrab_capture_region_into(ctx_, 0, 0, 8, 8, buf.data(), 8 * 4) !=
+      kPixelGrabOk) {
+    GTEST_SKIP() << "Capture unavailable";
+  }
+  // Still a region capture in the context's format afterwards.
+  PixelGrabImage* img = pixelgrab_capture_region(ctx_, 0, 0, 8, 8);
+  ASSERT_NE(img, nullptr);
+  EXPECT_EQ(pixelgrab_image_get_format(img), kPixelGrabFormatRgba8);
+  pixelgrab_image_destroy(img);
+}
+
+// ---------------------------------------------------------------------------
+// Batch capture
+// ---------------------------------------------------------------------------
+
+TEST_F(ScreenCaptureTest, CaptureRegionsNullArgs) {
+  PixelGrabRect rect = {0, 0, 8, 8};
+  PixelGrabImage* out[1] = {};
+  EXPECT_EQ(pixelgrab_capture_regions(nullptr, &rect, 1, out),
+            kPixelGrabErrorInvalidParam);
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  EXPECT_EQ(pixelgrab_capture_regions(ctx_, nullptr, 1, out),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(pixelgrab_capture_regions(ctx_, &rect, 1, nullptr),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(pixelgrab_capture_regions(ctx_, &rect, 0, out),
+            kPixelGrabErrorInvalidParam);
+}
+
+TEST_F(ScreenCaptureTest, CaptureRegionsInvalidSize) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  PixelGrabRect rects[2] = {{0, 0, 8, 8}, {10, 10, 0, 5}};
+  PixelGrabImage* out[2] = {};
+  EXPECT_EQ(pixelgrab_capture_regions(ctx_, rects, 2, out),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(out[0], nullptr);
+  EXPECT_EQ(out[1], nullptr);
+}
+
+TEST_F(ScreenCaptureTest, CaptureRegionsSizes) {
+  PixelGrabRect rects[4] = {
+      {0, 0, 20, 10}, {30, 0, 16, 16}, {5, 40, 7, 3}, {400, 300, 50, 25}};
+  PixelGrabImage* out[4] = {};
+  PixelGrabError err = pixelgrab_capture_regions(ctx_, rects, 4, out);
+  if (err != kPixelGrabOk) GTEST_SKIP() << "Capture unavailable";
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_NE(out[i], nullptr);
+    EXPECT_EQ(pixelgrab_image_get_width(out[i]), rects[i].width);
+    EXPECT_EQ(pixelgrab_image_get_height(out[i]), rects[i].height);
+    EXPECT_EQ(pixelgrab_image_get_format(out[i]), kPixelGrabFormatBgra8);
+    pixelgrab_image_destroy(out[i]);
+  }
+}
+
+TEST_F(ScreenCaptureTest, CaptureRegionsOverlapAgrees) {
+  // Both regions come from the same read, so their overlap is identical.
+  PixelGrabRect rects[2] = {{0, 0, 40, 20}, {10, 5, 40, 20}};
+  PixelGrabImage* out[2] = {};
+  if (pixelgrab_capture_regions(ctx_, rects, 2, out) != kPixelGrabOk) {
+    GTEST_SKIP() << "Capture unavailable";
+  }
+  const uint8_t* a = pixelgrab_image_get_data(out[0]);
+  const uint8_t* b = pixelgrab_image_get_data(out[1]);
+  int sa = pixelgrab_image_get_stride(out[0]);
+  int sb = pixelgrab_image_get_stride(out[1]);
+  for (int y = 0; y < 15; ++y) {
+    EXPECT_EQ(std::memcmp(a + (y + 5) * sa + 10 * 4, b + y * sb, 30 * 4), 0)
+        << "row " << y;
+  }
+  pixelgrab_image_destroy(out[0]);
+  pixelgrab_image_destroy(out[1]);
+}
+
+TEST_F(ScreenCaptureTest, CaptureRegionsOffscreenEntryIsNull) {
+  if (!HasDisplay()) GTEST_SKIP() << "No display available";
+  PixelGrabRect rects[2] = {{0, 0, 8, 8}, {-5000, -5000, 8, 8}};
+  PixelGrabImage* out[2] = {};
+  EXPECT_EQ(pixelgrab_capture_regions(ctx_, rects, 2, out),
+            kPixelGrabErrorCaptureFailed);
+  EXPECT_NE(out[0], nullptr);
+  EXPECT_EQ(out[1], nullptr);
+  pixelgrab_image_destroy(out[0]);
+}
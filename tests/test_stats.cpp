@@ -0,0 +1,114 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Tests for: Performance statistics (per-stage counters and latencies)
+
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "pixelgrab/pixelgrab.h"
+#include "test_util.h"
+
+class StatsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Headless: the synthetic backend needs no display server.
+    ctx_ = CreateSynthetic(320, 240);
+    ASSERT_NE(ctx_, nullptr);
+  }
+
+  void TearDown() override { pixelgrab_context_destroy(ctx_); }
+
+  PixelGrabContext* ctx_ = nullptr;
+};
+
+TEST_F(StatsTest, FreshContextIsEmpty) {
+  for (int s = 0; s < kPixelGrabStageCount; ++s) {
+    PixelGrabStageStats stats;
+    ASSERT_EQ(pixelgrab_get_stats(ctx_, static_cast<PixelGrabStage>(s),
+                                  &stats),
+              kPixelGrabOk);
+    EXPECT_EQ(stats.count, 0u);
+    EXPECT_EQ(stats.max_ms, 0.0);
+  }
+}
+
+TEST_F(StatsTest, CountsCapturesAndHistory) {
+  // Compress history images in the capture call, so the history stage is
+  // complete when the captures return.
+  ASSERT_EQ(pixelgrab_history_set_queue(ctx_, 0,
+                                        kPixelGrabHistoryBackpressureInline),
+            kPixelGrabOk);
+  for (int i = 0; i < 5; ++i) {
+    pixelgrab_image_destroy(pixelgrab_capture_region(ctx_, 0, 0, 64, 32));
+  }
+  // Entirely off-screen: a failed read.
+  EXPECT_EQ(pixelgrab_capture_region(ctx_, 5000, 0, 8, 8), nullptr);
+
+  PixelGrabStageStats capture;
+  ASSERT_EQ(pixelgrab_get_stats(ctx_, kPixelGrabStageCapture, &capture),
+            kPixelGrabOk);
+  EXPECT_EQ(capture.count, 6u);
+  EXPECT_EQ(capture.failures, 1u);
+  EXPECT_EQ(capture.bytes, 5u * 64 * 32 * 4);
+  EXPECT_LE(capture.p50_ms, capture.p99_ms);
+  EXPECT_LE(capture.p99_ms, capture.max_ms);
+  EXPECT_GE(capture.total_ms, capture.max_ms);
+
+  // Region captures are stored (compressed) in the history.
+  PixelGrabStageStats history;
+  ASSERT_EQ(pixelgrab_get_stats(ctx_, kPixelGrabStageHistoryCompress,
+                                &history),
+            kPixelGrabOk);
+  EXPECT_EQ(history.count, 5u);
+
+  // Format conversion is only counted when pixels are rewritten.
+  PixelGrabStageStats convert;
+  pixelgrab_get_stats(ctx_, kPixelGrabStageConvert, &convert);
+  EXPECT_EQ(convert.count, 0u);
+
+  pixelgrab_stats_reset(ctx_);
+  pixelgrab_get_stats(ctx_, kPixelGrabStageCapture, &capture);
+  EXPECT_EQ(capture.count, 0u);
+}
+
+TEST_F(StatsTest, ProcessTotalsIncludeContexts) {
+  PixelGrabStageStats before;
+  ASSERT_EQ(pixelgrab_get_stats(nullptr, kPixelGrabStageCapture, &before),
+            kPixelGrabOk);
+  pixelgrab_image_destroy(pixelgrab_capture_screen(ctx_, 0));
+  PixelGrabStageStats after;
+  pixelgrab_get_stats(nullptr, kPixelGrabStageCapture, &after);
+  EXPECT_EQ(after.count, before.count + 1);
+
+  // Resetting the context leaves the totals alone.
+  pixelgrab_stats_reset(ctx_);
+  pixelgrab_get_stats(nullptr, kPixelGrabStageCapture, &after);
+  EXPECT_EQ(after.count, before.count + 1);
+}
+
+TEST_F(StatsTest, Dump) {
+  pixelgrab_image_destroy(pixelgrab_capture_region(ctx_, 0, 0, 16, 16));
+
+  char* json = pixelgrab_stats_dump(ctx_, kPixelGrabStatsJson);
+  ASSERT_NE(json, nullptr);
+  std::string j = json;
+  pixelgrab_free_string(json);
+  EXPECT_EQ(j.front(), '{');
+  EXPECT_EQ(j.back(), '}');
+  EXPECT_NE(j.find("\"capture\":{\"count\":1,"), std::string::npos);
+  EXPECT_NE(j.find("\"recorder\":"), std::string::npos);
+  EXPECT_NE(j.find("\"p99_ms\":"), std::string::npos);
+
+  char* text = pixelgrab_stats_dump(ctx_, kPixelGrabStatsText);
+  ASSERT_NE(text, nullptr);
+  EXPECT_NE(std::strstr(text, "history_compress"), nullptr);
+  pixelgrab_free_string(text);
+}
+
+TEST(StatsStandaloneTest, InvalidParams) {
+  PixelGrabStageStats stats;
+  EXPECT_EQ(pixelgrab_get_stats(nullptr, kPixelGrabStageCount, &stats),
+            kPixelGrabErrorInvalidParam);
+  EXPECT_EQ(pixelgrab_get_stats(nullptr, kPixelGrabStageCapture, nullptr),
+            kPixelGrabErrorInvalidParam);
+}
@@ -0,0 +1,157 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Tests for: Synthetic capture backend (headless, deterministic)
+
+#include "gtest/gtest.h"
+#include "pixelgrab/pixelgrab.h"
+#include "test_util.h"
+
+namespace {
+
+// Two 640x360 monitors side by side.
+PixelGrabContext* CreateTwoScreens(int damage_percent, uint32_t seed = 1) {
+  PixelGrabSyntheticConfig scene = {};
+  scene.screen_count = 2;
+  scene.screen_width = 640;
+  scene.screen_height = 360;
+  scene.damage_percent = damage_percent;
+  scene.seed = seed;
+  return CreateSynthetic(scene);
+}
+
+}  // namespace
+
+TEST(SyntheticBackendTest, ReportsVirtualMonitors) {
+  PixelGrabContext* ctx = CreateTwoScreens(10);
+  ASSERT_NE(ctx, nullptr);
+  EXPECT_EQ(pixelgrab_get_backend_type(ctx), kPixelGrabBackendSynthetic);
+  ASSERT_EQ(pixelgrab_get_screen_count(ctx), 2);
+
+  PixelGrabScreenInfo info = {};
+  ASSERT_EQ(pixelgrab_get_screen_info(ctx, 1, &info), kPixelGrabOk);
+  EXPECT_EQ(info.x, 640);
+  EXPECT_EQ(info.y, 0);
+  EXPECT_EQ(info.width, 640);
+  EXPECT_EQ(info.height, 360);
+  EXPECT_EQ(info.is_primary, 0);
+
+  PixelGrabImage* screen = pixelgrab_capture_screen(ctx, 1);
+  ASSERT_NE(screen, nullptr);
+  EXPECT_EQ(pixelgrab_image_get_width(screen), 640);
+  EXPECT_EQ(pixelgrab_image_get_height(screen), 360);
+  pixelgrab_image_destroy(screen);
+  pixelgrab_context_destroy(ctx);
+}
+
+TEST(SyntheticBackendTest, FramesAreReproducible) {
+  PixelGrabContext* a = CreateTwoScreens(30, 42);
+  PixelGrabContext* b = CreateTwoScreens(30, 42);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  for (int frame = 0; frame < 3; ++frame) {
+    PixelGrabImage* ia = pixelgrab_capture_region(a, 0, 0, 1280, 360);
+    PixelGrabImage* ib = pixelgrab_capture_region(b, 0, 0, 1280, 360);
+    ASSERT_NE(ia, nullptr);
+    ASSERT_NE(ib, nullptr);
+    EXPECT_TRUE(SamePixels(ia, ib)) << "frame " << frame;
+    pixelgrab_image_destroy(ia);
+    pixelgrab_image_destroy(ib);
+  }
+  pixelgrab_context_destroy(a);
+  pixelgrab_context_destroy(b);
+}
+
+TEST(SyntheticBackendTest, DamageRateControlsChanges) {
+  PixelGrabContext* still = CreateTwoScreens(0);
+  PixelGrabContext* busy = CreateTwoScreens(50);
+  ASSERT_NE(still, nullptr);
+  ASSERT_NE(busy, nullptr);
+
+  int changed_tiles[2] = {-1, -1};
+  PixelGrabContext* contexts[2] = {still, busy};
+  for (int i = 0; i < 2; ++i) {
+    PixelGrabImage* f0 = pixelgrab_capture_screen(contexts[i], 0);
+    PixelGrabImage* f1 = pixelgrab_capture_screen(contexts[i], 0);
+    ASSERT_NE(f0, nullptr);
+    ASSERT_NE(f1, nullptr);
+    EXPECT_EQ(pixelgrab_image_diff(f0, f1, 64, nullptr, 0, &changed_tiles[i]),
+              kPixelGrabOk);
+    pixelgrab_image_destroy(f0);
+    pixelgrab_image_destroy(f1);
+  }
+  // 10 x 6 tiles per screen.
+  EXPECT_EQ(changed_tiles[0], 0);
+  EXPECT_GT(changed_tiles[1], 10);
+  EXPECT_LT(changed_tiles[1], 50);
+
+  pixelgrab_context_destroy(still);
+  pixelgrab_context_destroy(busy);
+}
+
+TEST(SyntheticBackendTest, IncrementalReportsAnimatedTiles) {
+  PixelGrabContext* ctx = CreateTwoScreens(25);
+  ASSERT_NE(ctx, nullptr);
+  PixelGrabRect changed[64];
+  int count = 0;
+  PixelGrabImage* first = pixelgrab_capture_region_incremental(
+      ctx, 0, 0, 640, 360, changed, 64, &count);
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(count, 1);
+
+  PixelGrabImage* second = pixelgrab_capture_region_incremental(
+      ctx, 0, 0, 640, 360, changed, 64, &count);
+  ASSERT_NE(second, nullptr);
+  int diff_count = -1;
+  ASSERT_EQ(pixelgrab_image_diff(first, second, 64, nullptr, 0, &diff_count),
+            kPixelGrabOk);
+  // Every tile that really changed is reported, aligned to the 64 grid.
+  EXPECT_GE(count, diff_count);
+  EXPECT_GT(count, 1);
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(changed[i].x % 64, 0);
+    EXPECT_EQ(changed[i].y % 64, 0);
+  }
+  pixelgrab_image_destroy(first);
+  pixelgrab_image_destroy(second);
+  pixelgrab_context_destroy(ctx);
+}
+
+TEST(SyntheticBackendTest, WindowsAndClipping) {
+  PixelGrabContext* ctx = CreateTwoScreens(10);
+  ASSERT_NE(ctx, nullptr);
+  PixelGrabWindowInfo windows[16];
+  int n = pixelgrab_enumerate_windows(ctx, windows, 16);
+  ASSERT_EQ(n, 6);
+  PixelGrabImage* window = pixelgrab_capture_window(ctx, windows[4].id);
+  ASSERT_NE(window, nullptr);
+  EXPECT_EQ(pixelgrab_image_get_width(window), windows[4].width);
+  pixelgrab_image_destroy(window);
+
+  // Clipped to the 1280x360 desktop.
+  PixelGrabImage* edge = pixelgrab_capture_region(ctx, 1200, 300, 200, 200);
+  ASSERT_NE(edge, nullptr);
+  EXPECT_EQ(pixelgrab_image_get_width(edge), 80);
+  EXPECT_EQ(pixelgrab_image_get_height(edge), 60);
+  pixelgrab_image_destroy(edge);
+  EXPECT_EQ(pixelgrab_capture_region(ctx, 5000, 0, 10, 10), nullptr);
+  pixelgrab_context_destroy(ctx);
+}
+
+TEST(SyntheticBackendTest, CaptureFormat) {
+  PixelGrabContext* ctx = CreateTwoScreens(0);
+  ASSERT_NE(ctx, nullptr);
+  PixelGrabImage* bgra = pixelgrab_capture_region(ctx, 0, 0, 32, 32);
+  ASSERT_EQ(pixelgrab_set_capture_format(ctx, kPixelGrabFormatRgba8),
+            kPixelGrabOk);
+  PixelGrabImage* rgba = pixelgrab_capture_region(ctx, 0, 0, 32, 32);
+  ASSERT_NE(bgra, nullptr);
+  ASSERT_NE(rgba, nullptr);
+  EXPECT_EQ(pixelgrab_image_get_format(rgba), kPixelGrabFormatRgba8);
+  const uint8_t* b = pixelgrab_image_get_data(bgra);
+  const uint8_t* r = pixelgrab_image_get_data(rgba);
+  EXPECT_EQ(b[0], r[2]);
+  EXPECT_EQ(b[1], r[1]);
+  EXPECT_EQ(b[2], r[0]);
+  pixelgrab_image_destroy(bgra);
+  pixelgrab_image_destroy(rgba);
+  pixelgrab_context_destroy(ctx);
+}
@@ -0,0 +1,61 @@
+// Copyright 2026 The loong-pixelgrab Authors
+// Helpers shared by tests that run headless on the synthetic backend.
+
+#ifndef PIXELGRAB_TESTS_TEST_UTIL_H_
+#define PIXELGRAB_TESTS_TEST_UTIL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "pixelgrab/pixelgrab.h"
+
+/// A context on the synthetic backend showing |scene|.  Evicted history is
+/// kept in |history_directory| if given.
+inline PixelGrabContext* CreateSynthetic(
+    const PixelGrabSyntheticConfig& scene,
+    const char* history_directory = nullptr) {
+  PixelGrabContextOptions options = {};
+  options.backend = kPixelGrabBackendSynthetic;
+  options.synthetic = &scene;
+  options.history_directory = history_directory;
+  return pixelgrab_context_create_with_options(&options);
+}
+
+/// A context on the synthetic backend with one |width| x |height| monitor
+/// on which |damage_percent| of the tiles animate.
+inline PixelGrabContext* CreateSynthetic(int width, int height,
+                                         int damage_percent = 0) {
+  PixelGrabSyntheticConfig scene = {};
+  scene.screen_width = width;
+  scene.screen_height = height;
+  scene.damage_percent = damage_percent;
+  return CreateSynthetic(scene);
+}
+
+/// True if |a| and |b| have the same size, format and pixels.  Rows are
+/// compared up to the width, so the strides may differ (e.g. views).
+inline bool SamePixels(const PixelGrabImage* a, const PixelGrabImage* b) {
+  if (!a || !b) return false;
+  const int width = pixelgrab_image_get_width(a);
+  const int height = pixelgrab_image_get_height(a);
+  if (width != pixelgrab_image_get_width(b) ||
+      height != pixelgrab_image_get_height(b) ||
+      pixelgrab_image_get_format(a) != pixelgrab_image_get_format(b)) {
+    return false;
+  }
+  const uint8_t* pa = pixelgrab_image_get_data(a);
+  const uint8_t* pb = pixelgrab_image_get_data(b);
+  const int sa = pixelgrab_image_get_stride(a);
+  const int sb = pixelgrab_image_get_stride(b);
+  for (int row = 0; row < height; ++row) {
+    if (std::memcmp(pa + static_cast<ptrdiff_t>(row) * sa,
+                    pb + static_cast<ptrdiff_t>(row) * sb,
+                    static_cast<size_t>(width) * 4) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#endif  // PIXELGRAB_TESTS_TEST_UTIL_H_